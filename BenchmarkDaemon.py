@@ -0,0 +1,54 @@
+import argparse
+import os
+import statistics
+import subprocess
+import tempfile
+import time
+
+
+def run_commands(cli, args, count):
+    latencies = []
+    for _ in range(count):
+        start = time.perf_counter()
+        subprocess.run([cli] + args, check=True, stdout=subprocess.DEVNULL)
+        latencies.append((time.perf_counter() - start) * 1000.0)
+    return latencies
+
+
+def report(name, latencies):
+    latencies = sorted(latencies)
+    p95 = latencies[min(len(latencies) - 1, int(len(latencies) * 0.95))]
+    print('{:<10} n={:<4} mean={:8.1f} ms  median={:8.1f} ms  p95={:8.1f} ms  min={:8.1f} ms'.format(
+        name, len(latencies), statistics.mean(latencies), statistics.median(latencies), p95, latencies[0]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compares per-command latency of one-shot and daemon mode')
+    parser.add_argument('cli', help='Path to the RemoteCli executable')
+    parser.add_argument('--count', type=int, default=20, help='Commands per mode')
+    parser.add_argument('--prop', default='FNumber', help='Property read by each command')
+    args = parser.parse_args()
+
+    socket = os.path.join(tempfile.gettempdir(), 'RemoteCliBenchmark.sock')
+    command = ['get', '--prop', args.prop, '--socket', socket]
+
+    # One-shot: nothing is listening on the socket, so every call connects on its own
+    subprocess.run([args.cli, 'serve', '--stop', '--socket', socket], stdout=subprocess.DEVNULL)
+    oneshot = run_commands(args.cli, command, args.count)
+
+    daemon = subprocess.Popen([args.cli, 'serve', '--socket', socket], stdout=subprocess.DEVNULL)
+    try:
+        while not os.path.exists(socket):
+            if daemon.poll() is not None:
+                raise RuntimeError('daemon exited with status {}'.format(daemon.returncode))
+            time.sleep(0.05)
+        served = run_commands(args.cli, command, args.count)
+    finally:
+        subprocess.run([args.cli, 'serve', '--stop', '--socket', socket], stdout=subprocess.DEVNULL)
+        daemon.wait()
+
+    report('one-shot', oneshot)
+    report('daemon', served)
+
+if __name__ == '__main__':
+    main()
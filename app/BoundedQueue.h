@@ -0,0 +1,105 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace cli
+{
+// Fixed capacity queue for any number of producers and consumers, without locks or allocation after construction.
+// Each cell carries a sequence number telling whether it is free for the producer of that round or holds
+// the value for the consumer of that round, so a push or pop is one compare-exchange on the shared index.
+// try_push() and try_pop() fail instead of waiting when the queue is full or empty.
+template <typename T>
+class BoundedQueue
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit BoundedQueue(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool try_push(T value)
+    {
+        auto pos = m_push.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& cell = m_cells[pos & m_mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (0 == diff) {
+                if (m_push.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false; // Full
+            }
+            else {
+                pos = m_push.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value)
+    {
+        auto pos = m_pop.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& cell = m_cells[pos & m_mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (0 == diff) {
+                if (m_pop.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false; // Empty
+            }
+            else {
+                pos = m_pop.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+    // Only a snapshot while producers or consumers are running
+    std::size_t size() const
+    {
+        auto push = m_push.load(std::memory_order_acquire);
+        auto pop = m_pop.load(std::memory_order_acquire);
+        return push < pop ? 0 : push - pop;
+    }
+    bool empty() const { return 0 == size(); }
+
+private:
+    // Keeps the two indexes off each other's cache line
+    static constexpr std::size_t const cache_line = 64;
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask = 0;
+    alignas(cache_line) std::atomic<std::size_t> m_push{ 0 };
+    alignas(cache_line) std::atomic<std::size_t> m_pop{ 0 };
+};
+} // namespace cli
+
+#endif // !BOUNDEDQUEUE_H
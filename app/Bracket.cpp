@@ -0,0 +1,57 @@
+#include "Bracket.h"
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+Bracket::Bracket(CameraDevice& camera, BracketProperty property)
+    : m_camera(camera)
+    , m_property(property)
+    , m_shots(camera)
+{}
+
+bool Bracket::run(const std::vector<CrInt64>& values, std::chrono::milliseconds download_timeout)
+{
+    auto started = std::chrono::steady_clock::now();
+    m_steps.clear();
+
+    CrInt32u code = (BracketProperty::exposure_bias == m_property)
+        ? SDK::CrDevicePropertyCode::CrDeviceProperty_ExposureBiasCompensation
+        : SDK::CrDevicePropertyCode::CrDeviceProperty_ShutterSpeed;
+    CrInt64 original = 0;
+    bool restore = m_camera.get_property_value(code, original);
+
+    bool success = m_shots.begin();
+    for (std::uint32_t i = 0; i < values.size(); ++i) {
+        BracketStep step{ values[i], false, false, {}, {} };
+
+        // Sent while the previous image is still on its way
+        auto step_start = std::chrono::steady_clock::now();
+        step.confirmed = set_value(values[i]);
+        auto confirmed = std::chrono::steady_clock::now();
+        step.set_time = std::chrono::duration_cast<std::chrono::milliseconds>(confirmed - step_start);
+
+        bool saved = m_shots.wait_for_transfers(0, download_timeout);
+        step.wait = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - confirmed);
+
+        // A frame at the wrong value is worse than a missing one
+        if (step.confirmed && saved) step.fired = m_shots.fire(i);
+        success = step.fired && saved && success;
+        m_steps.push_back(step);
+        if (m_step_sink) m_step_sink(i, step);
+    }
+    success = m_shots.finish(download_timeout) && success;
+
+    if (restore) set_value(original);
+    m_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    return success;
+}
+
+bool Bracket::set_value(CrInt64 value)
+{
+    if (BracketProperty::exposure_bias == m_property) {
+        return m_camera.set_exposure_bias_comp(static_cast<CrInt16>(value));
+    }
+    return m_camera.set_shutter_speed(static_cast<CrInt32u>(value));
+}
+} // namespace cli
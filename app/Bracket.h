@@ -0,0 +1,66 @@
+#ifndef BRACKET_H
+#define BRACKET_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BurstCapture.h"
+#include "CameraDevice.h"
+
+namespace cli
+{
+// Property stepped through by a bracket
+enum class BracketProperty
+{
+    exposure_bias, // CrDeviceProperty_ExposureBiasCompensation, in 1/1000 EV
+    shutter_speed  // CrDeviceProperty_ShutterSpeed, as the camera encodes it
+};
+
+struct BracketStep
+{
+    CrInt64 value;
+    bool confirmed; // The camera reported the value
+    bool fired;     // Captured
+    std::chrono::milliseconds set_time; // From the set request to the camera confirming it
+    std::chrono::milliseconds wait;     // Then until the previous image was saved
+};
+
+// Takes one frame per value within a single connection. Each frame is fired once the camera confirmed
+// its value and the previous frame's image was saved, with no fixed waits. The next value is set
+// while the previous image is still downloading. The value in effect before the bracket is restored after it.
+class Bracket
+{
+public:
+    // Called after each step was fired or given up on, on the caller's thread
+    using StepSink = std::function<void(std::uint32_t step, const BracketStep& result)>;
+
+    Bracket(CameraDevice& camera, BracketProperty property);
+
+    Bracket(const Bracket&) = delete;
+    Bracket& operator=(const Bracket&) = delete;
+
+    void set_step_sink(StepSink sink) { m_step_sink = std::move(sink); }
+    // Images are reported as they are saved, numbered by step
+    void set_result_sink(BurstCapture::ResultSink sink) { m_shots.set_result_sink(std::move(sink)); }
+
+    // True when every value was confirmed and every frame saved
+    bool run(const std::vector<CrInt64>& values, std::chrono::milliseconds download_timeout);
+
+    const std::vector<BracketStep>& steps() const { return m_steps; }
+    BurstStats shot_stats() const { return m_shots.stats(); }
+    std::chrono::milliseconds elapsed() const { return m_elapsed; }
+
+private:
+    bool set_value(CrInt64 value);
+
+    CameraDevice& m_camera;
+    BracketProperty m_property;
+    BurstCapture m_shots;
+    StepSink m_step_sink;
+    std::vector<BracketStep> m_steps;
+    std::chrono::milliseconds m_elapsed{ 0 };
+};
+} // namespace cli
+
+#endif // !BRACKET_H
@@ -0,0 +1,127 @@
+#include "BurstCapture.h"
+#include <algorithm>
+#include <thread>
+
+namespace cli
+{
+BurstCapture::BurstCapture(CameraDevice& camera)
+    : m_camera(camera)
+{}
+
+BurstCapture::~BurstCapture()
+{
+    m_camera.set_download_sink(nullptr);
+}
+
+bool BurstCapture::run(std::uint32_t count, std::chrono::milliseconds interval, std::chrono::milliseconds download_timeout)
+{
+    if (0 == count) return true;
+
+    bool success = begin();
+    auto next = std::chrono::steady_clock::now();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        // A shot that ran late starts the next interval from now rather than firing a catch-up burst
+        std::this_thread::sleep_until(next);
+        next = std::max(next + interval, std::chrono::steady_clock::now());
+        success = fire(i) && success;
+    }
+    return finish(download_timeout) && success;
+}
+
+bool BurstCapture::begin()
+{
+    m_camera.set_download_sink([this](const text& file, std::chrono::steady_clock::time_point completed) {
+        on_download(file, completed);
+    });
+    return m_camera.arm_release();
+}
+
+bool BurstCapture::fire(std::uint32_t number)
+{
+    auto capture_count = m_camera.get_capture_count();
+    {
+        // Queued before the release, as the image can arrive before release_shot() returns
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_in_transfer.push_back({ number, std::chrono::steady_clock::now() });
+        if (0 == m_shots) m_first_issued = m_in_transfer.back().issued;
+        m_last_issued = m_in_transfer.back().issued;
+        ++m_shots;
+    }
+    bool released = m_camera.release_shot();
+    bool captured = released && capture_count < m_camera.get_capture_count();
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (captured) {
+        ++m_captured;
+    }
+    else {
+        // No image will come for it
+        auto it = std::find_if(m_in_transfer.begin(), m_in_transfer.end(), [number](const Shot& shot) { return number == shot.number; });
+        if (m_in_transfer.end() != it) m_in_transfer.erase(it);
+    }
+    return captured;
+}
+
+bool BurstCapture::finish(std::chrono::milliseconds download_timeout)
+{
+    bool success = m_camera.half_press_up();
+
+    bool transferred = wait_for_transfers(0, download_timeout);
+    m_camera.set_download_sink(nullptr);
+    return transferred && success;
+}
+
+std::size_t BurstCapture::in_transfer() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_in_transfer.size();
+}
+
+bool BurstCapture::wait_for_transfers(std::size_t at_most, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    return m_cv.wait_for(lock, timeout, [&] { return m_in_transfer.size() <= at_most; });
+}
+
+void BurstCapture::on_download(const text& file, std::chrono::steady_clock::time_point completed)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        // Not from this burst
+        if (m_in_transfer.empty()) return;
+        auto shot = m_in_transfer.front();
+        m_in_transfer.pop_front();
+        auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(completed - shot.issued);
+        m_latencies.push_back(latency);
+        m_last_download = completed;
+        // Reported under the lock, so that run() cannot return before the last image was reported
+        if (m_result_sink) m_result_sink(shot.number, file, latency);
+    }
+    m_cv.notify_all();
+}
+
+BurstStats BurstCapture::stats() const
+{
+    BurstStats result{};
+    std::vector<std::chrono::milliseconds> latencies;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        result.shots = m_shots;
+        result.captured = m_captured;
+        result.downloaded = static_cast<std::uint32_t>(m_latencies.size());
+        result.firing = std::chrono::duration_cast<std::chrono::milliseconds>(m_last_issued - m_first_issued);
+        if (!m_latencies.empty()) result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(m_last_download - m_first_issued);
+        latencies = m_latencies;
+    }
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        auto at = [&](double p) { return latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]; };
+        result.latency_p50 = at(0.50);
+        result.latency_p90 = at(0.90);
+        result.latency_p99 = at(0.99);
+        result.latency_max = at(1.0);
+    }
+    return result;
+}
+} // namespace cli
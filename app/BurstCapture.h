@@ -0,0 +1,99 @@
+#ifndef BURSTCAPTURE_H
+#define BURSTCAPTURE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "CameraDevice.h"
+#include "Text.h"
+
+namespace cli
+{
+struct BurstStats
+{
+    std::uint32_t shots;      // Release sent
+    std::uint32_t captured;   // Confirmed by CrNotify_Captured_Event
+    std::uint32_t downloaded; // Saved to the computer
+    std::chrono::milliseconds firing;  // First to last release
+    std::chrono::milliseconds elapsed; // First release to last download
+    // Release to OnCompleteDownload of the same image
+    std::chrono::milliseconds latency_p50;
+    std::chrono::milliseconds latency_p90;
+    std::chrono::milliseconds latency_p99;
+    std::chrono::milliseconds latency_max;
+
+    double shots_per_second() const
+    {
+        return 0 < firing.count() ? (shots - 1) * 1000.0 / firing.count() : 0.0;
+    }
+    // Images on disk per second over the whole burst, downloads included
+    double frames_per_second() const
+    {
+        return 0 < elapsed.count() ? downloaded * 1000.0 / elapsed.count() : 0.0;
+    }
+};
+
+// Fires a series of shots while the earlier images are still being transferred.
+// The camera stays half pressed for the whole burst, so only the first shot waits for focus.
+// Images arrive in the order they were captured, so each download is matched with the oldest shot still in transfer.
+class BurstCapture
+{
+public:
+    // Called on an event thread of CameraDevice as each image is saved; shot counts from 0
+    using ResultSink = std::function<void(std::uint32_t shot, const text& file, std::chrono::milliseconds latency)>;
+
+    explicit BurstCapture(CameraDevice& camera);
+    ~BurstCapture();
+
+    BurstCapture(const BurstCapture&) = delete;
+    BurstCapture& operator=(const BurstCapture&) = delete;
+
+    void set_result_sink(ResultSink sink) { m_result_sink = std::move(sink); }
+
+    // Fires count shots, one per interval or as fast as the camera takes them with a zero interval.
+    // Then waits up to download_timeout for the images still in transfer.
+    // True when every shot was captured and saved.
+    bool run(std::uint32_t count, std::chrono::milliseconds interval, std::chrono::milliseconds download_timeout);
+
+    // The steps of run(), for callers that schedule the shots themselves.
+    // begin() arms the camera and follows its downloads; fire() sends one shot numbered as the caller likes
+    // and returns once the camera confirmed the capture; finish() lets go of S1 and waits for the transfers.
+    bool begin();
+    bool fire(std::uint32_t number);
+    bool finish(std::chrono::milliseconds download_timeout);
+    // Shots captured whose image has not arrived yet
+    std::size_t in_transfer() const;
+    // True once at most this many images are still in transfer
+    bool wait_for_transfers(std::size_t at_most, std::chrono::milliseconds timeout);
+
+    BurstStats stats() const;
+
+private:
+    struct Shot
+    {
+        std::uint32_t number;
+        std::chrono::steady_clock::time_point issued;
+    };
+
+    void on_download(const text& file, std::chrono::steady_clock::time_point completed);
+
+    CameraDevice& m_camera;
+    ResultSink m_result_sink;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<Shot> m_in_transfer; // Oldest first
+    std::vector<std::chrono::milliseconds> m_latencies;
+    std::uint32_t m_shots = 0;
+    std::uint32_t m_captured = 0;
+    std::chrono::steady_clock::time_point m_first_issued;
+    std::chrono::steady_clock::time_point m_last_issued;
+    std::chrono::steady_clock::time_point m_last_download;
+};
+} // namespace cli
+
+#endif // !BURSTCAPTURE_H
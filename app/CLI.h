@@ -7,26 +7,59 @@ namespace fs = std::experimental::filesystem;
 #include <unistd.h>
 #endif
 #endif
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <fstream>
+#include <future>
 #include <iomanip>
 #include <thread>
 #include <chrono>
 #include <iostream>
 #include "CRSDK/CameraRemote_SDK.h"
+#include "Bracket.h"
+#include "BurstCapture.h"
 #include "CameraDevice.h"
+#include "CameraSession.h"
+#include "Daemon.h"
+#include "FocusStack.h"
+#include "JsonLines.h"
+#include "LibManager.h"
+#include "MjpegServer.h"
+#include "PropertyTable.h"
+#include "RigCapture.h"
+#include "SyncJournal.h"
 #include "Text.h"
+#include "Timelapse.h"
 #include "clipp.h"
 
 enum class mode {
     capture,
+    timelapse,
+    bracket,
+    focusstack,
     get,
     set,
+    watch,
+    liveview,
+    contents,
+    download,
+    sync,
+    dump_index,
+    rig,
+    serve,
     sdk,
     help
 };
 
 //#define LIVEVIEW_ENB
 
+// Upper bound for a camera to connect and report its properties
+#define CONNECT_TIMEOUT 10000ms
+
+// Upper bound for a capture to arrive on the computer after release
+#define DOWNLOAD_TIMEOUT 5000ms
+
 namespace SDK = SCRSDK;
 using namespace SCRSDK;
 using namespace cli;
@@ -36,220 +69,213 @@ using std::string;
 
 typedef std::shared_ptr<CameraDevice> CameraDevicePtr;
 
-const std::unordered_map<text, CrInt32u> map_device_property
-{
-    {TEXT("Undefined"), CrDeviceProperty_Undefined},
-    {TEXT("S1"), CrDeviceProperty_S1},
-    {TEXT("AEL"), CrDeviceProperty_AEL},
-    {TEXT("FEL"), CrDeviceProperty_FEL},
-    {TEXT("AFL"), CrDeviceProperty_AFL},
-    {TEXT("AWBL"), CrDeviceProperty_AWBL},
-    {TEXT("FNumber"), CrDeviceProperty_FNumber},
-    {TEXT("ExposureBiasCompensation"), CrDeviceProperty_ExposureBiasCompensation},
-    {TEXT("FlashCompensation"), CrDeviceProperty_FlashCompensation},
-    {TEXT("ShutterSpeed"), CrDeviceProperty_ShutterSpeed},
-    {TEXT("IsoSensitivity"), CrDeviceProperty_IsoSensitivity},
-    {TEXT("ExposureProgramMode"), CrDeviceProperty_ExposureProgramMode},
-    {TEXT("FileType"), CrDeviceProperty_FileType},
-    {TEXT("JpegQuality"), CrDeviceProperty_JpegQuality},
-    {TEXT("WhiteBalance"), CrDeviceProperty_WhiteBalance},
-    {TEXT("FocusMode"), CrDeviceProperty_FocusMode},
-    {TEXT("MeteringMode"), CrDeviceProperty_MeteringMode},
-    {TEXT("FlashMode"), CrDeviceProperty_FlashMode},
-    {TEXT("WirelessFlash"), CrDeviceProperty_WirelessFlash},
-    {TEXT("RedEyeReduction"), CrDeviceProperty_RedEyeReduction},
-    {TEXT("DriveMode"), CrDeviceProperty_DriveMode},
-    {TEXT("DRO"), CrDeviceProperty_DRO},
-    {TEXT("ImageSize"), CrDeviceProperty_ImageSize},
-    {TEXT("AspectRatio"), CrDeviceProperty_AspectRatio},
-    {TEXT("PictureEffect"), CrDeviceProperty_PictureEffect},
-    {TEXT("FocusArea"), CrDeviceProperty_FocusArea},
-    {TEXT("Colortemp"), CrDeviceProperty_Colortemp},
-    {TEXT("ColorTuningAB"), CrDeviceProperty_ColorTuningAB},
-    {TEXT("ColorTuningGM"), CrDeviceProperty_ColorTuningGM},
-    {TEXT("LiveViewDisplayEffect"), CrDeviceProperty_LiveViewDisplayEffect},
-    {TEXT("StillImageStoreDestination"), CrDeviceProperty_StillImageStoreDestination},
-    {TEXT("PriorityKeySettings"), CrDeviceProperty_PriorityKeySettings},
-    {TEXT("Focus_Magnifier_Setting"), CrDeviceProperty_Focus_Magnifier_Setting},
-    {TEXT("DateTime_Settings"), CrDeviceProperty_DateTime_Settings},
-    {TEXT("NearFar"), CrDeviceProperty_NearFar},
-    {TEXT("AF_Area_Position"), CrDeviceProperty_AF_Area_Position},
-    {TEXT("Zoom_Scale"), CrDeviceProperty_Zoom_Scale},
-    {TEXT("Zoom_Setting"), CrDeviceProperty_Zoom_Setting},
-    {TEXT("Zoom_Operation"), CrDeviceProperty_Zoom_Operation},
-    {TEXT("Movie_File_Format"), CrDeviceProperty_Movie_File_Format},
-    {TEXT("Movie_Recording_Setting"), CrDeviceProperty_Movie_Recording_Setting},
-    {TEXT("Movie_Recording_FrameRateSetting"), CrDeviceProperty_Movie_Recording_FrameRateSetting},
-    {TEXT("CompressionFileFormatStill"), CrDeviceProperty_CompressionFileFormatStill},
-    {TEXT("MediaSLOT1_FileType"), CrDeviceProperty_MediaSLOT1_FileType},
-    {TEXT("MediaSLOT2_FileType"), CrDeviceProperty_MediaSLOT2_FileType},
-    {TEXT("MediaSLOT1_JpegQuality"), CrDeviceProperty_MediaSLOT1_JpegQuality},
-    {TEXT("MediaSLOT2_JpegQuality"), CrDeviceProperty_MediaSLOT2_JpegQuality},
-    {TEXT("MediaSLOT1_ImageSize"), CrDeviceProperty_MediaSLOT1_ImageSize},
-    {TEXT("MediaSLOT2_ImageSize"), CrDeviceProperty_MediaSLOT2_ImageSize},
-    {TEXT("RAW_FileCompressionType"), CrDeviceProperty_RAW_FileCompressionType},
-    {TEXT("MediaSLOT1_RAW_FileCompressionType"), CrDeviceProperty_MediaSLOT1_RAW_FileCompressionType},
-    {TEXT("MediaSLOT2_RAW_FileCompressionType"), CrDeviceProperty_MediaSLOT2_RAW_FileCompressionType},
-    {TEXT("ZoomAndFocusPosition_Save"), CrDeviceProperty_ZoomAndFocusPosition_Save},
-    {TEXT("ZoomAndFocusPosition_Load"), CrDeviceProperty_ZoomAndFocusPosition_Load},
-    {TEXT("S2"), CrDeviceProperty_S2},
-    {TEXT("Interval_Rec_Mode"), CrDeviceProperty_Interval_Rec_Mode},
-    {TEXT("Still_Image_Trans_Size"), CrDeviceProperty_Still_Image_Trans_Size},
-    {TEXT("RAW_J_PC_Save_Image"), CrDeviceProperty_RAW_J_PC_Save_Image},
-    {TEXT("LiveView_Image_Quality"), CrDeviceProperty_LiveView_Image_Quality},
-    {TEXT("CustomWB_Capture_Standby"), CrDeviceProperty_CustomWB_Capture_Standby},
-    {TEXT("CustomWB_Capture_Standby_Cancel"), CrDeviceProperty_CustomWB_Capture_Standby_Cancel},
-    {TEXT("CustomWB_Capture"), CrDeviceProperty_CustomWB_Capture},
-    {TEXT("Remocon_Zoom_Speed_Type"), CrDeviceProperty_Remocon_Zoom_Speed_Type},
-    {TEXT("GetOnly"), CrDeviceProperty_GetOnly},
-    {TEXT("SnapshotInfo"), CrDeviceProperty_SnapshotInfo},
-    {TEXT("BatteryRemain"), CrDeviceProperty_BatteryRemain},
-    {TEXT("BatteryLevel"), CrDeviceProperty_BatteryLevel},
-    {TEXT("EstimatePictureSize"), CrDeviceProperty_EstimatePictureSize},
-    {TEXT("RecordingState"), CrDeviceProperty_RecordingState},
-    {TEXT("LiveViewStatus"), CrDeviceProperty_LiveViewStatus},
-    {TEXT("FocusIndication"), CrDeviceProperty_FocusIndication},
-    {TEXT("MediaSLOT1_Status"), CrDeviceProperty_MediaSLOT1_Status},
-    {TEXT("MediaSLOT1_RemainingNumber"), CrDeviceProperty_MediaSLOT1_RemainingNumber},
-    {TEXT("MediaSLOT1_RemainingTime"), CrDeviceProperty_MediaSLOT1_RemainingTime},
-    {TEXT("MediaSLOT1_FormatEnableStatus"), CrDeviceProperty_MediaSLOT1_FormatEnableStatus},
-    {TEXT("MediaSLOT2_Status"), CrDeviceProperty_MediaSLOT2_Status},
-    {TEXT("MediaSLOT2_FormatEnableStatus"), CrDeviceProperty_MediaSLOT2_FormatEnableStatus},
-    {TEXT("MediaSLOT2_RemainingNumber"), CrDeviceProperty_MediaSLOT2_RemainingNumber},
-    {TEXT("MediaSLOT2_RemainingTime"), CrDeviceProperty_MediaSLOT2_RemainingTime},
-    {TEXT("Media_FormatProgressRate"), CrDeviceProperty_Media_FormatProgressRate},
-    {TEXT("LiveView_Area"), CrDeviceProperty_LiveView_Area},
-    {TEXT("Interval_Rec_Status"), CrDeviceProperty_Interval_Rec_Status},
-    {TEXT("CustomWB_Execution_State"), CrDeviceProperty_CustomWB_Execution_State},
-    {TEXT("CustomWB_Capturable_Area"), CrDeviceProperty_CustomWB_Capturable_Area},
-    {TEXT("CustomWB_Capture_Frame_Size"), CrDeviceProperty_CustomWB_Capture_Frame_Size},
-    {TEXT("CustomWB_Capture_Operation"), CrDeviceProperty_CustomWB_Capture_Operation},
-    {TEXT("Zoom_Operation_Status"), CrDeviceProperty_Zoom_Operation_Status},
-    {TEXT("Zoom_Bar_Information"), CrDeviceProperty_Zoom_Bar_Information},
-    {TEXT("Zoom_Type_Status"), CrDeviceProperty_Zoom_Type_Status},
-    {TEXT("MediaSLOT1_QuickFormatEnableStatus"), CrDeviceProperty_MediaSLOT1_QuickFormatEnableStatus},
-    {TEXT("MediaSLOT2_QuickFormatEnableStatus"), CrDeviceProperty_MediaSLOT2_QuickFormatEnableStatus},
-    {TEXT("Cancel_Media_FormatEnableStatus"), CrDeviceProperty_Cancel_Media_FormatEnableStatus},
-    {TEXT("Zoom_Speed_Range"), CrDeviceProperty_Zoom_Speed_Range},
-    {TEXT("SdkControlMode"), CrDeviceProperty_SdkControlMode},
-    {TEXT("ContentsTransferStatus"), CrDeviceProperty_ContentsTransferStatus},
-    {TEXT("ContentsTransferCancelEnableStatus"), CrDeviceProperty_ContentsTransferCancelEnableStatus},
-    {TEXT("ContentsTransferProgress"), CrDeviceProperty_ContentsTransferProgress},
-    {TEXT("MaxVal"), CrDeviceProperty_MaxVal}
-};
-
-const std::unordered_map<CrInt32u, text> map_property_names{
-    {CrDeviceProperty_Undefined, TEXT("Undefined")},
-    {CrDeviceProperty_S1, TEXT("S1")},
-    {CrDeviceProperty_AEL, TEXT("AEL")},
-    {CrDeviceProperty_FEL, TEXT("FEL")},
-    {CrDeviceProperty_AFL, TEXT("AFL")},
-    {CrDeviceProperty_AWBL, TEXT("AWBL")},
-    {CrDeviceProperty_FNumber, TEXT("FNumber")},
-    {CrDeviceProperty_ExposureBiasCompensation, TEXT("ExposureBiasCompensation")},
-    {CrDeviceProperty_FlashCompensation, TEXT("FlashCompensation")},
-    {CrDeviceProperty_ShutterSpeed, TEXT("ShutterSpeed")},
-    {CrDeviceProperty_IsoSensitivity, TEXT("IsoSensitivity")},
-    {CrDeviceProperty_ExposureProgramMode, TEXT("ExposureProgramMode")},
-    {CrDeviceProperty_FileType, TEXT("FileType")},
-    {CrDeviceProperty_JpegQuality, TEXT("JpegQuality")},
-    {CrDeviceProperty_WhiteBalance, TEXT("WhiteBalance")},
-    {CrDeviceProperty_FocusMode, TEXT("FocusMode")},
-    {CrDeviceProperty_MeteringMode, TEXT("MeteringMode")},
-    {CrDeviceProperty_FlashMode, TEXT("FlashMode")},
-    {CrDeviceProperty_WirelessFlash, TEXT("WirelessFlash")},
-    {CrDeviceProperty_RedEyeReduction, TEXT("RedEyeReduction")},
-    {CrDeviceProperty_DriveMode, TEXT("DriveMode")},
-    {CrDeviceProperty_DRO, TEXT("DRO")},
-    {CrDeviceProperty_ImageSize, TEXT("ImageSize")},
-    {CrDeviceProperty_AspectRatio, TEXT("AspectRatio")},
-    {CrDeviceProperty_PictureEffect, TEXT("PictureEffect")},
-    {CrDeviceProperty_FocusArea, TEXT("FocusArea")},
-    {CrDeviceProperty_Colortemp, TEXT("Colortemp")},
-    {CrDeviceProperty_ColorTuningAB, TEXT("ColorTuningAB")},
-    {CrDeviceProperty_ColorTuningGM, TEXT("ColorTuningGM")},
-    {CrDeviceProperty_LiveViewDisplayEffect, TEXT("LiveViewDisplayEffect")},
-    {CrDeviceProperty_StillImageStoreDestination, TEXT("StillImageStoreDestination")},
-    {CrDeviceProperty_PriorityKeySettings, TEXT("PriorityKeySettings")},
-    {CrDeviceProperty_Focus_Magnifier_Setting, TEXT("Focus_Magnifier_Setting")},
-    {CrDeviceProperty_DateTime_Settings, TEXT("DateTime_Settings")},
-    {CrDeviceProperty_NearFar, TEXT("NearFar")},
-    {CrDeviceProperty_AF_Area_Position, TEXT("AF_Area_Position")},
-    {CrDeviceProperty_Zoom_Scale, TEXT("Zoom_Scale")},
-    {CrDeviceProperty_Zoom_Setting, TEXT("Zoom_Setting")},
-    {CrDeviceProperty_Zoom_Operation, TEXT("Zoom_Operation")},
-    {CrDeviceProperty_Movie_File_Format, TEXT("Movie_File_Format")},
-    {CrDeviceProperty_Movie_Recording_Setting, TEXT("Movie_Recording_Setting")},
-    {CrDeviceProperty_Movie_Recording_FrameRateSetting, TEXT("Movie_Recording_FrameRateSetting")},
-    {CrDeviceProperty_CompressionFileFormatStill, TEXT("CompressionFileFormatStill")},
-    {CrDeviceProperty_MediaSLOT1_FileType, TEXT("MediaSLOT1_FileType")},
-    {CrDeviceProperty_MediaSLOT2_FileType, TEXT("MediaSLOT2_FileType")},
-    {CrDeviceProperty_MediaSLOT1_JpegQuality, TEXT("MediaSLOT1_JpegQuality")},
-    {CrDeviceProperty_MediaSLOT2_JpegQuality, TEXT("MediaSLOT2_JpegQuality")},
-    {CrDeviceProperty_MediaSLOT1_ImageSize, TEXT("MediaSLOT1_ImageSize")},
-    {CrDeviceProperty_MediaSLOT2_ImageSize, TEXT("MediaSLOT2_ImageSize")},
-    {CrDeviceProperty_RAW_FileCompressionType, TEXT("RAW_FileCompressionType")},
-    {CrDeviceProperty_MediaSLOT1_RAW_FileCompressionType, TEXT("MediaSLOT1_RAW_FileCompressionType")},
-    {CrDeviceProperty_MediaSLOT2_RAW_FileCompressionType, TEXT("MediaSLOT2_RAW_FileCompressionType")},
-    {CrDeviceProperty_ZoomAndFocusPosition_Save, TEXT("ZoomAndFocusPosition_Save")},
-    {CrDeviceProperty_ZoomAndFocusPosition_Load, TEXT("ZoomAndFocusPosition_Load")},
-    {CrDeviceProperty_S2, TEXT("S2")},
-    {CrDeviceProperty_Interval_Rec_Mode, TEXT("Interval_Rec_Mode")},
-    {CrDeviceProperty_Still_Image_Trans_Size, TEXT("Still_Image_Trans_Size")},
-    {CrDeviceProperty_RAW_J_PC_Save_Image, TEXT("RAW_J_PC_Save_Image")},
-    {CrDeviceProperty_LiveView_Image_Quality, TEXT("LiveView_Image_Quality")},
-    {CrDeviceProperty_CustomWB_Capture_Standby, TEXT("CustomWB_Capture_Standby")},
-    {CrDeviceProperty_CustomWB_Capture_Standby_Cancel, TEXT("CustomWB_Capture_Standby_Cancel")},
-    {CrDeviceProperty_CustomWB_Capture, TEXT("CustomWB_Capture")},
-    {CrDeviceProperty_Remocon_Zoom_Speed_Type, TEXT("Remocon_Zoom_Speed_Type")},
-    {CrDeviceProperty_GetOnly, TEXT("GetOnly")},
-    {CrDeviceProperty_SnapshotInfo, TEXT("SnapshotInfo")},
-    {CrDeviceProperty_BatteryRemain, TEXT("BatteryRemain")},
-    {CrDeviceProperty_BatteryLevel, TEXT("BatteryLevel")},
-    {CrDeviceProperty_EstimatePictureSize, TEXT("EstimatePictureSize")},
-    {CrDeviceProperty_RecordingState, TEXT("RecordingState")},
-    {CrDeviceProperty_LiveViewStatus, TEXT("LiveViewStatus")},
-    {CrDeviceProperty_FocusIndication, TEXT("FocusIndication")},
-    {CrDeviceProperty_MediaSLOT1_Status, TEXT("MediaSLOT1_Status")},
-    {CrDeviceProperty_MediaSLOT1_RemainingNumber, TEXT("MediaSLOT1_RemainingNumber")},
-    {CrDeviceProperty_MediaSLOT1_RemainingTime, TEXT("MediaSLOT1_RemainingTime")},
-    {CrDeviceProperty_MediaSLOT1_FormatEnableStatus, TEXT("MediaSLOT1_FormatEnableStatus")},
-    {CrDeviceProperty_MediaSLOT2_Status, TEXT("MediaSLOT2_Status")},
-    {CrDeviceProperty_MediaSLOT2_FormatEnableStatus, TEXT("MediaSLOT2_FormatEnableStatus")},
-    {CrDeviceProperty_MediaSLOT2_RemainingNumber, TEXT("MediaSLOT2_RemainingNumber")},
-    {CrDeviceProperty_MediaSLOT2_RemainingTime, TEXT("MediaSLOT2_RemainingTime")},
-    {CrDeviceProperty_Media_FormatProgressRate, TEXT("Media_FormatProgressRate")},
-    {CrDeviceProperty_LiveView_Area, TEXT("LiveView_Area")},
-    {CrDeviceProperty_Interval_Rec_Status, TEXT("Interval_Rec_Status")},
-    {CrDeviceProperty_CustomWB_Execution_State, TEXT("CustomWB_Execution_State")},
-    {CrDeviceProperty_CustomWB_Capturable_Area, TEXT("CustomWB_Capturable_Area")},
-    {CrDeviceProperty_CustomWB_Capture_Frame_Size, TEXT("CustomWB_Capture_Frame_Size")},
-    {CrDeviceProperty_CustomWB_Capture_Operation, TEXT("CustomWB_Capture_Operation")},
-    {CrDeviceProperty_Zoom_Operation_Status, TEXT("Zoom_Operation_Status")},
-    {CrDeviceProperty_Zoom_Bar_Information, TEXT("Zoom_Bar_Information")},
-    {CrDeviceProperty_Zoom_Type_Status, TEXT("Zoom_Type_Status")},
-    {CrDeviceProperty_MediaSLOT1_QuickFormatEnableStatus, TEXT("MediaSLOT1_QuickFormatEnableStatus")},
-    {CrDeviceProperty_MediaSLOT2_QuickFormatEnableStatus, TEXT("MediaSLOT2_QuickFormatEnableStatus")},
-    {CrDeviceProperty_Cancel_Media_FormatEnableStatus, TEXT("Cancel_Media_FormatEnableStatus")},
-    {CrDeviceProperty_Zoom_Speed_Range, TEXT("Zoom_Speed_Range")},
-    {CrDeviceProperty_SdkControlMode, TEXT("SdkControlMode")},
-    {CrDeviceProperty_ContentsTransferStatus, TEXT("ContentsTransferStatus")},
-    {CrDeviceProperty_ContentsTransferCancelEnableStatus, TEXT("ContentsTransferCancelEnableStatus")},
-    {CrDeviceProperty_ContentsTransferProgress, TEXT("ContentsTransferProgress")},
-    {CrDeviceProperty_MaxVal, TEXT("MaxVal")}
-};
+// The camera SDK every command goes through: the one linked, or the library given with --backend
+CRLibInterface const* cr_lib = linked_cr_lib();
 
 void releaseExitSuccess() {
-    SDK::Release();
+    cr_lib->Release();
     std::exit(EXIT_SUCCESS);
 }
 
 void releaseExitFailure() {
-    SDK::Release();
+    cr_lib->Release();
     std::exit(EXIT_FAILURE);
 }
 
-CameraDevicePtr getCamera(bool verbose) 
+// Options of one invocation, shared by the one-shot and daemon paths
+struct Request
+{
+    mode selected = mode::help;
+    bool verbose = false;
+    bool json = false;
+    bool timing = false;
+    bool all = false;
+    bool possible = false;
+    bool stop = false;
+    bool fetch_stats = false;
+    bool event_stats = false;
+    bool rescan = false;
+    int seconds = 0;
+    int count = 1;
+    int interval = 0;
+    int backlog = 2;
+    int steps = 0;
+    int size = 0;
+    int port = 0;
+    int workers = 4;
+    int jobs = 4;
+    unsigned long long min_size = 0;
+    unsigned long long max_size = 0;
+    string dir;
+    string index;
+    string folder;
+    string from;
+    string to;
+    string ext;
+    string dest;
+    string policy;
+    string overflow;
+    string ev;
+    string shutter;
+    string prop;
+    string val;
+    string socket;
+    string backend;
+    std::vector<string> assignments;
+};
+
+auto makeCli(Request& req)
+{
+    auto captureCommand = (
+        command("capture").set(req.selected, mode::capture).doc("Capture an image"),
+        option("--dir").doc("Output dir") & value("output dir", req.dir),
+        option("--timing").set(req.timing, true).doc("Prints the time taken by each shutter step"),
+        option("--all").set(req.all, true).doc("Fires every connected camera at once and prints the skew between them"),
+        option("--count").doc("Shots in a burst, fired while earlier images are still downloading") & value("count", req.count),
+        option("--interval").doc("Milliseconds from one shot of a burst to the next, as fast as possible by default") & value("ms", req.interval)
+    );
+
+    auto timelapseCommand = (
+        command("timelapse").set(req.selected, mode::timelapse).doc("Captures a frame at a fixed interval"),
+        required("--interval").doc("Milliseconds from one frame to the next") & value("ms", req.interval),
+        required("--count").doc("Frames to take") & value("count", req.count),
+        option("--policy").doc("When the camera or the downloads fall behind: skip frames (default) or adapt the interval") & value("skip|adapt", req.policy),
+        option("--backlog").doc("Images still downloading that count as falling behind, 2 by default") & value("images", req.backlog),
+        option("--dir").doc("Output dir") & value("output dir", req.dir)
+    );
+
+    auto bracketCommand = (
+        command("bracket").set(req.selected, mode::bracket).doc("Captures one frame per exposure value within one connection"),
+        (option("--ev").doc("Exposure compensation steps in EV, e.g. -2,0,2") & value("values", req.ev)) |
+        (option("--shutter").doc("Shutter speed steps as the camera encodes them, e.g. 0x00010064,0x000100C8") & value("values", req.shutter)),
+        option("--dir").doc("Output dir") & value("output dir", req.dir)
+    );
+
+    auto focusStackCommand = (
+        command("focusstack").set(req.selected, mode::focusstack).doc("Sweeps the focus in NearFar steps and captures a frame at each position"),
+        required("--steps").doc("Frames in the stack") & value("steps", req.steps),
+        required("--size").doc("NearFar step between frames, 1 to 7 towards far or -1 to -7 towards near") & value("size", req.size),
+        option("--backlog").doc("Images still downloading before a frame waits, 2 by default") & value("images", req.backlog),
+        option("--dir").doc("Output dir") & value("output dir", req.dir)
+    );
+
+    auto getCommand = (
+        command("get").set(req.selected, mode::get).doc("Gets the value of camera properties"),
+        (required("--prop").doc("Property names, separated by commas") & value("props", req.prop)) |
+        option("--all").set(req.all, true).doc("Every property the camera reports"),
+        option("--values").set(req.possible, true).doc("Also lists the values the camera accepts")
+    );
+
+    auto setCommand = (
+        command("set").set(req.selected, mode::set).doc("Sets the value of camera properties"),
+        (required("--prop").doc("Property name") & value("prop", req.prop),
+         required("--value").doc("Property value") & value("value", req.val)) |
+        values("prop=value", req.assignments).doc("Several properties, sent together")
+    );
+
+    auto watchCommand = (
+        command("watch").set(req.selected, mode::watch).doc("Prints property changes as the camera reports them"),
+        (required("--prop").doc("Property names, separated by commas") & value("props", req.prop)) |
+        option("--all").set(req.all, true).doc("Every property"),
+        option("--seconds").doc("Watching time, 10 by default") & value("seconds", req.seconds)
+    );
+
+    auto liveviewCommand = (
+        command("liveview").set(req.selected, mode::liveview).doc("Streams live view and prints frame statistics"),
+        option("--seconds").doc("Streaming time, 5 by default and unlimited with --serve") & value("seconds", req.seconds),
+        option("--dir").doc("Saves every received frame to this dir") & value("output dir", req.dir),
+        option("--serve").doc("Serves the stream as MJPEG to HTTP clients on 127.0.0.1:<port>") & value("port", req.port)
+    );
+
+    auto contentsCommand = (
+        command("contents").set(req.selected, mode::contents).doc("Lists the contents of the memory card as they are indexed"),
+        option("--workers").doc("Detail requests kept in flight, 4 by default") & value("workers", req.workers),
+        option("--index").doc("Directory of the contents index, the temp dir by default") & value("index dir", req.index),
+        option("--rescan").set(req.rescan, true).doc("Queries every file again instead of reusing the contents index")
+    );
+
+    auto transferOptions = (
+        option("--folder").doc("Only this date folder") & value("folder", req.folder),
+        option("--from").doc("Only contents dated from, e.g. 20261017 or 20261017T1200") & value("date", req.from),
+        option("--to").doc("Only contents dated up to, inclusive") & value("date", req.to),
+        option("--ext").doc("Only these extensions, e.g. JPG,ARW") & value("extensions", req.ext),
+        option("--min-size").doc("Only files of at least this many bytes") & value("bytes", req.min_size),
+        option("--max-size").doc("Only files of at most this many bytes") & value("bytes", req.max_size),
+        option("--jobs").doc("Downloads kept in flight, 4 by default") & value("jobs", req.jobs),
+        option("--workers").doc("Detail requests kept in flight, 4 by default") & value("workers", req.workers),
+        option("--index").doc("Directory of the contents index, the temp dir by default") & value("index dir", req.index),
+        option("--rescan").set(req.rescan, true).doc("Queries every file again instead of reusing the contents index")
+    );
+
+    auto downloadCommand = (
+        command("download").set(req.selected, mode::download).doc("Downloads all contents matching the filters"),
+        option("--dir").doc("Output dir") & value("output dir", req.dir),
+        transferOptions
+    );
+
+    auto syncCommand = (
+        command("sync").set(req.selected, mode::sync).doc("Mirrors the contents to a dir, skipping files copied before"),
+        required("--dest").doc("Destination dir") & value("dest dir", req.dest),
+        transferOptions
+    );
+
+    auto dumpIndexCommand = (
+        command("dump-index").set(req.selected, mode::dump_index).doc("Prints a contents index file"),
+        value("index file", req.index)
+    );
+
+    auto serveCommand = (
+        command("serve").set(req.selected, mode::serve).doc("Keeps the camera connected and serves capture/get/set/liveview to other invocations"),
+        option("--stop").set(req.stop, true).doc("Stops a running daemon")
+    );
+
+    auto rigCommand = (
+        command("rig").set(req.selected, mode::rig).doc("Connects every camera at once and reports how long the rig took to come online"),
+        option("--prop").doc("Also reads this property from every camera") & value("prop", req.prop)
+    );
+
+    return (
+        captureCommand |
+        timelapseCommand |
+        bracketCommand |
+        focusStackCommand |
+        getCommand |
+        setCommand |
+        watchCommand |
+        liveviewCommand |
+        contentsCommand |
+        downloadCommand |
+        syncCommand |
+        dumpIndexCommand |
+        rigCommand |
+        serveCommand |
+        command("sdk").set(req.selected, mode::sdk).doc("Load the sample app from Sony Camera SDK") |
+        command("--help").set(req.selected, mode::help).doc("This printed message"),
+        option("--socket").doc("Daemon socket path") & value("path", req.socket),
+        option("--backend").doc("Loads the camera SDK from this library instead of the linked one, such as the simulated camera") & value("library", req.backend),
+        option("--fetch-stats").set(req.fetch_stats, true).doc("Prints how many property requests were sent to the camera"),
+        option("--event-stats").set(req.event_stats, true).doc("Prints how the camera's events were queued and how long handling them took"),
+        option("--event-overflow").doc("When the camera's property changes outpace their handling: wait (default), drop the newest or drop the oldest") & value("block|drop-newest|drop-oldest", req.overflow),
+        option("--json").set(req.json, true).doc("Prints one JSON object per line, also for the camera's events"),
+        option("--verbose").set(req.verbose, true).doc("Prints debugging messages")
+    );
+}
+
+// Reports a failed command; with --json as an "error" line, in order with the camera's events
+void printError(const Request& req, CameraDevicePtr camera, const text& message, std::basic_ostream<text_char>& out)
+{
+    if (!req.json) {
+        out << "Error: " << message << "\n";
+        return;
+    }
+    JsonLine line("error", camera ? camera->get_id() : text());
+    line.field("message", message);
+    auto* json = camera ? camera->get_json_writer() : nullptr;
+    if (json) json->write(line);
+    else out << line.finish();
+}
+
+void initSdk(const Request& req)
 {
     // Change global locale to native locale
     std::locale::global(std::locale(""));
@@ -258,23 +284,28 @@ CameraDevicePtr getCamera(bool verbose)
     tin.imbue(std::locale());
     tout.imbue(std::locale());
 
-    auto init_success = SDK::Init();
+    auto init_success = cr_lib->Init(0);
     if (!init_success) {
-        tout << "Error: Failed to initialize Remote SDK\n";
+        printError(req, nullptr, TEXT("Failed to initialize Remote SDK"), tout);
         releaseExitFailure();
     }
-     if (verbose) tout << "Remote SDK successfully initialized.\n";
+     if (req.verbose) tout << "Remote SDK successfully initialized.\n";
+}
+
+CameraDevicePtr getCamera(const Request& req, SDK::CrSdkControlMode open_mode = SDK::CrSdkControlMode_Remote)
+{
+    initSdk(req);
 
     SDK::ICrEnumCameraObjectInfo* camera_list = nullptr;
 
-    auto enum_status = SDK::EnumCameraObjects(&camera_list, 0);
+    auto enum_status = cr_lib->EnumCameraObjects(&camera_list, 0);
     if (CR_FAILED(enum_status) || camera_list == nullptr) {
-        tout << "Error: No cameras detected\n";
+        printError(req, nullptr, TEXT("No cameras detected"), tout);
         releaseExitFailure();
     }
     auto ncams = camera_list->GetCount();
 
-     if (verbose) tout << "Cameras detectd: " << ncams << "\n";
+     if (req.verbose) tout << "Cameras detectd: " << ncams << "\n";
 
     std::int32_t cameraNumUniq = 1;
     std::int32_t selectCamera = 1;
@@ -282,124 +313,1272 @@ CameraDevicePtr getCamera(bool verbose)
 
     auto* camera_info = camera_list->GetCameraObjectInfo(no - 1);
 
-    CameraDevicePtr camera = CameraDevicePtr(new CameraDevice(cameraNumUniq, nullptr, camera_info));
-    camera->releaseExitSuccess = releaseExitSuccess;
-    
-    camera->set_verbose(verbose);
+    CameraDevicePtr camera = CameraDevicePtr(new CameraDevice(cameraNumUniq, cr_lib, camera_info));
+
+    camera->set_verbose(req.verbose);
 
     camera_list->Release();
 
-    if (!camera->connect(SDK::CrSdkControlMode_Remote)) {
-        tout << "Error: Unable to connect to camera\n";
+    if (!camera->connect(open_mode) || !camera->wait_for_connection(CONNECT_TIMEOUT)) {
+        printError(req, nullptr, TEXT("Unable to connect to camera"), tout);
         return nullptr;
     }
-    std::this_thread::sleep_for(1000ms);
-    if (verbose) tout << "Camera connected\n";
+    if (req.verbose) tout << "Camera connected\n";
     return camera;
 }
 
-void capture(string dir, bool verbose)
+bool findProperty(const Request& req, CameraDevicePtr camera, const string& prop, CrInt32u& code, std::basic_ostream<text_char>& out)
 {
-    CameraDevicePtr camera = getCamera(verbose);
-    if (camera == nullptr) releaseExitFailure();
+    auto* info = find_property(std::string_view(prop));
+    if (nullptr == info) {
+        printError(req, camera, TEXT("Property not found: ") + text(prop.begin(), prop.end()), out);
+        return false;
+    }
+    code = info->code;
+    return true;
+}
 
-    camera->set_release_after_download(true);
+bool findProperty(const Request& req, CameraDevicePtr camera, CrInt32u& code, std::basic_ostream<text_char>& out)
+{
+    return findProperty(req, camera, req.prop, code, out);
+}
 
-    text textDir(dir.begin(), dir.end());
+// Name of a property for output; codes without a name are printed in hex
+text propertyName(CrInt32u code)
+{
+    auto* info = find_property(code);
+    if (nullptr != info) return info->display_name;
+    text_stringstream ts;
+    ts << "0x" << std::hex << code;
+    return ts.str();
+}
 
-    if (dir.length() > 0) {
+// Codes of get --prop A,B,C; empty for --all
+bool propertyCodes(const Request& req, CameraDevicePtr camera, std::vector<CrInt32u>& codes, std::basic_ostream<text_char>& out)
+{
+    codes.clear();
+    if (req.all) return true;
+    std::istringstream props(req.prop);
+    for (string prop; std::getline(props, prop, ',');) {
+        CrInt32u code = 0;
+        if (!findProperty(req, camera, prop, code, out)) return false;
+        codes.push_back(code);
+    }
+    if (codes.empty()) {
+        printError(req, camera, TEXT("Property not found"), out);
+        return false;
+    }
+    return true;
+}
+
+// Decimal, or hex with 0x
+bool parsePropertyValue(const string& text_value, CrInt64& value)
+{
+    bool hex = 2 < text_value.size() && '0' == text_value[0] && ('x' == text_value[1] || 'X' == text_value[1]);
+    try {
+        std::size_t used = 0;
+        value = std::stoll(text_value, &used, hex ? 16 : 10);
+        return used == text_value.size();
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Values of set --prop A --value 1, or of set A=1 B=2
+bool propertyAssignments(const Request& req, CameraDevicePtr camera, std::vector<PropertyValue>& values, std::basic_ostream<text_char>& out)
+{
+    values.clear();
+    std::vector<std::pair<string, string>> pairs;
+    if (req.assignments.empty()) pairs.emplace_back(req.prop, req.val);
+    for (auto& assignment : req.assignments) {
+        auto split = assignment.find('=');
+        if (string::npos == split) {
+            printError(req, camera, TEXT("Expected prop=value: ") + text(assignment.begin(), assignment.end()), out);
+            return false;
+        }
+        pairs.emplace_back(assignment.substr(0, split), assignment.substr(split + 1));
+    }
+    for (auto& pair : pairs) {
+        PropertyValue value{ 0, 0 };
+        if (!findProperty(req, camera, pair.first, value.code, out)) return false;
+        if (!parsePropertyValue(pair.second, value.value)) {
+            printError(req, camera, TEXT("Invalid value: ") + text(pair.second.begin(), pair.second.end()), out);
+            return false;
+        }
+        values.push_back(value);
+    }
+    return true;
+}
+
+void printShutterTiming(const ShutterTimingList& timing, std::basic_ostream<text_char>& out)
+{
+    std::chrono::milliseconds total(0);
+    out << "Timing:\n";
+    for (auto& step : timing) {
+        out << "  " << std::setw(14) << std::left << step.step << std::right << std::setw(6) << step.elapsed.count() << " ms"
+            << (step.timed_out ? " (timed out)" : "") << "\n";
+        total += step.elapsed;
+    }
+    out << "  " << std::setw(14) << std::left << "Total" << std::right << std::setw(6) << total.count() << " ms\n";
+}
+
+void writeShutterTiming(JsonLine& line, const ShutterTimingList& timing)
+{
+    line.begin_array("timing");
+    for (auto& step : timing) {
+        line.begin_object(nullptr).field("step", step.step).field("ms", static_cast<long long>(step.elapsed.count()))
+            .field("timed_out", step.timed_out).end_object();
+    }
+    line.end_array();
+}
+
+void printBurstStats(const BurstStats& stats, std::basic_ostream<text_char>& out)
+{
+    out << "Burst: " << stats.downloaded << " of " << stats.shots << " images saved (" << stats.captured << " captured) in "
+        << stats.elapsed.count() << " ms" << std::fixed << std::setprecision(2)
+        << ", fired at " << stats.shots_per_second() << " fps, sustained " << stats.frames_per_second() << " fps\n"
+        << std::defaultfloat;
+    out << "Shutter to disk: p50 " << stats.latency_p50.count() << " ms, p90 " << stats.latency_p90.count()
+        << " ms, p99 " << stats.latency_p99.count() << " ms, max " << stats.latency_max.count() << " ms\n";
+}
+
+void writeBurstStats(JsonWriter& json, const text& camera_id, const BurstStats& stats)
+{
+    JsonLine line("burst", camera_id);
+    line.field("shots", stats.shots).field("captured", stats.captured).field("downloaded", stats.downloaded)
+        .field("elapsed_ms", static_cast<long long>(stats.elapsed.count()))
+        .field("fired_fps", stats.shots_per_second()).field("sustained_fps", stats.frames_per_second())
+        .field("latency_p50_ms", static_cast<long long>(stats.latency_p50.count()))
+        .field("latency_p90_ms", static_cast<long long>(stats.latency_p90.count()))
+        .field("latency_p99_ms", static_cast<long long>(stats.latency_p99.count()))
+        .field("latency_max_ms", static_cast<long long>(stats.latency_max.count()));
+    json.write(line);
+}
+
+bool burstCapture(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    if (req.interval < 0) {
+        printError(req, camera, TEXT("Invalid interval"), out);
+        return false;
+    }
+
+    auto* json = camera->get_json_writer();
+    text id = json ? camera->get_id() : text();
+    BurstCapture burst(*camera);
+    burst.set_result_sink([&](std::uint32_t shot, const text& file, std::chrono::milliseconds latency) {
+        if (json) {
+            JsonLine line("capture", id);
+            line.field("shot", shot + 1).field("file", file).field("latency_ms", static_cast<long long>(latency.count()));
+            json->write(line);
+            return;
+        }
+        out << "Download Complete (" << file << "), shot " << shot + 1 << " after " << latency.count() << " ms\n";
+    });
+    bool success = burst.run(static_cast<std::uint32_t>(req.count), std::chrono::milliseconds(req.interval), DOWNLOAD_TIMEOUT);
+
+    auto stats = burst.stats();
+    if (json) writeBurstStats(*json, id, stats);
+    else printBurstStats(stats, out);
+    if (!success) {
+        auto missing = std::to_string(stats.shots - stats.downloaded);
+        printError(req, camera, TEXT("Unable to download ") + text(missing.begin(), missing.end()) + TEXT(" images"), out);
+        return false;
+    }
+    return true;
+}
+
+text_literal timelapseFrameName(TimelapseFrame result)
+{
+    switch (result) {
+        case TimelapseFrame::fired: return TEXT("fired");
+        case TimelapseFrame::not_captured: return TEXT("not_captured");
+        case TimelapseFrame::skipped_late: return TEXT("skipped_late");
+        case TimelapseFrame::skipped_backlog: return TEXT("skipped_backlog");
+    }
+    return TEXT("");
+}
+
+bool timelapse(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    TimelapsePolicy policy = TimelapsePolicy::skip;
+    if (req.policy == "adapt") policy = TimelapsePolicy::adapt;
+    else if (!req.policy.empty() && req.policy != "skip") {
+        printError(req, camera, TEXT("Invalid policy"), out);
+        return false;
+    }
+    if (req.interval <= 0 || req.count < 1 || req.backlog < 1) {
+        printError(req, camera, TEXT("Invalid interval, count or backlog"), out);
+        return false;
+    }
+    if (req.dir.length() > 0) {
+        camera->set_save_path(text(req.dir.begin(), req.dir.end()), TEXT(""), -1);
+    }
+
+    auto ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+    auto* json = camera->get_json_writer();
+    text id = json ? camera->get_id() : text();
+    Timelapse timelapse(*camera, policy, static_cast<std::size_t>(req.backlog));
+    timelapse.set_frame_sink([&](std::uint32_t frame, TimelapseFrame result, std::chrono::microseconds jitter) {
+        if (json) {
+            JsonLine line("timelapse_frame", id);
+            line.field("frame", frame + 1).field("result", timelapseFrameName(result)).field("jitter_ms", ms(jitter));
+            json->write(line);
+            return;
+        }
+        out << "Frame " << frame + 1 << ": ";
+        switch (result) {
+            case TimelapseFrame::fired:
+                out << "fired +" << std::fixed << std::setprecision(3) << ms(jitter) << " ms\n" << std::defaultfloat;
+                break;
+            case TimelapseFrame::not_captured:
+                out << "not captured\n";
+                break;
+            case TimelapseFrame::skipped_late:
+                out << "skipped, camera behind\n";
+                break;
+            case TimelapseFrame::skipped_backlog:
+                out << "skipped, downloads behind\n";
+                break;
+        }
+    });
+    timelapse.set_result_sink([&](std::uint32_t frame, const text& file, std::chrono::milliseconds latency) {
+        if (json) {
+            JsonLine line("capture", id);
+            line.field("frame", frame + 1).field("file", file).field("latency_ms", static_cast<long long>(latency.count()));
+            json->write(line);
+            return;
+        }
+        out << "Download Complete (" << file << "), frame " << frame + 1 << " after " << latency.count() << " ms\n";
+    });
+    bool success = timelapse.run(static_cast<std::uint32_t>(req.count), std::chrono::milliseconds(req.interval), DOWNLOAD_TIMEOUT);
+
+    auto stats = timelapse.stats();
+    auto shots = timelapse.shot_stats();
+    if (json) {
+        JsonLine line("timelapse", id);
+        line.field("scheduled", stats.scheduled).field("fired", stats.fired).field("skipped", stats.skipped)
+            .field("downloaded", shots.downloaded).field("adapted", stats.adapted)
+            .field("interval_ms", static_cast<long long>(stats.interval.count()))
+            .field("elapsed_ms", static_cast<long long>(stats.elapsed.count()))
+            .field("jitter_p50_ms", ms(stats.jitter_p50)).field("jitter_p90_ms", ms(stats.jitter_p90))
+            .field("jitter_p99_ms", ms(stats.jitter_p99)).field("jitter_max_ms", ms(stats.jitter_max));
+        json->write(line);
+        writeBurstStats(*json, id, shots);
+        return success;
+    }
+    out << "Timelapse: " << stats.fired << " of " << stats.scheduled << " frames fired, " << stats.skipped << " skipped, "
+        << shots.downloaded << " saved in " << stats.elapsed.count() << " ms";
+    if (0 < stats.adapted) out << ", interval lengthened " << stats.adapted << " times to " << stats.interval.count() << " ms";
+    out << "\n" << std::fixed << std::setprecision(3)
+        << "Jitter: p50 " << ms(stats.jitter_p50) << " ms, p90 " << ms(stats.jitter_p90) << " ms, p99 " << ms(stats.jitter_p99)
+        << " ms, max " << ms(stats.jitter_max) << " ms\n" << std::defaultfloat;
+    out << "Shutter to disk: p50 " << shots.latency_p50.count() << " ms, p90 " << shots.latency_p90.count()
+        << " ms, p99 " << shots.latency_p99.count() << " ms, max " << shots.latency_max.count() << " ms\n";
+    return success;
+}
+
+// Values of a comma separated list; false if one is not a number
+bool parseBracketValues(const Request& req, std::vector<CrInt64>& values)
+{
+    std::istringstream list(req.ev.empty() ? req.shutter : req.ev);
+    for (string item; std::getline(list, item, ',');) {
+        try {
+            std::size_t used = 0;
+            // Compensation is set in 1/1000 EV
+            if (!req.ev.empty()) values.push_back(std::llround(std::stod(item, &used) * 1000));
+            else values.push_back(static_cast<CrInt64>(std::stoul(item, &used, 0)));
+            if (used != item.size()) return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !values.empty();
+}
+
+bool bracket(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    std::vector<CrInt64> values;
+    if (!parseBracketValues(req, values)) {
+        printError(req, camera, TEXT("Invalid bracket values, give --ev or --shutter"), out);
+        return false;
+    }
+    if (req.dir.length() > 0) {
+        camera->set_save_path(text(req.dir.begin(), req.dir.end()), TEXT(""), -1);
+    }
+
+    bool ev = !req.ev.empty();
+    auto* json = camera->get_json_writer();
+    text id = json ? camera->get_id() : text();
+    Bracket bracket(*camera, ev ? BracketProperty::exposure_bias : BracketProperty::shutter_speed);
+    bracket.set_step_sink([&](std::uint32_t step, const BracketStep& result) {
+        if (json) {
+            JsonLine line("bracket_step", id);
+            line.field("step", step + 1).field("value", static_cast<long long>(result.value)).field("confirmed", result.confirmed)
+                .field("set_ms", static_cast<long long>(result.set_time.count()))
+                .field("wait_ms", static_cast<long long>(result.wait.count())).field("fired", result.fired);
+            json->write(line);
+            return;
+        }
+        out << "Step " << step + 1 << ": ";
+        if (ev) out << std::showpos << std::fixed << std::setprecision(1) << result.value / 1000.0 << std::noshowpos << " EV";
+        else out << "0x" << std::hex << std::setw(8) << std::setfill(TEXT('0')) << result.value << std::dec << std::setfill(TEXT(' '));
+        out << std::defaultfloat;
+        if (!result.confirmed) out << " not confirmed";
+        else out << " confirmed in " << result.set_time.count() << " ms";
+        out << ", waited " << result.wait.count() << " ms for the previous image, " << (result.fired ? "fired" : "not fired") << "\n";
+    });
+    bracket.set_result_sink([&](std::uint32_t step, const text& file, std::chrono::milliseconds latency) {
+        if (json) {
+            JsonLine line("capture", id);
+            line.field("step", step + 1).field("file", file).field("latency_ms", static_cast<long long>(latency.count()));
+            json->write(line);
+            return;
+        }
+        out << "Download Complete (" << file << "), step " << step + 1 << " after " << latency.count() << " ms\n";
+    });
+    bool success = bracket.run(values, DOWNLOAD_TIMEOUT);
+
+    auto shots = bracket.shot_stats();
+    if (json) {
+        JsonLine line("bracket", id);
+        line.field("steps", values.size()).field("downloaded", shots.downloaded)
+            .field("elapsed_ms", static_cast<long long>(bracket.elapsed().count()));
+        json->write(line);
+        return success;
+    }
+    out << "Bracket: " << shots.downloaded << " of " << values.size() << " frames saved in " << bracket.elapsed().count() << " ms\n";
+    return success;
+}
+
+bool focusStack(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    if (req.steps < 1 || req.size < -7 || 7 < req.size || 0 == req.size || req.backlog < 1) {
+        printError(req, camera, TEXT("Invalid steps, size or backlog"), out);
+        return false;
+    }
+    if (req.dir.length() > 0) {
+        camera->set_save_path(text(req.dir.begin(), req.dir.end()), TEXT(""), -1);
+    }
+
+    auto* json = camera->get_json_writer();
+    text id = json ? camera->get_id() : text();
+    FocusStack stack(*camera, static_cast<std::size_t>(req.backlog));
+    stack.set_slice_sink([&](std::uint32_t slice, const FocusSlice& result) {
+        if (json) {
+            JsonLine line("focus_slice", id);
+            line.field("slice", slice + 1).field("moved", result.moved).field("move_ms", static_cast<long long>(result.move.count()))
+                .field("fired", result.fired).field("cycle_ms", static_cast<long long>(result.cycle.count()));
+            json->write(line);
+            return;
+        }
+        out << "Slice " << slice + 1 << ": ";
+        if (0 < slice) out << (result.moved ? "moved in " : "move unconfirmed after ") << result.move.count() << " ms, ";
+        out << (result.fired ? "fired" : "not fired");
+        if (0 < slice) out << ", cycle " << result.cycle.count() << " ms";
+        out << "\n";
+    });
+    stack.set_result_sink([&](std::uint32_t slice, const text& file, std::chrono::milliseconds latency) {
+        if (json) {
+            JsonLine line("capture", id);
+            line.field("slice", slice + 1).field("file", file).field("latency_ms", static_cast<long long>(latency.count()));
+            json->write(line);
+            return;
+        }
+        out << "Download Complete (" << file << "), slice " << slice + 1 << " after " << latency.count() << " ms\n";
+    });
+    bool success = stack.run(static_cast<std::uint32_t>(req.steps), static_cast<CrInt16>(req.size), DOWNLOAD_TIMEOUT);
+
+    auto stats = stack.stats();
+    auto shots = stack.shot_stats();
+    if (json) {
+        JsonLine line("focus_stack", id);
+        line.field("slices", stats.slices).field("fired", stats.fired).field("downloaded", shots.downloaded)
+            .field("unconfirmed_moves", stats.unconfirmed_moves).field("elapsed_ms", static_cast<long long>(stats.elapsed.count()))
+            .field("slices_per_minute", stats.slices_per_minute())
+            .field("cycle_p50_ms", static_cast<long long>(stats.cycle_p50.count()))
+            .field("cycle_p90_ms", static_cast<long long>(stats.cycle_p90.count()))
+            .field("cycle_max_ms", static_cast<long long>(stats.cycle_max.count()));
+        json->write(line);
+    }
+    else {
+        out << "Focus stack: " << shots.downloaded << " of " << stats.slices << " slices saved in " << stats.elapsed.count() << " ms"
+            << std::fixed << std::setprecision(1) << " (" << stats.slices_per_minute() << " slices/min)" << std::defaultfloat;
+        if (0 < stats.unconfirmed_moves) out << ", " << stats.unconfirmed_moves << " moves unconfirmed";
+        out << "\nCycle per slice: p50 " << stats.cycle_p50.count() << " ms, p90 " << stats.cycle_p90.count()
+            << " ms, max " << stats.cycle_max.count() << " ms\n";
+    }
+    if (0 == stats.slices) {
+        printError(req, camera, TEXT("Unable to switch to manual focus"), out);
+        return false;
+    }
+    return success;
+}
+
+bool capture(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    text textDir(req.dir.begin(), req.dir.end());
+
+    if (req.dir.length() > 0) {
         camera->set_save_path(textDir, TEXT(""), -1);
     }
+    if (req.count < 1) {
+        printError(req, camera, TEXT("Invalid count"), out);
+        return false;
+    }
+    if (1 < req.count) return burstCapture(camera, req, out);
+
+    auto download_count = camera->get_download_count();
+    auto download_start = std::chrono::steady_clock::now();
     camera->half_full_release();
-    std::this_thread::sleep_for(5000ms);
-    tout << "Error: Unable to download image\n";
-    releaseExitFailure();
+    bool downloaded = camera->wait_for_download(download_count + 1, DOWNLOAD_TIMEOUT);
+
+    ShutterTimingList steps;
+    if (req.timing) {
+        steps = camera->get_shutter_timing();
+        auto download_elapsed = std::chrono::steady_clock::now() - download_start;
+        for (auto& step : steps) download_elapsed -= step.elapsed;
+        steps.push_back({ TEXT("Download"), std::chrono::duration_cast<std::chrono::milliseconds>(download_elapsed), !downloaded });
+        if (!req.json) printShutterTiming(steps, out);
+    }
+
+    if (!downloaded) {
+        printError(req, camera, TEXT("Unable to download image"), out);
+        return false;
+    }
+    if (auto* json = camera->get_json_writer()) {
+        JsonLine line("capture", camera->get_id());
+        line.field("file", camera->get_last_download());
+        if (req.timing) writeShutterTiming(line, steps);
+        json->write(line);
+        return true;
+    }
+    out << "Download Complete (" << camera->get_last_download() << ")\n";
+    return true;
 }
 
-void getProperty(const string &prop, bool verbose) {
-    text propText(prop.begin(), prop.end());
+bool getProperty(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    std::vector<CrInt32u> codes;
+    if (!propertyCodes(req, camera, codes, out)) return false;
 
-    if (map_device_property.count(propText) == 0) {
-        tout << "Error: Property not found\n";
-        releaseExitFailure();
+    // All codes in one request, however many were asked for
+    auto values = camera->get_property_values(codes);
+    auto* json = camera->get_json_writer();
+    std::vector<CrInt64> possible;
+    bool range = false;
+    for (auto& value : values) {
+        text formatted = format_property_value(value.code, value.value);
+        if (json) {
+            JsonLine line("get", camera->get_id());
+            line.field("prop", propertyName(value.code)).field("code", value.code).field("value", value.value);
+            if (!formatted.empty()) line.field("formatted", formatted);
+            if (req.possible && camera->get_possible_values(value.code, possible, range)) {
+                line.field("range", range).begin_array("values");
+                for (auto v : possible) line.field(nullptr, v);
+                line.end_array();
+            }
+            json->write(line);
+            continue;
+        }
+        out << propertyName(value.code) << ": " << value.value;
+        if (!formatted.empty()) out << " (" << formatted << ")";
+        out << "\n";
+        if (req.possible && camera->get_possible_values(value.code, possible, range)) {
+            out << (range ? "  range:" : "  values:");
+            for (std::size_t i = 0; i < possible.size(); ++i) {
+                text readable = format_property_value(value.code, possible[i]);
+                out << (0 == i ? " " : ", ") << possible[i];
+                if (!readable.empty()) out << " (" << readable << ")";
+            }
+            out << "\n";
+        }
+    }
+
+    bool success = true;
+    for (auto code : codes) {
+        auto found = std::find_if(values.begin(), values.end(), [&](const PropertyValue& value) { return value.code == code; });
+        if (found != values.end()) continue;
+        printError(req, camera, TEXT("Unable to get ") + propertyName(code), out);
+        success = false;
     }
+    return success;
+}
 
-    CameraDevicePtr camera = getCamera(verbose);
+bool setProperty(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    std::vector<PropertyValue> values;
+    if (!propertyAssignments(req, camera, values, out)) return false;
 
-    if (camera == nullptr) releaseExitFailure();
-    
-    CrInt32u code = map_device_property.at(propText);
-    CrInt64 value = 0;
-    if (!camera->get_property_value(code, value)) releaseExitFailure();
-    tout << propText << ": " << value << "\n";
+    std::vector<CrInt32u> unconfirmed;
+    bool success = camera->set_property_values(values, unconfirmed);
+    auto* json = camera->get_json_writer();
+    for (auto& value : values) {
+        bool confirmed = unconfirmed.end() == std::find(unconfirmed.begin(), unconfirmed.end(), value.code);
+        if (confirmed && json) {
+            JsonLine line("set", camera->get_id());
+            line.field("prop", propertyName(value.code)).field("code", value.code).field("value", value.value);
+            json->write(line);
+        }
+        if (!confirmed) printError(req, camera, TEXT("Unable to set ") + propertyName(value.code), out);
+    }
+    return success;
+}
+
+bool watchProperties(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    // Empty codes, as for --all, watch every property
+    std::vector<CrInt32u> codes;
+    if (!propertyCodes(req, camera, codes, out)) return false;
+
+    // The handler runs on the dispatch thread; this thread only waits for the subscription to end
+    std::promise<void> ended;
+    std::uint64_t changes = 0;
+    auto* json = camera->get_json_writer();
+    auto seconds = std::chrono::seconds(0 < req.seconds ? req.seconds : 10);
+    camera->subscribe_properties(codes, nullptr, [&](const PropertyChange& change) {
+        if (change.timed_out) {
+            ended.set_value();
+            return;
+        }
+        ++changes;
+        auto value = static_cast<CrInt64>(change.value);
+        text formatted = format_property_value(change.code, value);
+        if (json) {
+            JsonLine line("changed", camera->get_id());
+            line.field("prop", propertyName(change.code)).field("code", change.code).field("value", value);
+            if (!formatted.empty()) line.field("formatted", formatted);
+            json->write(line);
+            return;
+        }
+        out << propertyName(change.code) << ": " << value;
+        if (!formatted.empty()) out << " (" << formatted << ")";
+        out << std::endl;
+    }, seconds);
+    ended.get_future().wait();
+
+    if (!json) out << "Changes: " << changes << "\n";
+    return true;
+}
+
+void printLiveViewStats(const LiveViewStats& stats, std::basic_ostream<text_char>& out)
+{
+    auto ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+    out << "Frames: " << stats.frames << std::fixed << std::setprecision(1) << " (" << stats.fps << " fps)"
+        << ", dropped " << stats.dropped << ", not updated " << stats.not_updated << ", errors " << stats.errors << "\n";
+    out << "Fetch latency: p50 " << ms(stats.latency_p50) << " ms, p90 " << ms(stats.latency_p90)
+        << " ms, p99 " << ms(stats.latency_p99) << " ms, max " << ms(stats.latency_max) << " ms\n";
+    out << std::defaultfloat;
+}
+
+void writeLiveViewStats(JsonWriter& json, const text& camera_id, const LiveViewStats& stats)
+{
+    auto ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+    JsonLine line("liveview", camera_id);
+    line.field("frames", stats.frames).field("fps", stats.fps).field("dropped", stats.dropped)
+        .field("not_updated", stats.not_updated).field("errors", stats.errors)
+        .field("latency_p50_ms", ms(stats.latency_p50)).field("latency_p90_ms", ms(stats.latency_p90))
+        .field("latency_p99_ms", ms(stats.latency_p99)).field("latency_max_ms", ms(stats.latency_max));
+    json.write(line);
+}
+
+// Runs until the given time has passed, or forever without one
+bool serveLiveView(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    constexpr std::size_t const max_clients = 8;
+    if (req.port <= 0 || 65535 < req.port) {
+        printError(req, camera, TEXT("Invalid port"), out);
+        return false;
+    }
+    if (!camera->start_live_view(max_clients + 2)) {
+        printError(req, camera, TEXT("Unable to start live view"), out);
+        return false;
+    }
+    auto* stream = camera->get_live_view_stream();
+
+    MjpegServer server(*stream, max_clients);
+    if (!server.start(static_cast<std::uint16_t>(req.port))) {
+        camera->stop_live_view();
+        auto port = std::to_string(req.port);
+        printError(req, camera, TEXT("Unable to listen on port ") + text(port.begin(), port.end()), out);
+        return false;
+    }
+    if (req.verbose) tout << "Serving live view on http://127.0.0.1:" << req.port << "/\n";
+
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(req.seconds);
+    while (0 == req.seconds || std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(100ms);
+    }
+    server.stop();
+    camera->stop_live_view();
+
+    auto served = server.stats();
+    if (auto* json = camera->get_json_writer()) {
+        writeLiveViewStats(*json, camera->get_id(), stream->stats());
+        JsonLine line("liveview_served", camera->get_id());
+        line.field("clients", served.clients).field("sent", served.sent).field("skipped", served.skipped)
+            .field("rejected", served.rejected);
+        json->write(line);
+        return true;
+    }
+    printLiveViewStats(stream->stats(), out);
+    out << "Clients: " << served.clients << ", frames sent " << served.sent
+        << ", skipped by slow clients " << served.skipped << ", rejected " << served.rejected << "\n";
+    return true;
+}
+
+bool liveView(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    if (0 != req.port) return serveLiveView(camera, req, out);
+
+    if (!camera->start_live_view()) {
+        printError(req, camera, TEXT("Unable to start live view"), out);
+        return false;
+    }
+    auto* stream = camera->get_live_view_stream();
+
+    bool saved = true;
+    std::uint64_t sequence = 0;
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(0 < req.seconds ? req.seconds : 5);
+    while (std::chrono::steady_clock::now() < until) {
+        auto frame = stream->wait_next(sequence, 500ms);
+        if (!frame) continue;
+        sequence = frame.sequence();
+
+        if (!req.dir.empty()) {
+            std::ostringstream name;
+            name << "LiveView" << std::setw(6) << std::setfill('0') << sequence << ".JPG";
+            std::ofstream file(fs::path(req.dir) / name.str(), std::ios::out | std::ios::binary);
+            file.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+            saved = saved && file.good();
+        }
+    }
+    camera->stop_live_view();
+
+    if (auto* json = camera->get_json_writer()) writeLiveViewStats(*json, camera->get_id(), stream->stats());
+    else printLiveViewStats(stream->stats(), out);
+    if (!saved) {
+        printError(req, camera, TEXT("Unable to save all frames"), out);
+        return false;
+    }
+    return true;
+}
+
+void printContentsIndexStats(const ContentsIndexStats& stats, std::basic_ostream<text_char>& out)
+{
+    out << "Indexed: " << stats.entries << " entries (" << stats.cached << " from index) in " << stats.folders << " folders, "
+        << stats.elapsed.count() << " ms"
+        << std::fixed << std::setprecision(1) << " (" << stats.entries_per_second() << " entries/s)"
+        << ", first entry after " << stats.first_entry.count() << " ms";
+    if (0 < stats.failures) out << ", " << stats.failures << " failed";
+    out << "\n" << std::defaultfloat;
+}
+
+void printContentsEntry(CrContentHandle handle, CrInt64u size, const CrChar* date, const CrChar* name, std::basic_ostream<text_char>& out)
+{
+    out << "0x" << std::hex << std::setw(8) << std::setfill(TEXT('0')) << handle << std::dec << std::setfill(TEXT(' '))
+        << std::setw(12) << size << "  " << text(date, std::find(date, date + 16, 0)) << "  " << (name ? text(name) : text()) << "\n";
+}
+
+void writeContentsIndexStats(JsonWriter& json, const text& camera_id, const ContentsIndexStats& stats)
+{
+    JsonLine line("contents_indexed", camera_id);
+    line.field("entries", stats.entries).field("cached", stats.cached).field("folders", stats.folders)
+        .field("failures", stats.failures).field("elapsed_ms", static_cast<long long>(stats.elapsed.count()))
+        .field("first_entry_ms", static_cast<long long>(stats.first_entry.count()));
+    json.write(line);
+}
+
+bool listContents(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    if (req.workers < 1) {
+        printError(req, camera, TEXT("Invalid worker count"), out);
+        return false;
+    }
+
+    auto* json = camera->get_json_writer();
+    text id = json ? camera->get_id() : text();
+    camera->set_contents_index(req.index.empty() ? default_contents_index_dir() : req.index, !req.rescan);
+    ContentsIndexStats stats;
+    bool indexed = camera->index_contents(static_cast<std::size_t>(req.workers), [&](const SDK::CrMtpContentsInfo& info) {
+        if (json) {
+            JsonLine line("content", id);
+            line.field("handle", info.handle).field("size", info.contentSize)
+                .field("date", text(info.dateChar, std::find(info.dateChar, info.dateChar + 16, 0)))
+                .field("name", info.fileName);
+            json->write(line);
+            return;
+        }
+        printContentsEntry(info.handle, info.contentSize, info.dateChar, info.fileName, out);
+    }, stats);
+    if (json) writeContentsIndexStats(*json, id, stats);
+    else printContentsIndexStats(stats, out);
+    if (!indexed) {
+        printError(req, camera, TEXT("Unable to list contents"), out);
+        return false;
+    }
+    return true;
+}
+
+void printDownloadStats(const ContentsDownloadStats& stats, std::basic_ostream<text_char>& out)
+{
+    out << "Downloaded: " << stats.completed << " of " << stats.queued << " files" << std::fixed << std::setprecision(1)
+        << ", " << stats.bytes / 1048576.0 << " MB in " << stats.elapsed.count() << " ms"
+        << " (" << stats.megabytes_per_second() << " MB/s, " << stats.files_per_second() << " files/s)"
+        << ", " << stats.failed << " failed\n" << std::defaultfloat;
+}
+
+ContentsFilter contentsFilter(const Request& req)
+{
+    ContentsFilter filter;
+    filter.folder = text(req.folder.begin(), req.folder.end());
+    filter.date_from = text(req.from.begin(), req.from.end());
+    filter.date_to = text(req.to.begin(), req.to.end());
+    std::istringstream exts(req.ext);
+    for (string ext; std::getline(exts, ext, ',');) {
+        if (!ext.empty() && '.' == ext[0]) ext.erase(0, 1);
+        if (!ext.empty()) filter.extensions.emplace_back(ext.begin(), ext.end());
+    }
+    filter.min_size = req.min_size;
+    if (0 < req.max_size) filter.max_size = req.max_size;
+    return filter;
+}
+
+void printTransferResult(const Request& req, CameraDevicePtr camera, CrContentHandle handle, const text& file, CrInt32u error,
+    std::basic_ostream<text_char>& out)
+{
+    if (0 == error) {
+        // With --json the camera's contents_transfer event already reports the file
+        if (!req.json) out << "Download Complete (" << file << ")\n";
+        return;
+    }
+    text msg = get_message_desc(error);
+    text_stringstream ts;
+    ts << "Unable to download 0x" << std::hex << handle << " (0x" << error << std::dec << ")" << (msg.empty() ? text() : TEXT(" ") + msg);
+    printError(req, camera, ts.str(), out);
+}
+
+void writeDownloadStats(JsonWriter& json, const text& camera_id, const ContentsDownloadStats& stats)
+{
+    JsonLine line("contents_downloaded", camera_id);
+    line.field("queued", stats.queued).field("completed", stats.completed).field("failed", stats.failed)
+        .field("bytes", stats.bytes).field("elapsed_ms", static_cast<long long>(stats.elapsed.count()))
+        .field("megabytes_per_second", stats.megabytes_per_second()).field("files_per_second", stats.files_per_second());
+    json.write(line);
+}
+
+bool downloadContents(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    if (req.workers < 1 || req.jobs < 1) {
+        printError(req, camera, TEXT("Invalid worker or job count"), out);
+        return false;
+    }
+
+    ContentsFilter filter = contentsFilter(req);
+    camera->set_contents_index(req.index.empty() ? default_contents_index_dir() : req.index, !req.rescan);
+    ContentsIndexStats index_stats;
+    ContentsDownloadStats download_stats;
+    bool downloaded = camera->download_contents(static_cast<std::size_t>(req.workers), static_cast<std::size_t>(req.jobs),
+        text(req.dir.begin(), req.dir.end()), filter, [&](CrContentHandle handle, const text& file, CrInt32u error) {
+            printTransferResult(req, camera, handle, file, error, out);
+        }, index_stats, download_stats);
+
+    if (auto* json = camera->get_json_writer()) {
+        writeContentsIndexStats(*json, camera->get_id(), index_stats);
+        writeDownloadStats(*json, camera->get_id(), download_stats);
+        return downloaded;
+    }
+    printContentsIndexStats(index_stats, out);
+    printDownloadStats(download_stats, out);
+    return downloaded;
+}
+
+bool syncContents(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    if (req.workers < 1 || req.jobs < 1) {
+        printError(req, camera, TEXT("Invalid worker or job count"), out);
+        return false;
+    }
+
+    SyncJournal journal(req.dest, camera->get_id());
+    if (!journal.open()) {
+        printError(req, camera, TEXT("Unable to open the sync journal in ") + text(req.dest.begin(), req.dest.end()), out);
+        return false;
+    }
+    ContentsFilter filter = contentsFilter(req);
+    camera->set_contents_index(req.index.empty() ? default_contents_index_dir() : req.index, !req.rescan);
+    ContentsIndexStats index_stats;
+    ContentsDownloadStats download_stats;
+    bool synced = camera->sync_contents(static_cast<std::size_t>(req.workers), static_cast<std::size_t>(req.jobs), journal,
+        text(req.dest.begin(), req.dest.end()), filter, [&](CrContentHandle handle, const text& file, CrInt32u error) {
+            printTransferResult(req, camera, handle, file, error, out);
+        }, index_stats, download_stats);
+
+    if (auto* json = camera->get_json_writer()) {
+        writeContentsIndexStats(*json, camera->get_id(), index_stats);
+        JsonLine line("sync_skipped", camera->get_id());
+        line.field("skipped", journal.skipped()).field("conflicts", journal.conflicts());
+        json->write(line);
+        writeDownloadStats(*json, camera->get_id(), download_stats);
+        return synced;
+    }
+    printContentsIndexStats(index_stats, out);
+    out << "Skipped: " << journal.skipped() << " files already in " << text(req.dest.begin(), req.dest.end());
+    if (0 < journal.conflicts()) out << ", " << journal.conflicts() << " in place of files sync did not write";
+    out << "\n";
+    printDownloadStats(download_stats, out);
+    return synced;
+}
+
+// Brings up every camera the SDK finds; exits with failure unless all of them came online
+void rig(const Request& req)
+{
+    CrInt32u code = 0;
+    if (!req.prop.empty() && !findProperty(req, nullptr, code, tout)) std::exit(EXIT_FAILURE);
+
+    initSdk(req);
+    bool success = true;
+    {
+        SessionManager manager(cr_lib, req.verbose);
+        auto connected = manager.connect_all(SDK::CrSdkControlMode_Remote, CONNECT_TIMEOUT);
+        auto& sessions = manager.sessions();
+
+        // Each camera answers on its own worker; camera numbers count from 1 in session order
+        std::vector<CrInt64> values(sessions.size(), 0);
+        std::vector<bool> read(sessions.size(), false);
+        if (!req.prop.empty()) {
+            read = manager.run_all([&](CameraDevice& camera) { return camera.get_property_value(code, values[camera.get_number() - 1]); });
+        }
+
+        // Scoped to the sessions, so its lines are flushed before the exit
+        std::unique_ptr<JsonWriter> json;
+        if (req.json) json.reset(new JsonWriter(tout));
+        for (std::size_t i = 0; i < sessions.size(); ++i) {
+            auto& session = *sessions[i];
+            auto camera = session.camera();
+            if (json) {
+                JsonLine line("rig_camera", camera->get_id());
+                line.field("number", camera->get_number()).field("model", camera->get_model())
+                    .field("connected", session.connected()).field("connect_ms", static_cast<long long>(session.connect_time().count()));
+                if (session.connected() && !req.prop.empty()) {
+                    line.field("prop", text(req.prop.begin(), req.prop.end()));
+                    if (read[i]) line.field("value", values[i]);
+                }
+                json->write(line);
+                continue;
+            }
+            tout << "Camera " << camera->get_number() << " " << camera->get_model() << " (" << camera->get_id() << "): "
+                << (session.connected() ? "online after " : "failed after ") << session.connect_time().count() << " ms";
+            if (session.connected() && !req.prop.empty()) {
+                tout << ", " << text(req.prop.begin(), req.prop.end()) << ": ";
+                if (read[i]) tout << values[i];
+                else tout << "unavailable";
+            }
+            tout << "\n";
+        }
+        if (json) {
+            JsonLine line("rig", text());
+            line.field("online", connected).field("cameras", sessions.size())
+                .field("bring_up_ms", static_cast<long long>(manager.bring_up_time().count()));
+            json->write(line);
+        }
+        else {
+            tout << "Rig: " << connected << " of " << sessions.size() << " cameras online in " << manager.bring_up_time().count() << " ms\n";
+        }
+        success = (0 < connected && sessions.size() == connected);
+    }
+    if (!success) releaseExitFailure();
     releaseExitSuccess();
 }
 
-void setProperty(const string &prop, const string &value, bool verbose)
+void printSkew(const text& event, const RigSkew& skew, std::basic_ostream<text_char>& out)
 {
-    text propText(prop.begin(), prop.end());
+    auto ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+    out << "  " << std::setw(10) << std::left << event << std::right << std::fixed << std::setprecision(3)
+        << "p50 " << ms(skew.p50) << " ms, p90 " << ms(skew.p90) << " ms, p99 " << ms(skew.p99) << " ms, max " << ms(skew.max)
+        << " ms (" << skew.cameras << " cameras)\n" << std::defaultfloat;
+}
 
-    if (map_device_property.count(propText) == 0) {
-        tout << "Error: Property not found\n";
-        releaseExitFailure();
+void writeSkew(JsonLine& line, const char* event, const RigSkew& skew)
+{
+    auto ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+    line.begin_object(event).field("p50_ms", ms(skew.p50)).field("p90_ms", ms(skew.p90)).field("p99_ms", ms(skew.p99))
+        .field("max_ms", ms(skew.max)).field("cameras", skew.cameras).end_object();
+}
+
+// Fires every camera the SDK finds together; exits with failure unless all of them delivered their image
+void captureAll(const Request& req)
+{
+    initSdk(req);
+    bool success = true;
+    {
+        SessionManager manager(cr_lib, req.verbose);
+        auto connected = manager.connect_all(SDK::CrSdkControlMode_Remote, CONNECT_TIMEOUT);
+        auto& sessions = manager.sessions();
+        if (0 == connected) {
+            printError(req, nullptr, TEXT("No cameras connected"), tout);
+            releaseExitFailure();
+        }
+
+        if (!req.dir.empty()) {
+            // One dir per camera, as the cameras number their files the same way
+            manager.run_all([&](CameraDevice& camera) {
+                auto dir = fs::path(req.dir) / fs::path(camera.get_id());
+                std::error_code ec;
+                fs::create_directories(dir, ec);
+                return camera.set_save_path(dir.native(), TEXT(""), -1);
+            });
+        }
+
+        RigCapture rig(manager);
+        success = rig.run(DOWNLOAD_TIMEOUT) && sessions.size() == connected;
+
+        auto ms = [&](std::chrono::steady_clock::time_point when) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(when - rig.release_time()).count() / 1000.0;
+        };
+        // Scoped to the sessions, so its lines are flushed before the exit
+        std::unique_ptr<JsonWriter> json;
+        if (req.json) json.reset(new JsonWriter(tout));
+        for (std::size_t i = 0; i < sessions.size(); ++i) {
+            auto camera = sessions[i]->camera();
+            auto& shot = rig.shots()[i];
+            if (json) {
+                JsonLine line("rig_capture", camera->get_id());
+                line.field("number", camera->get_number()).field("model", camera->get_model())
+                    .field("connected", sessions[i]->connected()).field("armed", shot.armed).field("released", shot.released);
+                if (shot.released) line.field("released_ms", ms(shot.issued));
+                line.field("captured", shot.captured);
+                if (shot.captured) line.field("captured_ms", ms(shot.capture));
+                line.field("downloaded", shot.downloaded);
+                if (shot.downloaded) line.field("downloaded_ms", ms(shot.download)).field("file", shot.file);
+                if (req.timing) writeShutterTiming(line, shot.timing);
+                json->write(line);
+                continue;
+            }
+            tout << "Camera " << camera->get_number() << " " << camera->get_model() << " (" << camera->get_id() << "): ";
+            if (!sessions[i]->connected()) {
+                tout << "not connected\n";
+                continue;
+            }
+            if (!shot.released) {
+                tout << "release failed\n";
+                continue;
+            }
+            tout << std::fixed << std::setprecision(3) << "released +" << ms(shot.issued) << " ms";
+            if (shot.captured) tout << ", captured +" << ms(shot.capture) << " ms";
+            if (shot.downloaded) tout << ", downloaded +" << ms(shot.download) << " ms (" << shot.file << ")";
+            else tout << ", no download";
+            tout << (shot.armed ? "" : ", not armed") << "\n" << std::defaultfloat;
+            if (req.timing) printShutterTiming(shot.timing, tout);
+        }
+        if (json) {
+            JsonLine line("rig_skew", text());
+            writeSkew(line, "release", rig.issue_skew());
+            writeSkew(line, "capture", rig.capture_skew());
+            writeSkew(line, "download", rig.download_skew());
+            json->write(line);
+        }
+        else {
+            tout << "Skew from the first camera:\n";
+            printSkew(TEXT("Release"), rig.issue_skew(), tout);
+            printSkew(TEXT("Capture"), rig.capture_skew(), tout);
+            printSkew(TEXT("Download"), rig.download_skew(), tout);
+        }
     }
+    if (!success) releaseExitFailure();
+    releaseExitSuccess();
+}
 
-    CameraDevicePtr camera = getCamera(verbose);
-    if (camera == nullptr) releaseExitFailure();
+// Needs no camera, so it runs without the SDK
+void dumpIndex(const Request& req)
+{
+    auto index = ContentsIndexFile::open(req.index);
+    if (!index) {
+        printError(req, nullptr, TEXT("Not a contents index"), tout);
+        std::exit(EXIT_FAILURE);
+    }
+    auto& header = index->header();
+    if (req.json) {
+        text id(index->camera_id());
+        {
+            JsonWriter json(tout);
+            for (std::uint32_t f = 0; f < header.folder_count; ++f) {
+                auto& folder = index->folders()[f];
+                auto entries = index->entries(folder);
+                for (std::uint32_t e = 0; e < folder.entry_count; ++e) {
+                    auto& entry = entries[e];
+                    JsonLine line("content", id);
+                    line.field("folder", index->string(folder.name)).field("handle", entry.handle).field("size", entry.size)
+                        .field("date", text(entry.date, std::find(entry.date, entry.date + 16, 0)))
+                        .field("name", index->string(entry.name));
+                    json.write(line);
+                }
+            }
+            JsonLine line("index", id);
+            line.field("folders", header.folder_count).field("entries", header.entry_count);
+            json.write(line);
+        }
+        std::exit(EXIT_SUCCESS);
+    }
+    tout << "Camera: " << index->camera_id() << "\n"
+        << "Folders: " << header.folder_count << ", entries: " << header.entry_count << "\n";
+    for (std::uint32_t f = 0; f < header.folder_count; ++f) {
+        auto& folder = index->folders()[f];
+        tout << "===== 0x" << std::hex << std::setw(8) << std::setfill(TEXT('0')) << folder.handle << std::dec << std::setfill(TEXT(' '))
+            << " " << text(index->string(folder.name)) << " : " << folder.entry_count << " entries =====\n";
+        auto entries = index->entries(folder);
+        for (std::uint32_t e = 0; e < folder.entry_count; ++e) {
+            printContentsEntry(entries[e].handle, entries[e].size, entries[e].date, index->string(entries[e].name), tout);
+        }
+    }
+    std::exit(EXIT_SUCCESS);
+}
 
-    CrInt32u code = map_device_property.at(propText);
+void printFetchStats(const PropertyFetchStats& stats, std::basic_ostream<text_char>& out)
+{
+    out << "Property fetches: " << stats.total() << " (full " << stats.full << ", select " << stats.select << ")\n";
+}
 
-    if (!camera->set_property_value(code, std::stoi(value))) {
-        tout << "Error: Unable to set property\n";
-        releaseExitFailure();
+void printEventStats(const EventBusStats& stats, std::basic_ostream<text_char>& out)
+{
+    out << "Events: " << stats.posted << " queued, " << stats.handled << " handled, " << stats.dropped << " dropped, "
+        << stats.blocked << " waited for room\n";
+    out << "Queue depth: " << stats.depth << " (max " << stats.max_depth << ")\n";
+    out << "Queued for: p50 " << stats.wait_p50.count() << " us, p99 " << stats.wait_p99.count() << " us, max " << stats.wait_max.count() << " us\n";
+    out << "Handled in: p50 " << stats.handler_p50.count() << " us, p99 " << stats.handler_p99.count() << " us, max " << stats.handler_max.count() << " us\n";
+}
+
+void writeFetchStats(JsonWriter& json, const text& camera_id, const PropertyFetchStats& stats)
+{
+    JsonLine line("fetch_stats", camera_id);
+    line.field("total", stats.total()).field("full", stats.full).field("select", stats.select);
+    json.write(line);
+}
+
+void writeEventStats(JsonWriter& json, const text& camera_id, const EventBusStats& stats)
+{
+    JsonLine line("event_stats", camera_id);
+    line.field("posted", stats.posted).field("handled", stats.handled).field("dropped", stats.dropped)
+        .field("blocked", stats.blocked).field("depth", stats.depth).field("max_depth", stats.max_depth)
+        .field("wait_p50_us", static_cast<long long>(stats.wait_p50.count()))
+        .field("wait_p99_us", static_cast<long long>(stats.wait_p99.count()))
+        .field("wait_max_us", static_cast<long long>(stats.wait_max.count()))
+        .field("handler_p50_us", static_cast<long long>(stats.handler_p50.count()))
+        .field("handler_p99_us", static_cast<long long>(stats.handler_p99.count()))
+        .field("handler_max_us", static_cast<long long>(stats.handler_max.count()));
+    json.write(line);
+}
+
+bool eventOverflow(const string& name, EventOverflow& overflow)
+{
+    if (name == "block") overflow = EventOverflow::block;
+    else if (name == "drop-newest") overflow = EventOverflow::drop_newest;
+    else if (name == "drop-oldest") overflow = EventOverflow::drop_oldest;
+    else return false;
+    return true;
+}
+
+bool runSelected(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    bool success = false;
+    switch (req.selected) {
+        case mode::capture:
+            success = capture(camera, req, out);
+            break;
+        case mode::timelapse:
+            success = timelapse(camera, req, out);
+            break;
+        case mode::bracket:
+            success = bracket(camera, req, out);
+            break;
+        case mode::focusstack:
+            success = focusStack(camera, req, out);
+            break;
+        case mode::get:
+            success = getProperty(camera, req, out);
+            break;
+        case mode::set:
+            success = setProperty(camera, req, out);
+            break;
+        case mode::watch:
+            success = watchProperties(camera, req, out);
+            break;
+        case mode::liveview:
+            success = liveView(camera, req, out);
+            break;
+        case mode::contents:
+            success = listContents(camera, req, out);
+            break;
+        case mode::download:
+            success = downloadContents(camera, req, out);
+            break;
+        case mode::sync:
+            success = syncContents(camera, req, out);
+            break;
+        default:
+            printError(req, camera, TEXT("Command not supported"), out);
+            return false;
+    }
+    return success;
+}
+
+bool runCommand(CameraDevicePtr camera, const Request& req, std::basic_ostream<text_char>& out)
+{
+    // A daemon runs many commands on one camera, so a policy applies to its own command only
+    EventOverflow overflow = EventOverflow::block;
+    if (!req.overflow.empty() && !eventOverflow(req.overflow, overflow)) {
+        printError(req, camera, TEXT("Invalid event overflow policy"), out);
+        return false;
+    }
+    camera->set_event_overflow(overflow);
+
+    // Commands and the camera's events share one writer, so their lines never interleave
+    std::unique_ptr<JsonWriter> json;
+    if (req.json) {
+        json.reset(new JsonWriter(out));
+        camera->set_json_writer(json.get());
+    }
+    bool success = runSelected(camera, req, out);
+    camera->set_json_writer(nullptr);
+    // The writer's thread may still be writing to out, so while it lives every line goes through it
+    if (json) {
+        if (req.fetch_stats) writeFetchStats(*json, camera->get_id(), camera->get_fetch_stats());
+        if (req.event_stats) writeEventStats(*json, camera->get_id(), camera->get_event_stats());
+        return success;
+    }
+    if (req.fetch_stats) printFetchStats(camera->get_fetch_stats(), out);
+    if (req.event_stats) printEventStats(camera->get_event_stats(), out);
+    return success;
+}
+
+string socketPath(const Request& req)
+{
+    return req.socket.empty() ? default_socket_path() : req.socket;
+}
+
+// The arguments for the daemon, which runs in its own working dir, so relative paths are made absolute first
+std::vector<string> forwardedArgs(int argc, char* argv[])
+{
+    std::vector<string> args(argv + 1, argv + argc);
+    for (std::size_t i = 0; i + 1 < args.size(); ++i) {
+        if (args[i] != "--dir" && args[i] != "--index" && args[i] != "--dest") continue;
+        ++i;
+        fs::path path(args[i]);
+        if (!args[i].empty() && path.is_relative()) args[i] = (fs::current_path() / path).string();
     }
+    return args;
+}
+
+// Connects, runs a single command and exits
+void oneShot(const Request& req)
+{
+    // Reject unknown properties before paying for the connection
+    std::vector<CrInt32u> codes;
+    std::vector<PropertyValue> values;
+    if ((req.selected == mode::get || req.selected == mode::watch) && !propertyCodes(req, nullptr, codes, tout)) std::exit(EXIT_FAILURE);
+    if (req.selected == mode::set && !propertyAssignments(req, nullptr, values, tout)) std::exit(EXIT_FAILURE);
+
+    // The memory card is only reachable in contents transfer mode
+    bool transfer = (req.selected == mode::contents || req.selected == mode::download || req.selected == mode::sync);
+    auto open_mode = transfer ? SDK::CrSdkControlMode_ContentsTransfer : SDK::CrSdkControlMode_Remote;
+    CameraDevicePtr camera = getCamera(req, open_mode);
+    if (camera == nullptr) releaseExitFailure();
+
+    if (!runCommand(camera, req, tout)) releaseExitFailure();
     releaseExitSuccess();
 }
 
-mode ArgParser(int argc, char* argv[])
+// Keeps the SDK and the camera connection open and runs the commands sent by other invocations
+void serve(const Request& req)
 {
-    mode selected = mode::help;
-    bool verbose = false;
+    string path = socketPath(req);
 
-    string dir;
-    string prop;
-    string val;
+    if (req.stop) {
+        int status = EXIT_FAILURE;
+        if (!forward_request(path, { "serve", "--stop" }, status)) {
+            printError(req, nullptr, TEXT("No daemon running"), tout);
+        }
+        std::exit(status);
+    }
 
-    auto captureCommand = (
-        command("capture").set(selected, mode::capture).doc("Capture an image"),
-        option("--dir").doc("Output dir") & value("output dir", dir)
-    );
+    CameraDevicePtr camera = getCamera(req);
+    if (camera == nullptr) releaseExitFailure();
 
-    auto getCommand = (
-        command("get").set(selected, mode::get).doc("Gets the value of a camera property"),
-        required("--prop") & value("prop", prop)
-    );
+    bool served = serve_requests(path, [&](const std::vector<string>& args, std::basic_ostream<text_char>& out, bool& stop) {
+        Request client;
+        if (!parse(args, makeCli(client))) {
+            // The request did not parse, so --json is looked for in the raw arguments
+            client.json = args.end() != std::find(args.begin(), args.end(), "--json");
+            printError(client, nullptr, TEXT("Invalid request"), out);
+            return EXIT_FAILURE;
+        }
+        if (client.selected == mode::serve) {
+            stop = client.stop;
+            return EXIT_SUCCESS;
+        }
+        // Requests run one at a time, so one that never ends would lock every other client out
+        if (client.selected == mode::liveview && 0 != client.port && client.seconds <= 0) {
+            printError(client, camera, TEXT("liveview --serve needs --seconds when run by the daemon"), out);
+            return EXIT_FAILURE;
+        }
+        // Count only the requests made on behalf of this command
+        camera->reset_fetch_stats();
+        return runCommand(camera, client, out) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }, req.verbose);
 
-    auto setCommand = (
-        command("set").set(selected, mode::set).doc("Sets the value of camera property"),
-        required("--prop").doc("Property name") & value("prop", prop),
-        required("--value").doc("Property value") & value("value", val)
-    );
+    camera->disconnect();
+    if (!served) releaseExitFailure();
+    releaseExitSuccess();
+}
 
-    auto cli = (
-        captureCommand |
-        getCommand |
-        setCommand |
-        command("sdk").set(selected, mode::sdk).doc("Load the sample app from Sony Camera SDK") |
-        command("--help").set(selected, mode::help).doc("This printed message"),
-        option("--verbose").set(verbose, true).doc("Prints debugging messages")
-    );
+mode ArgParser(int argc, char* argv[])
+{
+    Request req;
+    auto cli = makeCli(req);
 
     if(parse(argc, argv, cli)) {
-        switch(selected) {
+        if (!req.backend.empty()) {
+            auto* loaded = load_cr_lib(req.backend);
+            if (!loaded) std::exit(EXIT_FAILURE);
+            cr_lib = loaded;
+        }
+        switch(req.selected) {
             case mode::capture:
-                capture(dir, verbose);
-                break;
+            case mode::timelapse:
+            case mode::bracket:
+            case mode::focusstack:
             case mode::get:
-                getProperty(prop, verbose);
-                break;
             case mode::set:
-                setProperty(prop, val, verbose);
+            case mode::liveview: {
+                // The daemon holds a single camera, so a rig capture always connects on its own
+                if (req.selected == mode::capture && req.all) captureAll(req);
+                // Hand the command to a running daemon, otherwise connect for this call only
+                int status = EXIT_FAILURE;
+                if (forward_request(socketPath(req), forwardedArgs(argc, argv), status)) {
+                    std::exit(status);
+                }
+                oneShot(req);
+                break;
+            }
+            case mode::watch:
+                // The daemon serves one request at a time, so a watch would hold it up; it connects on its own
+                oneShot(req);
+                break;
+            case mode::contents:
+            case mode::download:
+            case mode::sync:
+                // The daemon holds a remote control connection, so this always connects on its own
+                oneShot(req);
+                break;
+            case mode::dump_index:
+                dumpIndex(req);
+                break;
+            case mode::rig:
+                rig(req);
+                break;
+            case mode::serve:
+                serve(req);
                 break;
             case mode::sdk:
                 return mode::sdk;
@@ -412,4 +1591,4 @@ mode ArgParser(int argc, char* argv[])
         tout << "Try --help to see usage\n";
     }
     std::exit(EXIT_FAILURE);
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 ﻿#include "CameraDevice.h"
+#include "PropertyTable.h"
 #include <chrono>
 #if defined(__GNUC__) && __GNUC__ < 8
 #include <experimental/filesystem>
@@ -10,8 +11,11 @@ namespace fs = std::experimental::filesystem;
 #include <filesystem>
 namespace fs = std::filesystem;
 #endif
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <thread>
+#include <unordered_map>
 #include "CRSDK/CrDeviceProperty.h"
 #include "Text.h"
 
@@ -20,25 +24,83 @@ using namespace std::chrono_literals;
 
 constexpr int const ImageSaveAutoStartNo = -1;
 
-#define SET_PROP_TIME 1000ms
-#define GET_PROP_TIME 400ms
+// Upper bound for the camera to report a value that was just set
+#define SET_PROP_TIMEOUT 1000ms
+// Upper bound for get_property_values_async() to fetch what is not stored; the stored values are returned after it
+#define GET_PROP_TIMEOUT 1000ms
+
+// Upper bounds for each step of half_full_release().
+// Each step moves on as soon as the camera reports it is ready.
+#define PRIORITY_TIMEOUT 2000ms
+#define FOCUS_TIMEOUT 1200ms
+#define CAPTURE_TIMEOUT 2000ms
+#define RELEASE_TIMEOUT 200ms
+#define RELEASE_HOLD_TIME 35ms
+
+// Upper bound for the lens to finish one NearFar step
+#define NEAR_FAR_TIMEOUT 1000ms
+
+// Detail info requests kept in flight while the contents list is built
+#define CONTENTS_INDEX_WORKERS 4
+
+// SDK callbacks queued per event thread. Property changes are handled on one thread,
+// everything else on the other, so a slow property fetch never holds up a capture or download.
+#define EVENT_QUEUE_CAPACITY 256
+#define EVENT_THREADS 2
+
+namespace impl
+{
+// True when the reported value equals the requested one within the width of the wire type
+bool same_value(CrInt64u reported, CrInt64 requested, SDK::CrDataType type)
+{
+    CrInt64u mask = ~0ULL;
+    switch (type & ~(SDK::CrDataType::CrDataType_SignBit | SDK::CrDataType::CrDataType_ArrayBit | SDK::CrDataType::CrDataType_RangeBit)) {
+    case SDK::CrDataType::CrDataType_UInt8:
+        mask = 0xFFULL;
+        break;
+    case SDK::CrDataType::CrDataType_UInt16:
+        mask = 0xFFFFULL;
+        break;
+    case SDK::CrDataType::CrDataType_UInt32:
+        mask = 0xFFFFFFFFULL;
+        break;
+    default:
+        break;
+    }
+    return (reported & mask) == (static_cast<CrInt64u>(requested) & mask);
+}
+
+// For the asynchronous calls that know their outcome without asking the camera
+template <typename T>
+std::future<T> ready_future(T value)
+{
+    std::promise<T> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future();
+}
+} // namespace impl
 
 namespace cli
 {
 CameraDevice::CameraDevice(std::int32_t no, CRLibInterface const* cr_lib, SCRSDK::ICrCameraObjectInfo const* camera_info)
-    : m_cr_lib(cr_lib)
+    : m_cr_lib(cr_lib ? cr_lib : linked_cr_lib())
     , m_number(no)
     , m_device_handle(0)
     , m_connected(false)
     , m_conn_type(ConnectionType::UNKNOWN)
     , m_net_info()
     , m_usb_info()
-    , m_prop()
+    , m_props()
     , m_lvEnbSet(true)
     , m_modeSDK(SCRSDK::CrSdkControlMode_ContentsTransfer)
     , m_spontaneous_disconnection(false)
+    , m_events([this](CameraEvent& event) { handle_event(event); }, EVENT_QUEUE_CAPACITY, EVENT_THREADS)
 {
-    m_info = SDK::CreateCameraObjectInfo(
+    m_events.set_drop_handler([this](const CameraEvent&) { m_properties_lost = true; });
+    // A dropped fetch would leave its caller waiting for the whole timeout
+    m_events.set_keep([](const CameraEvent& event) { return CameraEvent::Type::fetch == event.type; });
+
+    m_info = m_cr_lib->CreateCameraObjectInfo(
         camera_info->GetName(),
         camera_info->GetModel(),
         camera_info->GetUsbPid(),
@@ -69,14 +131,23 @@ CameraDevice::CameraDevice(std::int32_t no, CRLibInterface const* cr_lib, SCRSDK
 
 CameraDevice::~CameraDevice()
 {
+    // No handler may run once members are being destroyed
+    m_events.stop();
+    stop_live_view();
+    clear_contents_list();
     if (m_info) m_info->Release();
 }
 
 bool CameraDevice::connect(SCRSDK::CrSdkControlMode openMode)
 {
     m_spontaneous_disconnection = false;
-    // auto connect_status = m_cr_lib->Connect(m_info, this, &m_device_handle);
-    auto connect_status = SDK::Connect(m_info, this, &m_device_handle, openMode);
+    {
+        // Values from a previous connection are no longer reported on
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        m_store.clear();
+        m_connect_error = 0;
+    }
+    auto connect_status = m_cr_lib->Connect(m_info, this, &m_device_handle, openMode);
     if (CR_FAILED(connect_status)) {
         text id(this->get_id());
         if (verbose) tout << std::endl << "Failed to connect : 0x" << std::hex << connect_status << std::dec << ". " << m_info->GetModel() << " (" << id.data() << ")\n";
@@ -88,10 +159,10 @@ bool CameraDevice::connect(SCRSDK::CrSdkControlMode openMode)
 
 bool CameraDevice::disconnect()
 {
+    stop_live_view();
     m_spontaneous_disconnection = true;
     if (verbose) tout << "Disconnect from camera...\n";
-    // auto disconnect_status = m_cr_lib->Disconnect(m_device_handle);
-    auto disconnect_status = SDK::Disconnect(m_device_handle);
+    auto disconnect_status = m_cr_lib->Disconnect(m_device_handle);
     if (CR_FAILED(disconnect_status)) {
         if (verbose) tout << "Disconnect failed to initialize.\n";
         return false;
@@ -102,8 +173,7 @@ bool CameraDevice::disconnect()
 bool CameraDevice::release()
 {
     if (verbose) tout << "Release camera...\n";
-    // auto finalize_status = m_cr_lib->FinalizeDevice(m_device_handle);
-    auto finalize_status = SDK::ReleaseDevice(m_device_handle);
+    auto finalize_status = m_cr_lib->ReleaseDevice(m_device_handle);
     m_device_handle = 0; // clear
     if (CR_FAILED(finalize_status)) {
         if (verbose) tout << "Finalize device failed to initialize.\n";
@@ -114,7 +184,7 @@ bool CameraDevice::release()
 
 SCRSDK::CrSdkControlMode CameraDevice::get_sdkmode() 
 {
-    load_properties();
+    ensure_properties();
     if (SDK::CrSdkControlMode_ContentsTransfer == m_modeSDK) {
         if (verbose) tout << TEXT("Contets Transfer Mode\n");
     }
@@ -128,14 +198,12 @@ void CameraDevice::capture_image() const
 {
     if (verbose) tout << "Capture image...\n";
     if (verbose) tout << "Shutter down\n";
-    // m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam_Down);
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam_Down);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam_Down);
 
     // Wait, then send shutter up
     std::this_thread::sleep_for(35ms);
     if (verbose) tout << "Shutter up\n";
-    // m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam_Up);
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam_Up);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam_Up);
 }
 
 void CameraDevice::s1_shooting() const
@@ -154,13 +222,13 @@ void CameraDevice::s1_shooting() const
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_S1);
     prop.SetCurrentValue(SDK::CrLockIndicator::CrLockIndicator_Locked);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 
     // Wait, then send shutter up
     std::this_thread::sleep_for(1s);
     if (verbose) tout << "Shutter Halfpress up\n";
     prop.SetCurrentValue(SDK::CrLockIndicator::CrLockIndicator_Unlocked);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::af_shutter() const
@@ -179,23 +247,23 @@ void CameraDevice::af_shutter() const
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_S1);
     prop.SetCurrentValue(SDK::CrLockIndicator::CrLockIndicator_Locked);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 
     // Wait, then send shutter down
     std::this_thread::sleep_for(500ms);
     if (verbose) tout << "Shutter down\n";
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Down);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Down);
 
     // Wait, then send shutter up
     std::this_thread::sleep_for(35ms);
     if (verbose) tout << "Shutter up\n";
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Up);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Up);
 
     // Wait, then send shutter up
     std::this_thread::sleep_for(1s);
     if (verbose) tout << "Shutter Halfpress up\n";
     prop.SetCurrentValue(SDK::CrLockIndicator::CrLockIndicator_Unlocked);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::continuous_shooting() const
@@ -208,7 +276,7 @@ void CameraDevice::continuous_shooting() const
     priority.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_PriorityKeySettings);
     priority.SetCurrentValue(SDK::CrPriorityKeySettings::CrPriorityKey_PCRemote);
     priority.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
-    auto err_priority = SDK::SetDeviceProperty(m_device_handle, &priority);
+    auto err_priority = m_cr_lib->SetDeviceProperty(m_device_handle, &priority);
     if (CR_FAILED(err_priority)) {
         if (verbose) tout << "Priority Key setting FAILED\n";
         return;
@@ -222,7 +290,7 @@ void CameraDevice::continuous_shooting() const
     mode.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_DriveMode);
     mode.SetCurrentValue(SDK::CrDriveMode::CrDrive_Continuous_Hi);
     mode.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
-    auto err_still_capture_mode = SDK::SetDeviceProperty(m_device_handle, &mode);
+    auto err_still_capture_mode = m_cr_lib->SetDeviceProperty(m_device_handle, &mode);
     if (CR_FAILED(err_still_capture_mode)) {
         if (verbose) tout << "Still Capture Mode setting FAILED\n";
         return;
@@ -234,61 +302,69 @@ void CameraDevice::continuous_shooting() const
     // get_still_capture_mode();
     std::this_thread::sleep_for(1s);
     if (verbose) tout << "Shutter down\n";
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Down);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Down);
 
     // Wait, then send shutter up
     std::this_thread::sleep_for(500ms);
     if (verbose) tout << "Shutter up\n";
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Up);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Up);
 }
 
 void CameraDevice::get_aperture()
 {
-    load_properties();
-    if (verbose) tout << format_f_number(m_prop.f_number.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << format_f_number(props->f_number.current) << '\n';
 }
 
 void CameraDevice::get_iso()
 {
-    load_properties();
+    ensure_properties();
+    auto props = m_props.load();
 
-    if (verbose) tout << "ISO: " << format_iso_sensitivity(m_prop.iso_sensitivity.current) << '\n';
+    if (verbose) tout << "ISO: " << format_iso_sensitivity(props->iso_sensitivity.current) << '\n';
 }
 
 void CameraDevice::get_shutter_speed()
 {
-    load_properties();
-    if (verbose) tout << "Shutter speed: " << format_shutter_speed(m_prop.shutter_speed.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Shutter speed: " << format_shutter_speed(props->shutter_speed.current) << '\n';
 }
 
 void CameraDevice::get_position_key_setting()
 {
-    load_properties();
-    if (verbose) tout << "Position Key Setting: " << format_position_key_setting(m_prop.position_key_setting.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Position Key Setting: " << format_position_key_setting(props->position_key_setting.current) << '\n';
 }
 
 void CameraDevice::get_exposure_program_mode()
 {
-    load_properties();
-    if (verbose) tout << "Exposure Program Mode: " << format_exposure_program_mode(m_prop.exposure_program_mode.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Exposure Program Mode: " << format_exposure_program_mode(props->exposure_program_mode.current) << '\n';
 }
 
 void CameraDevice::get_still_capture_mode()
 {
-    load_properties();
-    if (verbose) tout << "Still Capture Mode: " << format_still_capture_mode(m_prop.still_capture_mode.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Still Capture Mode: " << format_still_capture_mode(props->still_capture_mode.current) << '\n';
 }
 
 void CameraDevice::get_focus_mode()
 {
-    load_properties();
-    if (verbose) tout << "Focus Mode: " << format_focus_mode(m_prop.focus_mode.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Focus Mode: " << format_focus_mode(props->focus_mode.current) << '\n';
 }
 
 void CameraDevice::get_focus_area()
 {
-    load_properties();
-    if (verbose) tout << "Focus Area: " << format_focus_area(m_prop.focus_area.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Focus Area: " << format_focus_area(props->focus_area.current) << '\n';
 }
 
 void CameraDevice::get_live_view()
@@ -297,15 +373,15 @@ void CameraDevice::get_live_view()
 
     CrInt32 num = 0;
     SDK::CrLiveViewProperty* property = nullptr;
-    auto err = SDK::GetLiveViewProperties(m_device_handle, &property, &num);
+    auto err = m_cr_lib->GetLiveViewProperties(m_device_handle, &property, &num);
     if (CR_FAILED(err)) {
         if (verbose) tout << "GetLiveView FAILED\n";
         return;
     }
-    SDK::ReleaseLiveViewProperties(m_device_handle, property);
+    m_cr_lib->ReleaseLiveViewProperties(m_device_handle, property);
 
     SDK::CrImageInfo inf;
-    err = SDK::GetLiveViewImageInfo(m_device_handle, &inf);
+    err = m_cr_lib->GetLiveViewImageInfo(m_device_handle, &inf);
     if (CR_FAILED(err)) {
         if (verbose) tout << "GetLiveView FAILED\n";
         return;
@@ -334,7 +410,7 @@ void CameraDevice::get_live_view()
         image_data->SetSize(bufSize);
         image_data->SetData(image_buff);
 
-        err = SDK::GetLiveViewImage(m_device_handle, image_data);
+        err = m_cr_lib->GetLiveViewImage(m_device_handle, image_data);
         if (CR_FAILED(err))
         {
             // FAILED
@@ -384,45 +460,67 @@ void CameraDevice::get_live_view()
     }
 }
 
+bool CameraDevice::start_live_view(std::size_t buffers)
+{
+    if (m_live_view && m_live_view->is_running()) return true;
+    // A stopped stream is restarted rather than replaced, since frames from its last run may still be held
+    if (!m_live_view) m_live_view.reset(new LiveViewStream(m_cr_lib, m_device_handle));
+    if (!m_live_view->start(buffers)) {
+        if (verbose) tout << "Start live view FAILED\n";
+        return false;
+    }
+    return true;
+}
+
+void CameraDevice::stop_live_view()
+{
+    if (m_live_view) m_live_view->stop();
+}
+
 void CameraDevice::get_live_view_image_quality()
 {
-    load_properties();
-    if (verbose) tout << "Live View Image Quality: " << format_live_view_image_quality(m_prop.live_view_image_quality.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Live View Image Quality: " << format_live_view_image_quality(props->live_view_image_quality.current) << '\n';
 }
 
 void CameraDevice::get_live_view_status()
 {
-    load_properties();
-    if (verbose) tout << "LiveView Enabled: " << format_live_view_status(m_prop.live_view_status.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "LiveView Enabled: " << format_live_view_status(props->live_view_status.current) << '\n';
 }
 
 void CameraDevice::get_select_media_format()
 {
-    load_properties();
-    if (verbose) tout << "Media SLOT1 Full Format Enable Status: " << format_media_slotx_format_enable_status(m_prop.media_slot1_full_format_enable_status.current) << std::endl;
-    if (verbose) tout << "Media SLOT2 Full Format Enable Status: " << format_media_slotx_format_enable_status(m_prop.media_slot2_full_format_enable_status.current) << std::endl;
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Media SLOT1 Full Format Enable Status: " << format_media_slotx_format_enable_status(props->media_slot1_full_format_enable_status.current) << std::endl;
+    if (verbose) tout << "Media SLOT2 Full Format Enable Status: " << format_media_slotx_format_enable_status(props->media_slot2_full_format_enable_status.current) << std::endl;
     // Valid Quick format
-    if (m_prop.media_slot1_quick_format_enable_status.writable || m_prop.media_slot2_quick_format_enable_status.writable){
-        if (verbose) tout << "Media SLOT1 Quick Format Enable Status: " << format_media_slotx_format_enable_status(m_prop.media_slot1_quick_format_enable_status.current) << std::endl;
-        if (verbose) tout << "Media SLOT2 Quick Format Enable Status: " << format_media_slotx_format_enable_status(m_prop.media_slot2_quick_format_enable_status.current) << std::endl;
+    if (props->media_slot1_quick_format_enable_status.writable || props->media_slot2_quick_format_enable_status.writable){
+        if (verbose) tout << "Media SLOT1 Quick Format Enable Status: " << format_media_slotx_format_enable_status(props->media_slot1_quick_format_enable_status.current) << std::endl;
+        if (verbose) tout << "Media SLOT2 Quick Format Enable Status: " << format_media_slotx_format_enable_status(props->media_slot2_quick_format_enable_status.current) << std::endl;
     }
 }
 
 void CameraDevice::get_white_balance()
 {
-    load_properties();
-    if (verbose) tout << "White Balance: " << format_white_balance(m_prop.white_balance.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "White Balance: " << format_white_balance(props->white_balance.current) << '\n';
 }
 
 bool CameraDevice::get_custom_wb()
 {
     bool state = false;
-    load_properties();
-    if (verbose) tout << "CustomWB Capture Standby Operation: " << format_customwb_capture_stanby(m_prop.customwb_capture_stanby.current) << '\n';
-    if (verbose) tout << "CustomWB Capture Standby CancelOperation: " << format_customwb_capture_stanby_cancel(m_prop.customwb_capture_stanby_cancel.current) << '\n';
-    if (verbose) tout << "CustomWB Capture Operation: " << format_customwb_capture_operation(m_prop.customwb_capture_operation.current) << '\n';
-    if (verbose) tout << "CustomWB Capture Execution State : " << format_customwb_capture_execution_state(m_prop.customwb_capture_execution_state.current) << '\n';
-    if (m_prop.customwb_capture_operation.current == 1) {
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "CustomWB Capture Standby Operation: " << format_customwb_capture_stanby(props->customwb_capture_stanby.current) << '\n';
+    if (verbose) tout << "CustomWB Capture Standby CancelOperation: " << format_customwb_capture_stanby_cancel(props->customwb_capture_stanby_cancel.current) << '\n';
+    if (verbose) tout << "CustomWB Capture Operation: " << format_customwb_capture_operation(props->customwb_capture_operation.current) << '\n';
+    if (verbose) tout << "CustomWB Capture Execution State : " << format_customwb_capture_execution_state(props->customwb_capture_execution_state.current) << '\n';
+    if (props->customwb_capture_operation.current == 1) {
         state = true;
     }
     return state;
@@ -430,26 +528,27 @@ bool CameraDevice::get_custom_wb()
 
 void CameraDevice::get_zoom_operation()
 {
-    load_properties();
-    if (verbose) tout << "Zoom Operation Status: " << format_zoom_operation_status(m_prop.zoom_operation_status.current) << '\n';
-    if (verbose) tout << "Zoom Setting Type: " << format_zoom_setting_type(m_prop.zoom_setting_type.current) << '\n';
-    if (verbose) tout << "Zoom Type Status: " << format_zoom_types_status(m_prop.zoom_types_status.current) << '\n';
-    if (verbose) tout << "Zoom Operation: " << format_zoom_operation(m_prop.zoom_operation.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Zoom Operation Status: " << format_zoom_operation_status(props->zoom_operation_status.current) << '\n';
+    if (verbose) tout << "Zoom Setting Type: " << format_zoom_setting_type(props->zoom_setting_type.current) << '\n';
+    if (verbose) tout << "Zoom Type Status: " << format_zoom_types_status(props->zoom_types_status.current) << '\n';
+    if (verbose) tout << "Zoom Operation: " << format_zoom_operation(props->zoom_operation.current) << '\n';
 
     // Zoom Speed Range is not supported
-    if (m_prop.zoom_speed_range.possible.size() < 2) {
+    if (props->zoom_speed_range.possible.size() < 2) {
         if (verbose) tout << "Zoom Speed Range: -1 to 1" << std::endl 
-             << "Zoom Speed Type: " << format_remocon_zoom_speed_type(m_prop.remocon_zoom_speed_type.current) << std::endl;
+             << "Zoom Speed Type: " << format_remocon_zoom_speed_type(props->remocon_zoom_speed_type.current) << std::endl;
     }
     else {
-        if (verbose) tout << "Zoom Speed Range: " << (int)m_prop.zoom_speed_range.possible.at(0) << " to " << (int)m_prop.zoom_speed_range.possible.at(1) << std::endl
-             << "Zoom Speed Type: " << format_remocon_zoom_speed_type(m_prop.remocon_zoom_speed_type.current) << std::endl;
+        if (verbose) tout << "Zoom Speed Range: " << (int)props->zoom_speed_range.possible.at(0) << " to " << (int)props->zoom_speed_range.possible.at(1) << std::endl
+             << "Zoom Speed Type: " << format_remocon_zoom_speed_type(props->remocon_zoom_speed_type.current) << std::endl;
     }
 
     std::int32_t nprop = 0;
     SDK::CrDeviceProperty* prop_list = nullptr;
     CrInt32u getCode = SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Bar_Information;
-    auto status = SDK::GetSelectDeviceProperties(m_device_handle, 1, &getCode, &prop_list, &nprop);
+    auto status = fetch_properties(1, &getCode, &prop_list, &nprop);
 
     if (CR_FAILED(status)) {
         if (verbose) tout << "Failed to get Zoom Bar Information.\n";
@@ -462,19 +561,21 @@ void CameraDevice::get_zoom_operation()
         {
             if (verbose) tout << "Zoom Bar Information: 0x" << std::hex << prop.GetCurrentValue() << std::dec << '\n';
         }
-        SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
+        m_cr_lib->ReleaseDeviceProperties(m_device_handle, prop_list);
     }
 }
 
 void CameraDevice::get_remocon_zoom_speed_type()
 {
-    load_properties();
-    if (verbose) tout << "Zoom Speed Type: " << format_remocon_zoom_speed_type(m_prop.remocon_zoom_speed_type.current) << '\n';
+    ensure_properties();
+    auto props = m_props.load();
+    if (verbose) tout << "Zoom Speed Type: " << format_remocon_zoom_speed_type(props->remocon_zoom_speed_type.current) << '\n';
 }
 
 void CameraDevice::set_aperture()
 {
-    if (!m_prop.f_number.writable) {
+    auto props = m_props.load();
+    if (!props->f_number.writable) {
         // Not a settable property
         if (verbose) tout << "Aperture is not writable\n";
         return;
@@ -491,7 +592,7 @@ void CameraDevice::set_aperture()
     if (verbose) tout << "Choose a number set a new Aperture value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.f_number.possible;
+    auto& values = props->f_number.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_f_number(values[i]) << '\n';
     }
@@ -515,13 +616,13 @@ void CameraDevice::set_aperture()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_iso()
 {
-    if (!m_prop.iso_sensitivity.writable) {
+    auto props = m_props.load();
+    if (!props->iso_sensitivity.writable) {
         // Not a settable property
         if (verbose) tout << "ISO is not writable\n";
         return;
@@ -538,7 +639,7 @@ void CameraDevice::set_iso()
     if (verbose) tout << "Choose a number set a new ISO value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.iso_sensitivity.possible;
+    auto& values = props->iso_sensitivity.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_iso_sensitivity(values[i]) << '\n';
     }
@@ -562,8 +663,7 @@ void CameraDevice::set_iso()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 bool CameraDevice::set_save_info() const
@@ -572,13 +672,13 @@ bool CameraDevice::set_save_info() const
     text_char path[255]; /*MAX_PATH*/
     getcwd(path, sizeof(path) -1);
 
-    auto save_status = SDK::SetSaveInfo(m_device_handle
+    auto save_status = m_cr_lib->SetSaveInfo(m_device_handle
         , path, (char*)"", ImageSaveAutoStartNo);
 #else
     text path = fs::current_path().native();
     if (verbose) tout << path.data() << '\n';
 
-    auto save_status = SDK::SetSaveInfo(m_device_handle
+    auto save_status = m_cr_lib->SetSaveInfo(m_device_handle
         , const_cast<text_char*>(path.data()), TEXT(""), ImageSaveAutoStartNo);
 #endif
     if (CR_FAILED(save_status)) {
@@ -590,7 +690,8 @@ bool CameraDevice::set_save_info() const
 
 void CameraDevice::set_shutter_speed()
 {
-    if (!m_prop.shutter_speed.writable) {
+    auto props = m_props.load();
+    if (!props->shutter_speed.writable) {
         // Not a settable property
         if (verbose) tout << "Shutter Speed is not writable\n";
         return;
@@ -607,7 +708,7 @@ void CameraDevice::set_shutter_speed()
     if (verbose) tout << "Choose a number set a new Shutter Speed value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.shutter_speed.possible;
+    auto& values = props->shutter_speed.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_shutter_speed(values[i]) << '\n';
     }
@@ -631,13 +732,13 @@ void CameraDevice::set_shutter_speed()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_position_key_setting()
 {
-    if (!m_prop.position_key_setting.writable) {
+    auto props = m_props.load();
+    if (!props->position_key_setting.writable) {
         // Not a settable property
         if (verbose) tout << "Position Key Setting is not writable\n";
         return;
@@ -654,7 +755,7 @@ void CameraDevice::set_position_key_setting()
     if (verbose) tout << "Choose a number set a new Position Key Setting value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.position_key_setting.possible;
+    auto& values = props->position_key_setting.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_position_key_setting(values[i]) << '\n';
     }
@@ -678,13 +779,13 @@ void CameraDevice::set_position_key_setting()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt8Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_exposure_program_mode()
 {
-    if (!m_prop.exposure_program_mode.writable) {
+    auto props = m_props.load();
+    if (!props->exposure_program_mode.writable) {
         // Not a settable property
         if (verbose) tout << "Exposure Program Mode is not writable\n";
         return;
@@ -701,7 +802,7 @@ void CameraDevice::set_exposure_program_mode()
     if (verbose) tout << "Choose a number set a new Exposure Program Mode value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.exposure_program_mode.possible;
+    auto& values = props->exposure_program_mode.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_exposure_program_mode(values[i]) << '\n';
     }
@@ -725,13 +826,13 @@ void CameraDevice::set_exposure_program_mode()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_still_capture_mode()
 {
-    if (!m_prop.still_capture_mode.writable) {
+    auto props = m_props.load();
+    if (!props->still_capture_mode.writable) {
         // Not a settable property
         if (verbose) tout << "Still Capture Mode is not writable\n";
         return;
@@ -748,7 +849,7 @@ void CameraDevice::set_still_capture_mode()
     if (verbose) tout << "Choose a number set a new Still Capture Mode value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.still_capture_mode.possible;
+    auto& values = props->still_capture_mode.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_still_capture_mode(values[i]) << '\n';
     }
@@ -772,13 +873,13 @@ void CameraDevice::set_still_capture_mode()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_focus_mode()
 {
-    if (!m_prop.focus_mode.writable) {
+    auto props = m_props.load();
+    if (!props->focus_mode.writable) {
         // Not a settable property
         if (verbose) tout << "Focus Mode is not writable\n";
         return;
@@ -795,7 +896,7 @@ void CameraDevice::set_focus_mode()
     if (verbose) tout << "Choose a number set a new Focus Mode value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.focus_mode.possible;
+    auto& values = props->focus_mode.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_focus_mode(values[i]) << '\n';
     }
@@ -819,13 +920,13 @@ void CameraDevice::set_focus_mode()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_focus_area()
 {
-    if (!m_prop.focus_area.writable) {
+    auto props = m_props.load();
+    if (!props->focus_area.writable) {
         // Not a settable property
         if (verbose) tout << "Focus Area is not writable\n";
         return;
@@ -842,7 +943,7 @@ void CameraDevice::set_focus_area()
     if (verbose) tout << "Choose a number set a new Focus Area value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.focus_area.possible;
+    auto& values = props->focus_area.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_focus_area(values[i]) << '\n';
     }
@@ -866,13 +967,13 @@ void CameraDevice::set_focus_area()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_live_view_image_quality()
 {
-    if (!m_prop.live_view_image_quality.writable) {
+    auto props = m_props.load();
+    if (!props->live_view_image_quality.writable) {
         // Not a settable property
         if (verbose) tout << "Live View Image Quality is not writable\n";
         return;
@@ -889,7 +990,7 @@ void CameraDevice::set_live_view_image_quality()
     if (verbose) tout << "Choose a number set a new Live View Image Quality value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.live_view_image_quality.possible;
+    auto& values = props->live_view_image_quality.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_live_view_image_quality(values[i]) << '\n';
     }
@@ -913,12 +1014,13 @@ void CameraDevice::set_live_view_image_quality()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::set_live_view_status()
 {
-    if (!m_prop.live_view_status.writable) {
+    auto props = m_props.load();
+    if (!props->live_view_status.writable) {
         // Not a settable property
         if (verbose) tout << "Live View Status is not writable\n";
         return;
@@ -957,14 +1059,15 @@ void CameraDevice::set_live_view_status()
     prop.SetCurrentValue(selected_index);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt8);
 
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 
     get_live_view_status();
 }
 
 void CameraDevice::set_white_balance()
 {
-    if (!m_prop.white_balance.writable) {
+    auto props = m_props.load();
+    if (!props->white_balance.writable) {
         // Not a settable property
         if (verbose) tout << "White Balance is not writable\n";
         return;
@@ -981,7 +1084,7 @@ void CameraDevice::set_white_balance()
     if (verbose) tout << std::endl << "Choose a number set a new White Balance value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.white_balance.possible;
+    auto& values = props->white_balance.possible;
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_white_balance(values[i]) << '\n';
     }
@@ -1005,12 +1108,12 @@ void CameraDevice::set_white_balance()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::execute_lock_property(CrInt16u code)
 {
-    load_properties();
+    ensure_properties();
 
     text input;
     if (verbose) tout << std::endl << "Would you like to execute Unlock or Lock? (y/n): ";
@@ -1058,7 +1161,7 @@ void CameraDevice::execute_lock_property(CrInt16u code)
     prop.SetCurrentValue((CrInt64u)(ptpValue));
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
 
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::get_af_area_position()
@@ -1066,7 +1169,7 @@ void CameraDevice::get_af_area_position()
     CrInt32 num = 0;
     SDK::CrLiveViewProperty* lvProperty = nullptr;
     CrInt32u getCode = SDK::CrLiveViewPropertyCode::CrLiveViewProperty_AF_Area_Position;
-    auto err = SDK::GetSelectLiveViewProperties(m_device_handle, 1, &getCode, &lvProperty, &num);
+    auto err = m_cr_lib->GetSelectLiveViewProperties(m_device_handle, 1, &getCode, &lvProperty, &num);
     if (CR_FAILED(err)) {
         if (verbose) tout << "Failed to get AF Area Position [LiveViewProperties]\n";
         return;
@@ -1097,20 +1200,20 @@ void CameraDevice::get_af_area_position()
                 }
             }
         }
-        SDK::ReleaseLiveViewProperties(m_device_handle, lvProperty);
+        m_cr_lib->ReleaseLiveViewProperties(m_device_handle, lvProperty);
     }
 }
 
 void CameraDevice::set_af_area_position()
 {
-    load_properties();
+    ensure_properties();
     // Set, FocusArea property
     if (verbose) tout << "Set FocusArea to Flexible_Spot_S\n";
     SDK::CrDeviceProperty prop;
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusArea);
     prop.SetCurrentValue(SDK::CrFocusArea::CrFocusArea_Flexible_Spot_S);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
-    auto err_prop = SDK::SetDeviceProperty(m_device_handle, &prop);
+    auto err_prop = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     if (CR_FAILED(err_prop)) {
         if (verbose) tout << "FocusArea FAILED\n";
         return;
@@ -1128,20 +1231,21 @@ void CameraDevice::set_af_area_position()
 
 void CameraDevice::set_select_media_format()
 {
+    auto props = m_props.load();
     bool validQuickFormat = false;
     SDK::CrCommandId ptpFormatType = SDK::CrCommandId::CrCommandId_MediaFormat;
 
-    if ((SDK::CrMediaFormat::CrMediaFormat_Disable == m_prop.media_slot1_full_format_enable_status.current) &&
-        (SDK::CrMediaFormat::CrMediaFormat_Disable == m_prop.media_slot2_full_format_enable_status.current)) {
+    if ((SDK::CrMediaFormat::CrMediaFormat_Disable == props->media_slot1_full_format_enable_status.current) &&
+        (SDK::CrMediaFormat::CrMediaFormat_Disable == props->media_slot2_full_format_enable_status.current)) {
             // Not a settable property
         if (verbose) tout << std::endl << "Slot1 and Slot2 is can not format\n";
         return;
     }
 
-    if ((m_prop.media_slot1_quick_format_enable_status.writable || m_prop.media_slot2_quick_format_enable_status.writable)
+    if ((props->media_slot1_quick_format_enable_status.writable || props->media_slot2_quick_format_enable_status.writable)
         &&
-         ((SDK::CrMediaFormat::CrMediaFormat_Enable == m_prop.media_slot1_quick_format_enable_status.current) ||
-          (SDK::CrMediaFormat::CrMediaFormat_Enable == m_prop.media_slot2_quick_format_enable_status.current))) {
+         ((SDK::CrMediaFormat::CrMediaFormat_Enable == props->media_slot1_quick_format_enable_status.current) ||
+          (SDK::CrMediaFormat::CrMediaFormat_Enable == props->media_slot2_quick_format_enable_status.current))) {
             validQuickFormat = true;
     }
 
@@ -1195,19 +1299,19 @@ void CameraDevice::set_select_media_format()
 
     CrInt64u ptpValue = 0xFFFF;
     if (SDK::CrCommandId::CrCommandId_MediaQuickFormat == ptpFormatType) {
-        if ((1 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == m_prop.media_slot1_quick_format_enable_status.current)) {
+        if ((1 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == props->media_slot1_quick_format_enable_status.current)) {
         ptpValue = SDK::CrCommandParam::CrCommandParam_Up;
         }
-        else if ((2 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == m_prop.media_slot2_quick_format_enable_status.current)) {
+        else if ((2 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == props->media_slot2_quick_format_enable_status.current)) {
             ptpValue = SDK::CrCommandParam::CrCommandParam_Down;
         }
     }
     else
     {
-        if ((1 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == m_prop.media_slot1_full_format_enable_status.current)) {
+        if ((1 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == props->media_slot1_full_format_enable_status.current)) {
             ptpValue = SDK::CrCommandParam::CrCommandParam_Up;
         }
-        else if ((2 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == m_prop.media_slot2_full_format_enable_status.current)) {
+        else if ((2 == selected_index) && (SDK::CrMediaFormat::CrMediaFormat_Enable == props->media_slot2_full_format_enable_status.current)) {
             ptpValue = SDK::CrCommandParam::CrCommandParam_Down;
         }
     }
@@ -1225,7 +1329,7 @@ void CameraDevice::set_select_media_format()
         return;
     }
 
-    SDK::SendCommand(m_device_handle, ptpFormatType, (SDK::CrCommandParam)ptpValue);
+    m_cr_lib->SendCommand(m_device_handle, ptpFormatType, (SDK::CrCommandParam)ptpValue);
 
     if (verbose) tout << std::endl << "Formatting .....\n";
 
@@ -1238,7 +1342,7 @@ void CameraDevice::set_select_media_format()
     // check of progress
     while (true)
     {
-        auto status = SDK::GetSelectDeviceProperties(m_device_handle, 1, &getCodes, &prop_list, &nprop);
+        auto status = fetch_properties(1, &getCodes, &prop_list, &nprop);
         if (CR_FAILED(status)) {
             if (verbose) tout << "Failed to get Media FormatProgressRate.\n";
             return;
@@ -1255,7 +1359,7 @@ void CameraDevice::set_select_media_format()
                 if ((1 == startflag) && (0 == prop.GetCurrentValue()))
                 {
                     if (verbose) tout << std::endl << "Format completed " << '\n';
-                    SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
+                    m_cr_lib->ReleaseDeviceProperties(m_device_handle, prop_list);
                     prop_list = nullptr;
                     break;
                 }
@@ -1263,14 +1367,14 @@ void CameraDevice::set_select_media_format()
             }
         }
         std::this_thread::sleep_for(250ms);
-        SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
+        m_cr_lib->ReleaseDeviceProperties(m_device_handle, prop_list);
         prop_list = nullptr;
     }
 }
 
 void CameraDevice::execute_movie_rec()
 {
-    load_properties();
+    ensure_properties();
 
     text input;
     if (verbose) tout << std::endl << "Operate the movie recording button ? (y/n):";
@@ -1318,7 +1422,7 @@ void CameraDevice::execute_movie_rec()
         return;
     }
 
-    SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_MovieRecord, (SDK::CrCommandParam)ptpValue);
+    m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_MovieRecord, (SDK::CrCommandParam)ptpValue);
 
 }
 
@@ -1330,7 +1434,7 @@ void CameraDevice::set_custom_wb()
     priority.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_PriorityKeySettings);
     priority.SetCurrentValue(SDK::CrPriorityKeySettings::CrPriorityKey_PCRemote);
     priority.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
-    auto err_priority = SDK::SetDeviceProperty(m_device_handle, &priority);
+    auto err_priority = m_cr_lib->SetDeviceProperty(m_device_handle, &priority);
     if (CR_FAILED(err_priority)) {
         if (verbose) tout << "Priority Key setting FAILED\n";
         return;
@@ -1347,7 +1451,7 @@ void CameraDevice::set_custom_wb()
     expromode.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_ExposureProgramMode);
     expromode.SetCurrentValue(SDK::CrExposureProgram::CrExposure_P_Auto);
     expromode.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
-    auto err_expromode = SDK::SetDeviceProperty(m_device_handle, &expromode);
+    auto err_expromode = m_cr_lib->SetDeviceProperty(m_device_handle, &expromode);
     if (CR_FAILED(err_expromode)) {
         if (verbose) tout << "Exposure Program mode FAILED\n";
         return;
@@ -1364,7 +1468,7 @@ void CameraDevice::set_custom_wb()
     wb.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_WhiteBalance);
     wb.SetCurrentValue(SDK::CrWhiteBalanceSetting::CrWhiteBalance_Custom_1);
     wb.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
-    auto err_wb = SDK::SetDeviceProperty(m_device_handle, &wb);
+    auto err_wb = m_cr_lib->SetDeviceProperty(m_device_handle, &wb);
     if (CR_FAILED(err_wb)) {
         if (verbose) tout << "White Balance FAILED\n";
         return;
@@ -1419,7 +1523,8 @@ void CameraDevice::set_custom_wb()
 
 void CameraDevice::set_zoom_operation()
 {
-    load_properties();
+    ensure_properties();
+    auto props = m_props.load();
 
     text input;
     if (verbose) tout << std::endl << "Operate the zoom ? (y/n):";
@@ -1435,7 +1540,7 @@ void CameraDevice::set_zoom_operation()
         bool cancel = false;
 
         // Zoom Speed Range is not supported
-        if (m_prop.zoom_speed_range.possible.size() < 2) {
+        if (props->zoom_speed_range.possible.size() < 2) {
             if (verbose) tout << std::endl << "Choose a number :\n";
             if (verbose) tout << "[-1] Cancel input\n";
 
@@ -1477,7 +1582,7 @@ void CameraDevice::set_zoom_operation()
             ss >> input_value;
 
             //Stop zoom and return to the top menu when out-of-range values or non-numeric values are entered
-            if (((input_value == 0) && (input != TEXT("0"))) || (input_value < (int)m_prop.zoom_speed_range.possible.at(0)) || ((int)m_prop.zoom_speed_range.possible.at(1) < input_value))
+            if (((input_value == 0) && (input != TEXT("0"))) || (input_value < (int)props->zoom_speed_range.possible.at(0)) || ((int)props->zoom_speed_range.possible.at(1) < input_value))
             {
                 cancel = true;
                 ptpValue = SDK::CrZoomOperation::CrZoomOperation_Stop;
@@ -1492,7 +1597,7 @@ void CameraDevice::set_zoom_operation()
         prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Operation);
         prop.SetCurrentValue((CrInt64u)ptpValue);
         prop.SetValueType(SDK::CrDataType::CrDataType_UInt16Array);
-        SDK::SetDeviceProperty(m_device_handle, &prop);
+        m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
         if (cancel == true) {
             return;
         }
@@ -1502,7 +1607,8 @@ void CameraDevice::set_zoom_operation()
 
 void CameraDevice::set_remocon_zoom_speed_type()
 {
-    if (!m_prop.remocon_zoom_speed_type.writable) {
+    auto props = m_props.load();
+    if (!props->remocon_zoom_speed_type.writable) {
         // Not a settable property
         if (verbose) tout << "Zoom speed type is not writable\n";
         return;
@@ -1519,7 +1625,7 @@ void CameraDevice::set_remocon_zoom_speed_type()
     if (verbose) tout << "Choose a number set a new zoom speed type value:\n";
     if (verbose) tout << "[-1] Cancel input\n";
 
-    auto& values = m_prop.remocon_zoom_speed_type.possible;
+    auto& values = props->remocon_zoom_speed_type.possible;
 
     for (std::size_t i = 0; i < values.size(); ++i) {
         if (verbose) tout << '[' << i << "] " << format_remocon_zoom_speed_type(values[i]) << '\n';
@@ -1544,8 +1650,7 @@ void CameraDevice::set_remocon_zoom_speed_type()
     prop.SetCurrentValue(values[selected_index]);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt32Array);
 
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::execute_downup_property(CrInt16u code)
@@ -1556,20 +1661,20 @@ void CameraDevice::execute_downup_property(CrInt16u code)
 
     // Down
     prop.SetCurrentValue(SDK::CrPropertyCustomWBCaptureButton::CrPropertyCustomWBCapture_Down);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 
     std::this_thread::sleep_for(500ms);
 
     // Up
     prop.SetCurrentValue(SDK::CrPropertyCustomWBCaptureButton::CrPropertyCustomWBCapture_Up);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 
     std::this_thread::sleep_for(500ms);
 }
 
 void CameraDevice::execute_pos_xy(CrInt16u code)
 {
-    load_properties();
+    ensure_properties();
 
     text input;
     if (verbose) tout << std::endl << "Change position ? (y/n):";
@@ -1623,18 +1728,19 @@ void CameraDevice::execute_pos_xy(CrInt16u code)
     prop.SetCurrentValue((CrInt64u)x_y);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt32);
 
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 
 void CameraDevice::execute_preset_focus()
 {
-    load_properties();
+    ensure_properties();
+    auto props = m_props.load();
 
-    auto& values_save = m_prop.save_zoom_and_focus_position.possible;
-    auto& values_load = m_prop.load_zoom_and_focus_position.possible;
+    auto& values_save = props->save_zoom_and_focus_position.possible;
+    auto& values_load = props->load_zoom_and_focus_position.possible;
 
-    if ((!m_prop.save_zoom_and_focus_position.writable) &&
-        (!m_prop.load_zoom_and_focus_position.writable)){
+    if ((!props->save_zoom_and_focus_position.writable) &&
+        (!props->load_zoom_and_focus_position.writable)){
         // Not a settable property
         if (verbose) tout << "Preset Focus is not supported.\n";
         return;
@@ -1669,10 +1775,10 @@ void CameraDevice::execute_preset_focus()
     ss >> selected_index;
 
     CrInt32u code = 0;
-    if ((1 == selected_index) && (m_prop.save_zoom_and_focus_position.writable)) {
+    if ((1 == selected_index) && (props->save_zoom_and_focus_position.writable)) {
         code = SDK::CrDevicePropertyCode::CrDeviceProperty_ZoomAndFocusPosition_Save;
     }
-    else if ((2 == selected_index) && (m_prop.load_zoom_and_focus_position.writable)) {
+    else if ((2 == selected_index) && (props->load_zoom_and_focus_position.writable)) {
         code = SDK::CrDevicePropertyCode::CrDeviceProperty_ZoomAndFocusPosition_Load;
     }
     else {
@@ -1705,12 +1811,12 @@ void CameraDevice::execute_preset_focus()
     prop.SetCode(code);
     prop.SetCurrentValue(input_value);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt8);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
 }
 void CameraDevice::change_live_view_enable()
 {
     m_lvEnbSet = !m_lvEnbSet;
-    SDK::SetDeviceSetting(m_device_handle, SDK::Setting_Key_EnableLiveView, (CrInt32u)m_lvEnbSet);
+    m_cr_lib->SetDeviceSetting(m_device_handle, SDK::Setting_Key_EnableLiveView, (CrInt32u)m_lvEnbSet);
 }
 
 bool CameraDevice::is_connected() const
@@ -1757,22 +1863,47 @@ text CameraDevice::get_id()
         return text((TCHAR*)m_info->GetId());
 }
 
+void CameraDevice::set_json_writer(JsonWriter* writer)
+{
+    // Written before the first writer only, the callbacks read it without the lock
+    if (writer && m_json_id.empty()) m_json_id = get_id();
+    // Once this returns, no callback holds on to the previous writer
+    std::lock_guard<std::mutex> lock(m_json_mtx);
+    m_json = writer;
+}
+
+void CameraDevice::write_json(JsonLine& line)
+{
+    std::lock_guard<std::mutex> lock(m_json_mtx);
+    if (auto* json = m_json.load()) json->write(line);
+}
+
+void CameraDevice::post_event(CameraEvent& event)
+{
+    event.reported = std::chrono::steady_clock::now();
+    if (CameraEvent::Type::properties_changed == event.type) {
+        m_events.post(event, 0, m_properties_overflow.load());
+    }
+    else {
+        // Requested fetches queue behind the property changes, so they see the latest values
+        m_events.post(event, CameraEvent::Type::fetch == event.type ? 0 : 1, EventOverflow::block);
+    }
+}
+
+// The callbacks only queue what they were told; the work is done by handle_event() on the event threads
 void CameraDevice::OnConnected(SDK::DeviceConnectionVersioin version)
 {
-    m_connected.store(true);
-    text id(this->get_id());
-    if (verbose) tout << "Connected to " << m_info->GetModel() << " (" << id.data() << ")\n";
+    CameraEvent event;
+    event.type = CameraEvent::Type::connected;
+    post_event(event);
 }
 
 void CameraDevice::OnDisconnected(CrInt32u error)
 {
-    m_connected.store(false);
-    text id(this->get_id());
-    if (verbose) tout << "Disconnected from " << m_info->GetModel() << " (" << id.data() << ")\n";
-    if ((false == m_spontaneous_disconnection) && (SDK::CrSdkControlMode_ContentsTransfer == m_modeSDK))
-    {
-        if (verbose) tout << "Please input '0' to return to the TOP-MENU\n";
-    }
+    CameraEvent event;
+    event.type = CameraEvent::Type::disconnected;
+    event.code = error;
+    post_event(event);
 }
 
 void CameraDevice::OnPropertyChanged()
@@ -1787,74 +1918,39 @@ void CameraDevice::OnLvPropertyChanged()
 
 void CameraDevice::OnCompleteDownload(CrChar* filename)
 {
-    text file(filename);
-    tout << "Download Complete (" << file.data() << ")\n";
-
-    if (release_after_download) {
-        releaseExitSuccess();
-    }
+    CameraEvent event;
+    event.type = CameraEvent::Type::download;
+    event.file = filename;
+    post_event(event);
 }
 
 void CameraDevice::OnNotifyContentsTransfer(CrInt32u notify, SDK::CrContentHandle contentHandle, CrChar* filename)
 {
-    // Start
-    if (SDK::CrNotify_ContentsTransfer_Start == notify)
-    {
-        if (verbose) tout << "[START] Contents Handle: 0x " << std::hex << contentHandle << std::dec << std::endl;
-    }
-    // Complete
-    else if (SDK::CrNotify_ContentsTransfer_Complete == notify)
-    {
-        text file(filename);
-        if (verbose) tout << "[COMPLETE] Contents Handle: 0x" << std::hex << contentHandle << std::dec << ", File: " << file.data() << std::endl;
-    }
-    // Other
-    else
-    {
-        text msg = get_message_desc(notify);
-        if (msg.empty()) {
-            if (verbose) tout << "[-] Content transfer failure. 0x" << std::hex << notify << ", handle: 0x" << contentHandle << std::dec << std::endl;
-        } else {
-            if (verbose) tout << "[-] Content transfer failure. handle: 0x" << std::hex << contentHandle  << std::dec << std::endl << "    -> ";
-            if (verbose) tout << msg.data() << std::endl;
-        }
-    }
+    CameraEvent event;
+    event.type = CameraEvent::Type::contents_transfer;
+    event.code = notify;
+    event.handle = contentHandle;
+    if (filename) event.file = filename;
+    post_event(event);
 }
 
 void CameraDevice::OnWarning(CrInt32u warning)
 {
-    text id(this->get_id());
-    if (SDK::CrWarning_Connect_Reconnecting == warning) {
-        if (verbose) tout << "Device Disconnected. Reconnecting... " << m_info->GetModel() << " (" << id.data() << ")\n";
-        return;
-    }
-    switch (warning)
-    {
-    case SDK::CrWarning_ContentsTransferMode_Invalid:
-    case SDK::CrWarning_ContentsTransferMode_DeviceBusy:
-    case SDK::CrWarning_ContentsTransferMode_StatusError:
-        if (verbose) tout << "\nThe camera is in a condition where it cannot transfer content.\n\n";
-        if (verbose) tout << "Please input '0' to return to the TOP-MENU and connect again.\n";
-        break;
-    case SDK::CrWarning_ContentsTransferMode_CanceledFromCamera:
-        if (verbose) tout << "\nContent transfer mode canceled.\n";
-        if (verbose) tout << "If you want to continue content transfer, input '0' to return to the TOP-MENU and connect again.\n\n";
-        break;
-    default:
-        return;
-    }
+    CameraEvent event;
+    event.type = CameraEvent::Type::warning;
+    event.code = warning;
+    post_event(event);
 }
 
 void CameraDevice::OnPropertyChangedCodes(CrInt32u num, CrInt32u* codes)
 {
-    //if (verbose) tout << "Property changed.  num = " << std::dec << num;
-    //if (verbose) tout << std::hex;
-    //for (std::int32_t i = 0; i < num; ++i)
-    //{
-    //    if (verbose) tout << ", 0x" << codes[i];
-    //}
-    //if (verbose) tout << std::endl << std::dec;
-    load_properties(num, codes);
+    CameraEvent event;
+    event.type = CameraEvent::Type::properties_changed;
+    for (CrInt32u i = 0; i < num; i += CameraEvent::max_codes) {
+        event.count = std::min<CrInt32u>(num - i, CameraEvent::max_codes);
+        std::copy(codes + i, codes + i + event.count, event.codes);
+        post_event(event);
+    }
 }
 
 void CameraDevice::OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes)
@@ -1869,7 +1965,7 @@ void CameraDevice::OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes)
 #if 0 
     SDK::CrLiveViewProperty* lvProperty = nullptr;
     int32_t nprop = 0;
-    SDK::CrError err = SDK::GetSelectLiveViewProperties(m_device_handle, num, codes, &lvProperty, &nprop);
+    SDK::CrError err = m_cr_lib->GetSelectLiveViewProperties(m_device_handle, num, codes, &lvProperty, &nprop);
     if (CR_SUCCEEDED(err) && lvProperty) {
         for (int32_t i=0 ; i<nprop ; i++) {
             auto prop = lvProperty[i];
@@ -1913,7 +2009,7 @@ void CameraDevice::OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes)
                 }
             }
         }
-        SDK::ReleaseLiveViewProperties(m_device_handle, lvProperty);
+        m_cr_lib->ReleaseLiveViewProperties(m_device_handle, lvProperty);
     }
 #endif
     if (verbose) tout << std::dec;
@@ -1921,6 +2017,219 @@ void CameraDevice::OnLvPropertyChangedCodes(CrInt32u num, CrInt32u* codes)
 
 void CameraDevice::OnError(CrInt32u error)
 {
+    CameraEvent event;
+    event.type = CameraEvent::Type::error;
+    event.code = error;
+    post_event(event);
+}
+
+void CameraDevice::handle_event(CameraEvent& event)
+{
+    switch (event.type) {
+    case CameraEvent::Type::connected: handle_connected(event); break;
+    case CameraEvent::Type::disconnected: handle_disconnected(event); break;
+    case CameraEvent::Type::properties_changed: handle_properties_changed(event); break;
+    case CameraEvent::Type::download: handle_download(event); break;
+    case CameraEvent::Type::contents_transfer: handle_contents_transfer(event); break;
+    case CameraEvent::Type::warning: handle_warning(event); break;
+    case CameraEvent::Type::error: handle_error(event); break;
+    case CameraEvent::Type::fetch: handle_fetch(event); break;
+    }
+}
+
+void CameraDevice::handle_connected(const CameraEvent&)
+{
+    m_connected.store(true);
+    text id(this->get_id());
+    if (verbose) tout << "Connected to " << m_info->GetModel() << " (" << id.data() << ")\n";
+    // Seed the property store on the consumer of the property changes, so a change handled there is never
+    // overwritten by this fetch; from here on only changed codes are fetched
+    CameraEvent seed;
+    seed.type = CameraEvent::Type::fetch;
+    post_event(seed);
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        m_completions.check();
+    }
+    m_event_cv.notify_all();
+}
+
+void CameraDevice::handle_disconnected(const CameraEvent& event)
+{
+    m_connected.store(false);
+    {
+        std::lock_guard<std::mutex> lock(m_transfer_mtx);
+        for (auto& pull : m_pulls) pull.second.set_value(PulledContent{ text(), SDK::CrError_Connect_Disconnected });
+        m_pulls.clear();
+    }
+    text id(this->get_id());
+    if (verbose) tout << "Disconnected from " << m_info->GetModel() << " (" << id.data() << ")\n";
+    if (m_json.load()) {
+        JsonLine line("disconnected", m_json_id);
+        line.field("error", event.code);
+        write_json(line);
+    }
+    if ((false == m_spontaneous_disconnection) && (SDK::CrSdkControlMode_ContentsTransfer == m_modeSDK))
+    {
+        if (verbose) tout << "Please input '0' to return to the TOP-MENU\n";
+    }
+}
+
+void CameraDevice::handle_download(const CameraEvent& event)
+{
+    auto& file = event.file;
+    if (verbose) tout << "Download Complete (" << file.data() << ")\n";
+
+    DownloadSink sink;
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        ++m_download_count;
+        m_last_download = file;
+        m_last_download_time = event.reported;
+        sink = m_download_sink;
+        m_completions.check();
+    }
+    m_event_cv.notify_all();
+    if (m_json.load()) {
+        JsonLine line("download", m_json_id);
+        line.field("file", file);
+        write_json(line);
+    }
+    if (sink) sink(file, event.reported);
+}
+
+void CameraDevice::handle_contents_transfer(const CameraEvent& event)
+{
+    auto notify = event.code;
+    auto contentHandle = event.handle;
+    {
+        std::lock_guard<std::mutex> lock(m_transfer_mtx);
+        if (m_downloader) m_downloader->on_transfer(notify, contentHandle, event.file);
+        auto pull = std::find_if(m_pulls.begin(), m_pulls.end(),
+            [&](const std::pair<SDK::CrContentHandle, std::promise<PulledContent>>& pull) { return pull.first == contentHandle; });
+        if (SDK::CrNotify_ContentsTransfer_Start != notify && m_pulls.end() != pull) {
+            bool completed = (SDK::CrNotify_ContentsTransfer_Complete == notify);
+            pull->second.set_value(PulledContent{ completed ? event.file : text(), completed ? 0 : notify });
+            m_pulls.erase(pull);
+        }
+    }
+    if (m_json.load()) {
+        JsonLine line("contents_transfer", m_json_id);
+        line.field("notify", notify).field("handle", contentHandle);
+        if (SDK::CrNotify_ContentsTransfer_Complete == notify) line.field("file", event.file);
+        else if (SDK::CrNotify_ContentsTransfer_Start != notify) line.field("message", get_message_desc(notify));
+        write_json(line);
+    }
+
+    // Start
+    if (SDK::CrNotify_ContentsTransfer_Start == notify)
+    {
+        if (verbose) tout << "[START] Contents Handle: 0x " << std::hex << contentHandle << std::dec << std::endl;
+    }
+    // Complete
+    else if (SDK::CrNotify_ContentsTransfer_Complete == notify)
+    {
+        if (verbose) tout << "[COMPLETE] Contents Handle: 0x" << std::hex << contentHandle << std::dec << ", File: " << event.file.data() << std::endl;
+    }
+    // Other
+    else
+    {
+        text msg = get_message_desc(notify);
+        if (msg.empty()) {
+            if (verbose) tout << "[-] Content transfer failure. 0x" << std::hex << notify << ", handle: 0x" << contentHandle << std::dec << std::endl;
+        } else {
+            if (verbose) tout << "[-] Content transfer failure. handle: 0x" << std::hex << contentHandle  << std::dec << std::endl << "    -> ";
+            if (verbose) tout << msg.data() << std::endl;
+        }
+    }
+}
+
+void CameraDevice::handle_warning(const CameraEvent& event)
+{
+    auto warning = event.code;
+    if (SDK::CrNotify_Captured_Event == warning) {
+        {
+            std::lock_guard<std::mutex> lock(m_event_mtx);
+            ++m_capture_count;
+            m_last_capture_time = event.reported;
+            m_completions.check();
+        }
+        m_event_cv.notify_all();
+        if (m_json.load()) {
+            JsonLine line("captured", m_json_id);
+            write_json(line);
+        }
+        return;
+    }
+    if (m_json.load()) {
+        JsonLine line("warning", m_json_id);
+        line.field("code", warning).field("message", get_message_desc(warning));
+        write_json(line);
+    }
+
+    text id(this->get_id());
+    if (SDK::CrWarning_Connect_Reconnecting == warning) {
+        if (verbose) tout << "Device Disconnected. Reconnecting... " << m_info->GetModel() << " (" << id.data() << ")\n";
+        return;
+    }
+    switch (warning)
+    {
+    case SDK::CrWarning_ContentsTransferMode_Invalid:
+    case SDK::CrWarning_ContentsTransferMode_DeviceBusy:
+    case SDK::CrWarning_ContentsTransferMode_StatusError:
+        if (verbose) tout << "\nThe camera is in a condition where it cannot transfer content.\n\n";
+        if (verbose) tout << "Please input '0' to return to the TOP-MENU and connect again.\n";
+        break;
+    case SDK::CrWarning_ContentsTransferMode_CanceledFromCamera:
+        if (verbose) tout << "\nContent transfer mode canceled.\n";
+        if (verbose) tout << "If you want to continue content transfer, input '0' to return to the TOP-MENU and connect again.\n\n";
+        break;
+    default:
+        return;
+    }
+}
+
+void CameraDevice::handle_properties_changed(const CameraEvent& event)
+{
+    // A dropped change is not known by its codes any more, so every property is fetched instead
+    if (m_properties_lost.exchange(false)) load_properties();
+    else load_properties(event.count, const_cast<CrInt32u*>(event.codes));
+
+    if (m_json.load()) {
+        JsonLine line("properties_changed", m_json_id);
+        line.begin_array("properties");
+        {
+            std::lock_guard<std::mutex> lock(m_event_mtx);
+            for (CrInt32u i = 0; i < event.count; ++i) {
+                line.begin_object(nullptr).field("code", event.codes[i]);
+                auto* record = m_store.find(event.codes[i]);
+                if (record) line.field("value", record->current_as<CrInt64>());
+                line.end_object();
+            }
+        }
+        line.end_array();
+        write_json(line);
+    }
+}
+
+void CameraDevice::handle_error(const CameraEvent& event)
+{
+    auto error = event.code;
+    if (SDK::CrError_Connect == (error & 0xFF00)) {
+        // Ends wait_for_connection() right away instead of at its timeout
+        {
+            std::lock_guard<std::mutex> lock(m_event_mtx);
+            m_connect_error = error;
+            m_completions.check();
+        }
+        m_event_cv.notify_all();
+    }
+    if (m_json.load()) {
+        JsonLine line("error", m_json_id);
+        line.field("code", error).field("message", get_message_desc(error));
+        write_json(line);
+    }
+
     text id(this->get_id());
     text msg = get_message_desc(error);
     if (!msg.empty()) {
@@ -1940,23 +2249,27 @@ void CameraDevice::OnError(CrInt32u error)
     }
 }
 
+void CameraDevice::handle_fetch(const CameraEvent& event)
+{
+    load_properties(event.count, const_cast<CrInt32u*>(event.codes));
+    if (event.fetched) {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        *event.fetched = true;
+        m_completions.check();
+    }
+}
+
 void CameraDevice::load_properties(CrInt32u num, CrInt32u* codes)
 {
+    // Held from the request until the table is published: a fetch that started earlier never applies its older
+    // values after a later one
+    std::lock_guard<std::mutex> publish(m_publish_mtx);
     std::int32_t nprop = 0;
     SDK::CrDeviceProperty* prop_list = nullptr;
 
-    m_prop.media_slot1_quick_format_enable_status.writable = false;
-    m_prop.media_slot2_quick_format_enable_status.writable = false;
-
     SDK::CrError status = SDK::CrError_Generic;
-    if (0 == num){
-        // Get all
-        status = SDK::GetDeviceProperties(m_device_handle, &prop_list, &nprop);
-    }
-    else {
-        // Get difference
-        status = SDK::GetSelectDeviceProperties(m_device_handle, num, codes, &prop_list, &nprop);
-    }
+    // Get all when num is 0, otherwise get difference
+    status = fetch_properties(num, codes, &prop_list, &nprop);
 
     if (CR_FAILED(status)) {
         if (verbose) tout << "Failed to get device properties.\n";
@@ -1964,259 +2277,40 @@ void CameraDevice::load_properties(CrInt32u num, CrInt32u* codes)
     }
 
     if (prop_list && nprop > 0) {
-        // Got properties list
+        // Publish to the store first so that waiters can be woken up
+        {
+            std::lock_guard<std::mutex> lock(m_event_mtx);
+            auto before = m_store.generation();
+            m_store.update(prop_list, nprop, 0 == num);
+            // Subscribers see only values that changed; queuing them never waits for a handler
+            for (std::int32_t i = 0; i < nprop; ++i) {
+                auto* record = m_store.find(prop_list[i].GetCode());
+                if (record && before < record->generation) m_subscriptions.publish(prop_list[i].GetCode(), record->current);
+            }
+            m_completions.check();
+        }
+        m_event_cv.notify_all();
+
+        // Build the next table from the current one; readers keep the version they hold until it is published
+        auto next = std::make_shared<PropertyValueTable>(*m_props.load());
+        if (0 == num) {
+            // Only a full list tells that the quick format entries are absent
+            next->media_slot1_quick_format_enable_status.writable = false;
+            next->media_slot2_quick_format_enable_status.writable = false;
+        }
+
+        // The generated property table names the entry of each property the value table keeps
         for (std::int32_t i = 0; i < nprop; ++i) {
-            auto prop = prop_list[i];
-            int nval = 0;
-
-            switch (prop.GetCode()) {
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_SdkControlMode:
-                m_prop.sdk_mode.writable = prop.IsSetEnableCurrentValue();
-                m_prop.sdk_mode.current = static_cast<std::uint32_t>(prop.GetCurrentValue());
-                m_modeSDK = (SDK::CrSdkControlMode)m_prop.sdk_mode.current;
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_FNumber:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.f_number.writable = prop.IsSetEnableCurrentValue();
-                m_prop.f_number.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_f_number(prop.GetValues(), nval);
-                    m_prop.f_number.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_IsoSensitivity:
-                nval = prop.GetValueSize() / sizeof(std::uint32_t);
-                m_prop.iso_sensitivity.writable = prop.IsSetEnableCurrentValue();
-                m_prop.iso_sensitivity.current = static_cast<std::uint32_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_iso_sensitivity(prop.GetValues(), nval);
-                    m_prop.iso_sensitivity.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_ShutterSpeed:
-                nval = prop.GetValueSize() / sizeof(std::uint32_t);
-                m_prop.shutter_speed.writable = prop.IsSetEnableCurrentValue();
-                m_prop.shutter_speed.current = static_cast<std::uint32_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_shutter_speed(prop.GetValues(), nval);
-                    m_prop.shutter_speed.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_PriorityKeySettings:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.position_key_setting.writable = prop.IsSetEnableCurrentValue();
-                m_prop.position_key_setting.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (nval != m_prop.position_key_setting.possible.size()) {
-                    auto parsed_values = parse_position_key_setting(prop.GetValues(), nval);
-                    m_prop.position_key_setting.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_ExposureProgramMode:
-                nval = prop.GetValueSize() / sizeof(std::uint32_t);
-                m_prop.exposure_program_mode.writable = prop.IsSetEnableCurrentValue();
-                m_prop.exposure_program_mode.current = static_cast<std::uint32_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_exposure_program_mode(prop.GetValues(), nval);
-                    m_prop.exposure_program_mode.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_DriveMode:
-                nval = prop.GetValueSize() / sizeof(std::uint32_t);
-                m_prop.still_capture_mode.writable = prop.IsSetEnableCurrentValue();
-                m_prop.still_capture_mode.current = static_cast<std::uint32_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_still_capture_mode(prop.GetValues(), nval);
-                    m_prop.still_capture_mode.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.focus_mode.writable = prop.IsSetEnableCurrentValue();
-                m_prop.focus_mode.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_focus_mode(prop.GetValues(), nval);
-                    m_prop.focus_mode.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_FocusArea:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.focus_area.writable = prop.IsSetEnableCurrentValue();
-                m_prop.focus_area.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_focus_area(prop.GetValues(), nval);
-                    m_prop.focus_area.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_LiveView_Image_Quality:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.live_view_image_quality.writable = prop.IsSetEnableCurrentValue();
-                m_prop.live_view_image_quality.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto view = parse_live_view_image_quality(prop.GetValues(), nval);
-                    m_prop.live_view_image_quality.possible.swap(view);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_LiveViewStatus:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.live_view_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.live_view_status.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT1_FormatEnableStatus:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.media_slot1_full_format_enable_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.media_slot1_full_format_enable_status.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.media_slot1_full_format_enable_status.possible.size()) {
-                    auto parsed_values = parse_media_slotx_format_enable_status(prop.GetValues(), nval);
-                    m_prop.media_slot1_full_format_enable_status.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT2_FormatEnableStatus:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.media_slot2_full_format_enable_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.media_slot2_full_format_enable_status.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.media_slot2_full_format_enable_status.possible.size()) {
-                    auto parsed_values = parse_media_slotx_format_enable_status(prop.GetValues(), nval);
-                    m_prop.media_slot2_full_format_enable_status.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT1_QuickFormatEnableStatus:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.media_slot1_quick_format_enable_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.media_slot1_quick_format_enable_status.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.media_slot1_quick_format_enable_status.possible.size()) {
-                    auto parsed_values = parse_media_slotx_format_enable_status(prop.GetValues(), nval);
-                    m_prop.media_slot1_quick_format_enable_status.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_MediaSLOT2_QuickFormatEnableStatus:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.media_slot2_quick_format_enable_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.media_slot2_quick_format_enable_status.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.media_slot2_quick_format_enable_status.possible.size()) {
-                    auto parsed_values = parse_media_slotx_format_enable_status(prop.GetValues(), nval);
-                    m_prop.media_slot2_quick_format_enable_status.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_WhiteBalance:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.white_balance.writable = prop.IsSetEnableCurrentValue();
-                m_prop.white_balance.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_white_balance(prop.GetValues(), nval);
-                    m_prop.white_balance.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_CustomWB_Capture_Standby:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.customwb_capture_stanby.writable = prop.IsSetEnableCurrentValue();
-                m_prop.customwb_capture_stanby.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (nval != m_prop.white_balance.possible.size()) {
-                    auto parsed_values = parse_customwb_capture_stanby(prop.GetValues(), nval);
-                    m_prop.customwb_capture_stanby.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_CustomWB_Capture_Standby_Cancel:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.customwb_capture_stanby_cancel.writable = prop.IsSetEnableCurrentValue();
-                m_prop.customwb_capture_stanby_cancel.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (nval != m_prop.customwb_capture_stanby_cancel.possible.size()) {
-                    auto parsed_values = parse_customwb_capture_stanby_cancel(prop.GetValues(), nval);
-                    m_prop.customwb_capture_stanby_cancel.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_CustomWB_Capture_Operation:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.customwb_capture_operation.writable = prop.IsSetEnableCurrentValue();
-                m_prop.customwb_capture_operation.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_customwb_capture_operation(prop.GetValues(), nval);
-                    m_prop.customwb_capture_operation.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_CustomWB_Execution_State:
-                nval = prop.GetValueSize() / sizeof(std::uint16_t);
-                m_prop.customwb_capture_execution_state.writable = prop.IsSetEnableCurrentValue();
-                m_prop.customwb_capture_execution_state.current = static_cast<std::uint16_t>(prop.GetCurrentValue());
-                if (nval != m_prop.customwb_capture_execution_state.possible.size()) {
-                    auto parsed_values = parse_customwb_capture_execution_state(prop.GetValues(), nval);
-                    m_prop.customwb_capture_execution_state.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Operation_Status:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.zoom_operation_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.zoom_operation_status.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.zoom_operation_status.possible.size()) {
-                    auto parsed_values = parse_zoom_operation_status(prop.GetValues(), nval);
-                    m_prop.zoom_operation_status.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Setting:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.zoom_setting_type.writable = prop.IsSetEnableCurrentValue();
-                m_prop.zoom_setting_type.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_zoom_setting_type(prop.GetValues(), nval);
-                    m_prop.zoom_setting_type.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Type_Status:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.zoom_types_status.writable = prop.IsSetEnableCurrentValue();
-                m_prop.zoom_types_status.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.zoom_types_status.possible.size()) {
-                    auto parsed_values = parse_zoom_types_status(prop.GetValues(), nval);
-                    m_prop.zoom_types_status.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Operation:
-                nval = prop.GetValueSize() / sizeof(std::int8_t);
-                m_prop.zoom_operation.writable = prop.IsSetEnableCurrentValue();
-                m_prop.zoom_operation.current = static_cast<std::int8_t>(prop.GetCurrentValue());
-                if (nval != m_prop.zoom_operation.possible.size()) {
-                    auto parsed_values = parse_zoom_operation(prop.GetValues(), nval);
-                    m_prop.zoom_operation.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_Zoom_Speed_Range:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.zoom_speed_range.writable = prop.IsSetEnableCurrentValue();
-                if (0 < nval) {
-                    auto parsed_values = parse_zoom_speed_range(prop.GetValues(), nval);
-                    m_prop.zoom_speed_range.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_ZoomAndFocusPosition_Save:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.save_zoom_and_focus_position.writable = prop.IsSetEnableCurrentValue();
-                if (0 < nval) {
-                    auto parsed_values = parse_save_zoom_and_focus_position(prop.GetValues(), nval);
-                    m_prop.save_zoom_and_focus_position.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_ZoomAndFocusPosition_Load:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.load_zoom_and_focus_position.writable = prop.IsSetEnableCurrentValue();
-                if (0 < nval) {
-                    auto parsed_values = parse_load_zoom_and_focus_position(prop.GetValues(), nval);
-                    m_prop.load_zoom_and_focus_position.possible.swap(parsed_values);
-                }
-                break;
-            case SDK::CrDevicePropertyCode::CrDeviceProperty_Remocon_Zoom_Speed_Type:
-                nval = prop.GetValueSize() / sizeof(std::uint8_t);
-                m_prop.remocon_zoom_speed_type.writable = prop.IsSetEnableCurrentValue();
-                m_prop.remocon_zoom_speed_type.current = static_cast<std::uint8_t>(prop.GetCurrentValue());
-                if (0 < nval) {
-                    auto parsed_values = parse_remocon_zoom_speed_type(prop.GetValues(), nval);
-                    m_prop.remocon_zoom_speed_type.possible.swap(parsed_values);
-                }
-                break;
-
-            default:
-                break;
+            auto& prop = prop_list[i];
+            auto* info = find_property(prop.GetCode());
+            if (nullptr == info || nullptr == info->load) continue;
+            info->load(*next, prop);
+            if (SDK::CrDevicePropertyCode::CrDeviceProperty_SdkControlMode == prop.GetCode()) {
+                m_modeSDK = (SDK::CrSdkControlMode)next->sdk_mode.current;
             }
         }
-        SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
+        m_props.publish(std::move(next));
+        m_cr_lib->ReleaseDeviceProperties(m_device_handle, prop_list);
     }
 }
 
@@ -2224,37 +2318,55 @@ void CameraDevice::get_property(SDK::CrDeviceProperty& prop) const
 {
     SDK::CrDeviceProperty* properties = nullptr;
     int nprops = 0;
-    // m_cr_lib->GetDeviceProperties(m_device_handle, &properties, &nprops);
-    SDK::GetDeviceProperties(m_device_handle, &properties, &nprops);
+    m_cr_lib->GetDeviceProperties(m_device_handle, &properties, &nprops);
+}
+
+SDK::CrError CameraDevice::fetch_properties(CrInt32u num, CrInt32u* codes, SDK::CrDeviceProperty** props, std::int32_t* nprop)
+{
+    if (0 == num) {
+        ++m_full_fetches;
+        return m_cr_lib->GetDeviceProperties(m_device_handle, props, nprop);
+    }
+    ++m_select_fetches;
+    return m_cr_lib->GetSelectDeviceProperties(m_device_handle, num, codes, props, nprop);
+}
+
+PropertyFetchStats CameraDevice::get_fetch_stats() const
+{
+    return PropertyFetchStats{ m_full_fetches.load(), m_select_fetches.load() };
+}
+
+void CameraDevice::reset_fetch_stats()
+{
+    m_full_fetches = 0;
+    m_select_fetches = 0;
 }
 
 bool CameraDevice::set_property(SDK::CrDeviceProperty& prop) const
 {
-    // m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
-    SDK::SetDeviceProperty(m_device_handle, &prop);
+    m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     return false;
 }
 
-void CameraDevice::getContentsList()
+bool CameraDevice::contents_transfer_enabled()
 {
-    // check status
     std::int32_t nprop = 0;
     SDK::CrDeviceProperty* prop_list = nullptr;
     CrInt32u getCode = SDK::CrDevicePropertyCode::CrDeviceProperty_ContentsTransferStatus;
-    SDK::CrError res = SDK::GetSelectDeviceProperties(m_device_handle, 1, &getCode, &prop_list, &nprop);
+    SDK::CrError res = fetch_properties(1, &getCode, &prop_list, &nprop);
     bool bExec = false;
     if (CR_SUCCEEDED(res) && (1 == nprop)) {
         if ((getCode == prop_list[0].GetCode()) && (SDK::CrContentsTransfer_ON == prop_list[0].GetCurrentValue()))
         {
             bExec = true;
         }
-        SDK::ReleaseDeviceProperties(m_device_handle, prop_list);
-    }
-    if (false == bExec) {
-        if (verbose) tout << "GetContentsListEnableStatus is Disable. Do it after it becomes Enable.\n";
-        return;
+        m_cr_lib->ReleaseDeviceProperties(m_device_handle, prop_list);
     }
+    return bExec;
+}
 
+void CameraDevice::clear_contents_list()
+{
     for (CRFolderInfos* pF : m_foldList)
     {
         delete pF;
@@ -2265,87 +2377,170 @@ void CameraDevice::getContentsList()
         delete pC;
     }
     m_contentList.clear();
+}
 
-    CrInt32u f_nums = 0;
-    CrInt32u c_nums = 0;
-    SDK::CrMtpFolderInfo* f_list = nullptr;
-    SDK::CrError err = SDK::GetDateFolderList(m_device_handle, &f_list, &f_nums);
-    if (CR_SUCCEEDED(err) && 0 < f_nums)
-    {
-        if (f_list)
-        {
-            if (verbose) tout << "NumOfFolder [" << f_nums << "]" << std::endl;
-
-            for (int i = 0; i < f_nums; ++i)
-            {
-                auto pFold = new SDK::CrMtpFolderInfo();
-                pFold->handle = f_list[i].handle;
-                pFold->folderNameSize = f_list[i].folderNameSize;
-                CrInt32u lenByOS = sizeof(CrChar) * pFold->folderNameSize;
-                pFold->folderName = new CrChar[lenByOS];
-                memcpy(pFold->folderName, f_list[i].folderName, lenByOS);
-                CRFolderInfos* pCRF = new CRFolderInfos(pFold, 0); // 2nd : fill in later
-                m_foldList.push_back(pCRF);
-            }
-            SDK::ReleaseDateFolderList(m_device_handle, f_list);
-        }
+bool CameraDevice::index_contents(std::size_t workers, ContentsIndexer::EntrySink sink, ContentsIndexStats& stats,
+    ContentsIndexer::FolderFilter folder_filter, ContentsIndexer::FolderSink folder_sink)
+{
+    stats = ContentsIndexStats{};
+    if (!contents_transfer_enabled()) {
+        if (verbose) tout << "GetContentsListEnableStatus is Disable. Do it after it becomes Enable.\n";
+        return false;
+    }
 
-        if (0 == m_foldList.size())
+    clear_contents_list();
+
+    // Folders that did not change since the last listing are taken from the index file
+    std::string index_path = contents_index_path();
+    std::unique_ptr<ContentsIndexFile> index;
+    if (!index_path.empty() && m_reuse_index) {
+        index = ContentsIndexFile::open(index_path);
+        if (index && index->camera_id() != get_id()) index.reset();
+        if (verbose) tout << (index ? "Using contents index " : "No contents index at ") << text(index_path.begin(), index_path.end()) << std::endl;
+    }
+
+    ContentsIndexer indexer(m_cr_lib, m_device_handle, workers);
+    indexer.set_index(index.get());
+    indexer.set_folder_filter(folder_filter);
+    indexer.set_folder_sink([&](const SDK::CrMtpFolderInfo& folder, CrInt32u contents) {
+        auto pFold = new SDK::CrMtpFolderInfo();
+        pFold->handle = folder.handle;
+        pFold->folderNameSize = folder.folderNameSize;
+        CrInt32u lenByOS = sizeof(CrChar) * pFold->folderNameSize;
+        pFold->folderName = new CrChar[lenByOS];
+        memcpy(pFold->folderName, folder.folderName, lenByOS);
+        m_foldList.push_back(new CRFolderInfos(pFold, contents));
+        if (verbose) tout << "(" << m_foldList.size() << ") NumOfContents [" << contents << "]" << std::endl;
+        if (folder_sink) folder_sink(folder, contents);
+    });
+    indexer.set_entry_sink([&](const SDK::CrMtpContentsInfo& info) {
+        m_contentList.push_back(new SDK::CrMtpContentsInfo(info));
+        if (sink) sink(info);
+        // progress
+        if (0 == (m_contentList.size() % 100))
         {
-            return;
+            if (verbose) tout << "  ... " << m_contentList.size() << std::endl;
         }
-
-        MtpFolderList::iterator it = m_foldList.begin();
-        for (int fcnt = 0; it != m_foldList.end(); ++fcnt, ++it)
-        {
-            SDK::CrContentHandle* c_list = nullptr;
-            err = SDK::GetContentsHandleList(m_device_handle, (*it)->pFolder->handle, &c_list, &c_nums);
-            if (CR_SUCCEEDED(err) && 0 < c_nums)
-            {
-                if (c_list)
-                {
-                    if (verbose) tout << "(" << (fcnt + 1) << "/" << f_nums << ") NumOfContents [" << c_nums << "]" << std::endl;
-                    (*it)->numOfContents = c_nums;
-                    for (int i = 0; i < c_nums; i++)
-                    {
-                        SDK::CrMtpContentsInfo* pConntents = new SDK::CrMtpContentsInfo();
-                        err = SDK::GetContentsDetailInfo(m_device_handle, c_list[i], pConntents);
-                        if (CR_SUCCEEDED(err))
-                        {
-                            m_contentList.push_back(pConntents);
-                            // progress
-                            if (0 == ((i + 1) % 100))
-                            {
-                                if (verbose) tout << "  ... " << (i + 1) << "/" << c_nums << std::endl;
-                            }
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-                    SDK::ReleaseContentsHandleList(m_device_handle, c_list);
-                }
-            }
-            if (CR_FAILED(err))
-            {
-                break;
-            }
+    });
+    indexer.start();
+    bool indexed = indexer.wait();
+    stats = indexer.stats();
+
+    // Entries arrive in completion order; keep the list in folder order for the menu
+    std::unordered_map<SDK::CrFolderHandle, std::size_t> folder_order;
+    for (std::size_t i = 0; i < m_foldList.size(); ++i) {
+        folder_order[m_foldList[i]->pFolder->handle] = i;
+    }
+    std::stable_sort(m_contentList.begin(), m_contentList.end(), [&](SDK::CrMtpContentsInfo* a, SDK::CrMtpContentsInfo* b) {
+        auto fa = folder_order[a->parentFolderHandle];
+        auto fb = folder_order[b->parentFolderHandle];
+        return fa != fb ? fa < fb : a->handle < b->handle;
+    });
+
+    // The old mapping has to go before the file is replaced
+    index.reset();
+    // A filtered listing would drop the other folders from the index
+    if (indexed && !index_path.empty() && !folder_filter) {
+        ContentsIndexWriter writer;
+        for (CRFolderInfos* pF : m_foldList) writer.add_folder(*pF->pFolder);
+        for (SDK::CrMtpContentsInfo* pC : m_contentList) writer.add_entry(*pC);
+        if (!writer.save(index_path, get_id()) && verbose) {
+            tout << "Failed to write contents index " << text(index_path.begin(), index_path.end()) << std::endl;
         }
     }
-    else if (CR_SUCCEEDED(err) && 0 == f_nums)
-    {
+
+    if (!indexed) {
+        if (verbose) tout << "Failed SDK::GetContentsList()" << std::endl;
+    }
+    else if (0 == m_foldList.size()) {
         if (verbose) tout << "No images in memory card." << std::endl;
-        return;
     }
-    else
+    return indexed;
+}
+
+bool CameraDevice::download_contents(std::size_t workers, std::size_t in_flight, const text& dir, const ContentsFilter& filter,
+    ContentsDownloader::ResultSink sink, ContentsIndexStats& index_stats, ContentsDownloadStats& download_stats,
+    ContentsTarget target)
+{
+    ContentsDownloader downloader(m_cr_lib, m_device_handle, in_flight, dir);
+    downloader.set_result_sink(std::move(sink));
     {
-        // err
-        if (verbose) tout << "Failed SDK::GetContentsList()" << std::endl;
+        std::lock_guard<std::mutex> lock(m_transfer_mtx);
+        m_downloader = &downloader;
+    }
+    downloader.start();
+
+    ContentsIndexer::FolderFilter folder_filter;
+    if (!filter.folder.empty()) {
+        folder_filter = [&](const SDK::CrMtpFolderInfo& folder) { return filter.matches_folder(folder); };
+    }
+    // The target is told the folder of each file. Folder and entry sinks are serialized, folders first.
+    std::unordered_map<SDK::CrFolderHandle, text> folders;
+    bool indexed = index_contents(workers, [&](const SDK::CrMtpContentsInfo& info) {
+        if (!filter.matches(info)) return;
+        if (!target) {
+            downloader.enqueue(info);
+            return;
+        }
+        auto folder = folders.find(info.parentFolderHandle);
+        text file_dir = dir;
+        text file_name;
+        if (target(info, folders.end() != folder ? folder->second : text(), file_dir, file_name)) {
+            downloader.enqueue(info, file_dir, file_name);
+        }
+    }, index_stats, folder_filter, [&](const SDK::CrMtpFolderInfo& folder, CrInt32u) {
+        folders[folder.handle] = folder.folderName ? text(folder.folderName) : text();
+    });
+
+    downloader.close();
+    downloader.wait();
+    {
+        std::lock_guard<std::mutex> lock(m_transfer_mtx);
+        m_downloader = nullptr;
+    }
+    download_stats = downloader.stats();
+    return indexed && 0 == download_stats.failed;
+}
+
+bool CameraDevice::sync_contents(std::size_t workers, std::size_t in_flight, SyncJournal& journal, const text& dir,
+    const ContentsFilter& filter, ContentsDownloader::ResultSink sink, ContentsIndexStats& index_stats,
+    ContentsDownloadStats& download_stats)
+{
+    bool journaled = true;
+    bool synced = download_contents(workers, in_flight, dir, filter, [&](SDK::CrContentHandle handle, const text& file, CrInt32u error) {
+        // Journaled before it is reported, so an interruption right after cannot lose it
+        text saved = file;
+        if (0 == error && !journal.complete(handle, saved)) {
+            error = SDK::CrError_Generic_Unknown;
+            journaled = false;
+        }
+        if (sink) sink(handle, saved, error);
+    }, index_stats, download_stats, [&](const SDK::CrMtpContentsInfo& info, const text& folder, text& target_dir, text& file_name) {
+        return journal.needs_sync(info, folder, target_dir, file_name);
+    });
+    journal.compact();
+    return synced && journaled;
+}
+
+std::string CameraDevice::contents_index_path()
+{
+    if (m_index_dir.empty()) return std::string();
+    // MAC addresses and serial numbers may contain characters that are not allowed in file names
+    std::string name;
+    for (auto c : get_id()) {
+        bool plain = (TEXT('0') <= c && c <= TEXT('9')) || (TEXT('A') <= c && c <= TEXT('Z')) || (TEXT('a') <= c && c <= TEXT('z'));
+        name += plain ? static_cast<char>(c) : '_';
+    }
+    return (fs::path(m_index_dir) / (name + ".crindex")).string();
+}
+
+void CameraDevice::getContentsList()
+{
+    ContentsIndexStats stats;
+    if (!index_contents(CONTENTS_INDEX_WORKERS, nullptr, stats) || 0 == m_foldList.size()) {
         return;
     }
 
-    if (CR_SUCCEEDED(err))
     {
         MtpFolderList::iterator itF = m_foldList.begin();
         for (std::int32_t f_sep = 0; itF != m_foldList.end(); ++f_sep, ++itF)
@@ -2450,7 +2645,7 @@ void CameraDevice::getContentsList()
 
 void CameraDevice::pullContents(SDK::CrContentHandle content)
 {
-    SDK::CrError err = SDK::PullContentsFile(m_device_handle, content);
+    SDK::CrError err = m_cr_lib->PullContentsFile(m_device_handle, content, SDK::CrPropertyStillImageTransSize_Original, nullptr, nullptr);
 
     if (SDK::CrError_None != err)
     {
@@ -2467,7 +2662,7 @@ void CameraDevice::pullContents(SDK::CrContentHandle content)
 
 void CameraDevice::getScreennail(SDK::CrContentHandle content)
 {
-    SDK::CrError err = SDK::PullContentsFile(m_device_handle, content, SDK::CrPropertyStillImageTransSize_SmallSizeJPEG);
+    SDK::CrError err = m_cr_lib->PullContentsFile(m_device_handle, content, SDK::CrPropertyStillImageTransSize_SmallSizeJPEG, nullptr, nullptr);
 
     if (SDK::CrError_None != err)
     {
@@ -2502,7 +2697,7 @@ void CameraDevice::getThumbnail(SDK::CrContentHandle content)
     image_data->SetSize(bufSize);
     image_data->SetData(image_buff);
 
-    SDK::CrError err = SDK::GetContentsThumbnailImage(m_device_handle, content, image_data);
+    SDK::CrError err = m_cr_lib->GetContentsThumbnailImage(m_device_handle, content, image_data);
     if (CR_FAILED(err))
     {
         //printf("[Error] err=0x%04X, handle(0x%08X)\n", err, content);
@@ -2542,79 +2737,301 @@ void CameraDevice::getThumbnail(SDK::CrContentHandle content)
     delete image_data; // Release
 }
 
-bool CameraDevice::wait_for_prop_value(CrInt32u prop, CrInt16u value)
+bool CameraDevice::get_property_value(CrInt32u prop_code, CrInt64& value)
 {
-    CrInt32u codes[] = {
-        prop
-    };
+    // Values are kept current by OnPropertyChangedCodes, so the camera is only asked
+    // for codes that were missing from the list fetched at connection
+    ensure_properties();
+    if (!cached_property_value(prop_code, value)) {
+        load_properties(1, &prop_code);
+        if (!cached_property_value(prop_code, value)) {
+            if (verbose) tout << "Get device property FAILED\n";
+            return false;
+        }
+    }
+    if (verbose) tout << "Get device property SUCCESS\n";
+    return true;
+}
 
-    for (int i = 0; i < 20; i++) {
-        SDK::CrDeviceProperty* pProps;
-        CrInt32 numofProps = 0;
+std::vector<PropertyValue> CameraDevice::get_property_values(const std::vector<CrInt32u>& codes)
+{
+    ensure_properties();
+    std::vector<CrInt32u> missing;
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        for (auto code : codes) {
+            if (nullptr == m_store.find(code)) missing.push_back(code);
+        }
+    }
+    // Codes left out of the list fetched at connection are read in a single request
+    if (!missing.empty()) load_properties(static_cast<CrInt32u>(missing.size()), missing.data());
 
-        SDK::GetSelectDeviceProperties(m_device_handle, 1, codes, &pProps, &numofProps);
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return stored_values(codes);
+}
 
-        if (pProps->GetCurrentValue() == value) {
-            tout << "Waited " << i * 100 << "ms\n";
-            return true;
-        }
-        std::this_thread::sleep_for(100ms);
+std::vector<PropertyValue> CameraDevice::stored_values(const std::vector<CrInt32u>& codes)
+{
+    std::vector<PropertyValue> values;
+    for (auto code : codes.empty() ? m_store.codes() : codes) {
+        auto* record = m_store.find(code);
+        if (nullptr != record) values.push_back({ code, record->current_as<CrInt64>() });
     }
-    return false;
+    return values;
 }
 
-bool CameraDevice::get_property_value(CrInt32u prop_code, CrInt64& value)
+std::future<bool> CameraDevice::when(std::function<bool()> reached, std::chrono::milliseconds timeout)
 {
-    CrInt32u codes[] = {
-        prop_code
-    };
-    SDK::CrDeviceProperty* pProps;
-    CrInt32 numofProps = 0;
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto future = promise->get_future();
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    m_completions.add([promise, reached] {
+        if (!reached()) return false;
+        promise->set_value(true);
+        return true;
+    }, [promise] { promise->set_value(false); }, timeout);
+    return future;
+}
 
-    std::this_thread::sleep_for(GET_PROP_TIME);
-    auto error = SDK::GetSelectDeviceProperties(m_device_handle, 1, codes, &pProps, &numofProps);
+std::future<bool> CameraDevice::connect_async(SCRSDK::CrSdkControlMode openMode, std::chrono::milliseconds timeout)
+{
+    if (!connect(openMode)) return impl::ready_future(false);
 
-    if (is_error(error, TEXT("Get device property"))) {
-        SDK::ReleaseDeviceProperties(m_device_handle, pProps);
-        return false;
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto future = promise->get_future();
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    m_completions.add([this, promise] {
+        bool connected = m_connected && m_store.seeded();
+        if (!connected && 0 == m_connect_error) return false;
+        promise->set_value(connected);
+        return true;
+    }, [promise] { promise->set_value(false); }, timeout);
+    return future;
+}
+
+std::future<std::vector<PropertyValue>> CameraDevice::get_property_values_async(std::vector<CrInt32u> codes)
+{
+    CameraEvent event;
+    event.type = CameraEvent::Type::fetch;
+    std::vector<CrInt32u> missing;
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        if (m_store.seeded()) {
+            for (auto code : codes) {
+                if (nullptr == m_store.find(code)) missing.push_back(code);
+            }
+            if (missing.empty()) return impl::ready_future(stored_values(codes));
+        }
     }
-    SDK::ReleaseDeviceProperties(m_device_handle, pProps);
 
-    value = pProps->GetCurrentValue();
-    return true;
+    // Without the values of the connection every property is fetched, as an event without codes
+    auto promise = std::make_shared<std::promise<std::vector<PropertyValue>>>();
+    auto future = promise->get_future();
+    auto fetched = std::make_shared<bool>(false);
+    std::size_t i = 0;
+    do {
+        event.count = static_cast<CrInt32u>(std::min<std::size_t>(missing.size() - i, CameraEvent::max_codes));
+        std::copy(missing.begin() + i, missing.begin() + i + event.count, event.codes);
+        i += event.count;
+        // Parts are handled in order, so the last one tells that all were loaded
+        if (missing.size() == i) event.fetched = fetched;
+        post_event(event);
+    } while (i < missing.size());
+
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    m_completions.add([this, promise, fetched, codes] {
+        if (!*fetched) return false;
+        promise->set_value(stored_values(codes));
+        return true;
+    }, [this, promise, codes] {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        promise->set_value(stored_values(codes));
+    }, GET_PROP_TIMEOUT);
+    return future;
 }
 
-bool CameraDevice::set_property_value(CrInt32u prop_code, CrInt64 value)
+std::future<bool> CameraDevice::set_property_value_async(CrInt32u prop_code, CrInt64 value)
 {
     SDK::CrDeviceProperty prop;
     prop.SetCode(prop_code);
+    prop.SetValueType(set_value_type(prop_code));
+    prop.SetCurrentValue(value);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
+    if (is_error(error, TEXT("Unable to set property value"))) return impl::ready_future(false);
 
-    switch (prop_code) {
-    case SCRSDK::CrDevicePropertyCode::CrDeviceProperty_ExposureProgramMode:
-        prop.SetValueType(SCRSDK::CrDataType::CrDataType_UInt32);
-        break;
-    case SCRSDK::CrDevicePropertyCode::CrDeviceProperty_ExposureBiasCompensation:
-        prop.SetValueType(SCRSDK::CrDataType::CrDataType_UInt16);
-        break;
-    case SCRSDK::CrDevicePropertyCode::CrDeviceProperty_FNumber:
-        prop.SetValueType(SCRSDK::CrDataType::CrDataType_UInt16);
-        break;
-    default:
-        prop.SetValueType(SCRSDK::CrDataType::CrDataType_Int16);
+    auto type = prop.GetValueType();
+    return when([this, prop_code, value, type] {
+        auto* record = m_store.find(prop_code);
+        return (nullptr != record) && impl::same_value(record->current, value, type);
+    }, SET_PROP_TIMEOUT);
+}
+
+std::future<bool> CameraDevice::capture_async()
+{
+    std::uint32_t before = get_capture_count();
+    if (!release_down()) return impl::ready_future(false);
+    std::this_thread::sleep_for(RELEASE_HOLD_TIME);
+    if (!release_up()) return impl::ready_future(false);
+    return when([this, before] { return before < m_capture_count; }, CAPTURE_TIMEOUT);
+}
+
+std::future<LiveViewFrame> CameraDevice::next_live_view_frame_async(std::uint64_t sequence)
+{
+    if (!m_live_view) return impl::ready_future(LiveViewFrame());
+    return m_live_view->next(sequence);
+}
+
+std::future<PulledContent> CameraDevice::pull_contents_async(SDK::CrContentHandle content)
+{
+    // Registered first, as the notification may arrive before PullContentsFile returns
+    std::future<PulledContent> future;
+    {
+        std::lock_guard<std::mutex> lock(m_transfer_mtx);
+        m_pulls.emplace_back(content, std::promise<PulledContent>());
+        future = m_pulls.back().second.get_future();
+    }
+    auto err = m_cr_lib->PullContentsFile(m_device_handle, content, SDK::CrPropertyStillImageTransSize_Original, nullptr, nullptr);
+    if (CR_FAILED(err)) {
+        std::lock_guard<std::mutex> lock(m_transfer_mtx);
+        for (auto it = m_pulls.begin(); it != m_pulls.end(); ++it) {
+            if (it->first == content) {
+                it->second.set_value(PulledContent{ text(), static_cast<CrInt32u>(err) });
+                m_pulls.erase(it);
+                break;
+            }
+        }
+    }
+    return future;
+}
+
+std::uint64_t CameraDevice::subscribe_properties(std::vector<CrInt32u> codes, PropertyPredicate predicate, PropertyHandler handler,
+    std::chrono::milliseconds timeout, bool once)
+{
+    // Changes are only reported against the values loaded at connection
+    ensure_properties();
+    return m_subscriptions.subscribe(std::move(codes), std::move(predicate), std::move(handler), timeout, once);
+}
+
+std::future<PropertyChange> CameraDevice::next_property_change(std::vector<CrInt32u> codes, PropertyPredicate predicate, std::chrono::milliseconds timeout)
+{
+    ensure_properties();
+    return m_subscriptions.next(std::move(codes), std::move(predicate), timeout);
+}
+
+bool CameraDevice::get_possible_values(CrInt32u prop_code, std::vector<CrInt64>& values, bool& range)
+{
+    ensure_properties();
+    values.clear();
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    auto* record = m_store.find(prop_code);
+    if (nullptr == record) return false;
+    bool known = visit_values(record->type, record->values.data(), record->values.size(), [&](auto view) {
+        range = view.range();
+        values.assign(view.begin(), view.end());
+    });
+    return known && !values.empty();
+}
+
+bool CameraDevice::set_property_values(const std::vector<PropertyValue>& values, std::vector<CrInt32u>& unconfirmed)
+{
+    ensure_properties();
+    std::vector<SDK::CrDataType> types;
+    for (auto& value : values) types.push_back(set_value_type(value.code));
+    std::vector<bool> sent(values.size(), false);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        SDK::CrDeviceProperty prop;
+        prop.SetCode(values[i].code);
+        prop.SetValueType(types[i]);
+        prop.SetCurrentValue(values[i].value);
+        sent[i] = !is_error(m_cr_lib->SetDeviceProperty(m_device_handle, &prop), TEXT("Unable to set property value"));
+    }
+
+    // The camera works through the requests in parallel with this wait, so it costs one timeout at most
+    auto confirmed = [&](std::size_t i) {
+        auto* record = m_store.find(values[i].code);
+        return (nullptr != record) && impl::same_value(record->current, values[i].value, types[i]);
+    };
+    std::unique_lock<std::mutex> lock(m_event_mtx);
+    m_event_cv.wait_for(lock, SET_PROP_TIMEOUT, [&] {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (sent[i] && !confirmed(i)) return false;
+        }
+        return true;
+    });
+    unconfirmed.clear();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (!sent[i] || !confirmed(i)) unconfirmed.push_back(values[i].code);
+    }
+    if (verbose && !unconfirmed.empty()) tout << "Camera did not confirm " << unconfirmed.size() << " new values in time\n";
+    return unconfirmed.empty();
+}
+
+bool CameraDevice::cached_property_value(CrInt32u prop_code, CrInt64& value)
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    auto* record = m_store.find(prop_code);
+    if (nullptr == record) return false;
+    value = record->current_as<CrInt64>();
+    return true;
+}
+
+void CameraDevice::ensure_properties()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        if (m_store.seeded()) return;
     }
+    load_properties();
+}
 
+std::uint64_t CameraDevice::get_property_generation()
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_store.generation();
+}
+
+bool CameraDevice::wait_for_set(CrInt32u prop_code, CrInt64 value, SDK::CrDataType type)
+{
+    bool confirmed = wait_for_property(prop_code, [=](CrInt64u reported) { return impl::same_value(reported, value, type); }, SET_PROP_TIMEOUT);
+    if (!confirmed) {
+        if (verbose) tout << "Camera did not confirm the new value in time\n";
+    }
+    return confirmed;
+}
+
+SDK::CrDataType CameraDevice::set_value_type(CrInt32u prop_code)
+{
+    // The type the camera reported wins; the generated table covers properties not reported yet
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        auto* record = m_store.find(prop_code);
+        if (nullptr != record && SDK::CrDataType::CrDataType_Undefined != record->type) {
+            return static_cast<SDK::CrDataType>(record->type & ~(SDK::CrDataType::CrDataType_ArrayBit | SDK::CrDataType::CrDataType_RangeBit));
+        }
+    }
+    auto* info = find_property(prop_code);
+    if (nullptr != info && SDK::CrDataType::CrDataType_Undefined != info->type) return info->type;
+    return SDK::CrDataType::CrDataType_Int16;
+}
+
+bool CameraDevice::set_property_value(CrInt32u prop_code, CrInt64 value)
+{
+    SDK::CrDeviceProperty prop;
+    prop.SetCode(prop_code);
+    prop.SetValueType(set_value_type(prop_code));
     prop.SetCurrentValue(value);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
-    // wait for queue to empty
-    std::this_thread::sleep_for(SET_PROP_TIME);
-    return !is_error(error, TEXT("Unable to set property value"));
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
+    if (is_error(error, TEXT("Unable to set property value"))) {
+        return false;
+    }
+    return wait_for_set(prop_code, value, prop.GetValueType());
 }
 
 bool CameraDevice::set_save_path(const text& path, const text& prefix, int startNo) const
 {
     if (verbose) if (verbose) tout << "Save dir: " << path.data() << '\n';
 
-    auto save_status = SDK::SetSaveInfo(m_device_handle
+    auto save_status = m_cr_lib->SetSaveInfo(m_device_handle
         , const_cast<text_char*>(path.data()), const_cast<text_char*>(prefix.data()), startNo);
 
     if (CR_FAILED(save_status)) {
@@ -2629,8 +3046,12 @@ bool CameraDevice::set_focusmode_manual()
     SDK::CrDeviceProperty prop;
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode);
     prop.SetCurrentValue(SDK::CrFocusMode::CrFocus_MF);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
-    return !is_error(error, TEXT("Manual focus mode"));
+    prop.SetValueType(SDK::CrDataType::CrDataType_UInt16);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
+    if (is_error(error, TEXT("Manual focus mode"))) {
+        return false;
+    }
+    return wait_for_set(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode, SDK::CrFocusMode::CrFocus_MF, SDK::CrDataType::CrDataType_UInt16);
 }
 
 bool CameraDevice::set_focusmode_afs()
@@ -2638,7 +3059,7 @@ bool CameraDevice::set_focusmode_afs()
     SDK::CrDeviceProperty prop;
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode);
     prop.SetCurrentValue(SDK::CrFocusMode::CrFocus_AF_S);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     return !is_error(error, TEXT("AF-S focus mode"));
 }
 
@@ -2647,7 +3068,7 @@ bool CameraDevice::set_pcremote_priority()
     SDK::CrDeviceProperty prop;
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_PriorityKeySettings);
     prop.SetCurrentValue(SDK::CrPriorityKeySettings::CrPriorityKey_PCRemote);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     return !is_error(error, TEXT("PC remote priority"));
 }
 
@@ -2656,7 +3077,7 @@ bool CameraDevice::set_manual_exposure()
     SDK::CrDeviceProperty prop;
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_ExposureProgramMode);
     prop.SetCurrentValue(SDK::CrExposureProgram::CrExposure_M_Manual);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     return !is_error(error, TEXT("Manual exposure setting"));
 }
 
@@ -2666,9 +3087,55 @@ bool CameraDevice::set_exposure_bias_comp(CrInt16 value)
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_ExposureBiasCompensation);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16);
     prop.SetCurrentValue(value);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
-    std::this_thread::sleep_for(SET_PROP_TIME);
-    return !is_error(error, TEXT("Exposure bias compensation"));
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
+    if (is_error(error, TEXT("Exposure bias compensation"))) {
+        return false;
+    }
+    return wait_for_set(SDK::CrDevicePropertyCode::CrDeviceProperty_ExposureBiasCompensation, value, SDK::CrDataType::CrDataType_UInt16);
+}
+
+bool CameraDevice::set_shutter_speed(CrInt32u value)
+{
+    SDK::CrDeviceProperty prop;
+    prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_ShutterSpeed);
+    prop.SetValueType(SDK::CrDataType::CrDataType_UInt32);
+    prop.SetCurrentValue(value);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
+    if (is_error(error, TEXT("Shutter speed"))) {
+        return false;
+    }
+    return wait_for_set(SDK::CrDevicePropertyCode::CrDeviceProperty_ShutterSpeed, value, SDK::CrDataType::CrDataType_UInt32);
+}
+
+bool CameraDevice::step_focus(CrInt16 step)
+{
+    return step_focus_async(step).get();
+}
+
+std::future<bool> CameraDevice::step_focus_async(CrInt16 step)
+{
+    std::uint64_t since = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        since = m_store.updates();
+    }
+
+    SDK::CrDeviceProperty prop;
+    prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_NearFar);
+    prop.SetValueType(SDK::CrDataType::CrDataType_Int16);
+    prop.SetCurrentValue(static_cast<CrInt64u>(step));
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
+    if (is_error(error, TEXT("Focus step"))) {
+        return impl::ready_future(false);
+    }
+
+    // There is no focus position to watch. The camera disables NearFar while the lens moves,
+    // so a report of it enabled after the request means the move has ended, even when the report
+    // came too late to see it disabled.
+    return when([this, since] {
+        auto* record = m_store.find(SDK::CrDevicePropertyCode::CrDeviceProperty_NearFar);
+        return (nullptr != record) && since < record->reported && SDK::CrNearFar_Enable == record->current;
+    }, NEAR_FAR_TIMEOUT);
 }
 
 bool CameraDevice::half_press_down()
@@ -2677,7 +3144,7 @@ bool CameraDevice::half_press_down()
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_S1);
     prop.SetCurrentValue(SDK::CrLockIndicator::CrLockIndicator_Locked);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     return !is_error(error, TEXT("Half press down"));
 }
 
@@ -2687,38 +3154,180 @@ bool CameraDevice::half_press_up()
     prop.SetCode(SDK::CrDevicePropertyCode::CrDeviceProperty_S1);
     prop.SetCurrentValue(SDK::CrLockIndicator::CrLockIndicator_Unlocked);
     prop.SetValueType(SDK::CrDataType::CrDataType_UInt16);
-    auto error = SDK::SetDeviceProperty(m_device_handle, &prop);
+    auto error = m_cr_lib->SetDeviceProperty(m_device_handle, &prop);
     return !is_error(error, TEXT("Half press up"));
 }
 
 bool CameraDevice::release_down()
 {
-    auto error = SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Down);
+    auto error = m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Down);
     return !is_error(error, TEXT("Shutter release down"));
 }
 
 bool CameraDevice::release_up()
 {
-    auto error = SDK::SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Up);
+    auto error = m_cr_lib->SendCommand(m_device_handle, SDK::CrCommandId::CrCommandId_Release, SDK::CrCommandParam::CrCommandParam_Up);
     return !is_error(error, TEXT("Shutter release up"));
 }
 
-void CameraDevice::half_full_release()
+bool CameraDevice::half_full_release()
 {
-    set_pcremote_priority();
-    std::this_thread::sleep_for(2000ms);
+    bool armed = arm_release();
+    return release_armed() && armed;
+}
 
-    half_press_down();
-    std::this_thread::sleep_for(1200ms);
+bool CameraDevice::arm_release()
+{
+    m_shutter_timing.clear();
+    m_shutter_step_start = std::chrono::steady_clock::now();
 
-    release_down();
-    std::this_thread::sleep_for(2000ms);
+    bool success = set_pcremote_priority();
+    end_shutter_step(TEXT("Priority"), success && wait_for_property(SDK::CrDevicePropertyCode::CrDeviceProperty_PriorityKeySettings,
+        [](CrInt64u v) { return SDK::CrPriorityKeySettings::CrPriorityKey_PCRemote == v; }, PRIORITY_TIMEOUT));
+
+    auto since = focus_reports_since();
+    success = half_press_down() && success;
+    end_shutter_step(TEXT("Focus"), success && wait_for_focus(since));
+    return success;
+}
+
+std::uint64_t CameraDevice::focus_reports_since()
+{
+    ensure_properties();
+    CrInt32u indication = SDK::CrDevicePropertyCode::CrDeviceProperty_FocusIndication;
+    {
+        std::lock_guard<std::mutex> lock(m_event_mtx);
+        if (nullptr != m_store.find(indication)) return m_store.updates();
+    }
+    // Not in the list fetched at connection, so read it once
+    load_properties(1, &indication);
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_store.updates();
+}
+
+bool CameraDevice::wait_for_focus(std::uint64_t since)
+{
+    std::unique_lock<std::mutex> lock(m_event_mtx);
+    // Manual focus does not move the lens, and a camera without the indicator never reports focusing
+    auto* mode = m_store.find(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode);
+    if (nullptr != mode && (SDK::CrFocusMode::CrFocus_MF == mode->current || SDK::CrFocusMode::CrFocus_PF == mode->current)) return true;
+    if (nullptr == m_store.find(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusIndication)) return true;
+
+    // Focusing has finished once the indicator leaves the unlocked state, whether or not it found focus.
+    // Only a report after the half press counts; the stored value may still be the one of the previous shot.
+    return m_event_cv.wait_for(lock, FOCUS_TIMEOUT, [&] {
+        auto* record = m_store.find(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusIndication);
+        return (nullptr != record) && since < record->reported && SDK::CrFocusIndicator::CrFocusIndicator_Unlocked != record->current;
+    });
+}
+
+bool CameraDevice::release_armed()
+{
+    using LockIndicator = SDK::CrLockIndicator;
+
+    bool success = release_shot();
+    success = half_press_up() && success;
+    end_shutter_step(TEXT("Half release"), wait_for_property(SDK::CrDevicePropertyCode::CrDeviceProperty_S1,
+        [](CrInt64u v) { return LockIndicator::CrLockIndicator_Locked != v; }, RELEASE_TIMEOUT));
+
+    return success;
+}
 
-    release_up();
-    std::this_thread::sleep_for(200ms);
+bool CameraDevice::release_shot()
+{
+    using LockIndicator = SDK::CrLockIndicator;
+
+    // The arming steps may have ended long ago, e.g. while other cameras were still focusing
+    m_shutter_step_start = std::chrono::steady_clock::now();
+    auto capture_count = get_capture_count();
+    m_release_issued = m_shutter_step_start;
+    bool released = release_down();
+    bool success = released;
+    std::this_thread::sleep_for(RELEASE_HOLD_TIME);
+    end_shutter_step(TEXT("Capture"), released && wait_for_capture(capture_count + 1, CAPTURE_TIMEOUT));
+
+    success = release_up() && success;
+    end_shutter_step(TEXT("Release"), wait_for_property(SDK::CrDevicePropertyCode::CrDeviceProperty_S2,
+        [](CrInt64u v) { return LockIndicator::CrLockIndicator_Locked != v; }, RELEASE_TIMEOUT));
+    return success;
+}
+
+void CameraDevice::end_shutter_step(const text& step, bool ready)
+{
+    auto now = std::chrono::steady_clock::now();
+    m_shutter_timing.push_back({ step, std::chrono::duration_cast<std::chrono::milliseconds>(now - m_shutter_step_start), !ready });
+    m_shutter_step_start = now;
+}
+
+bool CameraDevice::wait_for_property(CrInt32u prop_code, std::function<bool(CrInt64u)> pred, std::chrono::milliseconds timeout)
+{
+    CrInt64 value = 0;
+    ensure_properties();
+    if (!cached_property_value(prop_code, value)) {
+        // Not in the list fetched at connection, so read it once
+        load_properties(1, &prop_code);
+    }
 
-    half_press_up();
-    std::this_thread::sleep_for(200ms);
+    std::unique_lock<std::mutex> lock(m_event_mtx);
+    return m_event_cv.wait_for(lock, timeout, [&] {
+        auto* record = m_store.find(prop_code);
+        return (nullptr != record) && pred(record->current);
+    });
+}
+
+bool CameraDevice::wait_for_connection(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_event_mtx);
+    m_event_cv.wait_for(lock, timeout, [&] { return (m_connected && m_store.seeded()) || 0 != m_connect_error; });
+    return m_connected && m_store.seeded();
+}
+
+bool CameraDevice::wait_for_capture(std::uint32_t count, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_event_mtx);
+    return m_event_cv.wait_for(lock, timeout, [&] { return count <= m_capture_count; });
+}
+
+bool CameraDevice::wait_for_download(std::uint32_t count, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_event_mtx);
+    return m_event_cv.wait_for(lock, timeout, [&] { return count <= m_download_count; });
+}
+
+std::uint32_t CameraDevice::get_capture_count()
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_capture_count;
+}
+
+std::uint32_t CameraDevice::get_download_count()
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_download_count;
+}
+
+text CameraDevice::get_last_download()
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_last_download;
+}
+
+void CameraDevice::set_download_sink(DownloadSink sink)
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    m_download_sink = std::move(sink);
+}
+
+std::chrono::steady_clock::time_point CameraDevice::get_last_capture_time()
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_last_capture_time;
+}
+
+std::chrono::steady_clock::time_point CameraDevice::get_last_download_time()
+{
+    std::lock_guard<std::mutex> lock(m_event_mtx);
+    return m_last_download_time;
 }
 
 bool CameraDevice::is_error(CrInt32u error, const text& desc)
@@ -2,11 +2,27 @@
 #define CAMERADEVICE_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include "CRSDK/CameraRemote_SDK.h"
 #include "CRSDK/IDeviceCallback.h"
+#include "Completions.h"
 #include "ConnectionInfo.h"
+#include "ContentsDownloader.h"
+#include "ContentsIndexer.h"
+#include "EventBus.h"
+#include "JsonLines.h"
+#include "LiveView.h"
+#include "PropertyStore.h"
+#include "PropertySubscriptions.h"
 #include "PropertyValueTable.h"
+#include "Snapshot.h"
+#include "SyncJournal.h"
 #include "Text.h"
 #include "MessageDefine.h"
 
@@ -35,35 +51,153 @@ public:
 typedef std::vector<CRFolderInfos*> MtpFolderList;
 typedef std::vector<SCRSDK::CrMtpContentsInfo*> MtpContentsList;
 
+// Elapsed time of one step of the shutter sequence
+struct ShutterStepTiming
+{
+    text step;
+    std::chrono::milliseconds elapsed;
+    bool timed_out;
+};
+
+typedef std::vector<ShutterStepTiming> ShutterTimingList;
+
+// One SDK callback, queued for the event threads of CameraDevice.
+// Fixed size apart from file, so queuing it costs the callback a copy and no fetch from the camera.
+struct CameraEvent
+{
+    enum class Type : std::uint8_t
+    {
+        connected,
+        disconnected,
+        properties_changed,
+        download,
+        contents_transfer,
+        warning,
+        error,
+        fetch // Not a callback: properties requested by get_property_values_async()
+    };
+    // Longer code lists of OnPropertyChangedCodes are split over several events
+    static constexpr std::size_t const max_codes = 32;
+
+    Type type = Type::connected;
+    CrInt32u code = 0; // Error, warning or transfer notification
+    CrInt32u count = 0;
+    CrInt32u codes[max_codes] = {};
+    SCRSDK::CrContentHandle handle = 0;
+    text file;
+    std::chrono::steady_clock::time_point reported; // When the callback arrived
+    std::shared_ptr<bool> fetched;                  // fetch: set under m_event_mtx once the codes were loaded
+};
+
+// Outcome of pull_contents_async()
+struct PulledContent
+{
+    text file;      // Saved path; empty when the transfer failed
+    CrInt32u error; // 0 on success, otherwise the SDK's error or transfer notification
+};
+
 // Forward declarations
 struct CRLibInterface;
 
 class CameraDevice : public SCRSDK::IDeviceCallback
 {
 public:
+    // Called on an event thread for every image the camera sends after a capture
+    using DownloadSink = std::function<void(const text& file, std::chrono::steady_clock::time_point completed)>;
+
     CameraDevice() = delete;
+    // Every SDK call goes through cr_lib; nullptr for the SDK the executable was linked with
     CameraDevice(std::int32_t no, CRLibInterface const* cr_lib, SCRSDK::ICrCameraObjectInfo const* camera_info);
     ~CameraDevice();
 
     // Added functions
-    void (*releaseExitSuccess)();
-    void (*releaseExitFailure)();
-    bool wait_for_prop_value(CrInt32u prop, CrInt16u value);
+    bool wait_for_property(CrInt32u prop_code, std::function<bool(CrInt64u)> pred, std::chrono::milliseconds timeout);
+    // True once OnConnected arrived and the properties were loaded; false on timeout or a connection error
+    bool wait_for_connection(std::chrono::milliseconds timeout);
+    bool wait_for_capture(std::uint32_t count, std::chrono::milliseconds timeout);
+    bool wait_for_download(std::uint32_t count, std::chrono::milliseconds timeout);
+    std::uint32_t get_capture_count();
+    std::uint32_t get_download_count();
+    text get_last_download();
+    // When the latest capture and download were reported, on the steady clock
+    std::chrono::steady_clock::time_point get_last_capture_time();
+    std::chrono::steady_clock::time_point get_last_download_time();
+    void set_download_sink(DownloadSink sink);
     bool get_property_value(CrInt32u prop_code, CrInt64& value);
+    // false also when the camera did not confirm the new value in time
     bool set_property_value(CrInt32u prop_code, CrInt64 value);
+    // Values of several properties at once; codes the camera does not report are left out.
+    // Without codes, every property the camera reported.
+    std::vector<PropertyValue> get_property_values(const std::vector<CrInt32u>& codes);
+    // Values the camera accepts for a stored property, widened; range tells that they are the minimum, maximum and step.
+    // False when the camera reported none or of a type without a C++ counterpart.
+    bool get_possible_values(CrInt32u prop_code, std::vector<CrInt64>& values, bool& range);
+    // Sends all values back to back, then waits for their confirmations together.
+    // The codes the camera did not confirm in time are returned in unconfirmed.
+    bool set_property_values(const std::vector<PropertyValue>& values, std::vector<CrInt32u>& unconfirmed);
+
+    // Asynchronous counterparts of the calls above. Each sends its request and returns; the future is made ready
+    // by the callback or property change that reports the outcome, so independent operations overlap.
+    // Ready once the properties are loaded after connecting, false on a connection error or after timeout
+    std::future<bool> connect_async(SCRSDK::CrSdkControlMode openMode, std::chrono::milliseconds timeout);
+    // Ready at once when all codes are stored, otherwise once the missing ones were fetched on the event thread
+    std::future<std::vector<PropertyValue>> get_property_values_async(std::vector<CrInt32u> codes);
+    // False when the camera refused the value or did not report it in time
+    std::future<bool> set_property_value_async(CrInt32u prop_code, CrInt64 value);
+    std::future<bool> step_focus_async(CrInt16 step);
+    // Returns after the release is held down; ready once the camera reported the capture
+    std::future<bool> capture_async();
+    // See LiveViewStream::next(); an empty handle without live view running
+    std::future<LiveViewFrame> next_live_view_frame_async(std::uint64_t sequence);
+    // Ready when the camera reported the transfer finished or failed, or on disconnection; there is no timeout
+    std::future<PulledContent> pull_contents_async(SCRSDK::CrContentHandle content);
+
+    // Calls handler on a dispatch thread with the changes of codes the camera reports, see PropertySubscriptions::subscribe().
+    // Changes are only queued as they are fetched, so handlers may take their time.
+    std::uint64_t subscribe_properties(std::vector<CrInt32u> codes, PropertyPredicate predicate, PropertyHandler handler,
+        std::chrono::milliseconds timeout, bool once = false);
+    void unsubscribe_properties(std::uint64_t id) { m_subscriptions.unsubscribe(id); }
+    // The first change of codes that predicate accepts, or a change with timed_out set after timeout
+    std::future<PropertyChange> next_property_change(std::vector<CrInt32u> codes, PropertyPredicate predicate, std::chrono::milliseconds timeout);
+    PropertySubscriptionStats get_subscription_stats() const { return m_subscriptions.stats(); }
+    // What happens to property changes when the callbacks outpace the event threads; other events always wait for room
+    void set_event_overflow(EventOverflow overflow) { m_properties_overflow = overflow; }
+    EventBusStats get_event_stats() const { return m_events.stats(); }
     void set_verbose(bool enable) { verbose = enable; };
+    // While set, the SDK callbacks are also written to it as JSON lines; nullptr stops them
+    void set_json_writer(JsonWriter* writer);
+    JsonWriter* get_json_writer() const { return m_json; }
     bool set_save_path(const text& path, const text& prefix, int startNo) const;
-    void set_release_after_download(bool enable) { release_after_download = enable; };
+    // Returns once the camera reported manual focus
     bool set_focusmode_manual();
     bool set_focusmode_afs();
     bool set_pcremote_priority();
     bool set_manual_exposure();
+    // These two return once the camera reported the new value, false if it did not in time
     bool set_exposure_bias_comp(CrInt16 value);
+    bool set_shutter_speed(CrInt32u value);
+    // Moves the focus by a NearFar step, positive towards far, and returns once the lens stopped
+    bool step_focus(CrInt16 step);
     bool half_press_down();
     bool half_press_up();
     bool release_down();
     bool release_up();
-    void half_full_release();
+    bool half_full_release();
+    // half_full_release() in two halves: the priority and focus steps, leaving S1 held,
+    // then the capture and release steps. Lets several cameras be released together once all are focused.
+    bool arm_release();
+    bool release_armed();
+    // Capture and release steps only; S1 stays held, so the next shot needs no new arming
+    bool release_shot();
+    const ShutterTimingList& get_shutter_timing() const { return m_shutter_timing; };
+    // When release_armed() sent the release down command
+    std::chrono::steady_clock::time_point get_release_time() const { return m_release_issued; };
+    // Changes whenever a property value changes
+    std::uint64_t get_property_generation();
+    // Latest property table; never blocks, also while a callback is building the next one
+    const Snapshot<PropertyValueTable>& get_properties() const { return m_props; }
+    PropertyFetchStats get_fetch_stats() const;
+    void reset_fetch_stats();
     bool is_error(CrInt32u error, const text& desc);
 
     // Try to connect to the device
@@ -127,6 +261,10 @@ public:
     void execute_pos_xy(CrInt16u code);
     void change_live_view_enable();
     bool is_live_view_enable() { return m_lvEnbSet; };
+    // Continuous live view on a dedicated thread; frames are read from get_live_view_stream()
+    bool start_live_view(std::size_t buffers = 4);
+    void stop_live_view();
+    LiveViewStream* get_live_view_stream() { return m_live_view.get(); }
     void execute_preset_focus();
 
     std::int32_t get_number() { return m_number; }
@@ -140,6 +278,22 @@ public:
     text mac_address() const;
     std::int16_t pid() const;
 
+    // Keeps a contents index per camera in dir, reused by the next listing unless reuse is false. Empty dir disables it.
+    void set_contents_index(const std::string& dir, bool reuse) { m_index_dir = dir; m_reuse_index = reuse; }
+    // Rebuilds the contents list with workers detail requests in flight; sink sees every entry as it arrives,
+    // and folder_sink every folder before its entries
+    bool index_contents(std::size_t workers, ContentsIndexer::EntrySink sink, ContentsIndexStats& stats,
+        ContentsIndexer::FolderFilter folder_filter = nullptr, ContentsIndexer::FolderSink folder_sink = nullptr);
+    // Downloads the contents matching filter to dir, starting while the card is still being indexed.
+    // target may place each file elsewhere or leave it out.
+    // False if indexing failed or any file could not be downloaded; the other files are downloaded regardless.
+    bool download_contents(std::size_t workers, std::size_t in_flight, const text& dir, const ContentsFilter& filter,
+        ContentsDownloader::ResultSink sink, ContentsIndexStats& index_stats, ContentsDownloadStats& download_stats,
+        ContentsTarget target = nullptr);
+    // Downloads the contents matching filter that journal does not have yet to dir, journaling each file as it completes.
+    // sink sees the final path of each file. False if any file could not be downloaded or journaled.
+    bool sync_contents(std::size_t workers, std::size_t in_flight, SyncJournal& journal, const text& dir, const ContentsFilter& filter,
+        ContentsDownloader::ResultSink sink, ContentsIndexStats& index_stats, ContentsDownloadStats& download_stats);
     void getContentsList();
     void pullContents(SCRSDK::CrContentHandle content);
     void getScreennail(SCRSDK::CrContentHandle content);
@@ -162,7 +316,39 @@ public:
     virtual void OnNotifyContentsTransfer(CrInt32u notify, SCRSDK::CrContentHandle contentHandle, CrChar* filename) override;
 
 private:
+    // Run on the event threads, in the order the callbacks of each kind arrived
+    void handle_event(CameraEvent& event);
+    void handle_connected(const CameraEvent& event);
+    void handle_disconnected(const CameraEvent& event);
+    void handle_properties_changed(const CameraEvent& event);
+    void handle_download(const CameraEvent& event);
+    void handle_contents_transfer(const CameraEvent& event);
+    void handle_warning(const CameraEvent& event);
+    void handle_error(const CameraEvent& event);
+    void handle_fetch(const CameraEvent& event);
+    void post_event(CameraEvent& event);
     void load_properties(CrInt32u num = 0, CrInt32u* codes = nullptr);
+    // Values of the stored codes, all stored ones without codes; m_event_mtx must be held
+    std::vector<PropertyValue> stored_values(const std::vector<CrInt32u>& codes);
+    // Future made ready with true once reached, checked under m_event_mtx after every change, or with false after timeout
+    std::future<bool> when(std::function<bool()> reached, std::chrono::milliseconds timeout);
+    void write_json(JsonLine& line);
+    // Fetches all properties once per connection
+    void ensure_properties();
+    bool cached_property_value(CrInt32u prop_code, CrInt64& value);
+    // Wire type for setting a property
+    SCRSDK::CrDataType set_value_type(CrInt32u prop_code);
+    bool wait_for_set(CrInt32u prop_code, CrInt64 value, SCRSDK::CrDataType type);
+    // Store update to compare focus reports against, taken before the half press
+    std::uint64_t focus_reports_since();
+    bool wait_for_focus(std::uint64_t since);
+    void end_shutter_step(const text& step, bool ready);
+    bool contents_transfer_enabled();
+    std::string contents_index_path();
+    // Frees the folders and contents of the last listing
+    void clear_contents_list();
+    // Every property request to the camera goes through here so that it is counted
+    SCRSDK::CrError fetch_properties(CrInt32u num, CrInt32u* codes, SCRSDK::CrDeviceProperty** props, std::int32_t* nprop);
     void get_property(SCRSDK::CrDeviceProperty& prop) const;
     bool set_property(SCRSDK::CrDeviceProperty& prop) const;
 
@@ -175,14 +361,53 @@ private:
     ConnectionType m_conn_type;
     NetworkInfo m_net_info;
     UsbInfo m_usb_info;
-    PropertyValueTable m_prop;
+    // Written from the event threads and the caller's thread, one writer at a time under m_publish_mtx.
+    // Readers load the published table without m_publish_mtx.
+    Snapshot<PropertyValueTable> m_props;
+    // Held by load_properties from fetching the values until they are applied and published
+    std::mutex m_publish_mtx;
     bool m_lvEnbSet;
-    SCRSDK::CrSdkControlMode m_modeSDK;
+    std::unique_ptr<LiveViewStream> m_live_view;
+    std::atomic<SCRSDK::CrSdkControlMode> m_modeSDK;
     MtpFolderList   m_foldList;
     MtpContentsList m_contentList;
+    std::string m_index_dir = default_contents_index_dir();
+    // Receives the transfer notifications while a download runs
+    std::mutex m_transfer_mtx;
+    ContentsDownloader* m_downloader = nullptr;
+    std::vector<std::pair<SCRSDK::CrContentHandle, std::promise<PulledContent>>> m_pulls; // pull_contents_async() in flight
+    bool m_reuse_index = true;
     bool m_spontaneous_disconnection;
-    bool release_after_download = false;
     bool verbose = false;
+    std::atomic<JsonWriter*> m_json{ nullptr };
+    std::mutex m_json_mtx;
+    text m_json_id; // Camera ID of the JSON lines, looked up with the first writer
+
+    // Latest values reported by the camera, guarded by m_event_mtx.
+    // m_event_cv is notified whenever a value, capture or download arrives.
+    std::mutex m_event_mtx;
+    std::condition_variable m_event_cv;
+    PropertyStore m_store;
+    std::uint32_t m_capture_count = 0;
+    CrInt32u m_connect_error = 0;
+    std::uint32_t m_download_count = 0;
+    text m_last_download;
+    std::chrono::steady_clock::time_point m_last_capture_time;
+    std::chrono::steady_clock::time_point m_last_download_time;
+    DownloadSink m_download_sink;
+    ShutterTimingList m_shutter_timing;
+    std::chrono::steady_clock::time_point m_shutter_step_start;
+    std::chrono::steady_clock::time_point m_release_issued;
+    std::atomic<std::uint32_t> m_full_fetches{ 0 };
+    std::atomic<std::uint32_t> m_select_fetches{ 0 };
+    // Asynchronous calls waiting for the state above, checked under m_event_mtx
+    Completions m_completions;
+    // Set when a property change was dropped, so the next one fetches all properties
+    std::atomic<bool> m_properties_lost{ false };
+    std::atomic<EventOverflow> m_properties_overflow{ EventOverflow::block };
+    PropertySubscriptions m_subscriptions;
+    // Last member, so that its event threads stop before anything a handler may use is destroyed
+    EventBus<CameraEvent> m_events;
 };
 } // namespace cli
 
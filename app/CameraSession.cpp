@@ -0,0 +1,149 @@
+#include "CameraSession.h"
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+CameraSession::CameraSession(std::shared_ptr<CameraDevice> camera)
+    : m_camera(std::move(camera))
+{
+    m_worker = std::thread(&CameraSession::run, this);
+}
+
+CameraSession::~CameraSession()
+{
+    stop();
+}
+
+std::future<bool> CameraSession::post(Task task)
+{
+    auto camera = m_camera;
+    std::packaged_task<bool()> job([camera, task] { return task(*camera); });
+    auto result = job.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_stopping) {
+            std::promise<bool> stopped;
+            stopped.set_value(false);
+            return stopped.get_future();
+        }
+        m_queue.push_back(std::move(job));
+    }
+    m_cv.notify_one();
+    return result;
+}
+
+std::size_t CameraSession::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_queue.size();
+}
+
+void CameraSession::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+    if (m_worker.joinable()) m_worker.join();
+}
+
+void CameraSession::run()
+{
+    while (true) {
+        std::packaged_task<bool()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_cv.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) break;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        job();
+    }
+}
+
+SessionManager::SessionManager(CRLibInterface const* cr_lib, bool verbose)
+    : m_cr_lib(cr_lib)
+    , m_verbose(verbose)
+{}
+
+SessionManager::~SessionManager()
+{
+    disconnect_all();
+}
+
+std::size_t SessionManager::connect_all(SDK::CrSdkControlMode mode, std::chrono::milliseconds timeout)
+{
+    auto started = std::chrono::steady_clock::now();
+
+    SDK::ICrEnumCameraObjectInfo* camera_list = nullptr;
+    auto enum_status = m_cr_lib->EnumCameraObjects(&camera_list, 0);
+    if (CR_FAILED(enum_status) || camera_list == nullptr) {
+        return 0;
+    }
+    auto ncams = camera_list->GetCount();
+    if (m_verbose) tout << "Cameras detected: " << ncams << "\n";
+
+    for (CrInt32u i = 0; i < ncams; ++i) {
+        // CameraDevice keeps its own copy of the info, the list can go right after
+        auto camera = std::make_shared<CameraDevice>(static_cast<std::int32_t>(i + 1), m_cr_lib, camera_list->GetCameraObjectInfo(i));
+        camera->set_verbose(m_verbose);
+        m_sessions.emplace_back(new CameraSession(camera));
+    }
+    camera_list->Release();
+
+    // Every camera connects on its own worker, so a slow or absent one does not delay the others
+    std::vector<std::future<bool>> connecting;
+    for (auto& session : m_sessions) {
+        auto* s = session.get();
+        connecting.push_back(s->post([s, mode, timeout, started](CameraDevice& camera) {
+            bool requested = camera.connect(mode);
+            s->m_connected = requested && camera.wait_for_connection(timeout);
+            // Give up on the attempt so the camera is not left half connected
+            if (requested && !s->m_connected) camera.disconnect();
+            s->m_connect_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+            return s->m_connected;
+        }));
+    }
+
+    std::size_t connected = 0;
+    for (auto& result : connecting) {
+        if (result.get()) ++connected;
+    }
+    m_bring_up_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    return connected;
+}
+
+void SessionManager::disconnect_all()
+{
+    std::vector<std::future<bool>> disconnecting;
+    for (auto& session : m_sessions) {
+        if (!session->connected()) continue;
+        disconnecting.push_back(session->post([](CameraDevice& camera) { return camera.disconnect(); }));
+    }
+    for (auto& result : disconnecting) result.wait();
+    for (auto& session : m_sessions) session->stop();
+    m_sessions.clear();
+}
+
+std::vector<bool> SessionManager::run_all(CameraSession::Task task)
+{
+    std::vector<std::future<bool>> running;
+    for (auto& session : m_sessions) {
+        if (session->connected()) {
+            running.push_back(session->post(task));
+        }
+        else {
+            std::promise<bool> skipped;
+            skipped.set_value(false);
+            running.push_back(skipped.get_future());
+        }
+    }
+
+    std::vector<bool> results;
+    for (auto& result : running) results.push_back(result.get());
+    return results;
+}
+} // namespace cli
@@ -0,0 +1,90 @@
+#ifndef CAMERASESSION_H
+#define CAMERASESSION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CameraDevice.h"
+
+namespace cli
+{
+// One camera with its own command queue. Tasks run in order on the camera's worker thread,
+// so a camera that is slow to answer only holds up its own queue.
+class CameraSession
+{
+public:
+    using Task = std::function<bool(CameraDevice& camera)>;
+
+    explicit CameraSession(std::shared_ptr<CameraDevice> camera);
+    ~CameraSession();
+
+    CameraSession(const CameraSession&) = delete;
+    CameraSession& operator=(const CameraSession&) = delete;
+
+    std::shared_ptr<CameraDevice> camera() const { return m_camera; }
+
+    // Queues a task; the future holds its result, or false when the session stopped before it ran
+    std::future<bool> post(Task task);
+    std::size_t pending() const;
+
+    bool connected() const { return m_connected; }
+    // Time from connect_all() until this camera was connected and its properties were loaded
+    std::chrono::milliseconds connect_time() const { return m_connect_time; }
+
+    // Runs the queued tasks that are left, then ends the worker
+    void stop();
+
+private:
+    friend class SessionManager;
+    void run();
+
+    std::shared_ptr<CameraDevice> m_camera;
+    std::thread m_worker;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<std::packaged_task<bool()>> m_queue;
+    bool m_stopping = false;
+
+    // Written by the worker while connecting, read after connect_all() returned
+    bool m_connected = false;
+    std::chrono::milliseconds m_connect_time{ 0 };
+};
+
+// Every camera EnumCameraObjects reports, each in its own CameraSession
+class SessionManager
+{
+public:
+    SessionManager(CRLibInterface const* cr_lib, bool verbose);
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    // Enumerates the cameras and connects them all at once, each on its own worker.
+    // Returns the number connected once every camera connected, failed or timed out.
+    std::size_t connect_all(SCRSDK::CrSdkControlMode mode, std::chrono::milliseconds timeout);
+    void disconnect_all();
+
+    const std::vector<std::unique_ptr<CameraSession>>& sessions() const { return m_sessions; }
+    // Time until the last camera came online, or gave up
+    std::chrono::milliseconds bring_up_time() const { return m_bring_up_time; }
+
+    // Queues task on every connected camera and waits for all of them; results are in session order
+    std::vector<bool> run_all(CameraSession::Task task);
+
+private:
+    CRLibInterface const* m_cr_lib;
+    bool m_verbose;
+    std::vector<std::unique_ptr<CameraSession>> m_sessions;
+    std::chrono::milliseconds m_bring_up_time{ 0 };
+};
+} // namespace cli
+
+#endif // !CAMERASESSION_H
@@ -0,0 +1,75 @@
+#include "Completions.h"
+#include <algorithm>
+#include <iterator>
+
+namespace cli
+{
+Completions::~Completions()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_running = false;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+
+    // Whoever still waits is told the operation failed
+    for (auto& operation : m_operations) operation.expire();
+}
+
+void Completions::add(Check check, Expire expire, std::chrono::milliseconds timeout)
+{
+    if (check()) return;
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    bool nearest = std::all_of(m_operations.begin(), m_operations.end(),
+        [&](const Operation& operation) { return deadline < operation.deadline; });
+    m_operations.push_back(Operation{ std::move(check), std::move(expire), deadline });
+    if (!m_thread.joinable()) {
+        m_running = true;
+        m_thread = std::thread(&Completions::run, this);
+    }
+    else if (nearest) {
+        m_cv.notify_one();
+    }
+}
+
+void Completions::check()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_operations.erase(std::remove_if(m_operations.begin(), m_operations.end(),
+        [](Operation& operation) { return operation.check(); }), m_operations.end());
+}
+
+std::size_t Completions::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_operations.size();
+}
+
+void Completions::run()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (m_running) {
+        auto now = std::chrono::steady_clock::now();
+        auto wake = std::chrono::steady_clock::time_point::max();
+        auto it = std::partition(m_operations.begin(), m_operations.end(),
+            [&](const Operation& operation) { return now < operation.deadline; });
+        for (auto left = m_operations.begin(); left != it; ++left) wake = std::min(wake, left->deadline);
+        std::move(it, m_operations.end(), std::back_inserter(m_expired));
+        m_operations.erase(it, m_operations.end());
+
+        if (!m_expired.empty()) {
+            // Removed under the lock, so check() can no longer end them
+            lock.unlock();
+            for (auto& operation : m_expired) operation.expire();
+            m_expired.clear();
+            lock.lock();
+            continue;
+        }
+        if (wake == std::chrono::steady_clock::time_point::max()) m_cv.wait(lock);
+        else m_cv.wait_until(lock, wake);
+    }
+}
+} // namespace cli
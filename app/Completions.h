@@ -0,0 +1,57 @@
+#ifndef COMPLETIONS_H
+#define COMPLETIONS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cli
+{
+// Asynchronous operations waiting for the camera to report an outcome.
+// Each one ends either in check(), which the owner calls with its state lock held after every change it records,
+// or on a timer thread, started with the first operation, once its timeout passed. Never both.
+class Completions
+{
+public:
+    // Returns true once the operation is over, having fulfilled its promise; called with the owner's state lock held
+    using Check = std::function<bool()>;
+    // Fulfils the promise of an operation that timed out; called without any lock of the owner
+    using Expire = std::function<void()>;
+
+    Completions() = default;
+    // Expires the operations still waiting
+    ~Completions();
+
+    Completions(const Completions&) = delete;
+    Completions& operator=(const Completions&) = delete;
+
+    // Call with the owner's state lock held. check runs once right away, so a state reached before is not missed.
+    void add(Check check, Expire expire, std::chrono::milliseconds timeout);
+    // Call with the owner's state lock held, after the state changed
+    void check();
+    std::size_t pending() const;
+
+private:
+    struct Operation
+    {
+        Check check;
+        Expire expire;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void run();
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv; // An operation with a nearer deadline was added, or stopping
+    std::vector<Operation> m_operations;
+    std::vector<Operation> m_expired; // Scratch list of the timer thread
+    std::thread m_thread;
+    bool m_running = false;
+};
+} // namespace cli
+
+#endif // !COMPLETIONS_H
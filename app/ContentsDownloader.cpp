@@ -0,0 +1,228 @@
+#include "ContentsDownloader.h"
+#include <algorithm>
+#if defined(__GNUC__) && __GNUC__ < 8
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+namespace SDK = SCRSDK;
+using namespace std::chrono_literals;
+
+// A transfer that has not completed after this time, plus one second per megabyte, counts as failed
+#define TRANSFER_TIMEOUT 30s
+#define TRANSFER_MIN_RATE (1024 * 1024)
+
+namespace impl
+{
+using cli::text;
+using cli::text_char;
+
+text upper(text s)
+{
+    for (auto& c : s) {
+        if (TEXT('a') <= c && c <= TEXT('z')) c = static_cast<text_char>(c - TEXT('a') + TEXT('A'));
+    }
+    return s;
+}
+
+text date_of(const SDK::CrMtpContentsInfo& info)
+{
+    return text(info.dateChar, std::find(info.dateChar, info.dateChar + 16, 0));
+}
+} // namespace impl
+
+namespace cli
+{
+bool ContentsFilter::matches_folder(const SDK::CrMtpFolderInfo& info) const
+{
+    return folder.empty() || (info.folderName && folder == text(info.folderName));
+}
+
+bool ContentsFilter::matches(const SDK::CrMtpContentsInfo& info) const
+{
+    if (info.contentSize < min_size || max_size < info.contentSize) return false;
+
+    if (!date_from.empty() || !date_to.empty()) {
+        auto date = impl::date_of(info);
+        if (!date_from.empty() && date.compare(0, date_from.size(), date_from) < 0) return false;
+        if (!date_to.empty() && 0 < date.compare(0, date_to.size(), date_to)) return false;
+    }
+
+    if (!extensions.empty()) {
+        text name = impl::upper(info.fileName ? text(info.fileName) : text());
+        auto dot = name.rfind(TEXT('.'));
+        if (text::npos == dot) return false;
+        auto ext = name.substr(dot + 1);
+        if (std::none_of(extensions.begin(), extensions.end(), [&](const text& e) { return impl::upper(e) == ext; })) return false;
+    }
+    return !predicate || predicate(info);
+}
+
+ContentsDownloader::ContentsDownloader(CRLibInterface const* cr_lib, SDK::CrDeviceHandle device_handle, std::size_t in_flight, const text& dir)
+    : m_cr_lib(cr_lib)
+    , m_device_handle(device_handle)
+    , m_max_window(0 < in_flight ? in_flight : 1)
+    , m_window(m_max_window)
+    , m_dir(dir)
+    , m_timeout(TRANSFER_TIMEOUT)
+{}
+
+ContentsDownloader::~ContentsDownloader()
+{
+    cancel();
+    wait();
+}
+
+void ContentsDownloader::start()
+{
+    m_started = std::chrono::steady_clock::now();
+    m_thread = std::thread(&ContentsDownloader::run, this);
+}
+
+void ContentsDownloader::enqueue(const SDK::CrMtpContentsInfo& info, const text& dir, const text& file_name)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_queue.push_back(Job{ info.handle, info.contentSize, dir.empty() ? m_dir : dir, file_name });
+        ++m_queued;
+    }
+    m_cv.notify_all();
+}
+
+void ContentsDownloader::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_closed = true;
+    }
+    m_cv.notify_all();
+}
+
+void ContentsDownloader::wait()
+{
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void ContentsDownloader::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_cancelled = true;
+    }
+    m_cv.notify_all();
+}
+
+ContentsDownloadStats ContentsDownloader::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto until = (m_finished < m_started) ? std::chrono::steady_clock::now() : m_finished;
+    return ContentsDownloadStats{ m_queued, m_completed, m_failed, m_bytes,
+        std::chrono::duration_cast<std::chrono::milliseconds>(until - m_started) };
+}
+
+void ContentsDownloader::on_transfer(CrInt32u notify, SDK::CrContentHandle handle, const text& file)
+{
+    if (SDK::CrNotify_ContentsTransfer_Start == notify) return;
+
+    bool completed = (SDK::CrNotify_ContentsTransfer_Complete == notify);
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        auto it = m_in_flight.find(handle);
+        if (m_in_flight.end() == it) {
+            // Already reported as failed, so the file must not stay behind as if it had been downloaded
+            if (0 == m_timed_out.erase(handle) || !completed || file.empty()) return;
+            lock.unlock();
+            std::error_code ec;
+            fs::remove(fs::path(file), ec);
+            return;
+        }
+        if (completed) {
+            ++m_completed;
+            m_bytes += it->second.size;
+            // The camera takes requests again, so try the full window once more
+            if (m_window < m_max_window) ++m_window;
+        }
+        else {
+            ++m_failed;
+        }
+        m_in_flight.erase(it);
+    }
+    m_cv.notify_all();
+    report(handle, completed ? file : text(), completed ? 0 : notify);
+}
+
+void ContentsDownloader::run()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+        auto next_deadline = std::chrono::steady_clock::now() + m_timeout;
+        for (auto& transfer : m_in_flight) next_deadline = std::min(next_deadline, transfer.second.deadline);
+
+        m_cv.wait_until(lock, next_deadline, [&] {
+            return m_cancelled || (!m_queue.empty() && m_in_flight.size() < m_window)
+                || (m_closed && m_queue.empty() && m_in_flight.empty());
+        });
+        expire_transfers(lock);
+        if (m_cancelled || (m_closed && m_queue.empty() && m_in_flight.empty())) break;
+
+        while (!m_cancelled && !m_queue.empty() && m_in_flight.size() < m_window) {
+            auto job = m_queue.front();
+            m_queue.pop_front();
+            auto timeout = m_timeout + std::chrono::seconds(job.size / TRANSFER_MIN_RATE);
+            // Registered first, the completion may arrive before PullContentsFile returns
+            m_in_flight[job.handle] = Transfer{ job.size, std::chrono::steady_clock::now() + timeout };
+
+            lock.unlock();
+            auto err = m_cr_lib->PullContentsFile(m_device_handle, job.handle, SDK::CrPropertyStillImageTransSize_Original,
+                job.dir.empty() ? nullptr : const_cast<CrChar*>(job.dir.c_str()),
+                job.file_name.empty() ? nullptr : const_cast<CrChar*>(job.file_name.c_str()));
+            lock.lock();
+            if (CR_SUCCEEDED(err)) continue;
+
+            m_in_flight.erase(job.handle);
+            if (!m_in_flight.empty()) {
+                // The camera takes fewer requests at once than asked for; retry once one of the others completed
+                m_queue.push_front(job);
+                m_window = m_in_flight.size();
+                break;
+            }
+            ++m_failed;
+            lock.unlock();
+            report(job.handle, text(), err);
+            lock.lock();
+        }
+    }
+    m_finished = std::chrono::steady_clock::now();
+}
+
+void ContentsDownloader::expire_transfers(std::unique_lock<std::mutex>& lock)
+{
+    auto now = std::chrono::steady_clock::now();
+    std::vector<SDK::CrContentHandle> expired;
+    for (auto it = m_in_flight.begin(); it != m_in_flight.end();) {
+        if (it->second.deadline <= now) {
+            expired.push_back(it->first);
+            m_timed_out.insert(it->first);
+            it = m_in_flight.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    if (expired.empty()) return;
+
+    m_failed += expired.size();
+    lock.unlock();
+    for (auto handle : expired) report(handle, text(), SDK::CrError_Generic_Unknown);
+    lock.lock();
+}
+
+void ContentsDownloader::report(SDK::CrContentHandle handle, const text& file, CrInt32u error)
+{
+    std::lock_guard<std::mutex> lock(m_sink_mtx);
+    if (m_result_sink) m_result_sink(handle, file, error);
+}
+} // namespace cli
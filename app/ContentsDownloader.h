@@ -0,0 +1,142 @@
+#ifndef CONTENTSDOWNLOADER_H
+#define CONTENTSDOWNLOADER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "LibManager.h"
+#include "Text.h"
+
+namespace cli
+{
+struct ContentsDownloadStats
+{
+    std::uint64_t queued;
+    std::uint64_t completed;
+    std::uint64_t failed;
+    std::uint64_t bytes; // Sizes reported by the camera for the completed files
+    std::chrono::milliseconds elapsed;
+
+    double files_per_second() const
+    {
+        return 0 < elapsed.count() ? completed * 1000.0 / elapsed.count() : 0.0;
+    }
+    double megabytes_per_second() const
+    {
+        return 0 < elapsed.count() ? bytes / 1048576.0 * 1000.0 / elapsed.count() : 0.0;
+    }
+};
+
+// Selects contents by folder, date, extension and size. Empty fields match everything.
+struct ContentsFilter
+{
+    text folder;
+    // Compared with the start of the camera's date (YYYYMMDDThhmmss), so 20261017 and 20261017T12 both work
+    text date_from;
+    text date_to;
+    std::vector<text> extensions; // Without the dot, in any case
+    CrInt64u min_size = 0;
+    CrInt64u max_size = std::numeric_limits<CrInt64u>::max();
+    // Checked last, after all other fields matched
+    std::function<bool(const SCRSDK::CrMtpContentsInfo& info)> predicate;
+
+    bool matches_folder(const SCRSDK::CrMtpFolderInfo& folder) const;
+    bool matches(const SCRSDK::CrMtpContentsInfo& info) const;
+};
+
+// Chooses where a selected file is saved before it is queued, or returns false to leave it out.
+// folder is the name of the date folder holding the file. dir starts out as the download dir and file_name empty,
+// which lets the camera name the file.
+using ContentsTarget = std::function<bool(const SCRSDK::CrMtpContentsInfo& info, const text& folder, text& dir, text& file_name)>;
+
+// Downloads queued contents with a fixed number of PullContentsFile requests in flight.
+// Completion is reported by the camera through OnNotifyContentsTransfer, which the owner forwards to on_transfer().
+// A file that fails is reported and counted; the others carry on. A transfer that timed out stays failed:
+// if the camera completes it later, the file it saved is deleted rather than left behind looking complete.
+// When the camera refuses a request, the window shrinks to what it accepted and grows back as transfers succeed.
+class ContentsDownloader
+{
+public:
+    // Called once per file when its transfer ended. error is 0 on success, when file is the saved path.
+    // Calls are serialized, but come from an event thread of CameraDevice or the downloader's thread.
+    using ResultSink = std::function<void(SCRSDK::CrContentHandle handle, const text& file, CrInt32u error)>;
+
+    ContentsDownloader(CRLibInterface const* cr_lib, SCRSDK::CrDeviceHandle device_handle, std::size_t in_flight, const text& dir);
+    ~ContentsDownloader();
+
+    ContentsDownloader(const ContentsDownloader&) = delete;
+    ContentsDownloader& operator=(const ContentsDownloader&) = delete;
+
+    void set_result_sink(ResultSink sink) { m_result_sink = std::move(sink); }
+    // Time a transfer may take before it counts as failed, before the allowance for its size
+    void set_timeout(std::chrono::milliseconds timeout) { m_timeout = timeout; }
+
+    void start();
+    // Saves the file to dir, or the downloader's dir when empty, as file_name or the camera's name when empty
+    void enqueue(const SCRSDK::CrMtpContentsInfo& info, const text& dir = text(), const text& file_name = text());
+    // No more files will be queued; wait() returns once everything queued has ended
+    void close();
+    void wait();
+    // Stops sending requests; transfers already in flight are not waited for
+    void cancel();
+
+    void on_transfer(CrInt32u notify, SCRSDK::CrContentHandle handle, const text& file);
+
+    ContentsDownloadStats stats() const;
+
+private:
+    struct Job
+    {
+        SCRSDK::CrContentHandle handle;
+        CrInt64u size;
+        text dir;
+        text file_name;
+    };
+    struct Transfer
+    {
+        CrInt64u size;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void run();
+    void expire_transfers(std::unique_lock<std::mutex>& lock);
+    void report(SCRSDK::CrContentHandle handle, const text& file, CrInt32u error);
+
+    CRLibInterface const* m_cr_lib;
+    SCRSDK::CrDeviceHandle m_device_handle;
+    std::size_t m_max_window;
+    std::size_t m_window;
+    text m_dir;
+    std::chrono::milliseconds m_timeout;
+    ResultSink m_result_sink;
+    std::thread m_thread;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;
+    std::unordered_map<SCRSDK::CrContentHandle, Transfer> m_in_flight;
+    // Given up on, but the camera may still end them
+    std::unordered_set<SCRSDK::CrContentHandle> m_timed_out;
+    bool m_closed = false;
+    bool m_cancelled = false;
+
+    std::mutex m_sink_mtx;
+    std::chrono::steady_clock::time_point m_started;
+    std::chrono::steady_clock::time_point m_finished;
+    std::uint64_t m_queued = 0;
+    std::uint64_t m_completed = 0;
+    std::uint64_t m_failed = 0;
+    std::uint64_t m_bytes = 0;
+};
+} // namespace cli
+
+#endif // !CONTENTSDOWNLOADER_H
@@ -0,0 +1,258 @@
+#include "ContentsIndexFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#if defined(__GNUC__) && __GNUC__ < 8
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SDK = SCRSDK;
+
+namespace impl
+{
+constexpr char const index_magic[4] = { 'C', 'R', 'I', 'X' };
+constexpr std::uint32_t const index_version = 1;
+
+std::size_t string_length(const CrChar* str)
+{
+    std::size_t len = 0;
+    while (str && str[len]) ++len;
+    return len;
+}
+} // namespace impl
+
+namespace cli
+{
+std::unique_ptr<ContentsIndexFile> ContentsIndexFile::open(const std::string& path)
+{
+    std::unique_ptr<ContentsIndexFile> file(new ContentsIndexFile());
+    if (!file->map(path) || !file->validate()) return nullptr;
+    return file;
+}
+
+#if defined(_WIN32)
+bool ContentsIndexFile::map(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == file) return false;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(ContentsIndexHeader))) return false;
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) return false;
+    m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    return nullptr != m_data;
+}
+
+ContentsIndexFile::~ContentsIndexFile()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+}
+#else
+bool ContentsIndexFile::map(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(ContentsIndexHeader))) {
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == data) return false;
+    m_data = static_cast<const std::uint8_t*>(data);
+    return true;
+}
+
+ContentsIndexFile::~ContentsIndexFile()
+{
+    if (m_data) munmap(const_cast<std::uint8_t*>(m_data), m_size);
+}
+#endif
+
+bool ContentsIndexFile::validate()
+{
+    auto header = reinterpret_cast<const ContentsIndexHeader*>(m_data);
+    if (0 != std::memcmp(header->magic, impl::index_magic, sizeof impl::index_magic)
+        || impl::index_version != header->version || sizeof(CrChar) != header->char_size) {
+        return false;
+    }
+
+    std::uint64_t size = sizeof(ContentsIndexHeader)
+        + std::uint64_t(header->folder_count) * sizeof(ContentsIndexFolder)
+        + std::uint64_t(header->entry_count) * sizeof(ContentsIndexEntry)
+        + std::uint64_t(header->string_count) * sizeof(CrChar);
+    if (m_size != size || 0 == header->string_count) return false;
+
+    m_header = header;
+    m_folders = reinterpret_cast<const ContentsIndexFolder*>(m_data + sizeof(ContentsIndexHeader));
+    m_entries = reinterpret_cast<const ContentsIndexEntry*>(m_folders + header->folder_count);
+    m_strings = reinterpret_cast<const CrChar*>(m_entries + header->entry_count);
+
+    // Every string is terminated as long as offsets stay inside the table and the table ends with a null
+    if (0 != m_strings[header->string_count - 1] || header->string_count <= header->camera_id) return false;
+    for (std::uint32_t f = 0; f < header->folder_count; ++f) {
+        auto& folder = m_folders[f];
+        if (header->entry_count < folder.first_entry || header->entry_count - folder.first_entry < folder.entry_count
+            || header->string_count <= folder.name) {
+            return false;
+        }
+    }
+    for (std::uint32_t e = 0; e < header->entry_count; ++e) {
+        if (header->string_count <= m_entries[e].name) return false;
+    }
+    return true;
+}
+
+const ContentsIndexFolder* ContentsIndexFile::find_folder(CrInt32u handle) const
+{
+    auto end = m_folders + m_header->folder_count;
+    auto it = std::find_if(m_folders, end, [&](const ContentsIndexFolder& folder) { return folder.handle == handle; });
+    return end == it ? nullptr : it;
+}
+
+bool ContentsIndexFile::matches(const ContentsIndexFolder& folder, const SDK::CrContentHandle* handles, CrInt32u count) const
+{
+    if (folder.entry_count != count) return false;
+    auto first = entries(folder);
+    auto last = first + folder.entry_count;
+    for (CrInt32u i = 0; i < count; ++i) {
+        auto it = std::lower_bound(first, last, handles[i], [](const ContentsIndexEntry& entry, SDK::CrContentHandle handle) {
+            return entry.handle < handle;
+        });
+        if (last == it || it->handle != handles[i]) return false;
+    }
+    return true;
+}
+
+void ContentsIndexFile::fill(const ContentsIndexEntry& entry, SDK::CrMtpContentsInfo& info) const
+{
+    info.handle = entry.handle;
+    info.parentFolderHandle = entry.folder;
+    info.contentSize = entry.size;
+    std::memcpy(info.dateChar, entry.date, sizeof info.dateChar);
+    info.width = entry.width;
+    info.height = entry.height;
+    info.fileNameSize = entry.name_size;
+    info.fileName = const_cast<CrChar*>(string(entry.name));
+}
+
+void ContentsIndexWriter::add_folder(const SDK::CrMtpFolderInfo& folder)
+{
+    m_folders.push_back(ContentsIndexFolder{ folder.handle, 0, 0, add_string(folder.folderName, impl::string_length(folder.folderName)) });
+}
+
+void ContentsIndexWriter::add_entry(const SDK::CrMtpContentsInfo& info)
+{
+    ContentsIndexEntry entry{};
+    entry.handle = info.handle;
+    entry.folder = info.parentFolderHandle;
+    entry.size = info.contentSize;
+    entry.width = info.width;
+    entry.height = info.height;
+    auto length = impl::string_length(info.fileName);
+    entry.name = add_string(info.fileName, length);
+    entry.name_size = static_cast<std::uint32_t>(length + 1);
+    std::memcpy(entry.date, info.dateChar, sizeof entry.date);
+    m_entries.push_back(entry);
+}
+
+std::uint32_t ContentsIndexWriter::add_string(const CrChar* str, std::size_t length)
+{
+    auto offset = static_cast<std::uint32_t>(m_strings.size());
+    if (str) m_strings.insert(m_strings.end(), str, str + length);
+    m_strings.push_back(0);
+    return offset;
+}
+
+bool ContentsIndexWriter::save(const std::string& path, const text& camera_id)
+{
+    auto id = add_string(reinterpret_cast<const CrChar*>(camera_id.c_str()), camera_id.size());
+
+    // Group the entries by folder, keeping the folders in camera order
+    std::unordered_map<std::uint32_t, std::uint32_t> folder_index;
+    for (std::size_t f = 0; f < m_folders.size(); ++f) {
+        folder_index.emplace(m_folders[f].handle, static_cast<std::uint32_t>(f));
+    }
+    std::vector<std::uint32_t> folder_of(m_entries.size(), static_cast<std::uint32_t>(m_folders.size()));
+    for (std::size_t e = 0; e < m_entries.size(); ++e) {
+        auto it = folder_index.find(m_entries[e].folder);
+        if (folder_index.end() != it) folder_of[e] = it->second;
+    }
+    std::vector<std::size_t> order(m_entries.size());
+    for (std::size_t e = 0; e < order.size(); ++e) order[e] = e;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return folder_of[a] != folder_of[b] ? folder_of[a] < folder_of[b] : m_entries[a].handle < m_entries[b].handle;
+    });
+
+    std::vector<ContentsIndexEntry> entries;
+    entries.reserve(m_entries.size());
+    for (auto e : order) {
+        // Entries of unknown folders could never be matched again
+        if (m_folders.size() == folder_of[e]) continue;
+        auto& folder = m_folders[folder_of[e]];
+        if (0 == folder.entry_count) folder.first_entry = static_cast<std::uint32_t>(entries.size());
+        ++folder.entry_count;
+        entries.push_back(m_entries[e]);
+    }
+
+    ContentsIndexHeader header{};
+    std::memcpy(header.magic, impl::index_magic, sizeof header.magic);
+    header.version = impl::index_version;
+    header.char_size = sizeof(CrChar);
+    header.camera_id = id;
+    header.folder_count = static_cast<std::uint32_t>(m_folders.size());
+    header.entry_count = static_cast<std::uint32_t>(entries.size());
+    header.string_count = static_cast<std::uint32_t>(m_strings.size());
+
+    std::error_code ec;
+    fs::path target(path);
+    if (target.has_parent_path()) fs::create_directories(target.parent_path(), ec);
+    fs::path temp(path + ".tmp");
+    {
+        std::ofstream file(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof header);
+        file.write(reinterpret_cast<const char*>(m_folders.data()), m_folders.size() * sizeof(ContentsIndexFolder));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ContentsIndexEntry));
+        file.write(reinterpret_cast<const char*>(m_strings.data()), m_strings.size() * sizeof(CrChar));
+        if (!file.good()) {
+            file.close();
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+    fs::rename(temp, target, ec);
+    return !ec;
+}
+
+std::string default_contents_index_dir()
+{
+    std::error_code ec;
+    auto dir = fs::temp_directory_path(ec);
+    if (ec) return "RemoteCli-index";
+    return (dir / "RemoteCli-index").string();
+}
+} // namespace cli
@@ -0,0 +1,115 @@
+#ifndef CONTENTSINDEXFILE_H
+#define CONTENTSINDEXFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "Text.h"
+
+namespace cli
+{
+// On-disk layout, all integers in host byte order and every record 8-byte aligned:
+//   ContentsIndexHeader
+//   ContentsIndexFolder[folder_count]
+//   ContentsIndexEntry[entry_count]   grouped by folder, ascending handle within a folder
+//   CrChar[string_count]              camera ID and names, each followed by a null
+// Names are offsets into the string table, so the file is used in place once mapped.
+struct ContentsIndexHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t char_size;
+    std::uint32_t camera_id; // Offset into the string table
+    std::uint32_t folder_count;
+    std::uint32_t entry_count;
+    std::uint32_t string_count;
+    std::uint32_t reserved;
+};
+
+struct ContentsIndexFolder
+{
+    std::uint32_t handle;
+    std::uint32_t first_entry;
+    std::uint32_t entry_count;
+    std::uint32_t name;
+};
+
+struct ContentsIndexEntry
+{
+    std::uint32_t handle;
+    std::uint32_t folder;
+    std::uint64_t size;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t name;
+    std::uint32_t name_size; // In characters, including the null
+    CrChar date[16];
+};
+
+// A read-only, memory-mapped index file
+class ContentsIndexFile
+{
+public:
+    // nullptr when the file is missing, truncated or was written by another version or character width
+    static std::unique_ptr<ContentsIndexFile> open(const std::string& path);
+    ~ContentsIndexFile();
+
+    ContentsIndexFile(const ContentsIndexFile&) = delete;
+    ContentsIndexFile& operator=(const ContentsIndexFile&) = delete;
+
+    const ContentsIndexHeader& header() const { return *m_header; }
+    text camera_id() const { return text(string(m_header->camera_id)); }
+    const ContentsIndexFolder* folders() const { return m_folders; }
+    const ContentsIndexFolder* find_folder(CrInt32u handle) const;
+    const ContentsIndexEntry* entries(const ContentsIndexFolder& folder) const { return m_entries + folder.first_entry; }
+    const CrChar* string(std::uint32_t offset) const { return m_strings + offset; }
+
+    // True when the folder is indexed with exactly these handles, so its entries are still current
+    bool matches(const ContentsIndexFolder& folder, const SCRSDK::CrContentHandle* handles, CrInt32u count) const;
+
+    // Fills info with a cached entry. info.fileName then points into the mapping and must be reset to
+    // nullptr before info is destroyed, as the SDK would otherwise free it.
+    void fill(const ContentsIndexEntry& entry, SCRSDK::CrMtpContentsInfo& info) const;
+
+private:
+    ContentsIndexFile() = default;
+    bool map(const std::string& path);
+    bool validate();
+
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+
+    const ContentsIndexHeader* m_header = nullptr;
+    const ContentsIndexFolder* m_folders = nullptr;
+    const ContentsIndexEntry* m_entries = nullptr;
+    const CrChar* m_strings = nullptr;
+};
+
+// Collects folders and entries in any order and writes them as an index file
+class ContentsIndexWriter
+{
+public:
+    void add_folder(const SCRSDK::CrMtpFolderInfo& folder);
+    void add_entry(const SCRSDK::CrMtpContentsInfo& info);
+
+    // Writes to a temporary file and renames it over path, so readers never see a partial index
+    bool save(const std::string& path, const text& camera_id);
+
+private:
+    std::uint32_t add_string(const CrChar* str, std::size_t length);
+
+    std::vector<ContentsIndexFolder> m_folders;
+    std::vector<ContentsIndexEntry> m_entries;
+    std::vector<CrChar> m_strings;
+};
+
+// Where contents indexes are kept unless another directory is given
+std::string default_contents_index_dir();
+} // namespace cli
+
+#endif // !CONTENTSINDEXFILE_H
@@ -0,0 +1,148 @@
+#include "ContentsIndexer.h"
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+ContentsIndexer::ContentsIndexer(CRLibInterface const* cr_lib, SDK::CrDeviceHandle device_handle, std::size_t workers)
+    : m_cr_lib(cr_lib)
+    , m_device_handle(device_handle)
+    , m_worker_count(0 < workers ? workers : 1)
+{}
+
+ContentsIndexer::~ContentsIndexer()
+{
+    cancel();
+    wait();
+}
+
+void ContentsIndexer::start()
+{
+    m_started = std::chrono::steady_clock::now();
+    m_lister = std::thread(&ContentsIndexer::list_folders, this);
+    for (std::size_t i = 0; i < m_worker_count; ++i) {
+        m_workers.emplace_back(&ContentsIndexer::query_details, this);
+    }
+}
+
+bool ContentsIndexer::wait()
+{
+    if (m_lister.joinable()) m_lister.join();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    m_workers.clear();
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_finished < m_started) m_finished = std::chrono::steady_clock::now();
+    return !m_failed && !m_cancelled;
+}
+
+void ContentsIndexer::cancel()
+{
+    m_cancelled = true;
+    m_handles_cv.notify_all();
+}
+
+ContentsIndexStats ContentsIndexer::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto until = (m_finished < m_started) ? std::chrono::steady_clock::now() : m_finished;
+    auto ms = [](std::chrono::steady_clock::duration d) { return std::chrono::duration_cast<std::chrono::milliseconds>(d); };
+    return ContentsIndexStats{ m_folders, m_entries, m_cached, m_failures,
+        0 < m_entries ? ms(m_first_entry - m_started) : std::chrono::milliseconds(0), ms(until - m_started) };
+}
+
+void ContentsIndexer::list_folders()
+{
+    CrInt32u f_nums = 0;
+    SDK::CrMtpFolderInfo* f_list = nullptr;
+    auto err = m_cr_lib->GetDateFolderList(m_device_handle, &f_list, &f_nums);
+    if (CR_FAILED(err)) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_failed = true;
+    }
+
+    for (CrInt32u f = 0; CR_SUCCEEDED(err) && f_list && f < f_nums && !m_cancelled; ++f) {
+        if (m_folder_filter && !m_folder_filter(f_list[f])) continue;
+
+        SDK::CrContentHandle* c_list = nullptr;
+        CrInt32u c_nums = 0;
+        if (CR_FAILED(m_cr_lib->GetContentsHandleList(m_device_handle, f_list[f].handle, &c_list, &c_nums))) {
+            // The other folders are still listed, but the listing is not the whole card
+            std::lock_guard<std::mutex> lock(m_mtx);
+            ++m_failures;
+            m_failed = true;
+            continue;
+        }
+        if (m_folder_sink) {
+            std::lock_guard<std::mutex> lock(m_sink_mtx);
+            m_folder_sink(f_list[f], c_nums);
+        }
+        auto cached = m_index ? m_index->find_folder(f_list[f].handle) : nullptr;
+        if (cached && c_list && m_index->matches(*cached, c_list, c_nums)) {
+            SDK::CrMtpContentsInfo info;
+            auto entries = m_index->entries(*cached);
+            for (std::uint32_t i = 0; i < cached->entry_count; ++i) {
+                m_index->fill(entries[i], info);
+                deliver(info, true);
+            }
+            info.fileName = nullptr;
+            std::lock_guard<std::mutex> lock(m_mtx);
+            ++m_folders;
+        }
+        else {
+            {
+                // Hand the whole folder over at once; workers start on it while the next folder is listed
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_handles.insert(m_handles.end(), c_list, c_list + (c_list ? c_nums : 0));
+                ++m_folders;
+            }
+            m_handles_cv.notify_all();
+        }
+        if (c_list) m_cr_lib->ReleaseContentsHandleList(m_device_handle, c_list);
+    }
+    if (f_list) m_cr_lib->ReleaseDateFolderList(m_device_handle, f_list);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_listing_done = true;
+    }
+    m_handles_cv.notify_all();
+}
+
+void ContentsIndexer::query_details()
+{
+    // One info object per worker, reused for every handle
+    SDK::CrMtpContentsInfo info;
+    while (true) {
+        SDK::CrContentHandle handle = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_handles_cv.wait(lock, [&] { return m_cancelled || !m_handles.empty() || m_listing_done; });
+            if (m_cancelled || m_handles.empty()) break;
+            handle = m_handles.front();
+            m_handles.pop_front();
+        }
+
+        if (CR_FAILED(m_cr_lib->GetContentsDetailInfo(m_device_handle, handle, &info))) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            ++m_failures;
+            continue;
+        }
+
+        deliver(info, false);
+    }
+}
+
+void ContentsIndexer::deliver(const SDK::CrMtpContentsInfo& info, bool cached)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sink_mtx);
+        if (m_entry_sink) m_entry_sink(info);
+    }
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (0 == m_entries++) m_first_entry = std::chrono::steady_clock::now();
+    if (cached) ++m_cached;
+}
+} // namespace cli
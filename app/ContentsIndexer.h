@@ -0,0 +1,100 @@
+#ifndef CONTENTSINDEXER_H
+#define CONTENTSINDEXER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "ContentsIndexFile.h"
+#include "LibManager.h"
+
+namespace cli
+{
+struct ContentsIndexStats
+{
+    std::uint64_t folders;
+    std::uint64_t entries;
+    std::uint64_t cached;   // Entries taken from the index file instead of the camera
+    std::uint64_t failures; // Folders whose handles could not be listed, and handles whose detail info could not be read
+    std::chrono::milliseconds first_entry; // From start until the first entry was delivered
+    std::chrono::milliseconds elapsed;
+
+    double entries_per_second() const
+    {
+        return 0 < elapsed.count() ? entries * 1000.0 / elapsed.count() : 0.0;
+    }
+};
+
+// Builds the list of contents on the memory card as a pipeline: one thread walks the date folders and their
+// handle lists while worker threads query the detail info of the handles already known. Entries are handed
+// to the sink as soon as their detail info arrives, so consumers can start downloading while indexing continues.
+class ContentsIndexer
+{
+public:
+    // Called once per folder with its number of contents, before any entry of that folder
+    using FolderSink = std::function<void(const SCRSDK::CrMtpFolderInfo& folder, CrInt32u contents)>;
+    // Called once per content. Calls are serialized, but come from the worker threads
+    using EntrySink = std::function<void(const SCRSDK::CrMtpContentsInfo& info)>;
+    // Returns false to leave a folder out of the index
+    using FolderFilter = std::function<bool(const SCRSDK::CrMtpFolderInfo& folder)>;
+
+    ContentsIndexer(CRLibInterface const* cr_lib, SCRSDK::CrDeviceHandle device_handle, std::size_t workers);
+    ~ContentsIndexer();
+
+    ContentsIndexer(const ContentsIndexer&) = delete;
+    ContentsIndexer& operator=(const ContentsIndexer&) = delete;
+
+    void set_folder_sink(FolderSink sink) { m_folder_sink = std::move(sink); }
+    void set_entry_sink(EntrySink sink) { m_entry_sink = std::move(sink); }
+    void set_folder_filter(FolderFilter filter) { m_folder_filter = std::move(filter); }
+    // Folders whose handles are unchanged since the index was written are served from it without detail requests
+    void set_index(const ContentsIndexFile* index) { m_index = index; }
+
+    void start();
+    // Blocks until every entry was delivered; false if the folder list could not be read or indexing was cancelled
+    bool wait();
+    void cancel();
+
+    ContentsIndexStats stats() const;
+
+private:
+    void list_folders();
+    void query_details();
+    void deliver(const SCRSDK::CrMtpContentsInfo& info, bool cached);
+
+    CRLibInterface const* m_cr_lib;
+    SCRSDK::CrDeviceHandle m_device_handle;
+    std::size_t m_worker_count;
+    FolderSink m_folder_sink;
+    EntrySink m_entry_sink;
+    FolderFilter m_folder_filter;
+    const ContentsIndexFile* m_index = nullptr;
+
+    std::thread m_lister;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_cancelled{ false };
+    bool m_failed = false;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_handles_cv;
+    std::deque<SCRSDK::CrContentHandle> m_handles;
+    bool m_listing_done = false;
+
+    std::mutex m_sink_mtx;
+    std::chrono::steady_clock::time_point m_started;
+    std::chrono::steady_clock::time_point m_finished;
+    std::chrono::steady_clock::time_point m_first_entry;
+    std::uint64_t m_folders = 0;
+    std::uint64_t m_entries = 0;
+    std::uint64_t m_cached = 0;
+    std::uint64_t m_failures = 0;
+};
+} // namespace cli
+
+#endif // !CONTENTSINDEXER_H
@@ -0,0 +1,189 @@
+#include "Daemon.h"
+#include <cstdlib>
+#include <ostream>
+#include <streambuf>
+#if defined(__GNUC__) && __GNUC__ < 8
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+#include "Socket.h"
+
+// Wire format
+//   request : the number of arguments as decimal text and '\n', then each argument followed by '\0'
+//   reply   : client output, '\0', exit status as decimal text
+// Arguments cannot contain '\0', and the count ends the request, so an empty argument is sent as it is.
+namespace impl
+{
+constexpr char const count_separator = '\n';
+constexpr char const arg_terminator = '\0';
+constexpr char const status_separator = '\0';
+constexpr std::size_t const max_args = 4096;
+
+bool read_request(cli::socket_t sock, std::vector<std::string>& args)
+{
+    std::string buf;
+    char chunk[512];
+    std::size_t count = 0;
+    std::size_t start = std::string::npos;
+    while (true) {
+        if (std::string::npos == start) {
+            auto end = buf.find(count_separator);
+            if (std::string::npos != end) {
+                // Decimal digits only
+                if (0 == end || end != buf.find_first_not_of("0123456789")) return false;
+                count = std::strtoul(buf.c_str(), nullptr, 10);
+                if (max_args < count) return false;
+                start = end + 1;
+            }
+        }
+        if (std::string::npos != start) {
+            for (auto end = buf.find(arg_terminator, start); args.size() < count && std::string::npos != end;
+                end = buf.find(arg_terminator, start)) {
+                args.push_back(buf.substr(start, end - start));
+                start = end + 1;
+            }
+            if (args.size() == count) return true;
+        }
+        long len = cli::recv_some(sock, chunk, sizeof chunk);
+        if (len <= 0) return false;
+        buf.append(chunk, static_cast<std::size_t>(len));
+    }
+}
+
+// Sends the client's output as it is written, a line at a time
+class ReplyBuffer : public std::basic_streambuf<cli::text_char>
+{
+public:
+    explicit ReplyBuffer(cli::socket_t sock) : m_sock(sock) {}
+
+    // Sends the rest of the output, the status separator and the status
+    void finish(int status)
+    {
+        m_pending.push_back(status_separator);
+        m_pending.append(std::to_string(status));
+        send_pending();
+    }
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+        m_pending.push_back(static_cast<char>(traits_type::to_char_type(ch)));
+        if ('\n' == m_pending.back()) send_pending();
+        return ch;
+    }
+
+    int sync() override
+    {
+        send_pending();
+        return 0;
+    }
+
+private:
+    // A client that went away does not fail the command; the rest of its output is dropped
+    void send_pending()
+    {
+        if (m_connected) m_connected = cli::send_all(m_sock, m_pending.data(), m_pending.size());
+        m_pending.clear();
+    }
+
+    cli::socket_t m_sock;
+    std::string m_pending;
+    bool m_connected = true;
+};
+} // namespace impl
+
+namespace cli
+{
+std::string default_socket_path()
+{
+    std::error_code ec;
+    auto dir = fs::temp_directory_path(ec);
+    if (ec) return "RemoteCli.sock";
+    return (dir / "RemoteCli.sock").string();
+}
+
+bool serve_requests(const std::string& path, DaemonHandler handler, bool verbose)
+{
+    if (!socket_startup()) return false;
+
+    socket_t running = connect_local(path);
+    if (invalid_socket != running) {
+        close_socket(running);
+        tout << "Error: A daemon is already running on " << text(path.begin(), path.end()) << '\n';
+        return false;
+    }
+    socket_t server = listen_local(path);
+    if (invalid_socket == server) {
+        tout << "Error: Unable to listen on " << text(path.begin(), path.end()) << '\n';
+        return false;
+    }
+    if (verbose) tout << "Listening on " << text(path.begin(), path.end()) << '\n';
+
+    bool stop = false;
+    while (!stop) {
+        socket_t client = accept_client(server);
+        if (invalid_socket == client) continue;
+
+        std::vector<std::string> args;
+        if (impl::read_request(client, args)) {
+            impl::ReplyBuffer reply(client);
+            std::basic_ostream<text_char> out(&reply);
+            int status = handler(args, out, stop);
+            reply.finish(status);
+        }
+        close_socket(client);
+    }
+
+    close_socket(server);
+    std::remove(path.c_str());
+    return true;
+}
+
+bool forward_request(const std::string& path, const std::vector<std::string>& args, int& status)
+{
+    if (!socket_startup()) return false;
+
+    socket_t sock = connect_local(path);
+    if (invalid_socket == sock) return false;
+
+    std::string request = std::to_string(args.size());
+    request.push_back(impl::count_separator);
+    for (auto& arg : args) {
+        request.append(arg);
+        request.push_back(impl::arg_terminator);
+    }
+
+    // Print the output while the command runs; everything after the separator is the status
+    std::string trailer;
+    bool ended = false;
+    if (send_all(sock, request.data(), request.size())) {
+        char chunk[4096];
+        long len = 0;
+        while (0 < (len = recv_some(sock, chunk, sizeof chunk))) {
+            std::string received(chunk, static_cast<std::size_t>(len));
+            if (!ended) {
+                auto pos = received.find(impl::status_separator);
+                ended = (std::string::npos != pos);
+                tout << text(received.begin(), ended ? received.begin() + pos : received.end()) << std::flush;
+                if (ended) trailer.append(received, pos + 1, std::string::npos);
+            }
+            else {
+                trailer.append(received);
+            }
+        }
+    }
+    close_socket(sock);
+
+    if (!ended) {
+        tout << "Error: No reply from daemon\n";
+        status = EXIT_FAILURE;
+        return true;
+    }
+    status = std::atoi(trailer.c_str());
+    return true;
+}
+} // namespace cli
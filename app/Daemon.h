@@ -0,0 +1,27 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "Text.h"
+
+namespace cli
+{
+// Handles one request (the command line arguments of a client) and returns its exit status.
+// Output for the client goes to out and reaches it line by line while the command runs.
+// Set stop to shut the daemon down after replying.
+using DaemonHandler = std::function<int(const std::vector<std::string>& args, std::basic_ostream<text_char>& out, bool& stop)>;
+
+std::string default_socket_path();
+
+// Serves requests one at a time on a local socket until a handler sets stop.
+// Fails when another daemon already answers on path.
+bool serve_requests(const std::string& path, DaemonHandler handler, bool verbose);
+
+// Sends args to the daemon listening on path and prints its output as it arrives.
+// Returns false, without side effects, when no daemon is listening.
+bool forward_request(const std::string& path, const std::vector<std::string>& args, int& status);
+} // namespace cli
+
+#endif // !DAEMON_H
@@ -0,0 +1,259 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+
+namespace cli
+{
+// What post() does when the queue of the event's consumer is full
+enum class EventOverflow
+{
+    block,       // Waits for a consumer to make room; nothing is lost, but the posting thread is held up
+    drop_newest, // Discards the event being posted
+    drop_oldest  // Discards the oldest queued event to make room
+};
+
+struct EventBusStats
+{
+    std::uint64_t posted;  // Events queued, including those drop_oldest discarded later
+    std::uint64_t handled;
+    std::uint64_t dropped; // Events discarded by the overflow policy
+    std::uint64_t blocked; // Posts that had to wait for room
+    std::size_t depth;     // Events queued right now, over all consumers
+    std::size_t max_depth; // Most events queued at once in one consumer's queue
+    // Over the most recent events: time spent queued, and time in the handler
+    std::chrono::microseconds wait_p50;
+    std::chrono::microseconds wait_p99;
+    std::chrono::microseconds wait_max;
+    std::chrono::microseconds handler_p50;
+    std::chrono::microseconds handler_p99;
+    std::chrono::microseconds handler_max;
+};
+
+// Moves work off a thread that must not be held up, such as the SDK callback thread.
+// post() copies the event into a lock-free queue in constant time; consumer threads run the handler.
+// Each event goes to the consumer chosen by its key, so events with the same key are handled in order.
+template <typename Event>
+class EventBus
+{
+public:
+    using Handler = std::function<void(Event& event)>;
+    // Called on the posting thread with each event the overflow policy discards
+    using DropHandler = std::function<void(const Event& event)>;
+    // Tells which events drop_oldest must never discard
+    using KeepPredicate = std::function<bool(const Event& event)>;
+
+    EventBus(Handler handler, std::size_t capacity = 256, std::size_t consumers = 1, EventOverflow overflow = EventOverflow::block)
+        : m_handler(std::move(handler))
+        , m_overflow(overflow)
+    {
+        consumers = std::max<std::size_t>(consumers, 1);
+        for (std::size_t i = 0; i < consumers; ++i) m_consumers.emplace_back(new Consumer(capacity));
+        for (auto& consumer : m_consumers) consumer->thread = std::thread(&EventBus::run, this, consumer.get());
+    }
+
+    ~EventBus() { stop(); }
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    void set_overflow(EventOverflow overflow) { m_overflow = overflow; }
+    void set_drop_handler(DropHandler handler) { m_drop_handler = std::move(handler); }
+    void set_keep(KeepPredicate keep) { m_keep = std::move(keep); }
+
+    // False when the event was dropped or the bus is stopped
+    bool post(Event event, std::size_t key = 0) { return post(std::move(event), key, m_overflow.load(std::memory_order_relaxed)); }
+    // With the policy of this event instead of the bus's own
+    bool post(Event event, std::size_t key, EventOverflow overflow)
+    {
+        if (!m_running.load(std::memory_order_acquire)) return false;
+        auto& consumer = *m_consumers[key % m_consumers.size()];
+        Queued queued{ std::move(event), std::chrono::steady_clock::now() };
+
+        bool posted = consumer.queue.try_push(queued);
+        if (!posted) {
+            switch (overflow) {
+            case EventOverflow::block:
+                m_blocked.fetch_add(1, std::memory_order_relaxed);
+                while (!posted && m_running.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                    posted = consumer.queue.try_push(queued);
+                }
+                break;
+            case EventOverflow::drop_oldest:
+                // An event to keep goes to the back again instead; once a whole queue of them was passed over,
+                // this waits for room like block
+                for (std::size_t kept = 0; !posted && m_running.load(std::memory_order_acquire);) {
+                    Queued oldest;
+                    if (kept < consumer.queue.capacity() && consumer.queue.try_pop(oldest)) {
+                        if (m_keep && m_keep(oldest.event)) {
+                            ++kept;
+                            while (!consumer.queue.try_push(oldest) && m_running.load(std::memory_order_acquire)) std::this_thread::yield();
+                        }
+                        else {
+                            drop(oldest.event);
+                        }
+                    }
+                    else {
+                        std::this_thread::yield();
+                    }
+                    posted = consumer.queue.try_push(queued);
+                }
+                break;
+            case EventOverflow::drop_newest:
+                break;
+            }
+        }
+        if (!posted) {
+            drop(queued.event);
+            return false;
+        }
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+        auto depth = consumer.queue.size();
+        auto max_depth = m_max_depth.load(std::memory_order_relaxed);
+        while (max_depth < depth && !m_max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {}
+
+        // Pairs with the fence in run(): either the consumer sees the event before it sleeps, or this sees it sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer.sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(consumer.mtx);
+            consumer.cv.notify_one();
+        }
+        return true;
+    }
+
+    // Waits for the events being handled; the ones still queued are discarded and later posts are refused
+    void stop()
+    {
+        if (!m_running.exchange(false)) return;
+        for (auto& consumer : m_consumers) {
+            {
+                std::lock_guard<std::mutex> lock(consumer->mtx);
+                consumer->cv.notify_one();
+            }
+            if (consumer->thread.joinable()) consumer->thread.join();
+        }
+    }
+
+    EventBusStats stats() const
+    {
+        EventBusStats stats{};
+        stats.posted = m_posted.load();
+        stats.dropped = m_dropped.load();
+        stats.blocked = m_blocked.load();
+        stats.max_depth = m_max_depth.load();
+        for (auto& consumer : m_consumers) stats.depth += consumer->queue.size();
+
+        std::vector<std::uint32_t> wait;
+        std::vector<std::uint32_t> handler;
+        {
+            std::lock_guard<std::mutex> lock(m_stats_mtx);
+            stats.handled = m_handled;
+            auto count = std::min<std::size_t>(m_samples, latency_samples);
+            wait.assign(m_wait_us.begin(), m_wait_us.begin() + count);
+            handler.assign(m_handler_us.begin(), m_handler_us.begin() + count);
+        }
+        percentiles(wait, stats.wait_p50, stats.wait_p99, stats.wait_max);
+        percentiles(handler, stats.handler_p50, stats.handler_p99, stats.handler_max);
+        return stats;
+    }
+
+private:
+    static constexpr std::size_t const latency_samples = 1024;
+
+    struct Queued
+    {
+        Event event;
+        std::chrono::steady_clock::time_point posted;
+    };
+
+    struct Consumer
+    {
+        explicit Consumer(std::size_t capacity) : queue(capacity) {}
+
+        BoundedQueue<Queued> queue;
+        std::thread thread;
+        std::atomic<bool> sleeping{ false };
+        std::mutex mtx;
+        std::condition_variable cv;
+    };
+
+    void run(Consumer* consumer)
+    {
+        for (;;) {
+            Queued queued;
+            while (m_running.load(std::memory_order_acquire) && consumer->queue.try_pop(queued)) {
+                auto started = std::chrono::steady_clock::now();
+                m_handler(queued.event);
+                record(started - queued.posted, std::chrono::steady_clock::now() - started);
+            }
+            if (!m_running.load(std::memory_order_acquire)) return;
+
+            std::unique_lock<std::mutex> lock(consumer->mtx);
+            consumer->sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (consumer->queue.empty() && m_running.load()) consumer->cv.wait(lock);
+            consumer->sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void drop(const Event& event)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        if (m_drop_handler) m_drop_handler(event);
+    }
+
+    void record(std::chrono::steady_clock::duration wait, std::chrono::steady_clock::duration handler)
+    {
+        auto us = [](std::chrono::steady_clock::duration d) {
+            return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+        };
+        std::lock_guard<std::mutex> lock(m_stats_mtx);
+        m_wait_us[m_samples % latency_samples] = us(wait);
+        m_handler_us[m_samples % latency_samples] = us(handler);
+        ++m_samples;
+        ++m_handled;
+    }
+
+    static void percentiles(std::vector<std::uint32_t>& samples, std::chrono::microseconds& p50, std::chrono::microseconds& p99, std::chrono::microseconds& max)
+    {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end());
+        p50 = std::chrono::microseconds(samples[(samples.size() - 1) / 2]);
+        p99 = std::chrono::microseconds(samples[(samples.size() - 1) * 99 / 100]);
+        max = std::chrono::microseconds(samples.back());
+    }
+
+    Handler m_handler;
+    DropHandler m_drop_handler;
+    KeepPredicate m_keep;
+    std::atomic<EventOverflow> m_overflow;
+    std::vector<std::unique_ptr<Consumer>> m_consumers;
+    std::atomic<bool> m_running{ true };
+
+    std::atomic<std::uint64_t> m_posted{ 0 };
+    std::atomic<std::uint64_t> m_dropped{ 0 };
+    std::atomic<std::uint64_t> m_blocked{ 0 };
+    std::atomic<std::size_t> m_max_depth{ 0 };
+
+    // Written by the consumers after each event, never by post()
+    mutable std::mutex m_stats_mtx;
+    std::uint64_t m_handled = 0;
+    std::uint64_t m_samples = 0;
+    std::array<std::uint32_t, latency_samples> m_wait_us{};
+    std::array<std::uint32_t, latency_samples> m_handler_us{};
+};
+} // namespace cli
+
+#endif // !EVENTBUS_H
@@ -0,0 +1,73 @@
+#include "FocusStack.h"
+#include <algorithm>
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+FocusStack::FocusStack(CameraDevice& camera, std::size_t max_in_transfer)
+    : m_camera(camera)
+    , m_max_in_transfer(std::max<std::size_t>(max_in_transfer, 1))
+    , m_shots(camera)
+{}
+
+bool FocusStack::run(std::uint32_t slices, CrInt16 step, std::chrono::milliseconds download_timeout)
+{
+    m_slices.clear();
+    CrInt64 focus_mode = 0;
+    bool restore = m_camera.get_property_value(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode, focus_mode)
+        && SDK::CrFocusMode::CrFocus_MF != focus_mode;
+    // The camera would refocus on the half press and undo the steps
+    if (!m_camera.set_focusmode_manual()) return false;
+
+    bool success = m_shots.begin();
+    auto started = std::chrono::steady_clock::now();
+    auto previous_release = started;
+    for (std::uint32_t i = 0; i < slices; ++i) {
+        FocusSlice slice{ true, false, {}, {} };
+        if (0 < i) {
+            auto move_start = std::chrono::steady_clock::now();
+            slice.moved = m_camera.step_focus(step);
+            slice.move = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - move_start);
+        }
+
+        // The previous images kept downloading while the lens moved
+        m_shots.wait_for_transfers(m_max_in_transfer - 1, download_timeout);
+        auto release = std::chrono::steady_clock::now();
+        if (0 < i) slice.cycle = std::chrono::duration_cast<std::chrono::milliseconds>(release - previous_release);
+        previous_release = release;
+        slice.fired = m_shots.fire(i);
+
+        success = slice.fired && success;
+        m_slices.push_back(slice);
+        if (m_slice_sink) m_slice_sink(i, slice);
+    }
+    success = m_shots.finish(download_timeout) && success;
+    m_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+
+    if (restore) m_camera.set_property_value(SDK::CrDevicePropertyCode::CrDeviceProperty_FocusMode, focus_mode);
+    return success;
+}
+
+FocusStackStats FocusStack::stats() const
+{
+    FocusStackStats result{};
+    result.slices = static_cast<std::uint32_t>(m_slices.size());
+    result.elapsed = m_elapsed;
+
+    std::vector<std::chrono::milliseconds> cycles;
+    for (std::size_t i = 0; i < m_slices.size(); ++i) {
+        if (m_slices[i].fired) ++result.fired;
+        if (!m_slices[i].moved) ++result.unconfirmed_moves;
+        if (0 < i) cycles.push_back(m_slices[i].cycle);
+    }
+    if (!cycles.empty()) {
+        std::sort(cycles.begin(), cycles.end());
+        auto at = [&](double p) { return cycles[static_cast<std::size_t>(p * (cycles.size() - 1))]; };
+        result.cycle_p50 = at(0.50);
+        result.cycle_p90 = at(0.90);
+        result.cycle_max = at(1.0);
+    }
+    return result;
+}
+} // namespace cli
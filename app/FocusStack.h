@@ -0,0 +1,74 @@
+#ifndef FOCUSSTACK_H
+#define FOCUSSTACK_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BurstCapture.h"
+#include "CameraDevice.h"
+
+namespace cli
+{
+struct FocusSlice
+{
+    bool moved;  // The lens reported the end of the step; always true for the first slice
+    bool fired;  // Captured
+    std::chrono::milliseconds move;  // Focus step
+    std::chrono::milliseconds cycle; // Release of the previous slice to release of this one
+};
+
+struct FocusStackStats
+{
+    std::uint32_t slices;
+    std::uint32_t fired;
+    std::uint32_t unconfirmed_moves;
+    std::chrono::milliseconds elapsed;
+    std::chrono::milliseconds cycle_p50;
+    std::chrono::milliseconds cycle_p90;
+    std::chrono::milliseconds cycle_max;
+
+    double slices_per_minute() const
+    {
+        return 0 < elapsed.count() ? fired * 60000.0 / elapsed.count() : 0.0;
+    }
+};
+
+// Sweeps the focus in NearFar steps and takes a frame at each position.
+// Focus is manual during the sweep, and the focus mode in effect before is restored after it.
+// The lens moves to the next position while the previous image is still downloading;
+// a frame waits only when max_in_transfer images are in transfer.
+class FocusStack
+{
+public:
+    // Called after each slice was fired or given up on, on the caller's thread
+    using SliceSink = std::function<void(std::uint32_t slice, const FocusSlice& result)>;
+
+    FocusStack(CameraDevice& camera, std::size_t max_in_transfer);
+
+    FocusStack(const FocusStack&) = delete;
+    FocusStack& operator=(const FocusStack&) = delete;
+
+    void set_slice_sink(SliceSink sink) { m_slice_sink = std::move(sink); }
+    // Images are reported as they are saved, numbered by slice
+    void set_result_sink(BurstCapture::ResultSink sink) { m_shots.set_result_sink(std::move(sink)); }
+
+    // Takes slices frames, moving the focus by step (positive towards far) between them.
+    // True when every frame was saved.
+    bool run(std::uint32_t slices, CrInt16 step, std::chrono::milliseconds download_timeout);
+
+    const std::vector<FocusSlice>& slices() const { return m_slices; }
+    FocusStackStats stats() const;
+    BurstStats shot_stats() const { return m_shots.stats(); }
+
+private:
+    CameraDevice& m_camera;
+    std::size_t m_max_in_transfer;
+    BurstCapture m_shots;
+    SliceSink m_slice_sink;
+    std::vector<FocusSlice> m_slices;
+    std::chrono::milliseconds m_elapsed{ 0 };
+};
+} // namespace cli
+
+#endif // !FOCUSSTACK_H
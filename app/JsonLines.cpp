@@ -0,0 +1,221 @@
+#include "JsonLines.h"
+#include <cmath>
+#include <cstdio>
+
+namespace impl
+{
+constexpr char const hex_digits[] = "0123456789abcdef";
+} // namespace impl
+
+namespace cli
+{
+JsonLine::JsonLine(const char* event, const text& camera_id)
+{
+    m_line.reserve(256);
+    m_line.push_back(TEXT('{'));
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch());
+    field("ts", static_cast<long long>(now.count()));
+    field("camera", camera_id);
+    field("event", text(event, event + std::char_traits<char>::length(event)));
+}
+
+JsonLine& JsonLine::field(const char* name, const text& value)
+{
+    key(name);
+    append_string(value.data(), value.size());
+    return *this;
+}
+
+JsonLine& JsonLine::field(const char* name, const text_char* value)
+{
+    key(name);
+    if (nullptr == value) append("null");
+    else append_string(value, std::char_traits<text_char>::length(value));
+    return *this;
+}
+
+JsonLine& JsonLine::field(const char* name, double value)
+{
+    key(name);
+    if (!std::isfinite(value)) {
+        append("null");
+        return *this;
+    }
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.6g", value);
+    append(number);
+    return *this;
+}
+
+JsonLine& JsonLine::field(const char* name, bool value)
+{
+    key(name);
+    append(value ? "true" : "false");
+    return *this;
+}
+
+JsonLine& JsonLine::begin_array(const char* name)
+{
+    key(name);
+    m_line.push_back(TEXT('['));
+    m_first = true;
+    return *this;
+}
+
+JsonLine& JsonLine::end_array()
+{
+    m_line.push_back(TEXT(']'));
+    m_first = false;
+    return *this;
+}
+
+JsonLine& JsonLine::begin_object(const char* name)
+{
+    key(name);
+    m_line.push_back(TEXT('{'));
+    m_first = true;
+    return *this;
+}
+
+JsonLine& JsonLine::end_object()
+{
+    m_line.push_back(TEXT('}'));
+    m_first = false;
+    return *this;
+}
+
+const text& JsonLine::finish()
+{
+    if (!m_finished) {
+        m_line.push_back(TEXT('}'));
+        m_line.push_back(TEXT('\n'));
+        m_finished = true;
+    }
+    return m_line;
+}
+
+void JsonLine::key(const char* name)
+{
+    if (!m_first) m_line.push_back(TEXT(','));
+    m_first = false;
+    if (nullptr == name) return;
+    m_line.push_back(TEXT('"'));
+    append(name);
+    m_line.push_back(TEXT('"'));
+    m_line.push_back(TEXT(':'));
+}
+
+void JsonLine::append(const char* ascii)
+{
+    for (; *ascii; ++ascii) m_line.push_back(static_cast<text_char>(*ascii));
+}
+
+void JsonLine::append_string(const text_char* value, std::size_t size)
+{
+    m_line.push_back(TEXT('"'));
+    for (std::size_t i = 0; i < size; ++i) {
+        auto c = value[i];
+        switch (c) {
+        case TEXT('"'): append("\\\""); break;
+        case TEXT('\\'): append("\\\\"); break;
+        case TEXT('\n'): append("\\n"); break;
+        case TEXT('\r'): append("\\r"); break;
+        case TEXT('\t'): append("\\t"); break;
+        default:
+            // Other control characters; everything else, also non-ASCII, goes out as it is
+            if (0 <= c && c < 0x20) {
+                append("\\u00");
+                m_line.push_back(static_cast<text_char>(impl::hex_digits[c >> 4]));
+                m_line.push_back(static_cast<text_char>(impl::hex_digits[c & 0xF]));
+            }
+            else {
+                m_line.push_back(c);
+            }
+        }
+    }
+    m_line.push_back(TEXT('"'));
+}
+
+void JsonLine::append_integer(unsigned long long magnitude, bool negative)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (0 != magnitude);
+    if (negative) *--p = '-';
+    m_line.append(p, end);
+}
+
+JsonWriter::JsonWriter(std::basic_ostream<text_char>& out, std::size_t capacity, std::chrono::milliseconds flush_interval)
+    : m_out(out)
+    , m_capacity(capacity)
+    , m_flush_interval(flush_interval)
+{
+    m_buffer.reserve(capacity);
+    m_flusher = std::thread(&JsonWriter::run_flusher, this);
+}
+
+JsonWriter::~JsonWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+    m_flusher.join();
+    flush();
+}
+
+void JsonWriter::write(JsonLine& line)
+{
+    auto& finished = line.finish();
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_capacity < m_buffer.size() + finished.size()) flush_locked();
+        first = m_buffer.empty();
+        if (first) m_deadline = std::chrono::steady_clock::now() + m_flush_interval;
+        m_buffer.append(finished);
+        ++m_lines;
+    }
+    if (first) m_cv.notify_one();
+}
+
+void JsonWriter::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    flush_locked();
+}
+
+std::uint64_t JsonWriter::lines() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_lines;
+}
+
+void JsonWriter::run_flusher()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (!m_stopping) {
+        if (m_buffer.empty()) {
+            m_cv.wait(lock);
+            continue;
+        }
+        // A flush in between empties the buffer and the next line sets a new deadline
+        if (std::cv_status::timeout == m_cv.wait_until(lock, m_deadline) || m_deadline <= std::chrono::steady_clock::now()) {
+            flush_locked();
+        }
+    }
+}
+
+void JsonWriter::flush_locked()
+{
+    if (m_buffer.empty()) return;
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_out.flush();
+    m_buffer.clear();
+}
+} // namespace cli
@@ -0,0 +1,95 @@
+#ifndef JSONLINES_H
+#define JSONLINES_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include "Text.h"
+
+namespace cli
+{
+// One JSON object on one line, built in place in a single string.
+// Every line starts with the wall clock time in microseconds since the epoch, the camera ID and the event:
+//   {"ts":1760700000123456,"camera":"D0000001","event":"get",...}
+// Keys are plain ASCII and not escaped; string values are.
+class JsonLine
+{
+public:
+    JsonLine(const char* event, const text& camera_id);
+
+    JsonLine& field(const char* key, const text& value);
+    JsonLine& field(const char* key, const text_char* value);
+    JsonLine& field(const char* key, double value);
+    JsonLine& field(const char* key, bool value);
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    JsonLine& field(const char* name, T value)
+    {
+        key(name);
+        bool negative = std::is_signed<T>::value && value < 0;
+        append_integer(negative ? 0 - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value), negative);
+        return *this;
+    }
+
+    // Nested arrays and objects; fields inside an array take a null key
+    JsonLine& begin_array(const char* key);
+    JsonLine& end_array();
+    JsonLine& begin_object(const char* key);
+    JsonLine& end_object();
+
+    // Closes the object and ends the line; no fields can be added after it
+    const text& finish();
+
+private:
+    void key(const char* name);
+    void append(const char* ascii);
+    void append_string(const text_char* value, std::size_t size);
+    void append_integer(unsigned long long magnitude, bool negative);
+
+    text m_line;
+    bool m_first = true;
+    bool m_finished = false;
+};
+
+// Collects lines from any thread and writes them to a stream in large blocks.
+// Lines reach the stream once the buffer is full, at most flush_interval after they were written,
+// or on flush(); a line is never split across writes. A background thread keeps the deadline
+// when no further line arrives.
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::basic_ostream<text_char>& out, std::size_t capacity = 64 * 1024,
+        std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100));
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void write(JsonLine& line);
+    void flush();
+
+    std::uint64_t lines() const;
+
+private:
+    void flush_locked();
+    void run_flusher();
+
+    std::basic_ostream<text_char>& m_out;
+    std::size_t m_capacity;
+    std::chrono::milliseconds m_flush_interval;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    text m_buffer;
+    // When the oldest buffered line has to be written
+    std::chrono::steady_clock::time_point m_deadline;
+    std::uint64_t m_lines = 0;
+    bool m_stopping = false;
+    std::thread m_flusher;
+};
+} // namespace cli
+
+#endif // !JSONLINES_H
@@ -1,76 +1,134 @@
 ﻿#include "LibManager.h"
-#include <cstdlib>
-#if defined(_MSC_VER)
+#if defined(_WIN32)
 #include <Windows.h>
+#else
+#include <dlfcn.h>
 #endif
 #include "Text.h"
 
-namespace impl
+// Every function of CRLibInterface, in declaration order
+#define CR_LIB_FUNCTIONS(X) \
+    X(Init) \
+    X(Release) \
+    X(EnumCameraObjects) \
+    X(CreateCameraObjectInfo) \
+    X(EditSDKInfo) \
+    X(Connect) \
+    X(Disconnect) \
+    X(ReleaseDevice) \
+    X(GetDeviceProperties) \
+    X(GetSelectDeviceProperties) \
+    X(ReleaseDeviceProperties) \
+    X(SetDeviceProperty) \
+    X(SendCommand) \
+    X(GetLiveViewImage) \
+    X(GetLiveViewImageInfo) \
+    X(GetLiveViewProperties) \
+    X(GetSelectLiveViewProperties) \
+    X(ReleaseLiveViewProperties) \
+    X(GetDeviceSetting) \
+    X(SetDeviceSetting) \
+    X(SetSaveInfo) \
+    X(GetSDKVersion) \
+    X(GetSDKSerial) \
+    X(GetDateFolderList) \
+    X(GetContentsHandleList) \
+    X(GetContentsDetailInfo) \
+    X(ReleaseDateFolderList) \
+    X(ReleaseContentsHandleList) \
+    X(PullContentsFile) \
+    X(GetContentsThumbnailImage)
+
+namespace SDK = SCRSDK;
+
+namespace cli
 {
 struct LibraryHandle
 {
-
+#if defined(_WIN32)
+    HMODULE module;
+#else
+    void* module;
+#endif
 };
-} // namespace impl
+} // namespace cli
+
+namespace impl
+{
+void* find_symbol(cli::LibraryHandle* handle, const char* name)
+{
+#if defined(_WIN32)
+    return reinterpret_cast<void*>(GetProcAddress(handle->module, name));
+#else
+    return dlsym(handle->module, name);
+#endif
+}
 
-using LibraryHandle = impl::LibraryHandle;
+void close_library(cli::LibraryHandle* handle)
+{
+#if defined(_WIN32)
+    FreeLibrary(handle->module);
+#else
+    dlclose(handle->module);
+#endif
+    delete handle;
+}
+} // namespace impl
 
 namespace cli
 {
-CRLibInterface* load_cr_lib()
+CRLibInterface const* linked_cr_lib()
 {
-    CRLibInterface* cr_lib = new CRLibInterface;
+    static CRLibInterface const cr_lib = [] {
+        CRLibInterface linked{};
+#define CR_LIB_LINK(name) linked.name = &SDK::name;
+        CR_LIB_FUNCTIONS(CR_LIB_LINK)
+#undef CR_LIB_LINK
+        return linked;
+    }();
+    return &cr_lib;
+}
 
-#if defined(_MSC_VER)
-    cr_lib->m_handle = LoadLibraryEx(_T("LjCore.dll"), NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
-    if (!cr_lib->m_handle) {
-        tout << "Failed to load CrCore.dll. Abort.\n";
-        std::exit(EXIT_FAILURE);
+CRLibInterface* load_cr_lib(const std::string& path)
+{
+    auto* handle = new LibraryHandle;
+#if defined(_WIN32)
+    handle->module = LoadLibraryExA(path.c_str(), NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+    if (!handle->module) {
+        tout << "Error: Failed to load " << path.c_str() << "\n";
+        delete handle;
+        return nullptr;
     }
-
-    cr_lib->Init = CrInit(GetProcAddress(cr_lib->m_handle, "Init"));
-    cr_lib->Release = CrRelease(GetProcAddress(cr_lib->m_handle, "Release"));
-    cr_lib->EnumCameraObjects = CrEnumCameraObjects(GetProcAddress(cr_lib->m_handle, "EnumCameraObjects"));
-    cr_lib->CreateCameraObjectInfo = CrCreateCameraObjectInfo(GetProcAddress(cr_lib->m_handle, "CreateCameraObjectInfo"));
-    cr_lib->Connect = CrConnect(GetProcAddress(cr_lib->m_handle, "Connect"));
-    cr_lib->Disconnect = CrDisconnect(GetProcAddress(cr_lib->m_handle, "Disconnect"));
-    cr_lib->FinalizeDevice = CrFinalizeDevice(GetProcAddress(cr_lib->m_handle, "FinalizeDevice"));
-    cr_lib->GetDeviceProperties = CrGetDeviceProperties(GetProcAddress(cr_lib->m_handle, "GetDeviceProperties"));
-    cr_lib->ReleaseDeviceProperties = CrReleaseDeviceProperties(GetProcAddress(cr_lib->m_handle, "ReleaseDeviceProperties"));
-    cr_lib->SetDeviceProperty = CrSetDeviceProperty(GetProcAddress(cr_lib->m_handle, "SetDeviceProperty"));
-    cr_lib->SendCommand = CrSendCommand(GetProcAddress(cr_lib->m_handle, "SendCommond"));
-    cr_lib->SetSaveInfo = CrSetSaveInfo(GetProcAddress(cr_lib->m_handle, "SetSaveInfo"));
-#endif // defined(_MSC_VER)
-
-    if (!cr_lib->Init
-        || !cr_lib->Release
-        || !cr_lib->EnumCameraObjects
-        || !cr_lib->CreateCameraObjectInfo
-        || !cr_lib->Connect
-        || !cr_lib->Disconnect
-        || !cr_lib->FinalizeDevice
-        || !cr_lib->GetDeviceProperties
-        || !cr_lib->ReleaseDeviceProperties
-        || !cr_lib->SetDeviceProperty
-        || !cr_lib->SendCommand
-        || !cr_lib->SetSaveInfo)
-    {
-        tout << "CrCore.dll functions failed to load properly. Aborting.\n";
-        std::exit(EXIT_FAILURE);
+#else
+    handle->module = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle->module) {
+        tout << "Error: Failed to load " << dlerror() << "\n";
+        delete handle;
+        return nullptr;
     }
+#endif
 
-    tout << "Successfully loaded CrCore.dll\n\n";
+    CRLibInterface* cr_lib = new CRLibInterface{};
+    cr_lib->m_handle = handle;
+    char const* missing = nullptr;
+#define CR_LIB_LOAD(name) \
+    cr_lib->name = reinterpret_cast<decltype(cr_lib->name)>(impl::find_symbol(handle, #name)); \
+    if (!cr_lib->name && !missing) missing = #name;
+    CR_LIB_FUNCTIONS(CR_LIB_LOAD)
+#undef CR_LIB_LOAD
 
+    if (missing) {
+        tout << "Error: " << path.c_str() << " has no function " << missing << "\n";
+        free_cr_lib(&cr_lib);
+        return nullptr;
+    }
     return cr_lib;
 }
 
 void free_cr_lib(CRLibInterface** cr_lib)
 {
-#if defined(_MSC_VER)
-    FreeLibrary((*cr_lib)->m_handle);
-#endif // defined(_MSC_VER)
+    if ((*cr_lib)->m_handle) impl::close_library((*cr_lib)->m_handle);
     delete *cr_lib;
     *cr_lib = nullptr;
-    tout << "Unloaded CrCore library\n";
 }
 } // namespace cli
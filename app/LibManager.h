@@ -1,50 +1,89 @@
 ﻿#ifndef LIBMANAGER_H
 #define LIBMANAGER_H
 
-#include <functional>
+#include <string>
 #include "CRSDK/CameraRemote_SDK.h"
 
-using namespace SCRSDK;
-
 namespace cli
 {
-using CrInit                    = bool (*)(CrInt32u);
-using CrRelease                 = bool (*)();
-using CrEnumCameraObjects       = CrError(*)(ICrEnumCameraObjectInfo**, CrInt8u);
-using CrCreateCameraObjectInfo  = ICrCameraObjectInfo * (*)(CrChar*, CrChar*, CrInt16, CrInt32u, CrInt32u, CrInt8u*, CrChar*, CrChar*, CrChar*);
-using CrConnect                 = CrError(*)(const ICrCameraObjectInfo*, IDeviceCallback*, CrDeviceHandle*);
-using CrDisconnect              = CrError(*)(CrDeviceHandle);
-using CrFinalizeDevice          = CrError(*)(CrDeviceHandle);
-using CrGetDeviceProperties     = CrError(*)(CrDeviceHandle, CrDeviceProperty**, int*);
-using CrReleaseDeviceProperties = CrError(*)(CrDeviceHandle, CrDeviceProperty*);
-using CrSetDeviceProperty       = CrError(*)(CrDeviceHandle, CrDeviceProperty*);
-using CrSendCommand             = CrError(*)(CrDeviceHandle, CrInt32u, CrCommandParam);
-using CrSetSaveInfo             = CrError(*)(CrDeviceHandle, CrChar*, CrChar*, CrInt32);
+using CrInit                        = bool (*)(CrInt32u);
+using CrRelease                     = bool (*)();
+using CrEnumCameraObjects           = SCRSDK::CrError(*)(SCRSDK::ICrEnumCameraObjectInfo**, CrInt8u);
+using CrCreateCameraObjectInfo      = SCRSDK::ICrCameraObjectInfo * (*)(CrChar*, CrChar*, CrInt16, CrInt32u, CrInt32u, CrInt8u*, CrChar*, CrChar*, CrChar*);
+using CrEditSDKInfo                 = SCRSDK::CrError(*)(CrInt16u);
+using CrConnect                     = SCRSDK::CrError(*)(SCRSDK::ICrCameraObjectInfo*, SCRSDK::IDeviceCallback*, SCRSDK::CrDeviceHandle*, SCRSDK::CrSdkControlMode);
+using CrDisconnect                  = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle);
+using CrReleaseDevice               = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle);
+using CrGetDeviceProperties         = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrDeviceProperty**, CrInt32*);
+using CrGetSelectDeviceProperties   = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, CrInt32u, CrInt32u*, SCRSDK::CrDeviceProperty**, CrInt32*);
+using CrReleaseDeviceProperties     = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrDeviceProperty*);
+using CrSetDeviceProperty           = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrDeviceProperty*);
+using CrSendCommand                 = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, CrInt32u, SCRSDK::CrCommandParam);
+using CrGetLiveViewImage            = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrImageDataBlock*);
+using CrGetLiveViewImageInfo        = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrImageInfo*);
+using CrGetLiveViewProperties       = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrLiveViewProperty**, CrInt32*);
+using CrGetSelectLiveViewProperties = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, CrInt32u, CrInt32u*, SCRSDK::CrLiveViewProperty**, CrInt32*);
+using CrReleaseLiveViewProperties   = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrLiveViewProperty*);
+using CrGetDeviceSetting            = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, CrInt32u, CrInt32u*);
+using CrSetDeviceSetting            = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, CrInt32u, CrInt32u);
+using CrSetSaveInfo                 = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, CrChar*, CrChar*, CrInt32);
+using CrGetSDKVersion               = CrInt32u(*)();
+using CrGetSDKSerial                = CrInt32u(*)();
+using CrGetDateFolderList           = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrMtpFolderInfo**, CrInt32u*);
+using CrGetContentsHandleList       = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrFolderHandle, SCRSDK::CrContentHandle**, CrInt32u*);
+using CrGetContentsDetailInfo       = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrContentHandle, SCRSDK::CrMtpContentsInfo*);
+using CrReleaseDateFolderList       = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrMtpFolderInfo*);
+using CrReleaseContentsHandleList   = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrContentHandle*);
+using CrPullContentsFile            = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrContentHandle, SCRSDK::CrPropertyStillImageTransSize, CrChar*, CrChar*);
+using CrGetContentsThumbnailImage   = SCRSDK::CrError(*)(SCRSDK::CrDeviceHandle, SCRSDK::CrContentHandle, SCRSDK::CrImageDataBlock*);
 
 // Forward declare
 struct LibraryHandle;
 
-class CRLibInterface
+// The camera SDK functions the app calls. Every call goes through one of these tables,
+// so the SDK linked into the executable can be swapped for another build, such as the simulated camera.
+// Function pointers have no default arguments: callers pass every one.
+struct CRLibInterface
 {
-public:
     CrInit Init;
     CrRelease Release;
     CrEnumCameraObjects EnumCameraObjects;
     CrCreateCameraObjectInfo CreateCameraObjectInfo;
+    CrEditSDKInfo EditSDKInfo;
     CrConnect Connect;
     CrDisconnect Disconnect;
-    CrFinalizeDevice FinalizeDevice;
+    CrReleaseDevice ReleaseDevice;
     CrGetDeviceProperties GetDeviceProperties;
+    CrGetSelectDeviceProperties GetSelectDeviceProperties;
     CrReleaseDeviceProperties ReleaseDeviceProperties;
     CrSetDeviceProperty SetDeviceProperty;
     CrSendCommand SendCommand;
+    CrGetLiveViewImage GetLiveViewImage;
+    CrGetLiveViewImageInfo GetLiveViewImageInfo;
+    CrGetLiveViewProperties GetLiveViewProperties;
+    CrGetSelectLiveViewProperties GetSelectLiveViewProperties;
+    CrReleaseLiveViewProperties ReleaseLiveViewProperties;
+    CrGetDeviceSetting GetDeviceSetting;
+    CrSetDeviceSetting SetDeviceSetting;
     CrSetSaveInfo SetSaveInfo;
+    CrGetSDKVersion GetSDKVersion;
+    CrGetSDKSerial GetSDKSerial;
+    CrGetDateFolderList GetDateFolderList;
+    CrGetContentsHandleList GetContentsHandleList;
+    CrGetContentsDetailInfo GetContentsDetailInfo;
+    CrReleaseDateFolderList ReleaseDateFolderList;
+    CrReleaseContentsHandleList ReleaseContentsHandleList;
+    CrPullContentsFile PullContentsFile;
+    CrGetContentsThumbnailImage GetContentsThumbnailImage;
 
-private:
-    LibraryHandle* m_handle;
+    LibraryHandle* m_handle; // nullptr for the linked SDK
 };
 
-CRLibInterface* load_cr_lib();
+// The SDK the executable was linked with; never freed
+CRLibInterface const* linked_cr_lib();
+// Loads the SDK from a shared library, such as the simulated camera.
+// nullptr, with the reason printed, when the library or one of its functions is missing.
+CRLibInterface* load_cr_lib(const std::string& path);
 void free_cr_lib(CRLibInterface** cr_lib);
 } // namespace cli
 
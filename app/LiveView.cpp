@@ -0,0 +1,324 @@
+#include "LiveView.h"
+#include <algorithm>
+
+namespace SDK = SCRSDK;
+using namespace std::chrono_literals;
+
+// Pause before polling again when the camera has no new frame
+#define FRAME_RETRY_TIME 2ms
+// Pause after an error so that a disconnected camera is not polled in a tight loop
+#define ERROR_RETRY_TIME 100ms
+// How long the fetch thread waits for a consumer to release a buffer
+#define FREE_BUFFER_TIMEOUT 100ms
+
+namespace cli
+{
+LiveViewFrame::LiveViewFrame(LiveViewStream* stream, std::size_t slot)
+    : m_stream(stream)
+    , m_slot(slot)
+{}
+
+LiveViewFrame::LiveViewFrame(const LiveViewFrame& other)
+    : m_stream(other.m_stream)
+    , m_slot(other.m_slot)
+{
+    if (m_stream) m_stream->add_ref(m_slot);
+}
+
+LiveViewFrame::LiveViewFrame(LiveViewFrame&& other) noexcept
+    : m_stream(other.m_stream)
+    , m_slot(other.m_slot)
+{
+    other.m_stream = nullptr;
+}
+
+LiveViewFrame& LiveViewFrame::operator=(LiveViewFrame other) noexcept
+{
+    std::swap(m_stream, other.m_stream);
+    std::swap(m_slot, other.m_slot);
+    return *this;
+}
+
+LiveViewFrame::~LiveViewFrame()
+{
+    if (m_stream) m_stream->release(m_slot);
+}
+
+// The slot fields below are only written while no handle refers to the slot
+const std::uint8_t* LiveViewFrame::data() const
+{
+    return m_stream->m_slots[m_slot].image;
+}
+
+std::size_t LiveViewFrame::size() const
+{
+    return m_stream->m_slots[m_slot].image_size;
+}
+
+std::uint64_t LiveViewFrame::sequence() const
+{
+    return m_stream->m_slots[m_slot].sequence;
+}
+
+std::chrono::steady_clock::time_point LiveViewFrame::captured() const
+{
+    return m_stream->m_slots[m_slot].captured;
+}
+
+LiveViewStream::LiveViewStream(CRLibInterface const* cr_lib, SDK::CrDeviceHandle device_handle)
+    : m_cr_lib(cr_lib)
+    , m_device_handle(device_handle)
+{}
+
+LiveViewStream::~LiveViewStream()
+{
+    stop();
+}
+
+bool LiveViewStream::start(std::size_t buffers)
+{
+    if (m_running) return true;
+    if (buffers < 3) buffers = 3;
+    {
+        // Frames handed out before stop() still point into the pool that is about to be replaced
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (std::size_t i = 0; i < m_slot_count; ++i) {
+            if (0 < m_slots[i].refs) return false;
+        }
+    }
+
+    SDK::CrImageInfo info;
+    auto err = m_cr_lib->GetLiveViewImageInfo(m_device_handle, &info);
+    if (CR_FAILED(err) || info.GetBufferSize() < 1) {
+        return false;
+    }
+
+    m_buffer_size = info.GetBufferSize();
+    m_slot_count = buffers;
+    m_slots.reset(new Slot[buffers]);
+    for (std::size_t i = 0; i < buffers; ++i) {
+        m_slots[i].buffer.resize(m_buffer_size);
+    }
+
+    m_latest = no_slot;
+    m_latest_taken = false;
+    m_sequence = 0;
+    m_frames = m_not_updated = m_dropped = m_errors = 0;
+    m_latency_count = 0;
+    m_started = std::chrono::steady_clock::now();
+
+    m_running = true;
+    m_thread = std::thread(&LiveViewStream::run, this);
+    return true;
+}
+
+void LiveViewStream::stop()
+{
+    if (!m_running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stopped = std::chrono::steady_clock::now();
+    }
+    m_free_cv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+    m_frame_cv.notify_all();
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (auto& waiting : m_waiting) waiting.set_value(LiveViewFrame());
+    m_waiting.clear();
+}
+
+LiveViewFrame LiveViewStream::latest()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (no_slot == m_latest) return LiveViewFrame();
+    ++m_slots[m_latest].refs;
+    m_latest_taken = true;
+    return LiveViewFrame(this, m_latest);
+}
+
+LiveViewFrame LiveViewStream::wait_next(std::uint64_t sequence, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    bool arrived = m_frame_cv.wait_for(lock, timeout, [&] {
+        return !m_running || (no_slot != m_latest && sequence < m_slots[m_latest].sequence);
+    });
+    if (!arrived || no_slot == m_latest || m_slots[m_latest].sequence <= sequence) return LiveViewFrame();
+    ++m_slots[m_latest].refs;
+    m_latest_taken = true;
+    return LiveViewFrame(this, m_latest);
+}
+
+std::future<LiveViewFrame> LiveViewStream::next(std::uint64_t sequence)
+{
+    std::promise<LiveViewFrame> promise;
+    auto future = promise.get_future();
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (no_slot != m_latest && sequence < m_slots[m_latest].sequence) {
+        ++m_slots[m_latest].refs;
+        m_latest_taken = true;
+        promise.set_value(LiveViewFrame(this, m_latest));
+    }
+    else if (!m_running) {
+        promise.set_value(LiveViewFrame());
+    }
+    else {
+        m_waiting.push_back(std::move(promise));
+    }
+    return future;
+}
+
+LiveViewStats LiveViewStream::stats() const
+{
+    LiveViewStats result{};
+    std::vector<std::uint32_t> latencies;
+    auto until = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (!m_running) until = m_stopped;
+        result.frames = m_frames;
+        result.not_updated = m_not_updated;
+        result.dropped = m_dropped;
+        result.errors = m_errors;
+        auto count = std::min(m_latency_count, latency_samples);
+        latencies.assign(m_latency_us.begin(), m_latency_us.begin() + count);
+    }
+
+    std::chrono::duration<double> elapsed = until - m_started;
+    if (0 < elapsed.count()) result.fps = result.frames / elapsed.count();
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        auto at = [&](double p) { return std::chrono::microseconds(latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]); };
+        result.latency_p50 = at(0.50);
+        result.latency_p90 = at(0.90);
+        result.latency_p99 = at(0.99);
+        result.latency_max = at(1.0);
+    }
+    return result;
+}
+
+void LiveViewStream::run()
+{
+    while (m_running) {
+        auto slot = acquire_slot();
+        if (no_slot == slot) continue;
+
+        auto& frame = m_slots[slot];
+        frame.block.SetSize(static_cast<CrInt32u>(frame.buffer.size()));
+        frame.block.SetData(frame.buffer.data());
+
+        auto begin = std::chrono::steady_clock::now();
+        auto err = m_cr_lib->GetLiveViewImage(m_device_handle, &frame.block);
+        auto end = std::chrono::steady_clock::now();
+
+        if (SDK::CrWarning_Frame_NotUpdated == err) {
+            // The slot was never handed out, so it simply goes back to the pool
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                ++m_not_updated;
+            }
+            std::this_thread::sleep_for(FRAME_RETRY_TIME);
+            continue;
+        }
+        if (SDK::CrError_Memory_Insufficient == err) {
+            // Frames got larger (e.g. image quality changed); grow the buffers once
+            if (!resize_buffers()) std::this_thread::sleep_for(ERROR_RETRY_TIME);
+            continue;
+        }
+        if (CR_FAILED(err) || 0 == frame.block.GetImageSize()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                ++m_errors;
+            }
+            std::this_thread::sleep_for(ERROR_RETRY_TIME);
+            continue;
+        }
+
+        frame.image = frame.block.GetImageData();
+        frame.image_size = frame.block.GetImageSize();
+        record_latency(end - begin);
+        publish(slot, end);
+    }
+}
+
+std::size_t LiveViewStream::acquire_slot()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    auto find_free = [&] {
+        for (std::size_t i = 0; i < m_slot_count; ++i) {
+            if (i != m_latest && 0 == m_slots[i].refs) return i;
+        }
+        return no_slot;
+    };
+
+    auto slot = find_free();
+    if (no_slot == slot) {
+        // Every buffer is held by consumers; the frames the camera produces meanwhile are lost
+        ++m_dropped;
+        m_free_cv.wait_for(lock, FREE_BUFFER_TIMEOUT, [&] { return !m_running || no_slot != find_free(); });
+        slot = m_running ? find_free() : no_slot;
+    }
+    if (no_slot != slot && m_slots[slot].buffer.size() < m_buffer_size) {
+        m_slots[slot].buffer.resize(m_buffer_size);
+    }
+    return slot;
+}
+
+void LiveViewStream::publish(std::size_t slot, std::chrono::steady_clock::time_point captured)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (no_slot != m_latest && !m_latest_taken) ++m_dropped;
+        m_slots[slot].sequence = ++m_sequence;
+        m_slots[slot].captured = captured;
+        m_latest = slot;
+        m_latest_taken = !m_waiting.empty();
+        ++m_frames;
+        for (auto& waiting : m_waiting) {
+            ++m_slots[slot].refs;
+            waiting.set_value(LiveViewFrame(this, slot));
+        }
+        m_waiting.clear();
+    }
+    m_frame_cv.notify_all();
+}
+
+void LiveViewStream::record_latency(std::chrono::steady_clock::duration latency)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_latency_us[m_latency_count % latency_samples] = static_cast<std::uint32_t>(us);
+    ++m_latency_count;
+}
+
+bool LiveViewStream::resize_buffers()
+{
+    SDK::CrImageInfo info;
+    auto err = m_cr_lib->GetLiveViewImageInfo(m_device_handle, &info);
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (CR_FAILED(err) || info.GetBufferSize() <= m_buffer_size) {
+        ++m_errors;
+        return false;
+    }
+    // Buffers in use keep their size until they are next acquired
+    m_buffer_size = info.GetBufferSize();
+    return true;
+}
+
+void LiveViewStream::add_ref(std::size_t slot)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    ++m_slots[slot].refs;
+}
+
+void LiveViewStream::release(std::size_t slot)
+{
+    bool freed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        freed = (0 == --m_slots[slot].refs);
+    }
+    if (freed) m_free_cv.notify_one();
+}
+} // namespace cli
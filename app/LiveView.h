@@ -0,0 +1,142 @@
+#ifndef LIVEVIEW_H
+#define LIVEVIEW_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "LibManager.h"
+
+namespace cli
+{
+class LiveViewStream;
+
+struct LiveViewStats
+{
+    std::uint64_t frames;      // Frames received from the camera
+    std::uint64_t not_updated; // Polls answered with CrWarning_Frame_NotUpdated
+    std::uint64_t dropped;     // Frames replaced before any consumer took them, or not fetched for lack of a free buffer
+    std::uint64_t errors;
+    double fps;
+    // GetLiveViewImage duration over the most recent frames
+    std::chrono::microseconds latency_p50;
+    std::chrono::microseconds latency_p90;
+    std::chrono::microseconds latency_p99;
+    std::chrono::microseconds latency_max;
+};
+
+// Handle to a frame in the stream's buffer pool. The buffer is not reused while any copy is alive,
+// so consumers read the JPEG in place. Handles must not outlive the stream.
+class LiveViewFrame
+{
+public:
+    LiveViewFrame() = default;
+    LiveViewFrame(const LiveViewFrame& other);
+    LiveViewFrame(LiveViewFrame&& other) noexcept;
+    LiveViewFrame& operator=(LiveViewFrame other) noexcept;
+    ~LiveViewFrame();
+
+    explicit operator bool() const { return nullptr != m_stream; }
+
+    const std::uint8_t* data() const;
+    std::size_t size() const;
+    // Increases by one with every frame received, so gaps are frames this consumer missed
+    std::uint64_t sequence() const;
+    std::chrono::steady_clock::time_point captured() const;
+
+private:
+    friend class LiveViewStream;
+    LiveViewFrame(LiveViewStream* stream, std::size_t slot);
+
+    LiveViewStream* m_stream = nullptr;
+    std::size_t m_slot = 0;
+};
+
+// Fetches live view frames on a dedicated thread at the rate the camera produces them.
+// Buffers are allocated once at start and recycled; only the latest frame is kept for consumers.
+class LiveViewStream
+{
+public:
+    LiveViewStream(CRLibInterface const* cr_lib, SCRSDK::CrDeviceHandle device_handle);
+    ~LiveViewStream();
+
+    LiveViewStream(const LiveViewStream&) = delete;
+    LiveViewStream& operator=(const LiveViewStream&) = delete;
+
+    // buffers must leave room for the frame being fetched, the latest frame and the frames held by consumers.
+    // A restart fails while frames from the previous run are still held.
+    bool start(std::size_t buffers = 4);
+    void stop();
+    bool is_running() const { return m_running.load(); }
+
+    // Latest frame, or an empty handle if none arrived yet
+    LiveViewFrame latest();
+    // Waits for a frame newer than sequence; returns an empty handle on timeout or stop
+    LiveViewFrame wait_next(std::uint64_t sequence, std::chrono::milliseconds timeout);
+    // Ready with the first frame newer than sequence as soon as the fetch thread publishes it,
+    // or with an empty handle once the stream stopped
+    std::future<LiveViewFrame> next(std::uint64_t sequence);
+
+    LiveViewStats stats() const;
+
+private:
+    friend class LiveViewFrame;
+
+    static constexpr std::size_t const latency_samples = 1024;
+    static constexpr std::size_t const no_slot = static_cast<std::size_t>(-1);
+
+    struct Slot
+    {
+        std::vector<CrInt8u> buffer;
+        SCRSDK::CrImageDataBlock block;
+        const CrInt8u* image = nullptr; // JPEG inside buffer
+        std::size_t image_size = 0;
+        std::uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point captured;
+        int refs = 0; // Consumer handles, guarded by m_mtx
+    };
+
+    void run();
+    std::size_t acquire_slot();
+    void publish(std::size_t slot, std::chrono::steady_clock::time_point captured);
+    void record_latency(std::chrono::steady_clock::duration latency);
+    bool resize_buffers();
+    void add_ref(std::size_t slot);
+    void release(std::size_t slot);
+
+    CRLibInterface const* m_cr_lib;
+    SCRSDK::CrDeviceHandle m_device_handle;
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_slot_count = 0;
+    std::size_t m_buffer_size = 0;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_frame_cv; // A frame was published or the stream stopped
+    std::condition_variable m_free_cv;  // A consumer released a buffer
+    std::size_t m_latest = no_slot;
+    bool m_latest_taken = false;
+    std::uint64_t m_sequence = 0;
+    std::vector<std::promise<LiveViewFrame>> m_waiting; // Callers of next() until the next frame
+
+    std::chrono::steady_clock::time_point m_started;
+    std::chrono::steady_clock::time_point m_stopped;
+    std::uint64_t m_frames = 0;
+    std::uint64_t m_not_updated = 0;
+    std::uint64_t m_dropped = 0;
+    std::uint64_t m_errors = 0;
+    std::array<std::uint32_t, latency_samples> m_latency_us{};
+    std::size_t m_latency_count = 0;
+};
+} // namespace cli
+
+#endif // !LIVEVIEW_H
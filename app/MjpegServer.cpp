@@ -0,0 +1,157 @@
+#include "MjpegServer.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace std::chrono_literals;
+
+// How often blocked calls look at the stop flag
+#define POLL_INTERVAL_MS 200
+// A client that cannot take a frame within this time is disconnected
+#define SEND_TIMEOUT_MS 5000
+
+namespace impl
+{
+constexpr char const stream_header[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Cache-Control: no-cache, no-store\r\n"
+    "Pragma: no-cache\r\n"
+    "Connection: close\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+    "\r\n";
+
+constexpr char const busy_response[] =
+    "HTTP/1.0 503 Service Unavailable\r\n"
+    "Connection: close\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+// Reads and discards the request; any path gets the stream
+bool read_request(cli::socket_t sock)
+{
+    char buf[1024];
+    std::size_t filled = 0;
+    while (cli::wait_readable(sock, SEND_TIMEOUT_MS)) {
+        long len = cli::recv_some(sock, buf + filled, sizeof buf - 1 - filled);
+        if (len <= 0) return false;
+        filled += static_cast<std::size_t>(len);
+        buf[filled] = '\0';
+        if (std::strstr(buf, "\r\n\r\n") || std::strstr(buf, "\n\n")) return true;
+        // Only the end of the headers matters, keep the tail in case it straddles two reads
+        if (sizeof buf - 1 == filled) {
+            std::memmove(buf, buf + filled - 3, 3);
+            filled = 3;
+        }
+    }
+    return false;
+}
+} // namespace impl
+
+namespace cli
+{
+MjpegServer::MjpegServer(LiveViewStream& stream, std::size_t max_clients)
+    : m_stream(stream)
+    , m_max_clients(max_clients)
+{}
+
+MjpegServer::~MjpegServer()
+{
+    stop();
+}
+
+bool MjpegServer::start(std::uint16_t port)
+{
+    if (m_running) return true;
+    if (!socket_startup()) return false;
+
+    m_server = listen_tcp(port);
+    if (invalid_socket == m_server) return false;
+
+    m_running = true;
+    m_accept_thread = std::thread(&MjpegServer::accept_clients, this);
+    return true;
+}
+
+void MjpegServer::stop()
+{
+    if (!m_running.exchange(false)) return;
+    if (m_accept_thread.joinable()) m_accept_thread.join();
+    reap_clients(true);
+    close_socket(m_server);
+    m_server = invalid_socket;
+}
+
+MjpegServerStats MjpegServer::stats() const
+{
+    return MjpegServerStats{ m_served.load(), m_sent.load(), m_skipped.load(), m_rejected.load() };
+}
+
+void MjpegServer::accept_clients()
+{
+    while (m_running) {
+        reap_clients(false);
+        if (!wait_readable(m_server, POLL_INTERVAL_MS)) continue;
+
+        socket_t sock = accept_client(m_server);
+        if (invalid_socket == sock) continue;
+
+        if (m_max_clients <= m_clients.size()) {
+            send_all(sock, impl::busy_response, sizeof impl::busy_response - 1);
+            close_socket(sock);
+            ++m_rejected;
+            continue;
+        }
+
+        set_send_timeout(sock, SEND_TIMEOUT_MS);
+        m_clients.emplace_back();
+        auto& client = m_clients.back();
+        client.sock = sock;
+        client.thread = std::thread(&MjpegServer::serve_client, this, std::ref(client));
+        ++m_served;
+    }
+}
+
+void MjpegServer::serve_client(Client& client)
+{
+    if (impl::read_request(client.sock)
+        && send_all(client.sock, impl::stream_header, sizeof impl::stream_header - 1)) {
+        std::uint64_t sequence = 0;
+        char part[128];
+        while (m_running) {
+            auto frame = m_stream.wait_next(sequence, std::chrono::milliseconds(POLL_INTERVAL_MS));
+            if (!frame) {
+                if (!m_stream.is_running()) break;
+                continue;
+            }
+            if (0 != sequence && sequence + 1 < frame.sequence()) {
+                m_skipped += frame.sequence() - sequence - 1;
+            }
+            sequence = frame.sequence();
+
+            // The JPEG goes out of the stream's buffer as is; only the part header is formatted here
+            int len = std::snprintf(part, sizeof part,
+                "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %zu\r\n\r\n", frame.size());
+            if (!send_all(client.sock, part, static_cast<std::size_t>(len))
+                || !send_all(client.sock, reinterpret_cast<const char*>(frame.data()), frame.size())
+                || !send_all(client.sock, "\r\n", 2)) {
+                break;
+            }
+            ++m_sent;
+        }
+    }
+    close_socket(client.sock);
+    client.done = true;
+}
+
+void MjpegServer::reap_clients(bool all)
+{
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+        if (all || it->done) {
+            if (it->thread.joinable()) it->thread.join();
+            it = m_clients.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+} // namespace cli
@@ -0,0 +1,66 @@
+#ifndef MJPEGSERVER_H
+#define MJPEGSERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+#include "LiveView.h"
+#include "Socket.h"
+
+namespace cli
+{
+struct MjpegServerStats
+{
+    std::uint64_t clients;  // Clients served since start
+    std::uint64_t sent;     // Frames sent, over all clients
+    std::uint64_t skipped;  // Frames a client missed because it was still sending the previous one
+    std::uint64_t rejected; // Clients turned away because max_clients were connected
+};
+
+// Serves the frames of a LiveViewStream as multipart/x-mixed-replace JPEG over HTTP on the loopback interface.
+// Every client sends straight from the stream's frame buffers and always jumps to the latest frame,
+// so a slow client skips frames instead of holding back the stream or the other clients.
+class MjpegServer
+{
+public:
+    // Each client holds at most one frame, so the stream needs max_clients + 2 buffers to never run dry
+    MjpegServer(LiveViewStream& stream, std::size_t max_clients);
+    ~MjpegServer();
+
+    MjpegServer(const MjpegServer&) = delete;
+    MjpegServer& operator=(const MjpegServer&) = delete;
+
+    bool start(std::uint16_t port);
+    void stop();
+
+    MjpegServerStats stats() const;
+
+private:
+    struct Client
+    {
+        socket_t sock;
+        std::thread thread;
+        std::atomic<bool> done{ false };
+    };
+
+    void accept_clients();
+    void serve_client(Client& client);
+    void reap_clients(bool all);
+
+    LiveViewStream& m_stream;
+    std::size_t m_max_clients;
+    socket_t m_server = invalid_socket;
+    std::thread m_accept_thread;
+    std::atomic<bool> m_running{ false };
+
+    std::list<Client> m_clients; // Only touched by the accept thread and stop()
+    std::atomic<std::uint64_t> m_served{ 0 };
+    std::atomic<std::uint64_t> m_sent{ 0 };
+    std::atomic<std::uint64_t> m_skipped{ 0 };
+    std::atomic<std::uint64_t> m_rejected{ 0 };
+};
+} // namespace cli
+
+#endif // !MJPEGSERVER_H
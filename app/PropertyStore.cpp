@@ -0,0 +1,73 @@
+#include "PropertyStore.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+bool PropertyStore::update(SDK::CrDeviceProperty* props, std::int32_t num, bool seed)
+{
+    bool changed = false;
+    ++m_updates;
+    for (std::int32_t i = 0; i < num; ++i) {
+        auto& prop = props[i];
+        auto* first = prop.GetValues();
+        std::size_t size = first ? prop.GetValueSize() : 0;
+
+        auto it = m_records.find(prop.GetCode());
+        if (it != m_records.end()) {
+            // Compared in place, so that an unchanged report allocates nothing
+            auto& record = it->second;
+            if (record.type == prop.GetValueType()
+                && record.writable == prop.IsSetEnableCurrentValue()
+                && record.current == prop.GetCurrentValue()
+                && record.values.size() == size
+                && (0 == size || 0 == std::memcmp(record.values.data(), first, size))) {
+                record.reported = m_updates;
+                continue;
+            }
+        }
+
+        m_records[prop.GetCode()] = PropertyRecord{ prop.GetValueType(), prop.IsSetEnableCurrentValue(),
+            prop.GetCurrentValue(), std::vector<std::uint8_t>(first, first + size), m_generation + 1, m_updates };
+        changed = true;
+    }
+
+    if (changed) ++m_generation;
+    if (seed) m_seeded = true;
+    return changed;
+}
+
+void PropertyStore::clear()
+{
+    m_records.clear();
+    m_seeded = false;
+    // The generation keeps counting so that readers never see an old number reused
+    ++m_generation;
+}
+
+const PropertyRecord* PropertyStore::find(CrInt32u code) const
+{
+    auto it = m_records.find(code);
+    return it == m_records.end() ? nullptr : &it->second;
+}
+
+std::vector<CrInt32u> PropertyStore::changed_since(std::uint64_t since) const
+{
+    std::vector<CrInt32u> codes;
+    for (auto& entry : m_records) {
+        if (since < entry.second.generation) codes.push_back(entry.first);
+    }
+    return codes;
+}
+
+std::vector<CrInt32u> PropertyStore::codes() const
+{
+    std::vector<CrInt32u> codes;
+    codes.reserve(m_records.size());
+    for (auto& entry : m_records) codes.push_back(entry.first);
+    std::sort(codes.begin(), codes.end());
+    return codes;
+}
+} // namespace cli
@@ -0,0 +1,72 @@
+#ifndef PROPERTYSTORE_H
+#define PROPERTYSTORE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "CameraRemote_SDK.h"
+
+namespace cli
+{
+// Last reported state of one device property
+struct PropertyRecord
+{
+    SCRSDK::CrDataType type;
+    bool writable;
+    CrInt64u current;
+    std::vector<std::uint8_t> values; // Possible values exactly as reported, see type
+    std::uint64_t generation;         // Store generation of the last change
+    std::uint64_t reported;           // Store update of the last report, also when nothing changed
+
+    template <typename T>
+    T current_as() const { return static_cast<T>(current); }
+};
+
+// Value of one property as the store holds it
+struct PropertyValue
+{
+    CrInt32u code;
+    CrInt64 value;
+};
+
+// Number of property requests sent to the camera
+struct PropertyFetchStats
+{
+    std::uint32_t full;   // GetDeviceProperties
+    std::uint32_t select; // GetSelectDeviceProperties
+
+    std::uint32_t total() const { return full + select; }
+};
+
+// Device properties keyed by CrDevicePropertyCode.
+// Seeded from one full fetch, then updated only with the properties the camera reports as changed.
+// Not synchronized; the owner guards access.
+class PropertyStore
+{
+public:
+    // Merges fetched properties; seed marks the result of a full fetch.
+    // Returns true when any stored value changed.
+    bool update(SCRSDK::CrDeviceProperty* props, std::int32_t num, bool seed);
+    void clear();
+
+    bool seeded() const { return m_seeded; }
+    // Incremented on every change, so readers holding an older value know they are stale
+    std::uint64_t generation() const { return m_generation; }
+    // Incremented on every update, so a wait can tell a fresh report of an unchanged value from the old one
+    std::uint64_t updates() const { return m_updates; }
+
+    const PropertyRecord* find(CrInt32u code) const;
+    // Codes whose value changed after generation since
+    std::vector<CrInt32u> changed_since(std::uint64_t since) const;
+    // Every stored code in ascending order
+    std::vector<CrInt32u> codes() const;
+
+private:
+    std::unordered_map<CrInt32u, PropertyRecord> m_records;
+    std::uint64_t m_generation = 0;
+    std::uint64_t m_updates = 0;
+    bool m_seeded = false;
+};
+} // namespace cli
+
+#endif // !PROPERTYSTORE_H
@@ -0,0 +1,186 @@
+#include "PropertySubscriptions.h"
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+// Longest sleep of the dispatch thread when no deadline is nearer
+#define DISPATCH_IDLE_TIME 1000ms
+
+namespace cli
+{
+PropertySubscriptions::PropertySubscriptions(std::size_t capacity)
+    : m_queue(capacity)
+{
+}
+
+PropertySubscriptions::~PropertySubscriptions()
+{
+    if (m_thread.joinable()) {
+        m_running = false;
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mtx);
+            m_wake_cv.notify_one();
+        }
+        m_thread.join();
+    }
+
+    // Whoever still waits is told the subscription ended
+    std::vector<std::shared_ptr<Subscription>> left;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        left.swap(m_subscriptions);
+    }
+    for (auto& subscription : left) {
+        bool ended = false;
+        if (subscription->ended.compare_exchange_strong(ended, true)) {
+            subscription->handler(PropertyChange{ 0, 0, std::chrono::steady_clock::now(), true });
+        }
+    }
+}
+
+bool PropertySubscriptions::publish(CrInt32u code, CrInt64u value)
+{
+    if (!m_active.load(std::memory_order_acquire)) return true;
+    if (!m_queue.try_push(PropertyChange{ code, value, std::chrono::steady_clock::now(), false })) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_published.fetch_add(1, std::memory_order_relaxed);
+
+    // Pairs with the fence in run(): either the dispatch thread sees the change before it sleeps, or this sees it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_wake_mtx);
+        m_wake_cv.notify_one();
+    }
+    return true;
+}
+
+std::uint64_t PropertySubscriptions::subscribe(std::vector<CrInt32u> codes, PropertyPredicate predicate, PropertyHandler handler,
+    std::chrono::milliseconds timeout, bool once)
+{
+    auto subscription = std::make_shared<Subscription>();
+    subscription->codes = std::move(codes);
+    subscription->predicate = std::move(predicate);
+    subscription->handler = std::move(handler);
+    subscription->deadline = (0ms < timeout) ? std::chrono::steady_clock::now() + timeout : std::chrono::steady_clock::time_point::max();
+    subscription->once = once;
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    subscription->id = m_next_id++;
+    m_subscriptions.push_back(subscription);
+    m_active = true;
+    if (!m_thread.joinable()) {
+        m_running = true;
+        m_thread = std::thread(&PropertySubscriptions::run, this);
+    }
+    else if (0ms < timeout) {
+        // The dispatch thread may be sleeping past the new deadline
+        std::lock_guard<std::mutex> wake(m_wake_mtx);
+        m_wake_cv.notify_one();
+    }
+    return subscription->id;
+}
+
+void PropertySubscriptions::unsubscribe(std::uint64_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto& subscription : m_subscriptions) {
+            if (subscription->id == id) subscription->ended = true;
+        }
+    }
+    remove(id);
+}
+
+std::future<PropertyChange> PropertySubscriptions::next(std::vector<CrInt32u> codes, PropertyPredicate predicate, std::chrono::milliseconds timeout)
+{
+    auto promise = std::make_shared<std::promise<PropertyChange>>();
+    auto future = promise->get_future();
+    subscribe(std::move(codes), std::move(predicate), [promise](const PropertyChange& change) { promise->set_value(change); }, timeout, true);
+    return future;
+}
+
+PropertySubscriptionStats PropertySubscriptions::stats() const
+{
+    return PropertySubscriptionStats{ m_published.load(), m_dropped.load(), m_delivered.load() };
+}
+
+void PropertySubscriptions::run()
+{
+    while (m_running.load()) {
+        PropertyChange change;
+        while (m_queue.try_pop(change)) dispatch(change);
+
+        auto now = std::chrono::steady_clock::now();
+        auto wake = std::min(expire(now), now + DISPATCH_IDLE_TIME);
+
+        std::unique_lock<std::mutex> lock(m_wake_mtx);
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_queue.empty() && m_running.load()) m_wake_cv.wait_until(lock, wake);
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void PropertySubscriptions::dispatch(const PropertyChange& change)
+{
+    m_matching.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto& subscription : m_subscriptions) {
+            auto& codes = subscription->codes;
+            if (!subscription->ended && (codes.empty() || codes.end() != std::find(codes.begin(), codes.end(), change.code))) {
+                m_matching.push_back(subscription);
+            }
+        }
+    }
+
+    // Predicates and handlers run unlocked, so they may subscribe and unsubscribe themselves
+    for (auto& subscription : m_matching) {
+        if (subscription->predicate && !subscription->predicate(change.code, change.value)) continue;
+        if (subscription->once) {
+            bool ended = false;
+            if (!subscription->ended.compare_exchange_strong(ended, true)) continue;
+        }
+        else if (subscription->ended) {
+            continue;
+        }
+        subscription->handler(change);
+        m_delivered.fetch_add(1, std::memory_order_relaxed);
+        if (subscription->once) remove(subscription->id);
+    }
+    m_matching.clear();
+}
+
+std::chrono::steady_clock::time_point PropertySubscriptions::expire(std::chrono::steady_clock::time_point now)
+{
+    auto earliest = std::chrono::steady_clock::time_point::max();
+    m_matching.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto& subscription : m_subscriptions) {
+            if (subscription->deadline <= now) m_matching.push_back(subscription);
+            else earliest = std::min(earliest, subscription->deadline);
+        }
+    }
+
+    for (auto& subscription : m_matching) {
+        bool ended = false;
+        if (subscription->ended.compare_exchange_strong(ended, true)) {
+            subscription->handler(PropertyChange{ 0, 0, now, true });
+        }
+        remove(subscription->id);
+    }
+    m_matching.clear();
+    return earliest;
+}
+
+void PropertySubscriptions::remove(std::uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_subscriptions.erase(std::remove_if(m_subscriptions.begin(), m_subscriptions.end(),
+        [id](const std::shared_ptr<Subscription>& subscription) { return subscription->id == id; }), m_subscriptions.end());
+    m_active = !m_subscriptions.empty();
+}
+} // namespace cli
@@ -0,0 +1,109 @@
+#ifndef PROPERTYSUBSCRIPTIONS_H
+#define PROPERTYSUBSCRIPTIONS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+#include "CRSDK/CameraRemote_SDK.h"
+
+namespace cli
+{
+// One value reported by the camera, or the end of a subscription
+struct PropertyChange
+{
+    CrInt32u code;
+    CrInt64u value;
+    std::chrono::steady_clock::time_point reported; // When the SDK callback published it
+    bool timed_out;                                  // The subscription ended at its timeout; code and value are not set
+};
+
+// Decides whether a change is passed on; nullptr passes every change of the subscribed codes
+using PropertyPredicate = std::function<bool(CrInt32u code, CrInt64u value)>;
+// Runs on the dispatch thread, never on the thread that publishes the changes
+using PropertyHandler = std::function<void(const PropertyChange& change)>;
+
+struct PropertySubscriptionStats
+{
+    std::uint64_t published; // Changes queued by publish()
+    std::uint64_t dropped;   // Changes lost because the queue was full
+    std::uint64_t delivered; // Handler calls with a change
+};
+
+// Hands property changes from the thread that fetches them to subscribers.
+// That thread only pushes onto a lock-free queue; predicates and handlers run on a dispatch thread,
+// started with the first subscription, so a slow handler delays other handlers but never the SDK.
+class PropertySubscriptions
+{
+public:
+    explicit PropertySubscriptions(std::size_t capacity = 1024);
+    ~PropertySubscriptions();
+
+    PropertySubscriptions(const PropertySubscriptions&) = delete;
+    PropertySubscriptions& operator=(const PropertySubscriptions&) = delete;
+
+    // Called by the thread that fetched the changes; does nothing while there are no subscriptions.
+    // False when the queue was full and the change was dropped.
+    bool publish(CrInt32u code, CrInt64u value);
+
+    // Calls handler with every change of codes that predicate accepts, or only the first one when once is set.
+    // Empty codes subscribe to every property.
+    // After timeout, when it is not zero, handler is called a last time with timed_out set;
+    // a once subscription gets that call only if nothing matched before.
+    // Returns the ID for unsubscribe().
+    std::uint64_t subscribe(std::vector<CrInt32u> codes, PropertyPredicate predicate, PropertyHandler handler,
+        std::chrono::milliseconds timeout, bool once);
+    // A handler already running may still finish after this returns
+    void unsubscribe(std::uint64_t id);
+    // The first change of codes that predicate accepts, or a change with timed_out set after timeout
+    std::future<PropertyChange> next(std::vector<CrInt32u> codes, PropertyPredicate predicate, std::chrono::milliseconds timeout);
+
+    PropertySubscriptionStats stats() const;
+
+private:
+    struct Subscription
+    {
+        std::uint64_t id;
+        std::vector<CrInt32u> codes;
+        PropertyPredicate predicate;
+        PropertyHandler handler;
+        std::chrono::steady_clock::time_point deadline; // time_point::max() without timeout
+        bool once;
+        std::atomic<bool> ended{ false };
+    };
+
+    void run();
+    void dispatch(const PropertyChange& change);
+    // Ends the subscriptions past their deadline; returns the earliest deadline left
+    std::chrono::steady_clock::time_point expire(std::chrono::steady_clock::time_point now);
+    void remove(std::uint64_t id);
+
+    BoundedQueue<PropertyChange> m_queue;
+    std::atomic<bool> m_active{ false }; // Any subscription, so publish() can skip the queue otherwise
+    std::atomic<std::uint64_t> m_published{ 0 };
+    std::atomic<std::uint64_t> m_dropped{ 0 };
+    std::atomic<std::uint64_t> m_delivered{ 0 };
+
+    // Guards the subscription list; never taken by publish()
+    mutable std::mutex m_mtx;
+    std::vector<std::shared_ptr<Subscription>> m_subscriptions;
+    std::uint64_t m_next_id = 1;
+    std::vector<std::shared_ptr<Subscription>> m_matching; // Scratch list of the dispatch thread, reused to save allocations
+
+    // The dispatch thread sleeps on m_wake_cv; publish() only takes m_wake_mtx when m_sleeping says it must
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    std::atomic<bool> m_sleeping{ false };
+    std::mutex m_wake_mtx;
+    std::condition_variable m_wake_cv;
+};
+} // namespace cli
+
+#endif // !PROPERTYSUBSCRIPTIONS_H
@@ -0,0 +1,136 @@
+#include "PropertyTable.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include "PropertyValueTable.h"
+
+namespace SDK = SCRSDK;
+
+namespace cli
+{
+// Adapts a format_* function to the common signature of the table
+template <typename T, text (*Format)(T)>
+text format_as(CrInt64 value)
+{
+    return Format(static_cast<T>(value));
+}
+
+// Copies a reported property into its entry of the value table, in the entry's own type.
+// The possible values are kept when the camera reports none, and are rebuilt only when they differ.
+template <auto Entry>
+void load_as(PropertyValueTable& table, SCRSDK::CrDeviceProperty& prop)
+{
+    auto& entry = table.*Entry;
+    using T = decltype(entry.current);
+    entry.writable = prop.IsSetEnableCurrentValue();
+    entry.current = static_cast<T>(prop.GetCurrentValue());
+    auto values = view_values<T>(prop);
+    if (!values.empty() && !values.equals(entry.possible)) values.assign_to(entry.possible);
+}
+
+#include "PropertyTable.inc"
+
+constexpr std::size_t const property_count = std::size(property_table);
+
+constexpr bool codes_ascending()
+{
+    for (std::size_t i = 1; i < property_count; ++i) {
+        if (property_table[i].code <= property_table[i - 1].code) return false;
+    }
+    return true;
+}
+static_assert(codes_ascending(), "CrDeviceProperty.h no longer declares the codes in ascending order");
+
+// Perfect hash of the names, built by the compiler (hash and displace).
+// A name picks its bucket from the hash; the bucket's displacement then moves all its names to free slots.
+// A lookup is one hash, two array reads and a single name comparison.
+constexpr std::size_t const name_buckets = property_count / 4 + 1;
+constexpr std::size_t const name_slots = property_count * 2;
+static_assert(property_count < 0xFF, "Slots hold the table index in one byte");
+
+struct NameHash
+{
+    bool complete;
+    std::uint16_t displacement[name_buckets];
+    std::uint8_t slot[name_slots]; // Index into property_table plus one, 0 when free
+};
+
+constexpr std::uint64_t name_hash(std::string_view name)
+{
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+constexpr std::size_t name_slot(std::uint64_t hash, std::uint16_t displacement)
+{
+    return static_cast<std::size_t>(((hash >> 16) + displacement * ((hash >> 40) | 1)) % name_slots);
+}
+
+constexpr NameHash make_name_hash()
+{
+    NameHash result{};
+    std::uint64_t hashes[property_count]{};
+    std::size_t sizes[name_buckets]{};
+    for (std::size_t i = 0; i < property_count; ++i) {
+        hashes[i] = name_hash(property_table[i].name);
+        ++sizes[hashes[i] % name_buckets];
+    }
+
+    // Fullest buckets first, while most slots are still free
+    bool placed[name_buckets]{};
+    for (std::size_t round = 0; round < name_buckets; ++round) {
+        std::size_t bucket = 0;
+        while (placed[bucket]) ++bucket;
+        for (std::size_t b = bucket + 1; b < name_buckets; ++b) {
+            if (!placed[b] && sizes[bucket] < sizes[b]) bucket = b;
+        }
+        placed[bucket] = true;
+
+        bool fits = false;
+        for (std::uint32_t d = 0; d <= 0xFFFF && !fits; ++d) {
+            fits = true;
+            for (std::size_t i = 0; i < property_count && fits; ++i) {
+                if (hashes[i] % name_buckets != bucket) continue;
+                auto slot = name_slot(hashes[i], static_cast<std::uint16_t>(d));
+                if (0 != result.slot[slot]) fits = false;
+                else result.slot[slot] = static_cast<std::uint8_t>(i + 1);
+            }
+            if (fits) {
+                result.displacement[bucket] = static_cast<std::uint16_t>(d);
+                continue;
+            }
+            // Give back the slots taken by this attempt
+            for (auto& slot : result.slot) {
+                if (0 != slot && hashes[slot - 1] % name_buckets == bucket) slot = 0;
+            }
+        }
+        if (!fits) return result;
+    }
+    result.complete = true;
+    return result;
+}
+
+constexpr NameHash const property_names = make_name_hash();
+static_assert(property_names.complete, "No displacement places every property name; change name_slots");
+
+const PropertyInfo* find_property(CrInt32u code)
+{
+    auto end = property_table + property_count;
+    auto found = std::lower_bound(property_table, end, code, [](const PropertyInfo& info, CrInt32u code) { return info.code < code; });
+    return (found != end && found->code == code) ? found : nullptr;
+}
+
+const PropertyInfo* find_property(std::string_view name)
+{
+    auto hash = name_hash(name);
+    auto index = property_names.slot[name_slot(hash, property_names.displacement[hash % name_buckets])];
+    if (0 == index) return nullptr;
+    auto* info = &property_table[index - 1];
+    return (info->name == name) ? info : nullptr;
+}
+} // namespace cli
@@ -0,0 +1,36 @@
+#ifndef PROPERTYTABLE_H
+#define PROPERTYTABLE_H
+
+#include <cstddef>
+#include <string_view>
+#include "CameraRemote_SDK.h"
+#include "PropertyValueView.h"
+#include "Text.h"
+
+namespace cli
+{
+struct PropertyValueTable;
+
+// Static facts about one device property.
+// The table is generated from CrDeviceProperty.h and cmake/property_types.txt at build time.
+struct PropertyInfo
+{
+    CrInt32u code;
+    std::string_view name;         // Without the CrDeviceProperty_ prefix
+    const text_char* display_name; // The same name as text
+    SCRSDK::CrDataType type;       // Element type of the values, CrDataType_Undefined when not known
+    text (*format)(CrInt64 value); // Readable form of a value, nullptr when there is none
+    // Keeps the current and possible values in the property's PropertyValueTable entry, nullptr when it has none
+    void (*load)(PropertyValueTable& table, SCRSDK::CrDeviceProperty& prop);
+
+    // Bytes per element of GetValues(), 0 when the type is not known
+    constexpr std::size_t value_size() const { return data_type_size(type); }
+};
+
+// Lookups in the generated table, without allocation; nullptr when the property is not in it.
+// By code a binary search, by name a perfect hash computed at compile time.
+const PropertyInfo* find_property(CrInt32u code);
+const PropertyInfo* find_property(std::string_view name);
+} // namespace cli
+
+#endif // !PROPERTYTABLE_H
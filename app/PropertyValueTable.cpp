@@ -1,23 +1,12 @@
 ﻿#include "PropertyValueTable.h"
+#include "PropertyTable.h"
 #include <cmath>
-#include <cstring>
 
 
 namespace SDK = SCRSDK;
 
 namespace impl
 {
-template <typename T>
-std::vector<T> parse(unsigned char const* buf, std::uint32_t nval)
-{
-    constexpr std::size_t const type_size = sizeof(T);
-    std::vector<T> result(nval);
-    std::uint32_t i = 0; T* source = static_cast<T*>(buf);
-    for (; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-}
-
 inline double Round(double value, int figure)
 {
     bool isNagative = ( value < 0 );
@@ -49,282 +38,6 @@ constexpr std::uint16_t LOWORD(std::uint32_t dword)
 
 namespace cli
 {
-std::vector<std::uint16_t> parse_f_number(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint32_t> parse_iso_sensitivity(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint32_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint32_t> parse_shutter_speed(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint32_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_position_key_setting(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint32_t> parse_exposure_program_mode(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint32_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint32_t> parse_still_capture_mode(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint32_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_focus_mode(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_focus_area(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_live_view_image_quality(unsigned char const* buf, std::uint32_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_media_slotx_format_enable_status(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_white_balance(unsigned char const* buf, std::uint16_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_customwb_capture_stanby(unsigned char const* buf, std::uint16_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_customwb_capture_stanby_cancel(unsigned char const* buf, std::uint16_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_customwb_capture_operation(unsigned char const* buf, std::uint16_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint16_t> parse_customwb_capture_execution_state(unsigned char const* buf, std::uint16_t nval)
-{
-    using TargetType = std::uint16_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_zoom_operation_status(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_zoom_setting_type(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_zoom_types_status(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::int8_t> parse_zoom_operation(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::int8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::int8_t> parse_zoom_speed_range(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::int8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_save_zoom_and_focus_position(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_load_zoom_and_focus_position(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
-std::vector<std::uint8_t> parse_remocon_zoom_speed_type(unsigned char const* buf, std::uint8_t nval)
-{
-    using TargetType = std::uint8_t;
-    constexpr std::size_t const type_size = sizeof(TargetType);
-    TargetType const* source = reinterpret_cast<TargetType const*>(buf);
-    std::vector<TargetType> result(nval);
-    for (std::uint32_t i = 0; i < nval; ++i, ++source) {
-        std::memcpy(&result[i], source, type_size);
-    }
-    return result;
-}
-
 text format_f_number(std::uint16_t f_number)
 {
     text_stringstream ts;
@@ -1184,4 +897,10 @@ text format_remocon_zoom_speed_type(std::uint8_t remocon_zoom_speed_type)
 
     return ts.str();
 }
+
+text format_property_value(CrInt32u code, CrInt64 value)
+{
+    auto* info = find_property(code);
+    return (nullptr != info && nullptr != info->format) ? info->format(value) : text();
+}
 } // namespace cli
@@ -48,30 +48,6 @@ struct PropertyValueTable
     PropertyValueEntry<std::uint8_t> remocon_zoom_speed_type;
 };
 
-std::vector<std::uint16_t> parse_f_number(unsigned char const* buf, std::uint32_t nval);
-std::vector<std::uint32_t> parse_iso_sensitivity(unsigned char const* buf, std::uint32_t nval);
-std::vector<std::uint32_t> parse_shutter_speed(unsigned char const* buf, std::uint32_t nval);
-std::vector<std::uint16_t> parse_position_key_setting(unsigned char const * buf, std::uint32_t nval);
-std::vector<std::uint32_t> parse_exposure_program_mode(unsigned char const * buf, std::uint32_t nval);
-std::vector<std::uint32_t> parse_still_capture_mode(unsigned char const * buf, std::uint32_t nval);
-std::vector<std::uint16_t> parse_focus_mode(unsigned char const * buf, std::uint32_t nval);
-std::vector<std::uint16_t> parse_focus_area(unsigned char const* buf, std::uint32_t nval);
-std::vector<std::uint16_t> parse_live_view_image_quality(unsigned char const * buf, std::uint32_t nval);
-std::vector<std::uint8_t> parse_media_slotx_format_enable_status(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::uint16_t> parse_white_balance(unsigned char const* buf, std::uint16_t nval);
-std::vector<std::uint16_t> parse_customwb_capture_stanby(unsigned char const* buf, std::uint16_t nval);
-std::vector<std::uint16_t> parse_customwb_capture_stanby_cancel(unsigned char const* buf, std::uint16_t nval);
-std::vector<std::uint16_t> parse_customwb_capture_operation(unsigned char const* buf, std::uint16_t nval);
-std::vector<std::uint16_t> parse_customwb_capture_execution_state(unsigned char const* buf, std::uint16_t nval);
-std::vector<std::uint8_t> parse_zoom_operation_status(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::uint8_t> parse_zoom_setting_type(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::uint8_t> parse_zoom_types_status(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::int8_t> parse_zoom_operation(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::int8_t> parse_zoom_speed_range(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::uint8_t> parse_save_zoom_and_focus_position(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::uint8_t> parse_load_zoom_and_focus_position(unsigned char const* buf, std::uint8_t nval);
-std::vector<std::uint8_t> parse_remocon_zoom_speed_type(unsigned char const* buf, std::uint8_t nval);
-
 text format_f_number(std::uint16_t f_number);
 text format_iso_sensitivity(std::uint32_t iso);
 text format_shutter_speed(std::uint32_t shutter_speed);
@@ -93,6 +69,9 @@ text format_zoom_setting_type(std::uint8_t zoom_setting_type);
 text format_zoom_types_status(std::uint8_t zoom_types_status);
 text format_zoom_operation(std::int8_t zoom_operation);
 text format_remocon_zoom_speed_type(std::uint8_t remocon_zoom_speed_type);
+
+// Readable form of a value as stored for code by the property store; empty when there is no format_* function for it
+text format_property_value(CrInt32u code, CrInt64 value);
 } // namespace cli
 
 #endif // !PROPERTYVALUETABLE_H
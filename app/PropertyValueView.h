@@ -0,0 +1,144 @@
+#ifndef PROPERTYVALUEVIEW_H
+#define PROPERTYVALUEVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "CameraRemote_SDK.h"
+
+namespace cli
+{
+// Typed read-only view over the values buffer of a CrDeviceProperty, as returned by GetValues().
+// The elements are read in place; the buffer has no alignment guarantee, so each one is copied out on access.
+// The view does not own the buffer and is valid only as long as the property list it came from.
+// For Range types the elements are the minimum, the maximum and, when reported, the step.
+template <typename T>
+class PropertyValueView
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = T;
+
+        iterator() = default;
+        explicit iterator(const unsigned char* at) : m_at(at) {}
+
+        T operator*() const
+        {
+            T value;
+            std::memcpy(&value, m_at, sizeof(T));
+            return value;
+        }
+        T operator[](difference_type n) const { return *(*this + n); }
+
+        iterator& operator++() { m_at += sizeof(T); return *this; }
+        iterator operator++(int) { auto prev = *this; ++*this; return prev; }
+        iterator& operator--() { m_at -= sizeof(T); return *this; }
+        iterator operator--(int) { auto prev = *this; --*this; return prev; }
+        iterator& operator+=(difference_type n) { m_at += n * static_cast<difference_type>(sizeof(T)); return *this; }
+        iterator& operator-=(difference_type n) { return *this += -n; }
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(iterator a, iterator b) { return (a.m_at - b.m_at) / static_cast<difference_type>(sizeof(T)); }
+
+        friend bool operator==(iterator a, iterator b) { return a.m_at == b.m_at; }
+        friend bool operator!=(iterator a, iterator b) { return a.m_at != b.m_at; }
+        friend bool operator<(iterator a, iterator b) { return a.m_at < b.m_at; }
+        friend bool operator>(iterator a, iterator b) { return a.m_at > b.m_at; }
+        friend bool operator<=(iterator a, iterator b) { return a.m_at <= b.m_at; }
+        friend bool operator>=(iterator a, iterator b) { return a.m_at >= b.m_at; }
+
+    private:
+        const unsigned char* m_at = nullptr;
+    };
+
+    PropertyValueView() = default;
+    // size is in bytes; a trailing partial element is ignored
+    PropertyValueView(const unsigned char* data, std::size_t size, bool range = false)
+        : m_data(data)
+        , m_count(data ? size / sizeof(T) : 0)
+        , m_range(range)
+    {
+    }
+
+    iterator begin() const { return iterator(m_data); }
+    iterator end() const { return iterator(m_data + m_count * sizeof(T)); }
+    std::size_t size() const { return m_count; }
+    bool empty() const { return 0 == m_count; }
+    T operator[](std::size_t i) const { return begin()[static_cast<std::ptrdiff_t>(i)]; }
+    bool range() const { return m_range; }
+
+    // Materializes the values; assign_to() reuses the capacity of an existing vector
+    std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+    void assign_to(std::vector<T>& values) const { values.assign(begin(), end()); }
+
+    // Element-wise comparison, without materializing the view
+    bool equals(const std::vector<T>& values) const
+    {
+        if (values.size() != m_count) return false;
+        auto it = begin();
+        for (auto value : values) {
+            if (value != *it++) return false;
+        }
+        return true;
+    }
+
+private:
+    const unsigned char* m_data = nullptr;
+    std::size_t m_count = 0;
+    bool m_range = false;
+};
+
+// Bytes per element of a CrDataType, Array and Range bits included; 0 when it has none
+constexpr std::size_t data_type_size(SCRSDK::CrDataType type)
+{
+    switch (type & ~(SCRSDK::CrDataType::CrDataType_SignBit | SCRSDK::CrDataType::CrDataType_ArrayBit | SCRSDK::CrDataType::CrDataType_RangeBit)) {
+    case SCRSDK::CrDataType::CrDataType_UInt8: return 1;
+    case SCRSDK::CrDataType::CrDataType_UInt16: return 2;
+    case SCRSDK::CrDataType::CrDataType_UInt32: return 4;
+    case SCRSDK::CrDataType::CrDataType_UInt64: return 8;
+    case SCRSDK::CrDataType::CrDataType_UInt128: return 16;
+    default: return 0;
+    }
+}
+
+// Values of prop viewed as T.
+// The view is empty when the camera reports elements of another width; an undefined type is taken to be T.
+template <typename T>
+PropertyValueView<T> view_values(SCRSDK::CrDeviceProperty& prop)
+{
+    auto type = prop.GetValueType();
+    auto size = data_type_size(type);
+    if (0 != size && sizeof(T) != size) return PropertyValueView<T>();
+    return PropertyValueView<T>(prop.GetValues(), prop.GetValueSize(), 0 != (type & SCRSDK::CrDataType::CrDataType_RangeBit));
+}
+
+// Calls visitor with the view of the values matching type, e.g. PropertyValueView<std::int16_t> for Int16Range.
+// Returns false, without calling visitor, for types with no C++ counterpart (undefined, 128 bits).
+template <typename Visitor>
+bool visit_values(SCRSDK::CrDataType type, const unsigned char* data, std::size_t size, Visitor&& visitor)
+{
+    bool range = 0 != (type & SCRSDK::CrDataType::CrDataType_RangeBit);
+    switch (type & ~(SCRSDK::CrDataType::CrDataType_ArrayBit | SCRSDK::CrDataType::CrDataType_RangeBit)) {
+    case SCRSDK::CrDataType::CrDataType_UInt8: visitor(PropertyValueView<std::uint8_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_Int8: visitor(PropertyValueView<std::int8_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_UInt16: visitor(PropertyValueView<std::uint16_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_Int16: visitor(PropertyValueView<std::int16_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_UInt32: visitor(PropertyValueView<std::uint32_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_Int32: visitor(PropertyValueView<std::int32_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_UInt64: visitor(PropertyValueView<std::uint64_t>(data, size, range)); return true;
+    case SCRSDK::CrDataType::CrDataType_Int64: visitor(PropertyValueView<std::int64_t>(data, size, range)); return true;
+    default: return false;
+    }
+}
+} // namespace cli
+
+#endif // !PROPERTYVALUEVIEW_H
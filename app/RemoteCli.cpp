@@ -21,9 +21,6 @@ namespace fs = std::filesystem;
 
 namespace SDK = SCRSDK;
 
-// Global dll object
-// cli::CRLibInterface* cr_lib = nullptr;
-
 typedef std::shared_ptr<cli::CameraDevice> CameraDevicePtr;
 typedef std::vector<CameraDevicePtr> CameraDeviceList;
 
@@ -40,7 +37,7 @@ int RemoteSampleApp()
 
     if (verbose) cli::tout << "RemoteSampleApp v1.05.00 running...\n\n";
 
-    CrInt32u version = SDK::GetSDKVersion();
+    CrInt32u version = cr_lib->GetSDKVersion();
     int major = (version & 0xFF000000) >> 24;
     int minor = (version & 0x00FF0000) >> 16;
     int patch = (version & 0x0000FF00) >> 8;
@@ -49,9 +46,6 @@ int RemoteSampleApp()
     if (verbose) cli::tout << "Remote SDK version: ";
     if (verbose) cli::tout << major << "." << minor << "." << std::setfill(TEXT('0')) << std::setw(2) << patch << "\n";
 
-    // Load the library dynamically
-    // cr_lib = cli::load_cr_lib();
-
     if (verbose) cli::tout << "Initialize Remote SDK...\n";
     
 #if defined(__APPLE__)
@@ -61,24 +55,20 @@ int RemoteSampleApp()
 #else
         if (verbose) cli::tout << "Working directory: " << fs::current_path() << '\n';
 #endif
-    // auto init_success = cr_lib->Init(0);
-    auto init_success = SDK::Init();
+    auto init_success = cr_lib->Init(0);
     if (!init_success) {
         if (verbose) cli::tout << "Failed to initialize Remote SDK. Terminating.\n";
-        // cr_lib->Release();
-        SDK::Release();
+        cr_lib->Release();
         std::exit(EXIT_FAILURE);
     }
     if (verbose) cli::tout << "Remote SDK successfully initialized.\n\n";
 
     if (verbose) cli::tout << "Enumerate connected camera devices...\n";
     SDK::ICrEnumCameraObjectInfo* camera_list = nullptr;
-    // auto enum_status = cr_lib->EnumCameraObjects(&camera_list, 3);
-    auto enum_status = SDK::EnumCameraObjects(&camera_list);
+    auto enum_status = cr_lib->EnumCameraObjects(&camera_list, 3);
     if (CR_FAILED(enum_status) || camera_list == nullptr) {
         if (verbose) cli::tout << "No cameras detected. Connect a camera and retry.\n";
-        // cr_lib->Release();
-        SDK::Release();
+        cr_lib->Release();
         std::exit(EXIT_FAILURE);
     }
     auto ncams = camera_list->GetCount();
@@ -127,7 +117,7 @@ int RemoteSampleApp()
 
     if (no == 0) {
         if (verbose) cli::tout << "Invalid Number. Finish App.\n";
-        SDK::Release();
+        cr_lib->Release();
         std::exit(EXIT_FAILURE);
     }
 
@@ -139,7 +129,7 @@ int RemoteSampleApp()
     auto* camera_info = camera_list->GetCameraObjectInfo(no - 1);
 
     if (verbose) cli::tout << "Create camera SDK camera callback object.\n";
-    CameraDevicePtr camera = CameraDevicePtr(new cli::CameraDevice(cameraNumUniq, nullptr, camera_info));
+    CameraDevicePtr camera = CameraDevicePtr(new cli::CameraDevice(cameraNumUniq, cr_lib, camera_info));
     cameraList.push_back(camera); // add 1st
 
     if (verbose) cli::tout << "Release enumerated camera list.\n";
@@ -331,7 +321,7 @@ int RemoteSampleApp()
                     if (0 == selected_index) 
                     {
 
-                        enum_status = SDK::EnumCameraObjects(&camera_list);
+                        enum_status = cr_lib->EnumCameraObjects(&camera_list, 3);
                         if (CR_FAILED(enum_status) || camera_list == nullptr) {
                             if (verbose) cli::tout << "No cameras detected. Connect a camera and retry.\n";
                         }
@@ -392,7 +382,7 @@ int RemoteSampleApp()
                                 }
                                 if (false == findAlready) {
                                     std::int32_t newNum = cameraNumUniq + 1;
-                                    CameraDevicePtr newCam = CameraDevicePtr(new cli::CameraDevice(newNum, nullptr, camera_info));
+                                    CameraDevicePtr newCam = CameraDevicePtr(new cli::CameraDevice(newNum, cr_lib, camera_info));
                                     cameraNumUniq = newNum;
                                     cameraList.push_back(newCam); // add
                                     camera = newCam; // switch target
@@ -582,10 +572,7 @@ int RemoteSampleApp()
     }// end of loop-A
 
     if (verbose) cli::tout << "Release SDK resources.\n";
-    // cr_lib->Release();
-    SDK::Release();
-
-    // cli::free_cr_lib(&cr_lib);
+    cr_lib->Release();
 
     if (verbose) cli::tout << "Exiting application.\n";
     std::exit(EXIT_SUCCESS);
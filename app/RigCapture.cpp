@@ -0,0 +1,123 @@
+#include "RigCapture.h"
+#include <algorithm>
+#include <future>
+#include <thread>
+
+// Head start the last camera to arm gives the others to wake up before all of them release
+#define RIG_RELEASE_LEAD 3000us
+
+namespace cli
+{
+using namespace std::chrono_literals;
+
+ReleaseBarrier::ReleaseBarrier(std::size_t count, std::chrono::microseconds lead)
+    : m_count(count)
+    , m_lead(lead)
+{}
+
+std::chrono::steady_clock::time_point ReleaseBarrier::arrive_and_wait()
+{
+    std::chrono::steady_clock::time_point release;
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (++m_arrived == m_count) {
+            m_release = std::chrono::steady_clock::now() + m_lead;
+            m_cv.notify_all();
+        }
+        else {
+            m_cv.wait(lock, [&] { return m_count <= m_arrived; });
+        }
+        release = m_release;
+    }
+    // Waking from the condition variable takes a different time on every thread; spinning does not
+    while (std::chrono::steady_clock::now() < release) {
+        std::this_thread::yield();
+    }
+    return release;
+}
+
+RigCapture::RigCapture(SessionManager& manager)
+    : m_manager(manager)
+{}
+
+bool RigCapture::run(std::chrono::milliseconds download_timeout)
+{
+    auto& sessions = m_manager.sessions();
+    m_shots.assign(sessions.size(), RigShot());
+    auto connected = static_cast<std::size_t>(std::count_if(sessions.begin(), sessions.end(),
+        [](const std::unique_ptr<CameraSession>& session) { return session->connected(); }));
+    if (0 == connected) return false;
+
+    // Every connected camera arrives, armed or not, so one that fails cannot hold up the others
+    ReleaseBarrier barrier(connected, RIG_RELEASE_LEAD);
+    std::vector<std::future<bool>> firing;
+    for (std::size_t i = 0; i < sessions.size(); ++i) {
+        if (!sessions[i]->connected()) continue;
+        auto& shot = m_shots[i];
+        firing.push_back(sessions[i]->post([&barrier, &shot, download_timeout](CameraDevice& camera) {
+            shot.armed = camera.arm_release();
+            auto capture_count = camera.get_capture_count();
+            auto download_count = camera.get_download_count();
+
+            barrier.arrive_and_wait();
+            shot.released = camera.release_armed();
+            shot.issued = camera.get_release_time();
+            shot.timing = camera.get_shutter_timing();
+
+            shot.captured = camera.wait_for_capture(capture_count + 1, download_timeout);
+            shot.downloaded = camera.wait_for_download(download_count + 1, download_timeout);
+            if (shot.captured) shot.capture = camera.get_last_capture_time();
+            if (shot.downloaded) {
+                shot.download = camera.get_last_download_time();
+                shot.file = camera.get_last_download();
+            }
+            return shot.released && shot.downloaded;
+        }));
+    }
+
+    bool success = true;
+    for (auto& result : firing) success = result.get() && success;
+
+    m_release = std::chrono::steady_clock::time_point::max();
+    for (auto& shot : m_shots) {
+        if (shot.released) m_release = std::min(m_release, shot.issued);
+    }
+    return success;
+}
+
+RigSkew RigCapture::issue_skew() const
+{
+    return skew(&RigShot::released, &RigShot::issued);
+}
+
+RigSkew RigCapture::capture_skew() const
+{
+    return skew(&RigShot::captured, &RigShot::capture);
+}
+
+RigSkew RigCapture::download_skew() const
+{
+    return skew(&RigShot::downloaded, &RigShot::download);
+}
+
+RigSkew RigCapture::skew(bool RigShot::*happened, std::chrono::steady_clock::time_point RigShot::*when) const
+{
+    RigSkew result{};
+    std::vector<std::chrono::steady_clock::time_point> times;
+    for (auto& shot : m_shots) {
+        if (shot.*happened) times.push_back(shot.*when);
+    }
+    result.cameras = times.size();
+    if (times.empty()) return result;
+
+    std::sort(times.begin(), times.end());
+    auto at = [&](double p) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(times[static_cast<std::size_t>(p * (times.size() - 1))] - times.front());
+    };
+    result.p50 = at(0.50);
+    result.p90 = at(0.90);
+    result.p99 = at(0.99);
+    result.max = at(1.0);
+    return result;
+}
+} // namespace cli
@@ -0,0 +1,84 @@
+#ifndef RIGCAPTURE_H
+#define RIGCAPTURE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "CameraSession.h"
+#include "Text.h"
+
+namespace cli
+{
+// Lets a set of threads go on at the same instant. The last thread to arrive sets a release time
+// a little ahead, so every thread has woken up and spins the rest of the way to it.
+class ReleaseBarrier
+{
+public:
+    ReleaseBarrier(std::size_t count, std::chrono::microseconds lead);
+
+    // Returns the release time, once count threads arrived and it has passed
+    std::chrono::steady_clock::time_point arrive_and_wait();
+
+private:
+    std::size_t m_count;
+    std::chrono::microseconds m_lead;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::size_t m_arrived = 0;
+    std::chrono::steady_clock::time_point m_release;
+};
+
+// One camera's part in a rig capture; times are on the steady clock
+struct RigShot
+{
+    bool armed = false;
+    bool released = false;
+    bool captured = false;
+    bool downloaded = false;
+    std::chrono::steady_clock::time_point issued;     // Release down sent
+    std::chrono::steady_clock::time_point capture;    // CrNotify_Captured_Event arrived
+    std::chrono::steady_clock::time_point download;   // OnCompleteDownload arrived
+    text file;
+    ShutterTimingList timing;
+};
+
+// Spread of one event across the cameras, each measured from the earliest camera
+struct RigSkew
+{
+    std::size_t cameras;
+    std::chrono::microseconds p50;
+    std::chrono::microseconds p90;
+    std::chrono::microseconds p99;
+    std::chrono::microseconds max;
+};
+
+// Fires every connected camera of a rig together. Each camera first half presses and focuses on its own
+// worker; once all are armed, the workers leave a barrier together and send release down at the same time.
+class RigCapture
+{
+public:
+    explicit RigCapture(SessionManager& manager);
+
+    // True when every connected camera was released and delivered its file within download_timeout
+    bool run(std::chrono::milliseconds download_timeout);
+
+    // In session order; cameras that are not connected have an empty shot
+    const std::vector<RigShot>& shots() const { return m_shots; }
+    std::chrono::steady_clock::time_point release_time() const { return m_release; }
+
+    RigSkew issue_skew() const;
+    RigSkew capture_skew() const;
+    RigSkew download_skew() const;
+
+private:
+    RigSkew skew(bool RigShot::*happened, std::chrono::steady_clock::time_point RigShot::*when) const;
+
+    SessionManager& m_manager;
+    std::vector<RigShot> m_shots;
+    std::chrono::steady_clock::time_point m_release;
+};
+} // namespace cli
+
+#endif // !RIGCAPTURE_H
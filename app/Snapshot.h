@@ -0,0 +1,59 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace cli
+{
+// Immutable value shared between one writer and any number of readers.
+// The writer builds a new version off to the side and publishes it by swapping a pointer;
+// readers keep the version they loaded alive for as long as they use it.
+// The swap is std::atomic<std::shared_ptr> where the library has it. Otherwise it uses the atomic shared_ptr
+// functions, which libstdc++ and MSVC implement with a small pool of internal locks. A load can then wait
+// for a concurrent publish for the length of a pointer copy, so it is short but not lock-free.
+template <typename T>
+class Snapshot
+{
+public:
+    explicit Snapshot(std::shared_ptr<const T> initial = std::make_shared<const T>())
+        : m_current(std::move(initial))
+    {}
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    std::shared_ptr<const T> load() const
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return m_current.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+#endif
+    }
+
+    void publish(std::shared_ptr<const T> next)
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        m_current.store(std::move(next), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&m_current, std::move(next), std::memory_order_release);
+#endif
+        m_version.fetch_add(1, std::memory_order_release);
+    }
+
+    // Incremented after every publish
+    std::uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<const T>> m_current;
+#else
+    std::shared_ptr<const T> m_current;
+#endif
+    std::atomic<std::uint64_t> m_version{ 0 };
+};
+} // namespace cli
+
+#endif // !SNAPSHOT_H
@@ -0,0 +1,216 @@
+#include "Socket.h"
+#include <cerrno>
+#include <cstring>
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace impl
+{
+#if defined(_WIN32)
+using native_socket = SOCKET;
+#else
+using native_socket = int;
+#endif
+
+// Report a closed peer as a send error instead of raising SIGPIPE
+#if defined(MSG_NOSIGNAL)
+constexpr int const send_flags = MSG_NOSIGNAL;
+#else
+constexpr int const send_flags = 0;
+#endif
+
+inline native_socket native(cli::socket_t sock)
+{
+    return static_cast<native_socket>(sock);
+}
+
+inline cli::socket_t wrap(native_socket sock)
+{
+#if defined(_WIN32)
+    if (INVALID_SOCKET == sock) return cli::invalid_socket;
+#endif
+    return static_cast<cli::socket_t>(sock);
+}
+
+bool make_address(const std::string& path, sockaddr_un& addr)
+{
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Removes the socket file left behind by a previous run; false when path is something else
+bool remove_stale_socket(const std::string& path)
+{
+#if defined(_WIN32)
+    // AF_UNIX socket files are reparse points on Windows
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (INVALID_FILE_ATTRIBUTES == attributes) return true;
+    if (0 == (attributes & FILE_ATTRIBUTE_REPARSE_POINT) || 0 != (attributes & FILE_ATTRIBUTE_DIRECTORY)) return false;
+    return 0 != DeleteFileA(path.c_str());
+#else
+    struct stat info;
+    if (0 != lstat(path.c_str(), &info)) return ENOENT == errno;
+    if (!S_ISSOCK(info.st_mode)) return false;
+    return 0 == unlink(path.c_str());
+#endif
+}
+} // namespace impl
+
+namespace cli
+{
+bool socket_startup()
+{
+#if defined(_WIN32)
+    WSADATA data;
+    return 0 == WSAStartup(MAKEWORD(2, 2), &data);
+#else
+    return true;
+#endif
+}
+
+void close_socket(socket_t sock)
+{
+    if (invalid_socket == sock) return;
+#if defined(_WIN32)
+    closesocket(impl::native(sock));
+#else
+    close(impl::native(sock));
+#endif
+}
+
+socket_t listen_local(const std::string& path)
+{
+    sockaddr_un addr;
+    if (!impl::make_address(path, addr)) return invalid_socket;
+
+    // Never take over the socket of a server that is still running
+    socket_t running = connect_local(path);
+    if (invalid_socket != running) {
+        close_socket(running);
+        return invalid_socket;
+    }
+    if (!impl::remove_stale_socket(path)) return invalid_socket;
+
+    socket_t server = impl::wrap(socket(AF_UNIX, SOCK_STREAM, 0));
+    if (invalid_socket == server) return invalid_socket;
+
+    if (0 != bind(impl::native(server), reinterpret_cast<sockaddr*>(&addr), sizeof addr)
+        || 0 != listen(impl::native(server), 8)) {
+        close_socket(server);
+        return invalid_socket;
+    }
+    return server;
+}
+
+socket_t connect_local(const std::string& path)
+{
+    sockaddr_un addr;
+    if (!impl::make_address(path, addr)) return invalid_socket;
+
+    socket_t sock = impl::wrap(socket(AF_UNIX, SOCK_STREAM, 0));
+    if (invalid_socket == sock) return invalid_socket;
+
+    if (0 != connect(impl::native(sock), reinterpret_cast<sockaddr*>(&addr), sizeof addr)) {
+        close_socket(sock);
+        return invalid_socket;
+    }
+    return sock;
+}
+
+socket_t listen_tcp(std::uint16_t port)
+{
+    socket_t server = impl::wrap(socket(AF_INET, SOCK_STREAM, 0));
+    if (invalid_socket == server) return invalid_socket;
+
+    // Allow restarting right away while connections of the previous run are in TIME_WAIT
+    int reuse = 1;
+    setsockopt(impl::native(server), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof reuse);
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (0 != bind(impl::native(server), reinterpret_cast<sockaddr*>(&addr), sizeof addr)
+        || 0 != listen(impl::native(server), 8)) {
+        close_socket(server);
+        return invalid_socket;
+    }
+    return server;
+}
+
+socket_t connect_tcp(std::uint16_t port)
+{
+    socket_t sock = impl::wrap(socket(AF_INET, SOCK_STREAM, 0));
+    if (invalid_socket == sock) return invalid_socket;
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (0 != connect(impl::native(sock), reinterpret_cast<sockaddr*>(&addr), sizeof addr)) {
+        close_socket(sock);
+        return invalid_socket;
+    }
+    return sock;
+}
+
+socket_t accept_client(socket_t server)
+{
+    return impl::wrap(accept(impl::native(server), nullptr, nullptr));
+}
+
+bool wait_readable(socket_t sock, int timeout_ms)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(impl::native(sock), &readable);
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return 0 < select(static_cast<int>(impl::native(sock) + 1), &readable, nullptr, nullptr, &timeout);
+}
+
+bool set_send_timeout(socket_t sock, int timeout_ms)
+{
+#if defined(_WIN32)
+    DWORD timeout = static_cast<DWORD>(timeout_ms);
+#else
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+#endif
+    return 0 == setsockopt(impl::native(sock), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof timeout);
+}
+
+bool send_all(socket_t sock, const char* data, std::size_t size)
+{
+    while (0 < size) {
+        auto sent = send(impl::native(sock), data, static_cast<int>(size), impl::send_flags);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+long recv_some(socket_t sock, char* data, std::size_t size)
+{
+    return static_cast<long>(recv(impl::native(sock), data, static_cast<int>(size), 0));
+}
+} // namespace cli
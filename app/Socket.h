@@ -0,0 +1,37 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cli
+{
+// Native socket handle (SOCKET on Windows, file descriptor elsewhere)
+using socket_t = std::intptr_t;
+constexpr socket_t const invalid_socket = -1;
+
+// Must be called once before any other socket function
+bool socket_startup();
+void close_socket(socket_t sock);
+
+// Local (AF_UNIX) stream sockets.
+// listen_local only replaces a stale socket file; it fails when path is any other file or a server answers on it.
+socket_t listen_local(const std::string& path);
+socket_t connect_local(const std::string& path);
+
+// Loopback TCP stream sockets
+socket_t listen_tcp(std::uint16_t port);
+socket_t connect_tcp(std::uint16_t port);
+
+socket_t accept_client(socket_t server);
+// Waits until a read (or accept) would not block; false on timeout or error
+bool wait_readable(socket_t sock, int timeout_ms);
+// Makes a blocked send fail after timeout_ms so that a stalled peer can be dropped
+bool set_send_timeout(socket_t sock, int timeout_ms);
+bool send_all(socket_t sock, const char* data, std::size_t size);
+// Returns the number of bytes received, 0 on orderly shutdown and -1 on error
+long recv_some(socket_t sock, char* data, std::size_t size);
+} // namespace cli
+
+#endif // !SOCKET_H
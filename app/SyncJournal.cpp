@@ -0,0 +1,179 @@
+#include "SyncJournal.h"
+#include <algorithm>
+#include <sstream>
+#if defined(__GNUC__) && __GNUC__ < 8
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+namespace SDK = SCRSDK;
+
+namespace impl
+{
+constexpr char const journal_name[] = ".remotecli-sync";
+constexpr cli::text_char const field_separator = TEXT('\t');
+// Only the journal writes files with this suffix, so it may remove the ones an interrupted sync left behind
+constexpr cli::text_char const partial_suffix[] = TEXT(".remotecli-part");
+
+// MAC addresses and serial numbers may contain characters that are not allowed in file names
+std::string file_name_of(const cli::text& camera_id)
+{
+    std::string name;
+    for (auto c : camera_id) {
+        bool plain = (TEXT('0') <= c && c <= TEXT('9')) || (TEXT('A') <= c && c <= TEXT('Z')) || (TEXT('a') <= c && c <= TEXT('z'));
+        name += plain ? static_cast<char>(c) : '_';
+    }
+    return name;
+}
+} // namespace impl
+
+namespace cli
+{
+SyncJournal::SyncJournal(const std::string& dir, const text& camera_id)
+    : m_dir(dir)
+    , m_path((fs::path(dir) / impl::journal_name).string())
+    , m_camera_dir(impl::file_name_of(camera_id))
+    , m_camera_id(camera_id)
+{}
+
+bool SyncJournal::open()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::error_code ec;
+    fs::create_directories(m_dir, ec);
+
+    std::basic_ifstream<text_char> in(m_path);
+    for (text line; std::getline(in, line);) {
+        std::basic_istringstream<text_char> fields(line);
+        Record record;
+        text size;
+        if (!std::getline(fields, record.camera_id, impl::field_separator) || !std::getline(fields, size, impl::field_separator)
+            || !std::getline(fields, record.date, impl::field_separator) || !std::getline(fields, record.folder, impl::field_separator)
+            || !std::getline(fields, record.name)) {
+            // A line cut short by a crash
+            continue;
+        }
+        if (record.camera_id != m_camera_id) {
+            m_foreign.push_back(line);
+            continue;
+        }
+        try {
+            record.size = std::stoull(size);
+        }
+        catch (const std::exception&) {
+            continue;
+        }
+        m_synced[key(record)] = record;
+    }
+    in.close();
+
+    m_out.open(m_path, std::ios::out | std::ios::app);
+    return m_out.good();
+}
+
+bool SyncJournal::needs_sync(const SDK::CrMtpContentsInfo& info, const text& folder, text& dir, text& file_name)
+{
+    Record record{ m_camera_id, info.contentSize, text(info.dateChar, std::find(info.dateChar, info.dateChar + 16, 0)),
+        folder, info.fileName ? text(info.fileName) : text() };
+    auto target = fs::path(m_dir) / m_camera_dir / record.folder / record.name;
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_synced.find(key(record));
+    bool journaled = (m_synced.end() != it);
+    if (journaled && it->second.size == record.size && it->second.date == record.date && present(record)) {
+        ++m_skipped;
+        return false;
+    }
+    std::error_code ec;
+    if (!journaled && fs::exists(target, ec)) {
+        ++m_conflicts;
+        return false;
+    }
+
+    auto partial = target;
+    partial += impl::partial_suffix;
+    fs::create_directories(target.parent_path(), ec);
+    fs::remove(partial, ec);
+    dir = target.parent_path().native();
+    file_name = partial.filename().native();
+    m_pending[info.handle] = record;
+    return true;
+}
+
+bool SyncJournal::complete(SDK::CrContentHandle handle, text& file)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_pending.find(handle);
+    if (m_pending.end() == it) return false;
+    Record record = it->second;
+    m_pending.erase(it);
+
+    // A file that appeared in its place meanwhile is left alone, and so is the download
+    auto target = fs::path(m_dir) / m_camera_dir / record.folder / record.name;
+    std::error_code ec;
+    if (m_synced.end() == m_synced.find(key(record)) && fs::exists(target, ec)) {
+        ++m_conflicts;
+        return false;
+    }
+    fs::rename(fs::path(file), target, ec);
+    if (ec) return false;
+    file = target.native();
+
+    m_out << format(record) << std::endl;
+    m_synced[key(record)] = record;
+    return m_out.good();
+}
+
+bool SyncJournal::compact()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_out.close();
+
+    std::string temp = m_path + ".tmp";
+    {
+        std::basic_ofstream<text_char> out(temp, std::ios::out | std::ios::trunc);
+        for (auto& line : m_foreign) out << line << TEXT('\n');
+        for (auto& synced : m_synced) out << format(synced.second) << TEXT('\n');
+        if (!out.good()) return false;
+    }
+    std::error_code ec;
+    fs::rename(temp, m_path, ec);
+    m_out.open(m_path, std::ios::out | std::ios::app);
+    return !ec;
+}
+
+std::uint64_t SyncJournal::skipped() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_skipped;
+}
+
+std::uint64_t SyncJournal::conflicts() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_conflicts;
+}
+
+text SyncJournal::format(const Record& record)
+{
+    std::basic_ostringstream<text_char> line;
+    line << record.camera_id << impl::field_separator << record.size << impl::field_separator
+        << record.date << impl::field_separator << record.folder << impl::field_separator << record.name;
+    return line.str();
+}
+
+text SyncJournal::key(const Record& record)
+{
+    return record.folder + TEXT('/') + record.name;
+}
+
+bool SyncJournal::present(const Record& record) const
+{
+    std::error_code ec;
+    auto size = fs::file_size(fs::path(m_dir) / m_camera_dir / record.folder / record.name, ec);
+    return !ec && size == record.size;
+}
+} // namespace cli
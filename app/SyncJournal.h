@@ -0,0 +1,72 @@
+#ifndef SYNCJOURNAL_H
+#define SYNCJOURNAL_H
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "Text.h"
+
+namespace cli
+{
+// Records which files of a camera were completely copied to a directory, so a later or interrupted sync
+// only pulls what is missing. Files go to <dir>/<camera ID>/<folder>/<name>, so cameras and folders never collide.
+// The journal lives in the directory as a text file with one line per file:
+//   camera ID <tab> size <tab> date <tab> folder <tab> name
+// Lines are appended and flushed as each file completes, so a crash loses at most the files in flight.
+// A file is downloaded under a temporary name and renamed once complete; the journal never deletes or
+// overwrites a file it did not write.
+class SyncJournal
+{
+public:
+    SyncJournal(const std::string& dir, const text& camera_id);
+
+    // Reads the journal, if any, and opens it for appending
+    bool open();
+
+    // True unless the file was synced before and is still on disk with the recorded size, or another file
+    // is in its place. When true, dir and file_name are set to where the download has to go.
+    bool needs_sync(const SCRSDK::CrMtpContentsInfo& info, const text& folder, text& dir, text& file_name);
+    // Moves a file that needs_sync() selected to its name once its download to file completed, and journals it.
+    // file is then its final path.
+    bool complete(SCRSDK::CrContentHandle handle, text& file);
+    // Rewrites the journal without superseded lines
+    bool compact();
+
+    std::uint64_t skipped() const;
+    // Files left out because a file the journal did not write has their name
+    std::uint64_t conflicts() const;
+
+private:
+    struct Record
+    {
+        text camera_id;
+        CrInt64u size;
+        text date;
+        text folder;
+        text name;
+    };
+
+    static text format(const Record& record);
+    static text key(const Record& record);
+    bool present(const Record& record) const;
+
+    std::string m_dir;
+    std::string m_path;
+    std::string m_camera_dir;
+    text m_camera_id;
+
+    mutable std::mutex m_mtx;
+    std::basic_ofstream<text_char> m_out;
+    std::unordered_map<text, Record> m_synced; // By folder and name, this camera only
+    std::vector<text> m_foreign;               // Lines of other cameras, kept as they are
+    std::unordered_map<SCRSDK::CrContentHandle, Record> m_pending;
+    std::uint64_t m_skipped = 0;
+    std::uint64_t m_conflicts = 0;
+};
+} // namespace cli
+
+#endif // !SYNCJOURNAL_H
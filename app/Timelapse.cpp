@@ -0,0 +1,87 @@
+#include "Timelapse.h"
+#include <algorithm>
+#include <thread>
+
+namespace cli
+{
+Timelapse::Timelapse(CameraDevice& camera, TimelapsePolicy policy, std::size_t max_in_transfer)
+    : m_policy(policy)
+    , m_max_in_transfer(std::max<std::size_t>(max_in_transfer, 1))
+    , m_shots(camera)
+{}
+
+bool Timelapse::run(std::uint32_t count, std::chrono::milliseconds interval, std::chrono::milliseconds download_timeout)
+{
+    m_interval = interval;
+    bool success = m_shots.begin();
+    // The first frame is due once the camera has focused
+    m_started = std::chrono::steady_clock::now();
+
+    // Deadlines count from the anchor, which only moves when the interval is lengthened
+    auto anchor = m_started;
+    std::uint32_t anchor_frame = 0;
+    auto previous_issue = m_started;
+    for (std::uint32_t frame = 0; frame < count; ++frame) {
+        ++m_scheduled;
+        auto deadline = anchor + (frame - anchor_frame) * m_interval;
+        std::this_thread::sleep_until(deadline);
+
+        bool late = deadline + m_interval / 2 < std::chrono::steady_clock::now();
+        bool backlog = m_max_in_transfer <= m_shots.in_transfer();
+        if (late || backlog) {
+            if (TimelapsePolicy::skip == m_policy) {
+                ++m_skipped;
+                success = false;
+                report(frame, late ? TimelapseFrame::skipped_late : TimelapseFrame::skipped_backlog, std::chrono::microseconds(0));
+                continue;
+            }
+            if (backlog) m_shots.wait_for_transfers(m_max_in_transfer - 1, download_timeout);
+            // At least as long as the camera and the downloads actually needed for the last frame
+            auto now = std::chrono::steady_clock::now();
+            m_interval = std::max(m_interval * 5 / 4, std::chrono::duration_cast<std::chrono::milliseconds>(now - previous_issue));
+            anchor = now;
+            anchor_frame = frame;
+            ++m_adapted;
+        }
+
+        // Measured against the original deadline, so an adapted frame shows how late it was
+        previous_issue = std::chrono::steady_clock::now();
+        auto jitter = std::chrono::duration_cast<std::chrono::microseconds>(previous_issue - deadline);
+        bool captured = m_shots.fire(frame);
+        m_jitter.push_back(jitter);
+        success = captured && success;
+        report(frame, captured ? TimelapseFrame::fired : TimelapseFrame::not_captured, jitter);
+    }
+
+    success = m_shots.finish(download_timeout) && success;
+    m_finished = std::chrono::steady_clock::now();
+    return success;
+}
+
+TimelapseStats Timelapse::stats() const
+{
+    TimelapseStats result{};
+    result.scheduled = m_scheduled;
+    result.fired = static_cast<std::uint32_t>(m_jitter.size());
+    result.skipped = m_skipped;
+    result.adapted = m_adapted;
+    result.interval = m_interval;
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(m_finished - m_started);
+
+    if (!m_jitter.empty()) {
+        auto jitter = m_jitter;
+        std::sort(jitter.begin(), jitter.end());
+        auto at = [&](double p) { return jitter[static_cast<std::size_t>(p * (jitter.size() - 1))]; };
+        result.jitter_p50 = at(0.50);
+        result.jitter_p90 = at(0.90);
+        result.jitter_p99 = at(0.99);
+        result.jitter_max = at(1.0);
+    }
+    return result;
+}
+
+void Timelapse::report(std::uint32_t frame, TimelapseFrame result, std::chrono::microseconds jitter)
+{
+    if (m_frame_sink) m_frame_sink(frame, result, jitter);
+}
+} // namespace cli
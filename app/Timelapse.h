@@ -0,0 +1,86 @@
+#ifndef TIMELAPSE_H
+#define TIMELAPSE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BurstCapture.h"
+#include "CameraDevice.h"
+
+namespace cli
+{
+// What to do with a frame when the camera or the downloads cannot keep up with the interval
+enum class TimelapsePolicy
+{
+    skip,  // Leave the frame out and keep the schedule
+    adapt  // Take the frame late and lengthen the interval from then on
+};
+
+enum class TimelapseFrame
+{
+    fired,
+    not_captured,
+    skipped_late,    // The camera was still busy with earlier frames
+    skipped_backlog  // Too many images were still downloading
+};
+
+struct TimelapseStats
+{
+    std::uint32_t scheduled;
+    std::uint32_t fired;
+    std::uint32_t skipped;
+    std::uint32_t adapted; // Times the interval was lengthened
+    std::chrono::milliseconds interval; // At the end
+    std::chrono::milliseconds elapsed;
+    // Release sent minus the frame's deadline, over the fired frames
+    std::chrono::microseconds jitter_p50;
+    std::chrono::microseconds jitter_p90;
+    std::chrono::microseconds jitter_p99;
+    std::chrono::microseconds jitter_max;
+};
+
+// Fires a frame at every multiple of the interval from the start. Deadlines are absolute,
+// so time spent on a frame or oversleeping never shifts the frames after it.
+// A frame is behind when its deadline passed by more than half an interval before the camera was ready,
+// or when max_in_transfer images are still downloading; the policy decides what happens to it.
+class Timelapse
+{
+public:
+    // Called for every scheduled frame, on the caller's thread; jitter is zero for skipped frames
+    using FrameSink = std::function<void(std::uint32_t frame, TimelapseFrame result, std::chrono::microseconds jitter)>;
+
+    Timelapse(CameraDevice& camera, TimelapsePolicy policy, std::size_t max_in_transfer);
+
+    Timelapse(const Timelapse&) = delete;
+    Timelapse& operator=(const Timelapse&) = delete;
+
+    void set_frame_sink(FrameSink sink) { m_frame_sink = std::move(sink); }
+    // Images are reported as they are saved, numbered by frame
+    void set_result_sink(BurstCapture::ResultSink sink) { m_shots.set_result_sink(std::move(sink)); }
+
+    // True when every scheduled frame was fired, captured and saved
+    bool run(std::uint32_t count, std::chrono::milliseconds interval, std::chrono::milliseconds download_timeout);
+
+    TimelapseStats stats() const;
+    BurstStats shot_stats() const { return m_shots.stats(); }
+
+private:
+    void report(std::uint32_t frame, TimelapseFrame result, std::chrono::microseconds jitter);
+
+    TimelapsePolicy m_policy;
+    std::size_t m_max_in_transfer;
+    BurstCapture m_shots;
+    FrameSink m_frame_sink;
+
+    std::uint32_t m_scheduled = 0;
+    std::uint32_t m_skipped = 0;
+    std::uint32_t m_adapted = 0;
+    std::chrono::milliseconds m_interval{ 0 };
+    std::chrono::steady_clock::time_point m_started;
+    std::chrono::steady_clock::time_point m_finished;
+    std::vector<std::chrono::microseconds> m_jitter;
+};
+} // namespace cli
+
+#endif // !TIMELAPSE_H
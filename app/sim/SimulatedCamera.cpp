@@ -0,0 +1,665 @@
+#include "SimulatedCamera.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace SDK = SCRSDK;
+
+namespace impl
+{
+// Possible values the simulated camera reports, as a camera body would
+const CrInt16u f_numbers[] = { 280, 400, 560, 800, 1100, 1600 };
+const CrInt32u shutter_speeds[] = { 0x00010FA0, 0x000107D0, 0x000103E8, 0x000101F4, 0x000100FA, 0x0001007D, 0x0001003C, 0x0001001E, 0x000A000A };
+const CrInt32u iso_sensitivities[] = { 100, 200, 400, 800, 1600, 3200, 6400 };
+const CrInt16 exposure_biases[] = { -3000, -2700, -2300, -2000, -1700, -1300, -1000, -700, -300, 0, 300, 700, 1000, 1300, 1700, 2000, 2300, 2700, 3000 };
+const CrInt16u white_balances[] = { SDK::CrWhiteBalance_AWB, SDK::CrWhiteBalance_Daylight, SDK::CrWhiteBalance_Shadow, SDK::CrWhiteBalance_Cloudy };
+const CrInt32u exposure_programs[] = { SDK::CrExposure_M_Manual, SDK::CrExposure_P_Auto, SDK::CrExposure_A_AperturePriority, SDK::CrExposure_S_ShutterSpeedPriority };
+const CrInt16u focus_modes[] = { SDK::CrFocus_MF, SDK::CrFocus_AF_S, SDK::CrFocus_AF_C };
+const CrInt32u drive_modes[] = { SDK::CrDrive_Single, SDK::CrDrive_Continuous_Hi, SDK::CrDrive_Continuous_Lo };
+const CrInt16u focus_areas[] = { SDK::CrFocusArea_Wide, SDK::CrFocusArea_Zone, SDK::CrFocusArea_Center };
+const CrInt16u live_view_qualities[] = { SDK::CrPropertyLiveViewImageQuality_Low, SDK::CrPropertyLiveViewImageQuality_High };
+const CrInt16u priority_keys[] = { SDK::CrPriorityKey_CameraPosition, SDK::CrPriorityKey_PCRemote };
+const CrInt8 zoom_speed_range[] = { -8, 8, 1 };
+
+// Size of the images on the memory card; the live view is a quarter of it
+constexpr std::uint32_t const image_width = 1600;
+constexpr std::uint32_t const image_height = 1200;
+
+// Reads one element of a possible value list
+std::int64_t element(const void* values, SDK::CrDataType type, std::size_t index)
+{
+    bool is_signed = 0 != (type & SDK::CrDataType_SignBit);
+    switch (type & 0x0FFF) {
+    case SDK::CrDataType_UInt8:
+        return is_signed ? static_cast<const CrInt8*>(values)[index] : static_cast<const CrInt8u*>(values)[index];
+    case SDK::CrDataType_UInt16:
+        return is_signed ? static_cast<const CrInt16*>(values)[index] : static_cast<const CrInt16u*>(values)[index];
+    case SDK::CrDataType_UInt32:
+        return is_signed ? static_cast<const CrInt32*>(values)[index] : static_cast<const CrInt32u*>(values)[index];
+    default:
+        return static_cast<const CrInt64*>(values)[index];
+    }
+}
+
+std::size_t element_size(SDK::CrDataType type)
+{
+    switch (type & 0x0FFF) {
+    case SDK::CrDataType_UInt8: return 1;
+    case SDK::CrDataType_UInt16: return 2;
+    case SDK::CrDataType_UInt32: return 4;
+    default: return 8;
+    }
+}
+
+// Values of an unsigned type come back zero extended, signed ones sign extended
+std::int64_t as_signed(CrInt64u value, SDK::CrDataType type)
+{
+    if (0 == (type & SDK::CrDataType_SignBit)) return static_cast<std::int64_t>(value);
+    switch (type & 0x0FFF) {
+    case SDK::CrDataType_UInt8: return static_cast<CrInt8>(value);
+    case SDK::CrDataType_UInt16: return static_cast<CrInt16>(value);
+    case SDK::CrDataType_UInt32: return static_cast<CrInt32>(value);
+    default: return static_cast<std::int64_t>(value);
+    }
+}
+
+sim::sim_string widen(const std::string& s)
+{
+    return sim::sim_string(s.begin(), s.end());
+}
+
+FILE* open_file(const sim::sim_string& path)
+{
+#if defined(_WIN32) && (defined(UNICODE) || defined(_UNICODE))
+    return _wfopen(path.c_str(), L"wb");
+#else
+    return std::fopen(path.c_str(), "wb");
+#endif
+}
+
+// The image layout of the SDK, whose fields the SDK fills but keeps private
+struct ImageInfoFields
+{
+    CrInt32u width;
+    CrInt32u height;
+    CrInt32u bufferSize;
+};
+static_assert(sizeof(ImageInfoFields) == sizeof(SDK::CrImageInfo), "CrImageInfo layout changed");
+
+struct ImageDataBlockFields
+{
+    CrInt32u frameNo;
+    CrInt32u size;
+    CrInt8u* pData;
+    CrInt32u imageSize;
+};
+static_assert(sizeof(ImageDataBlockFields) == sizeof(SDK::CrImageDataBlock), "CrImageDataBlock layout changed");
+
+SDK::CrError fill_block(SDK::CrImageDataBlock* block, const std::vector<CrInt8u>& jpeg, std::uint64_t frame)
+{
+    auto* fields = reinterpret_cast<ImageDataBlockFields*>(block);
+    if (!fields->pData || fields->size < jpeg.size()) return SDK::CrError_Memory_Insufficient;
+    std::memcpy(fields->pData, jpeg.data(), jpeg.size());
+    fields->imageSize = static_cast<CrInt32u>(jpeg.size());
+    fields->frameNo = static_cast<CrInt32u>(frame);
+    return SDK::CrError_None;
+}
+} // namespace impl
+
+namespace sim
+{
+namespace
+{
+std::uint64_t env_number(const char* name, std::uint64_t fallback)
+{
+    const char* value = std::getenv(name);
+    if (!value || !*value) return fallback;
+    return std::strtoull(value, nullptr, 10);
+}
+
+std::chrono::milliseconds env_ms(const char* name, std::chrono::milliseconds fallback)
+{
+    return std::chrono::milliseconds(env_number(name, fallback.count()));
+}
+} // namespace
+
+SimConfig SimConfig::from_environment()
+{
+    SimConfig config;
+    config.cameras = static_cast<std::uint32_t>(env_number("CRSIM_CAMERAS", config.cameras));
+    config.seed = static_cast<std::uint32_t>(env_number("CRSIM_SEED", config.seed));
+    config.jitter = env_ms("CRSIM_JITTER_MS", config.jitter);
+    config.connect = env_ms("CRSIM_CONNECT_MS", config.connect);
+    config.get = env_ms("CRSIM_GET_MS", config.get);
+    config.set = env_ms("CRSIM_SET_MS", config.set);
+    config.autofocus = env_ms("CRSIM_AF_MS", config.autofocus);
+    config.focus_step = env_ms("CRSIM_FOCUS_STEP_MS", config.focus_step);
+    config.capture = env_ms("CRSIM_CAPTURE_MS", config.capture);
+    config.save = env_ms("CRSIM_SAVE_MS", config.save);
+    config.dial = env_ms("CRSIM_DIAL_MS", config.dial);
+    config.live_view_fps = static_cast<std::uint32_t>(env_number("CRSIM_LIVEVIEW_FPS", config.live_view_fps));
+    config.live_view_bytes = static_cast<std::uint32_t>(env_number("CRSIM_LIVEVIEW_BYTES", config.live_view_bytes));
+    config.live_view = env_ms("CRSIM_LIVEVIEW_MS", config.live_view);
+    config.folders = static_cast<std::uint32_t>(env_number("CRSIM_FOLDERS", config.folders));
+    config.contents = static_cast<std::uint32_t>(env_number("CRSIM_CONTENTS", config.contents));
+    config.content_bytes = env_number("CRSIM_CONTENT_BYTES", config.content_bytes);
+    config.mtp = env_ms("CRSIM_MTP_MS", config.mtp);
+    config.transfer = env_ms("CRSIM_TRANSFER_MS", config.transfer);
+    config.transfer_mbps = static_cast<std::uint32_t>(env_number("CRSIM_TRANSFER_MBPS", config.transfer_mbps));
+    if (config.live_view_fps < 1) config.live_view_fps = 1;
+    return config;
+}
+
+std::vector<CrInt8u> make_jpeg(std::uint32_t width, std::uint32_t height, std::uint64_t frame, std::uint64_t size)
+{
+    std::vector<CrInt8u> head;
+    std::vector<CrInt8u> tail;
+    auto marker = [](std::vector<CrInt8u>& out, CrInt8u code) { out.push_back(0xFF); out.push_back(code); };
+    auto put16 = [](std::vector<CrInt8u>& out, std::size_t value) {
+        out.push_back(static_cast<CrInt8u>(value >> 8));
+        out.push_back(static_cast<CrInt8u>(value & 0xFF));
+    };
+
+    marker(head, 0xD8); // SOI
+    std::string comment = "CRSIM frame " + std::to_string(frame);
+    marker(head, 0xFE); // COM
+    put16(head, 2 + comment.size());
+    head.insert(head.end(), comment.begin(), comment.end());
+
+    marker(tail, 0xDB); // DQT: table 0, every coefficient quantized by 1
+    put16(tail, 67);
+    tail.push_back(0x00);
+    tail.insert(tail.end(), 64, 1);
+    marker(tail, 0xC0); // SOF0: 8 bit greyscale
+    put16(tail, 11);
+    tail.push_back(8);
+    put16(tail, height);
+    put16(tail, width);
+    tail.push_back(1);
+    tail.push_back(1);
+    tail.push_back(0x11);
+    tail.push_back(0);
+    // A flat grey image needs one Huffman code per table: DC difference 0, and end of block
+    for (CrInt8u table : { CrInt8u(0x00), CrInt8u(0x10) }) {
+        marker(tail, 0xC4); // DHT
+        put16(tail, 2 + 1 + 16 + 1);
+        tail.push_back(table);
+        tail.push_back(1);
+        tail.insert(tail.end(), 15, 0);
+        tail.push_back(0x00);
+    }
+    marker(tail, 0xDA); // SOS
+    put16(tail, 8);
+    tail.push_back(1);
+    tail.push_back(1);
+    tail.push_back(0x00);
+    tail.push_back(0);
+    tail.push_back(63);
+    tail.push_back(0);
+    // Two zero bits per block, the last byte padded with ones
+    std::uint64_t bits = 2ull * ((width + 7) / 8) * ((height + 7) / 8);
+    tail.insert(tail.end(), static_cast<std::size_t>((bits + 7) / 8), 0x00);
+    if (bits % 8) tail.back() = static_cast<CrInt8u>(0xFF >> (bits % 8));
+    marker(tail, 0xD9); // EOI
+
+    // Comments up to the requested size, each at most 65533 bytes of payload
+    std::uint64_t used = head.size() + tail.size();
+    std::vector<CrInt8u> jpeg;
+    jpeg.reserve(static_cast<std::size_t>(std::max(size, used)));
+    jpeg.insert(jpeg.end(), head.begin(), head.end());
+    while (used + 4 <= size) {
+        auto payload = static_cast<std::size_t>(std::min<std::uint64_t>(size - used - 4, 65533));
+        marker(jpeg, 0xFE);
+        put16(jpeg, 2 + payload);
+        jpeg.insert(jpeg.end(), payload, 0x00);
+        used += 4 + payload;
+    }
+    jpeg.insert(jpeg.end(), tail.begin(), tail.end());
+    return jpeg;
+}
+
+SimulatedCamera::SimulatedCamera(const SimConfig& config, std::uint32_t index, SDK::IDeviceCallback* callback, SDK::CrSdkControlMode mode)
+    : m_config(config)
+    , m_index(index)
+    , m_callback(callback)
+    , m_connected(Clock::now())
+    , m_save_free(m_connected)
+    , m_transfer_free(m_connected)
+    , m_random(config.seed + index)
+{
+    auto add = [&](CrInt32u code, CrInt64u value, SDK::CrDataType type, const void* values = nullptr, std::size_t values_size = 0) {
+        m_properties[code] = Property{ value, type, values, static_cast<CrInt32u>(values_size) };
+    };
+    add(SDK::CrDeviceProperty_FNumber, 400, SDK::CrDataType_UInt16Array, impl::f_numbers, sizeof impl::f_numbers);
+    add(SDK::CrDeviceProperty_ShutterSpeed, 0x0001007D, SDK::CrDataType_UInt32Array, impl::shutter_speeds, sizeof impl::shutter_speeds);
+    add(SDK::CrDeviceProperty_IsoSensitivity, 100, SDK::CrDataType_UInt32Array, impl::iso_sensitivities, sizeof impl::iso_sensitivities);
+    add(SDK::CrDeviceProperty_ExposureBiasCompensation, 0, SDK::CrDataType_Int16Array, impl::exposure_biases, sizeof impl::exposure_biases);
+    add(SDK::CrDeviceProperty_WhiteBalance, SDK::CrWhiteBalance_AWB, SDK::CrDataType_UInt16Array, impl::white_balances, sizeof impl::white_balances);
+    add(SDK::CrDeviceProperty_ExposureProgramMode, SDK::CrExposure_M_Manual, SDK::CrDataType_UInt32Array, impl::exposure_programs, sizeof impl::exposure_programs);
+    add(SDK::CrDeviceProperty_FocusMode, SDK::CrFocus_AF_S, SDK::CrDataType_UInt16Array, impl::focus_modes, sizeof impl::focus_modes);
+    add(SDK::CrDeviceProperty_DriveMode, SDK::CrDrive_Single, SDK::CrDataType_UInt32Array, impl::drive_modes, sizeof impl::drive_modes);
+    add(SDK::CrDeviceProperty_FocusArea, SDK::CrFocusArea_Wide, SDK::CrDataType_UInt16Array, impl::focus_areas, sizeof impl::focus_areas);
+    add(SDK::CrDeviceProperty_LiveView_Image_Quality, SDK::CrPropertyLiveViewImageQuality_High, SDK::CrDataType_UInt16Array, impl::live_view_qualities, sizeof impl::live_view_qualities);
+    add(SDK::CrDeviceProperty_PriorityKeySettings, SDK::CrPriorityKey_CameraPosition, SDK::CrDataType_UInt16Array, impl::priority_keys, sizeof impl::priority_keys);
+    add(SDK::CrDeviceProperty_Zoom_Speed_Range, 0, SDK::CrDataType_Int8Range, impl::zoom_speed_range, sizeof impl::zoom_speed_range);
+    add(SDK::CrDeviceProperty_FileType, SDK::CrFileType_Jpeg, SDK::CrDataType_UInt16);
+    add(SDK::CrDeviceProperty_LiveViewStatus, SDK::CrLiveView_Enable, SDK::CrDataType_UInt16);
+    add(SDK::CrDeviceProperty_S1, SDK::CrLockIndicator_Unlocked, SDK::CrDataType_UInt16);
+    add(SDK::CrDeviceProperty_S2, SDK::CrLockIndicator_Unlocked, SDK::CrDataType_UInt16);
+    add(SDK::CrDeviceProperty_NearFar, SDK::CrNearFar_Enable, SDK::CrDataType_Int16);
+    add(SDK::CrDeviceProperty_FocusIndication, SDK::CrFocusIndicator_Unlocked, SDK::CrDataType_UInt32);
+    add(SDK::CrDeviceProperty_ContentsTransferStatus, SDK::CrContentsTransfer_ON, SDK::CrDataType_UInt16);
+    add(SDK::CrDeviceProperty_SdkControlMode, mode, SDK::CrDataType_UInt32);
+
+    for (std::uint32_t f = 0; f < m_config.folders; ++f) {
+        m_folders.push_back(0x1000 + f);
+        for (std::uint32_t c = 0; c < m_config.contents; ++c) add_content(m_folders.back(), m_config.content_bytes);
+    }
+
+    m_clock = std::thread(&SimulatedCamera::run, this);
+    auto connected = m_connected + latency(m_config.connect);
+    schedule(connected, [this] { m_callback->OnConnected(SDK::DEVICE_CONNECTION_VERSION_RCP3); });
+    if (0 < m_config.dial.count()) schedule(connected + m_config.dial, [this] { turn_dial(); });
+}
+
+SimulatedCamera::~SimulatedCamera()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_clock_mtx);
+        m_running = false;
+    }
+    m_clock_cv.notify_one();
+    if (m_clock.joinable()) m_clock.join();
+}
+
+void SimulatedCamera::disconnect()
+{
+    schedule(Clock::now(), [this] { m_callback->OnDisconnected(0); });
+}
+
+SDK::CrError SimulatedCamera::get_properties(const std::vector<CrInt32u>& codes, SDK::CrDeviceProperty** properties, CrInt32* count)
+{
+    if (!properties || !count) return SDK::CrError_Generic_InvalidParameter;
+    std::this_thread::sleep_for(latency(m_config.get));
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::vector<std::pair<CrInt32u, const Property*>> found;
+    if (codes.empty()) {
+        for (auto& property : m_properties) found.emplace_back(property.first, &property.second);
+    }
+    for (auto code : codes) {
+        auto it = m_properties.find(code);
+        if (it != m_properties.end()) found.emplace_back(code, &it->second);
+    }
+
+    auto* out = new SDK::CrDeviceProperty[found.size() ? found.size() : 1];
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        const auto& property = *found[i].second;
+        out[i].SetCode(found[i].first);
+        out[i].SetValueType(property.type);
+        out[i].SetCurrentValue(property.value);
+        out[i].SetValues(static_cast<CrInt8u*>(const_cast<void*>(property.values)));
+        out[i].SetValueSize(property.values_size);
+        out[i].SetSetValues(static_cast<CrInt8u*>(const_cast<void*>(property.values)));
+        out[i].SetSetValueSize(property.values_size);
+    }
+    *properties = out;
+    *count = static_cast<CrInt32>(found.size());
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::set_property(CrInt32u code, CrInt64u value)
+{
+    auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto it = m_properties.find(code);
+        // Properties the simulation does not model take any value, like a camera with more features
+        if (it == m_properties.end()) it = m_properties.emplace(code, Property{ value, SDK::CrDataType_Undefined, nullptr, 0 }).first;
+        // The camera ignores a value it does not offer, without an error
+        if (!accepts(it->second, value)) return SDK::CrError_None;
+    }
+
+    switch (code) {
+    case SDK::CrDeviceProperty_NearFar:
+        // NearFar reads disabled while the lens moves
+        report(code, SDK::CrNearFar_Disable, now);
+        report(code, SDK::CrNearFar_Enable, now + latency(m_config.focus_step));
+        break;
+    case SDK::CrDeviceProperty_S1: {
+        auto set = now + latency(m_config.set);
+        report(code, value, set);
+        if (SDK::CrLockIndicator_Locked == value) {
+            report(SDK::CrDeviceProperty_FocusIndication, SDK::CrFocusIndicator_Focused_AF_S, set + latency(m_config.autofocus));
+        }
+        else {
+            report(SDK::CrDeviceProperty_FocusIndication, SDK::CrFocusIndicator_Unlocked, set);
+        }
+        break;
+    }
+    default:
+        report(code, value, now + latency(m_config.set));
+        break;
+    }
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::send_command(CrInt32u command, SDK::CrCommandParam param)
+{
+    if (SDK::CrCommandId_Release != command) return SDK::CrError_None;
+    auto at = Clock::now() + latency(m_config.set);
+    report(SDK::CrDeviceProperty_S2, SDK::CrCommandParam_Down == param ? SDK::CrLockIndicator_Locked : SDK::CrLockIndicator_Unlocked, at);
+    if (SDK::CrCommandParam_Down == param) capture();
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::set_save_info(const CrChar* path, const CrChar* prefix, CrInt32 number)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_save_path = path ? path : sim_string();
+    m_save_prefix = prefix ? prefix : sim_string();
+    if (0 <= number) m_save_number = number;
+    return SDK::CrError_None;
+}
+
+void SimulatedCamera::set_setting(CrInt32u key, CrInt32u value)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_settings[key] = value;
+}
+
+CrInt32u SimulatedCamera::get_setting(CrInt32u key) const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_settings.find(key);
+    return it == m_settings.end() ? 0 : it->second;
+}
+
+SDK::CrError SimulatedCamera::live_view_info(SDK::CrImageInfo* info) const
+{
+    if (!info) return SDK::CrError_Generic_InvalidParameter;
+    auto* fields = reinterpret_cast<impl::ImageInfoFields*>(info);
+    fields->width = impl::image_width / 4;
+    fields->height = impl::image_height / 4;
+    fields->bufferSize = live_view_size();
+    return SDK::CrError_None;
+}
+
+CrInt32u SimulatedCamera::live_view_size() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto quality = m_properties.at(SDK::CrDeviceProperty_LiveView_Image_Quality).value;
+    return SDK::CrPropertyLiveViewImageQuality_High == quality ? m_config.live_view_bytes : m_config.live_view_bytes / 2;
+}
+
+SDK::CrError SimulatedCamera::live_view_image(SDK::CrImageDataBlock* block)
+{
+    if (!block) return SDK::CrError_Generic_InvalidParameter;
+    std::this_thread::sleep_for(latency(m_config.live_view));
+
+    // The camera produces frames at a steady rate from the connection on; only a newer one is handed out
+    auto period = std::chrono::microseconds(1000000 / m_config.live_view_fps);
+    auto frame = static_cast<std::uint64_t>((Clock::now() - m_connected) / period);
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (frame <= m_live_view_frame) return SDK::CrWarning_Frame_NotUpdated;
+    }
+    auto size = live_view_size();
+    auto err = impl::fill_block(block, make_jpeg(impl::image_width / 4, impl::image_height / 4, frame, size), frame);
+    if (SDK::CrError_None == err) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_live_view_frame = std::max(m_live_view_frame, frame);
+    }
+    return err;
+}
+
+SDK::CrError SimulatedCamera::date_folders(SDK::CrMtpFolderInfo** folders, CrInt32u* count)
+{
+    if (!folders || !count) return SDK::CrError_Generic_InvalidParameter;
+    std::this_thread::sleep_for(latency(m_config.mtp));
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto* out = new SDK::CrMtpFolderInfo[m_folders.size() ? m_folders.size() : 1];
+    for (std::size_t i = 0; i < m_folders.size(); ++i) {
+        char name[16];
+        std::snprintf(name, sizeof name, "202601%02u", static_cast<unsigned>(i % 28 + 1));
+        auto wide = impl::widen(name);
+        out[i].handle = m_folders[i];
+        out[i].folderNameSize = static_cast<CrInt32u>(wide.size() + 1);
+        out[i].folderName = new CrChar[wide.size() + 1];
+        std::copy(wide.c_str(), wide.c_str() + wide.size() + 1, out[i].folderName);
+    }
+    *folders = out;
+    *count = static_cast<CrInt32u>(m_folders.size());
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::contents_handles(SDK::CrFolderHandle folder, SDK::CrContentHandle** handles, CrInt32u* count)
+{
+    if (!handles || !count) return SDK::CrError_Generic_InvalidParameter;
+    std::this_thread::sleep_for(latency(m_config.mtp));
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (std::find(m_folders.begin(), m_folders.end(), folder) == m_folders.end()) return SDK::CrError_Generic_InvalidParameter;
+    std::vector<SDK::CrContentHandle> found;
+    for (auto& content : m_contents) {
+        if (folder == content.second.folder) found.push_back(content.first);
+    }
+    auto* out = new SDK::CrContentHandle[found.size() ? found.size() : 1];
+    std::copy(found.begin(), found.end(), out);
+    *handles = out;
+    *count = static_cast<CrInt32u>(found.size());
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::contents_detail(SDK::CrContentHandle handle, SDK::CrMtpContentsInfo* info)
+{
+    if (!info) return SDK::CrError_Generic_InvalidParameter;
+    std::this_thread::sleep_for(latency(m_config.mtp));
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_contents.find(handle);
+    if (it == m_contents.end()) return SDK::CrError_Generic_InvalidParameter;
+    const auto& content = it->second;
+    auto name = impl::widen(content.name);
+    info->handle = handle;
+    info->parentFolderHandle = content.folder;
+    info->contentSize = content.size;
+    std::memset(info->dateChar, 0, sizeof info->dateChar);
+    std::copy(content.date.begin(), content.date.end(), info->dateChar);
+    info->width = impl::image_width;
+    info->height = impl::image_height;
+    delete[] info->fileName;
+    info->fileNameSize = static_cast<CrInt32u>(name.size() + 1);
+    info->fileName = new CrChar[name.size() + 1];
+    std::copy(name.c_str(), name.c_str() + name.size() + 1, info->fileName);
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::pull_contents(SDK::CrContentHandle handle, SDK::CrPropertyStillImageTransSize size, const CrChar* path, const CrChar* file_name)
+{
+    auto now = Clock::now();
+    sim_string file;
+    std::uint64_t bytes = 0;
+    Clock::time_point done;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto it = m_contents.find(handle);
+        if (it == m_contents.end()) return SDK::CrError_Generic_InvalidParameter;
+        bytes = SDK::CrPropertyStillImageTransSize_Original == size ? it->second.size : it->second.size / 8;
+        sim_string dir = path ? sim_string(path) : m_save_path;
+        file = (dir.empty() ? sim_string() : dir + CrChar('/')) + (file_name ? sim_string(file_name) : impl::widen(it->second.name));
+
+        // The setup of each pull overlaps with the others, the data then takes its turn on the shared link
+        auto start = std::max(now + latency(m_config.transfer), m_transfer_free);
+        auto flowing = 0 < m_config.transfer_mbps
+            ? std::chrono::microseconds(bytes / m_config.transfer_mbps)
+            : std::chrono::microseconds(0);
+        done = start + std::chrono::duration_cast<Clock::duration>(flowing);
+        m_transfer_free = done;
+    }
+
+    schedule(now, [this, handle] { m_callback->OnNotifyContentsTransfer(SDK::CrNotify_ContentsTransfer_Start, handle, nullptr); });
+    schedule(done, [this, handle, file, bytes] {
+        auto jpeg = make_jpeg(impl::image_width, impl::image_height, handle, bytes);
+        FILE* out = impl::open_file(file);
+        bool written = out && jpeg.size() == std::fwrite(jpeg.data(), 1, jpeg.size(), out);
+        if (out) std::fclose(out);
+        if (!written) {
+            m_callback->OnNotifyContentsTransfer(SDK::CrWarning_ContentsTransferCancel_Error, handle, nullptr);
+            return;
+        }
+        auto name = file;
+        m_callback->OnNotifyContentsTransfer(SDK::CrNotify_ContentsTransfer_Complete, handle, &name[0]);
+    });
+    return SDK::CrError_None;
+}
+
+SDK::CrError SimulatedCamera::thumbnail(SDK::CrContentHandle handle, SDK::CrImageDataBlock* block)
+{
+    if (!block) return SDK::CrError_Generic_InvalidParameter;
+    std::this_thread::sleep_for(latency(m_config.mtp));
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_contents.find(handle) == m_contents.end()) return SDK::CrError_Generic_InvalidParameter;
+    }
+    return impl::fill_block(block, make_jpeg(160, 120, handle, 0), 0);
+}
+
+void SimulatedCamera::run()
+{
+    std::unique_lock<std::mutex> lock(m_clock_mtx);
+    for (;;) {
+        if (!m_scheduled.empty() && m_scheduled.top().at <= Clock::now()) {
+            auto action = m_scheduled.top().action;
+            m_scheduled.pop();
+            lock.unlock();
+            action();
+            lock.lock();
+            continue;
+        }
+        if (!m_running) return;
+        if (m_scheduled.empty()) m_clock_cv.wait(lock);
+        else {
+            // A copy: schedule() may reallocate the queue while this waits
+            auto next = m_scheduled.top().at;
+            m_clock_cv.wait_until(lock, next);
+        }
+    }
+}
+
+void SimulatedCamera::schedule(Clock::time_point at, std::function<void()> action)
+{
+    bool earliest = false;
+    {
+        std::lock_guard<std::mutex> lock(m_clock_mtx);
+        earliest = m_scheduled.empty() || at < m_scheduled.top().at;
+        m_scheduled.push(Scheduled{ at, m_order++, std::move(action) });
+    }
+    if (earliest) m_clock_cv.notify_one();
+}
+
+void SimulatedCamera::report(CrInt32u code, CrInt64u value, Clock::time_point at)
+{
+    schedule(at, [this, code, value] {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_properties[code].value = value;
+        }
+        CrInt32u changed = code;
+        m_callback->OnPropertyChangedCodes(1, &changed);
+    });
+}
+
+void SimulatedCamera::turn_dial()
+{
+    CrInt64u next = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto current = m_properties[SDK::CrDeviceProperty_IsoSensitivity].value;
+        auto* first = std::begin(impl::iso_sensitivities);
+        auto* last = std::end(impl::iso_sensitivities);
+        auto* it = std::find(first, last, current);
+        next = (it == last || it + 1 == last) ? *first : *(it + 1);
+    }
+    auto now = Clock::now();
+    report(SDK::CrDeviceProperty_IsoSensitivity, next, now);
+    schedule(now + m_config.dial, [this] { turn_dial(); });
+}
+
+void SimulatedCamera::capture()
+{
+    auto captured = Clock::now() + latency(m_config.capture);
+    Clock::time_point saved;
+    sim_string file;
+    {
+        // Images go to the computer one after the other, in capture order
+        std::lock_guard<std::mutex> lock(m_mtx);
+        saved = std::max(captured, m_save_free) + latency(m_config.save);
+        m_save_free = saved;
+
+        char number[16];
+        std::snprintf(number, sizeof number, "%05d", static_cast<int>(m_save_number++));
+        auto prefix = m_save_prefix.empty() ? impl::widen("DSC") : m_save_prefix;
+        file = (m_save_path.empty() ? sim_string() : m_save_path + CrChar('/')) + prefix + impl::widen(number) + impl::widen(".JPG");
+
+        // The image also lands on the memory card
+        if (m_folders.empty()) m_folders.push_back(0x1000);
+        add_content(m_folders.back(), m_config.content_bytes);
+    }
+
+    schedule(captured, [this] { m_callback->OnWarning(SDK::CrNotify_Captured_Event); });
+    schedule(saved, [this, file] {
+        auto jpeg = make_jpeg(impl::image_width, impl::image_height, 0, 0);
+        FILE* out = impl::open_file(file);
+        if (!out) {
+            // Like a camera that cannot create the file in the save folder
+            m_callback->OnWarning(SDK::CrWarning_SetFileName_Failed);
+            return;
+        }
+        std::fwrite(jpeg.data(), 1, jpeg.size(), out);
+        std::fclose(out);
+        auto name = file;
+        m_callback->OnCompleteDownload(&name[0]);
+    });
+}
+
+std::chrono::milliseconds SimulatedCamera::latency(std::chrono::milliseconds base)
+{
+    if (m_config.jitter.count() <= 0) return base;
+    std::lock_guard<std::mutex> lock(m_clock_mtx);
+    std::uniform_int_distribution<std::int64_t> extra(0, m_config.jitter.count());
+    return base + std::chrono::milliseconds(extra(m_random));
+}
+
+bool SimulatedCamera::accepts(const Property& property, CrInt64u value) const
+{
+    if (!property.values) return true;
+    auto wanted = impl::as_signed(value, property.type);
+    auto count = property.values_size / impl::element_size(property.type);
+    if (property.type & SDK::CrDataType_RangeBit) {
+        if (count < 3) return true;
+        auto min = impl::element(property.values, property.type, 0);
+        auto max = impl::element(property.values, property.type, 1);
+        auto step = impl::element(property.values, property.type, 2);
+        return min <= wanted && wanted <= max && (step <= 0 || 0 == (wanted - min) % step);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (wanted == impl::element(property.values, property.type, i)) return true;
+    }
+    return false;
+}
+
+SDK::CrContentHandle SimulatedCamera::add_content(SDK::CrFolderHandle folder, std::uint64_t size)
+{
+    auto handle = m_next_content++;
+    char name[16];
+    std::snprintf(name, sizeof name, "DSC%05u.JPG", static_cast<unsigned>(handle));
+    char date[16];
+    auto day = static_cast<unsigned>((folder - 0x1000) % 28 + 1);
+    std::snprintf(date, sizeof date, "202601%02uT12%02u%02u", day, static_cast<unsigned>(handle / 60 % 60), static_cast<unsigned>(handle % 60));
+    m_contents[handle] = Content{ folder, name, date, size };
+    return handle;
+}
+} // namespace sim
@@ -0,0 +1,156 @@
+#ifndef SIMULATEDCAMERA_H
+#define SIMULATEDCAMERA_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "CRSDK/IDeviceCallback.h"
+
+namespace sim
+{
+using sim_string = std::basic_string<CrChar>;
+
+// What the simulated cameras look like and how long they take, read from CRSIM_* environment variables by Init()
+struct SimConfig
+{
+    std::uint32_t cameras = 1;               // CRSIM_CAMERAS: cameras EnumCameraObjects reports
+    std::uint32_t seed = 1;                  // CRSIM_SEED: of the jitter added to every latency
+    std::chrono::milliseconds jitter{ 0 };   // CRSIM_JITTER_MS: up to this much on top of every latency
+    std::chrono::milliseconds connect{ 50 }; // CRSIM_CONNECT_MS: from Connect until OnConnected
+    std::chrono::milliseconds get{ 5 };      // CRSIM_GET_MS: round trip of a property request, spent in the call
+    std::chrono::milliseconds set{ 30 };     // CRSIM_SET_MS: from SetDeviceProperty until the camera reports the value
+    std::chrono::milliseconds autofocus{ 150 };  // CRSIM_AF_MS: from half press until focused
+    std::chrono::milliseconds focus_step{ 80 };  // CRSIM_FOCUS_STEP_MS: lens drive time of one NearFar step
+    std::chrono::milliseconds capture{ 100 };    // CRSIM_CAPTURE_MS: from release until the exposure is reported
+    std::chrono::milliseconds save{ 300 };       // CRSIM_SAVE_MS: sending one image to the computer, one after the other
+    std::chrono::milliseconds dial{ 0 };         // CRSIM_DIAL_MS: turns the ISO dial this often; 0 never
+    std::uint32_t live_view_fps = 30;            // CRSIM_LIVEVIEW_FPS
+    std::uint32_t live_view_bytes = 200000;      // CRSIM_LIVEVIEW_BYTES: of a high quality frame, low is half
+    std::chrono::milliseconds live_view{ 5 };    // CRSIM_LIVEVIEW_MS: fetching one frame, spent in the call
+    std::uint32_t folders = 2;                   // CRSIM_FOLDERS: date folders on the memory card
+    std::uint32_t contents = 5;                  // CRSIM_CONTENTS: images in each folder
+    std::uint64_t content_bytes = 4000000;       // CRSIM_CONTENT_BYTES: of each image
+    std::chrono::milliseconds mtp{ 2 };          // CRSIM_MTP_MS: each folder, handle or detail request, spent in the call
+    std::chrono::milliseconds transfer{ 20 };    // CRSIM_TRANSFER_MS: before a pulled file starts to flow; overlaps
+    std::uint32_t transfer_mbps = 40;            // CRSIM_TRANSFER_MBPS: MB/s of the link the pulls share; 0 unlimited
+
+    static SimConfig from_environment();
+};
+
+// One connected camera.
+// SDK calls change its state right away and schedule what the camera reports later. A single clock thread
+// delivers the scheduled callbacks in time order, ties in the order they were scheduled, so the same calls
+// with the same seed report the same events in the same order.
+class SimulatedCamera
+{
+public:
+    SimulatedCamera(const SimConfig& config, std::uint32_t index, SCRSDK::IDeviceCallback* callback, SCRSDK::CrSdkControlMode mode);
+    // Delivers the callbacks already due; the ones scheduled later are dropped
+    ~SimulatedCamera();
+
+    SimulatedCamera(const SimulatedCamera&) = delete;
+    SimulatedCamera& operator=(const SimulatedCamera&) = delete;
+
+    void disconnect();
+
+    // Every property when codes is empty
+    SCRSDK::CrError get_properties(const std::vector<CrInt32u>& codes, SCRSDK::CrDeviceProperty** properties, CrInt32* count);
+    SCRSDK::CrError set_property(CrInt32u code, CrInt64u value);
+    SCRSDK::CrError send_command(CrInt32u command, SCRSDK::CrCommandParam param);
+    SCRSDK::CrError set_save_info(const CrChar* path, const CrChar* prefix, CrInt32 number);
+    void set_setting(CrInt32u key, CrInt32u value);
+    CrInt32u get_setting(CrInt32u key) const;
+
+    SCRSDK::CrError live_view_info(SCRSDK::CrImageInfo* info) const;
+    SCRSDK::CrError live_view_image(SCRSDK::CrImageDataBlock* block);
+
+    SCRSDK::CrError date_folders(SCRSDK::CrMtpFolderInfo** folders, CrInt32u* count);
+    SCRSDK::CrError contents_handles(SCRSDK::CrFolderHandle folder, SCRSDK::CrContentHandle** handles, CrInt32u* count);
+    SCRSDK::CrError contents_detail(SCRSDK::CrContentHandle handle, SCRSDK::CrMtpContentsInfo* info);
+    SCRSDK::CrError pull_contents(SCRSDK::CrContentHandle handle, SCRSDK::CrPropertyStillImageTransSize size, const CrChar* path, const CrChar* file_name);
+    SCRSDK::CrError thumbnail(SCRSDK::CrContentHandle handle, SCRSDK::CrImageDataBlock* block);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Property
+    {
+        CrInt64u value;
+        SCRSDK::CrDataType type;
+        const void* values;   // Possible values, static; nullptr when any value is taken
+        CrInt32u values_size; // In bytes
+    };
+
+    struct Content
+    {
+        SCRSDK::CrFolderHandle folder;
+        std::string name;
+        std::string date; // YYYYMMDDThhmmss
+        std::uint64_t size;
+    };
+
+    struct Scheduled
+    {
+        Clock::time_point at;
+        std::uint64_t order;
+        std::function<void()> action;
+
+        bool operator>(const Scheduled& other) const { return at != other.at ? at > other.at : order > other.order; }
+    };
+
+    void run();
+    void schedule(Clock::time_point at, std::function<void()> action);
+    // Stores value at time at and tells the callback about it
+    void report(CrInt32u code, CrInt64u value, Clock::time_point at);
+    void turn_dial();
+    void capture();
+    CrInt32u live_view_size() const;
+    // The configured latency plus jitter
+    std::chrono::milliseconds latency(std::chrono::milliseconds base);
+    bool accepts(const Property& property, CrInt64u value) const;
+    SCRSDK::CrContentHandle add_content(SCRSDK::CrFolderHandle folder, std::uint64_t size);
+
+    const SimConfig m_config;
+    const std::uint32_t m_index;
+    SCRSDK::IDeviceCallback* const m_callback;
+    const Clock::time_point m_connected;
+
+    // Camera state; never held while calling the callback
+    mutable std::mutex m_mtx;
+    std::map<CrInt32u, Property> m_properties;
+    std::map<CrInt32u, CrInt32u> m_settings;
+    std::vector<SCRSDK::CrFolderHandle> m_folders;
+    std::map<SCRSDK::CrContentHandle, Content> m_contents;
+    SCRSDK::CrContentHandle m_next_content = 1;
+    sim_string m_save_path;
+    sim_string m_save_prefix;
+    CrInt32 m_save_number = 1;
+    Clock::time_point m_save_free;     // When the image link to the computer is idle again
+    Clock::time_point m_transfer_free; // When the link pulled files share is idle again
+    std::uint64_t m_live_view_frame = 0;
+
+    // Guards the schedule and the jitter generator
+    std::mutex m_clock_mtx;
+    std::condition_variable m_clock_cv;
+    std::priority_queue<Scheduled, std::vector<Scheduled>, std::greater<Scheduled>> m_scheduled;
+    std::uint64_t m_order = 0;
+    bool m_running = true;
+    std::mt19937 m_random;
+    std::thread m_clock;
+};
+
+// A baseline JPEG of a flat grey width x height image, padded with comments to about size bytes.
+// Each carries frame in a comment, so consecutive frames differ.
+std::vector<CrInt8u> make_jpeg(std::uint32_t width, std::uint32_t height, std::uint64_t frame, std::uint64_t size);
+} // namespace sim
+
+#endif // !SIMULATEDCAMERA_H
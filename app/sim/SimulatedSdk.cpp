@@ -0,0 +1,349 @@
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "SimulatedCamera.h"
+
+// The Camera Remote SDK functions, answered by simulated cameras instead of hardware.
+// Built as a library of its own, it stands in for Cr_Core or is loaded with RemoteCli --backend.
+
+namespace SDK = SCRSDK;
+
+namespace sim
+{
+namespace
+{
+// Reported by GetSDKVersion, as the SDK release the app was written against
+constexpr CrInt32u const sdk_version = 0x01050000;
+
+// One camera as EnumCameraObjects reports it; connected over USB with the ID SIM00001, SIM00002...
+class CameraObjectInfo final : public SDK::ICrCameraObjectInfo
+{
+public:
+    explicit CameraObjectInfo(std::uint32_t index)
+        : m_index(index)
+    {
+        char id[16];
+        std::snprintf(id, sizeof id, "SIM%05u", static_cast<unsigned>(index + 1));
+        m_id = sim_string(id, id + std::strlen(id));
+        m_name = widen("Simulated camera");
+        m_model = widen("ILCE-SIM");
+        m_connection = widen("USB");
+        m_adaptor = widen("sim");
+        m_pairing = widen("");
+    }
+
+    std::uint32_t index() const { return m_index; }
+
+    void Release() override { delete this; }
+    CrChar* GetName() const override { return text(m_name); }
+    CrInt32u GetNameSize() const override { return static_cast<CrInt32u>(m_name.size() + 1); }
+    CrChar* GetModel() const override { return text(m_model); }
+    CrInt32u GetModelSize() const override { return static_cast<CrInt32u>(m_model.size() + 1); }
+    CrInt16 GetUsbPid() const override { return 0x0001; }
+    CrInt8u* GetId() const override { return reinterpret_cast<CrInt8u*>(text(m_id)); }
+    CrInt32u GetIdSize() const override { return static_cast<CrInt32u>((m_id.size() + 1) * sizeof(CrChar)); }
+    CrInt32u GetIdType() const override { return 0; }
+    CrInt32u GetConnectionStatus() const override { return 0; }
+    CrChar* GetConnectionTypeName() const override { return text(m_connection); }
+    CrChar* GetAdaptorName() const override { return text(m_adaptor); }
+    CrChar* GetGuid() const override { return text(m_pairing); }
+    CrChar* GetPairingNecessity() const override { return text(m_pairing); }
+    CrInt16u GetAuthenticationState() const override { return 0; }
+
+    // The camera an ID names; 0 when it is not one of ours
+    static std::uint32_t parse_index(const CrInt8u* id, CrInt32u size)
+    {
+        if (!id || size < 4 * sizeof(CrChar)) return 0;
+        auto* chars = reinterpret_cast<const CrChar*>(id);
+        std::uint32_t number = 0;
+        for (CrInt32u i = 3; i < size / sizeof(CrChar) && chars[i]; ++i) {
+            if (chars[i] < '0' || '9' < chars[i]) return 0;
+            number = number * 10 + static_cast<std::uint32_t>(chars[i] - '0');
+        }
+        return 0 < number ? number - 1 : 0;
+    }
+
+private:
+    static sim_string widen(const char* s) { return sim_string(s, s + std::strlen(s)); }
+    static CrChar* text(const sim_string& s) { return const_cast<CrChar*>(s.c_str()); }
+
+    std::uint32_t m_index;
+    sim_string m_id;
+    sim_string m_name;
+    sim_string m_model;
+    sim_string m_connection;
+    sim_string m_adaptor;
+    sim_string m_pairing;
+};
+
+class CameraObjectList final : public SDK::ICrEnumCameraObjectInfo
+{
+public:
+    explicit CameraObjectList(std::uint32_t count)
+    {
+        for (std::uint32_t i = 0; i < count; ++i) m_cameras.emplace_back(new CameraObjectInfo(i));
+    }
+
+    CrInt32u GetCount() const override { return static_cast<CrInt32u>(m_cameras.size()); }
+    const SDK::ICrCameraObjectInfo* GetCameraObjectInfo(CrInt32u index) const override
+    {
+        return index < m_cameras.size() ? m_cameras[index].get() : nullptr;
+    }
+    void Release() override { delete this; }
+
+private:
+    struct Releaser
+    {
+        void operator()(CameraObjectInfo* info) const { info->Release(); }
+    };
+    std::vector<std::unique_ptr<CameraObjectInfo, Releaser>> m_cameras;
+};
+
+std::mutex g_mtx;
+SimConfig g_config = SimConfig::from_environment();
+std::map<SDK::CrDeviceHandle, std::shared_ptr<SimulatedCamera>> g_cameras;
+SDK::CrDeviceHandle g_next_handle = 1;
+
+std::shared_ptr<SimulatedCamera> find_camera(SDK::CrDeviceHandle handle)
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    auto it = g_cameras.find(handle);
+    return it == g_cameras.end() ? nullptr : it->second;
+}
+} // namespace
+} // namespace sim
+
+namespace SCRSDK
+{
+bool Init(CrInt32u)
+{
+    std::lock_guard<std::mutex> lock(sim::g_mtx);
+    sim::g_config = sim::SimConfig::from_environment();
+    return true;
+}
+
+bool Release()
+{
+    decltype(sim::g_cameras) cameras;
+    {
+        std::lock_guard<std::mutex> lock(sim::g_mtx);
+        cameras.swap(sim::g_cameras);
+    }
+    return true;
+}
+
+CrError EnumCameraObjects(ICrEnumCameraObjectInfo** ppEnumCameraObjectInfo, CrInt8u)
+{
+    if (!ppEnumCameraObjectInfo) return CrError_Generic_InvalidParameter;
+    std::uint32_t cameras = 0;
+    {
+        std::lock_guard<std::mutex> lock(sim::g_mtx);
+        cameras = sim::g_config.cameras;
+    }
+    *ppEnumCameraObjectInfo = nullptr;
+    if (0 == cameras) return CrError_Connect_Connect;
+    *ppEnumCameraObjectInfo = new sim::CameraObjectList(cameras);
+    return CrError_None;
+}
+
+ICrCameraObjectInfo* CreateCameraObjectInfo(CrChar*, CrChar*, CrInt16, CrInt32u, CrInt32u idSize, CrInt8u* id, CrChar*, CrChar*, CrChar*)
+{
+    return new sim::CameraObjectInfo(sim::CameraObjectInfo::parse_index(id, idSize));
+}
+
+CrError EditSDKInfo(CrInt16u)
+{
+    return CrError_None;
+}
+
+CrError Connect(ICrCameraObjectInfo* pCameraObjectInfo, IDeviceCallback* callback, CrDeviceHandle* deviceHandle, CrSdkControlMode openMode)
+{
+    if (!pCameraObjectInfo || !callback || !deviceHandle) return CrError_Generic_InvalidParameter;
+    auto index = sim::CameraObjectInfo::parse_index(pCameraObjectInfo->GetId(), pCameraObjectInfo->GetIdSize());
+
+    std::lock_guard<std::mutex> lock(sim::g_mtx);
+    if (sim::g_config.cameras <= index) return CrError_Connect_Connect;
+    *deviceHandle = sim::g_next_handle++;
+    sim::g_cameras[*deviceHandle] = std::make_shared<sim::SimulatedCamera>(sim::g_config, index, callback, openMode);
+    return CrError_None;
+}
+
+CrError Disconnect(CrDeviceHandle deviceHandle)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    camera->disconnect();
+    return CrError_None;
+}
+
+CrError ReleaseDevice(CrDeviceHandle deviceHandle)
+{
+    std::shared_ptr<sim::SimulatedCamera> camera;
+    {
+        std::lock_guard<std::mutex> lock(sim::g_mtx);
+        auto it = sim::g_cameras.find(deviceHandle);
+        if (it == sim::g_cameras.end()) return CrError_Generic_InvalidHandle;
+        camera = std::move(it->second);
+        sim::g_cameras.erase(it);
+    }
+    // Stops the camera's clock here, outside the lock
+    camera.reset();
+    return CrError_None;
+}
+
+CrError GetDeviceProperties(CrDeviceHandle deviceHandle, CrDeviceProperty** properties, CrInt32* numOfPropoties)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->get_properties({}, properties, numOfPropoties);
+}
+
+CrError GetSelectDeviceProperties(CrDeviceHandle deviceHandle, CrInt32u numOfCodes, CrInt32u* codes, CrDeviceProperty** properties, CrInt32* numOfPropoties)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    if (0 == numOfCodes || !codes) return CrError_Generic_InvalidParameter;
+    return camera->get_properties(std::vector<CrInt32u>(codes, codes + numOfCodes), properties, numOfPropoties);
+}
+
+CrError ReleaseDeviceProperties(CrDeviceHandle, CrDeviceProperty* properties)
+{
+    delete[] properties;
+    return CrError_None;
+}
+
+CrError SetDeviceProperty(CrDeviceHandle deviceHandle, CrDeviceProperty* pProperty)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    if (!pProperty) return CrError_Generic_InvalidParameter;
+    return camera->set_property(pProperty->GetCode(), pProperty->GetCurrentValue());
+}
+
+CrError SendCommand(CrDeviceHandle deviceHandle, CrInt32u commandId, CrCommandParam commandParam)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->send_command(commandId, commandParam);
+}
+
+CrError GetLiveViewImage(CrDeviceHandle deviceHandle, CrImageDataBlock* imageData)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->live_view_image(imageData);
+}
+
+CrError GetLiveViewImageInfo(CrDeviceHandle deviceHandle, CrImageInfo* info)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->live_view_info(info);
+}
+
+CrError GetLiveViewProperties(CrDeviceHandle deviceHandle, CrLiveViewProperty** properties, CrInt32* numOfProperties)
+{
+    // The simulated live view has no focus frames or other overlays
+    if (!sim::find_camera(deviceHandle)) return CrError_Generic_InvalidHandle;
+    if (!properties || !numOfProperties) return CrError_Generic_InvalidParameter;
+    *properties = new CrLiveViewProperty[1];
+    *numOfProperties = 0;
+    return CrError_None;
+}
+
+CrError GetSelectLiveViewProperties(CrDeviceHandle deviceHandle, CrInt32u, CrInt32u*, CrLiveViewProperty** properties, CrInt32* numOfProperties)
+{
+    return GetLiveViewProperties(deviceHandle, properties, numOfProperties);
+}
+
+CrError ReleaseLiveViewProperties(CrDeviceHandle, CrLiveViewProperty* properties)
+{
+    delete[] properties;
+    return CrError_None;
+}
+
+CrError GetDeviceSetting(CrDeviceHandle deviceHandle, CrInt32u key, CrInt32u* value)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    if (!value) return CrError_Generic_InvalidParameter;
+    *value = camera->get_setting(key);
+    return CrError_None;
+}
+
+CrError SetDeviceSetting(CrDeviceHandle deviceHandle, CrInt32u key, CrInt32u value)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    camera->set_setting(key, value);
+    return CrError_None;
+}
+
+CrError SetSaveInfo(CrDeviceHandle deviceHandle, CrChar* path, CrChar* prefix, CrInt32 no)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->set_save_info(path, prefix, no);
+}
+
+CrInt32u GetSDKVersion()
+{
+    return sim::sdk_version;
+}
+
+CrInt32u GetSDKSerial()
+{
+    return 0;
+}
+
+CrError GetDateFolderList(CrDeviceHandle deviceHandle, CrMtpFolderInfo** folders, CrInt32u* numOfFolders)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->date_folders(folders, numOfFolders);
+}
+
+CrError GetContentsHandleList(CrDeviceHandle deviceHandle, CrFolderHandle folderHandle, CrContentHandle** contentsHandles, CrInt32u* numOfContents)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->contents_handles(folderHandle, contentsHandles, numOfContents);
+}
+
+CrError GetContentsDetailInfo(CrDeviceHandle deviceHandle, CrContentHandle contentHandle, CrMtpContentsInfo* contentsInfo)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->contents_detail(contentHandle, contentsInfo);
+}
+
+CrError ReleaseDateFolderList(CrDeviceHandle, CrMtpFolderInfo* folders)
+{
+    delete[] folders;
+    return CrError_None;
+}
+
+CrError ReleaseContentsHandleList(CrDeviceHandle, CrContentHandle* contentsHandles)
+{
+    delete[] contentsHandles;
+    return CrError_None;
+}
+
+CrError PullContentsFile(CrDeviceHandle deviceHandle, CrContentHandle contentHandle, CrPropertyStillImageTransSize size, CrChar* path, CrChar* fileName)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->pull_contents(contentHandle, size, path, fileName);
+}
+
+CrError GetContentsThumbnailImage(CrDeviceHandle deviceHandle, CrContentHandle contentHandle, CrImageDataBlock* imageData)
+{
+    auto camera = sim::find_camera(deviceHandle);
+    if (!camera) return CrError_Generic_InvalidHandle;
+    return camera->thumbnail(contentHandle, imageData);
+}
+} // namespace SCRSDK
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <iterator>
+#include "CRSDK/CameraRemote_SDK.h"
+
+// The members of the SDK's exported classes, which Cr_Core defines and the simulated camera has to define itself.
+// Property and live view values point at data the camera owns, so copies share it;
+// MTP folder and file names are allocated per object, so copies duplicate them.
+
+namespace impl
+{
+CrChar* copy_text(const CrChar* text, CrInt32u size)
+{
+    if (!text) return nullptr;
+    auto* copy = new CrChar[size];
+    std::copy(text, text + size, copy);
+    return copy;
+}
+} // namespace impl
+
+namespace SCRSDK
+{
+CrDeviceProperty::CrDeviceProperty()
+    : code(0)
+    , valueType(CrDataType_Undefined)
+    , enableFlag(CrEnableValue_True)
+    , variableFlag(CrEnableValue_Variable)
+    , currentValue(0)
+    , currentStr(nullptr)
+    , valuesSize(0)
+    , values(nullptr)
+    , getSetValuesSize(0)
+    , getSetValues(nullptr)
+{
+}
+
+CrDeviceProperty::~CrDeviceProperty() = default;
+
+CrDeviceProperty::CrDeviceProperty(const CrDeviceProperty& ref) = default;
+
+CrDeviceProperty& CrDeviceProperty::operator=(const CrDeviceProperty& ref) = default;
+
+void CrDeviceProperty::Alloc(const CrInt32u, const CrInt32u)
+{
+}
+
+bool CrDeviceProperty::IsGetEnableCurrentValue() { return CrEnableValue_False != enableFlag; }
+bool CrDeviceProperty::IsSetEnableCurrentValue() { return CrEnableValue_True == enableFlag; }
+void CrDeviceProperty::SetCode(CrInt32u code) { this->code = code; }
+CrInt32u CrDeviceProperty::GetCode() { return code; }
+void CrDeviceProperty::SetValueType(CrDataType type) { valueType = type; }
+CrDataType CrDeviceProperty::GetValueType() { return valueType; }
+void CrDeviceProperty::SetPropertyEnableFlag(CrPropertyEnableFlag flag) { enableFlag = flag; }
+CrPropertyEnableFlag CrDeviceProperty::GetPropertyEnableFlag() { return enableFlag; }
+void CrDeviceProperty::SetPropertyVariableFlag(CrPropertyVariableFlag flag) { variableFlag = flag; }
+CrPropertyVariableFlag CrDeviceProperty::GetPropertyVariableFlag() { return variableFlag; }
+void CrDeviceProperty::SetCurrentValue(CrInt64u value) { currentValue = value; }
+CrInt64u CrDeviceProperty::GetCurrentValue() { return currentValue; }
+void CrDeviceProperty::SetCurrentStr(CrInt16u* str) { currentStr = str; }
+CrInt16u* CrDeviceProperty::GetCurrentStr() { return currentStr; }
+void CrDeviceProperty::SetValueSize(CrInt32u size) { valuesSize = size; }
+CrInt32u CrDeviceProperty::GetValueSize() { return valuesSize; }
+void CrDeviceProperty::SetValues(CrInt8u* value) { values = value; }
+CrInt8u* CrDeviceProperty::GetValues() { return values; }
+void CrDeviceProperty::SetSetValueSize(CrInt32u size) { getSetValuesSize = size; }
+CrInt32u CrDeviceProperty::GetSetValueSize() { return getSetValuesSize; }
+void CrDeviceProperty::SetSetValues(CrInt8u* value) { getSetValues = value; }
+CrInt8u* CrDeviceProperty::GetSetValues() { return getSetValues; }
+
+CrLiveViewProperty::CrLiveViewProperty()
+    : code(0)
+    , enableFlag(CrEnableValue_True)
+    , valueType(CrFrameInfoType_Unknown)
+    , valueSize(0)
+    , value(nullptr)
+{
+}
+
+CrLiveViewProperty::~CrLiveViewProperty() = default;
+
+CrLiveViewProperty::CrLiveViewProperty(const CrLiveViewProperty& ref) = default;
+
+CrLiveViewProperty& CrLiveViewProperty::operator=(const CrLiveViewProperty& ref) = default;
+
+void CrLiveViewProperty::Alloc(const CrInt32u)
+{
+}
+
+bool CrLiveViewProperty::IsGetEnableCurrentValue() { return CrEnableValue_False != enableFlag; }
+void CrLiveViewProperty::SetCode(CrInt32u code) { this->code = code; }
+CrInt32u CrLiveViewProperty::GetCode() { return code; }
+void CrLiveViewProperty::SetPropertyEnableFlag(CrPropertyEnableFlag flag) { enableFlag = flag; }
+CrPropertyEnableFlag CrLiveViewProperty::GetPropertyEnableFlag() { return enableFlag; }
+void CrLiveViewProperty::SetFrameInfoType(CrFrameInfoType type) { valueType = type; }
+CrFrameInfoType CrLiveViewProperty::GetFrameInfoType() { return valueType; }
+void CrLiveViewProperty::SetValueSize(CrInt32u size) { valueSize = size; }
+CrInt32u CrLiveViewProperty::GetValueSize() { return valueSize; }
+void CrLiveViewProperty::SetValue(CrInt8u* value) { this->value = value; }
+CrInt8u* CrLiveViewProperty::GetValue() { return value; }
+
+CrMtpFolderInfo::CrMtpFolderInfo()
+    : handle(0)
+    , folderNameSize(0)
+    , folderName(nullptr)
+{
+}
+
+CrMtpFolderInfo::~CrMtpFolderInfo()
+{
+    delete[] folderName;
+}
+
+CrMtpFolderInfo::CrMtpFolderInfo(const CrMtpFolderInfo& ref)
+    : handle(ref.handle)
+    , folderNameSize(ref.folderNameSize)
+    , folderName(impl::copy_text(ref.folderName, ref.folderNameSize))
+{
+}
+
+CrMtpFolderInfo& CrMtpFolderInfo::operator=(const CrMtpFolderInfo& ref)
+{
+    if (this == &ref) return *this;
+    delete[] folderName;
+    handle = ref.handle;
+    folderNameSize = ref.folderNameSize;
+    folderName = impl::copy_text(ref.folderName, ref.folderNameSize);
+    return *this;
+}
+
+void CrMtpFolderInfo::Alloc(const CrInt32u)
+{
+}
+
+CrMtpContentsInfo::CrMtpContentsInfo()
+    : handle(0)
+    , parentFolderHandle(0)
+    , contentSize(0)
+    , dateChar{}
+    , width(0)
+    , height(0)
+    , fileNameSize(0)
+    , fileName(nullptr)
+{
+}
+
+CrMtpContentsInfo::~CrMtpContentsInfo()
+{
+    delete[] fileName;
+}
+
+CrMtpContentsInfo::CrMtpContentsInfo(const CrMtpContentsInfo& ref)
+    : fileName(nullptr)
+{
+    *this = ref;
+}
+
+CrMtpContentsInfo& CrMtpContentsInfo::operator=(const CrMtpContentsInfo& ref)
+{
+    if (this == &ref) return *this;
+    delete[] fileName;
+    handle = ref.handle;
+    parentFolderHandle = ref.parentFolderHandle;
+    contentSize = ref.contentSize;
+    std::copy(std::begin(ref.dateChar), std::end(ref.dateChar), dateChar);
+    width = ref.width;
+    height = ref.height;
+    fileNameSize = ref.fileNameSize;
+    fileName = impl::copy_text(ref.fileName, ref.fileNameSize);
+    return *this;
+}
+
+void CrMtpContentsInfo::Alloc(const CrInt32u)
+{
+}
+
+CrImageInfo::CrImageInfo()
+    : width(0)
+    , height(0)
+    , bufferSize(0)
+{
+}
+
+CrImageInfo::~CrImageInfo() = default;
+
+CrInt32u CrImageInfo::GetBufferSize() { return bufferSize; }
+
+CrImageDataBlock::CrImageDataBlock()
+    : frameNo(0)
+    , size(0)
+    , pData(nullptr)
+    , imageSize(0)
+{
+}
+
+CrImageDataBlock::~CrImageDataBlock() = default;
+
+CrInt32u CrImageDataBlock::GetFrameNo() { return frameNo; }
+void CrImageDataBlock::SetSize(CrInt32u size) { this->size = size; }
+CrInt32u CrImageDataBlock::GetSize() { return size; }
+void CrImageDataBlock::SetData(CrInt8u* data) { pData = data; }
+CrInt32u CrImageDataBlock::GetImageSize() { return imageSize; }
+CrInt8u* CrImageDataBlock::GetImageData() { return pData; }
+} // namespace SCRSDK
@@ -4,12 +4,34 @@ set(__cli_hdr_dir ${CMAKE_CURRENT_SOURCE_DIR}/app)
 ### Enumerate RemoteCli header files ###
 message("[${PROJECT_NAME}] Indexing header files..")
 set(__cli_hdrs
+    ${__cli_hdr_dir}/BoundedQueue.h
+    ${__cli_hdr_dir}/Bracket.h
+    ${__cli_hdr_dir}/BurstCapture.h
     ${__cli_hdr_dir}/CameraDevice.h
+    ${__cli_hdr_dir}/CameraSession.h
+    ${__cli_hdr_dir}/Completions.h
     ${__cli_hdr_dir}/ConnectionInfo.h
-    # ${__cli_hdr_dir}/LibManager.h
+    ${__cli_hdr_dir}/ContentsDownloader.h
+    ${__cli_hdr_dir}/ContentsIndexFile.h
+    ${__cli_hdr_dir}/ContentsIndexer.h
+    ${__cli_hdr_dir}/Daemon.h
+    ${__cli_hdr_dir}/EventBus.h
+    ${__cli_hdr_dir}/FocusStack.h
+    ${__cli_hdr_dir}/JsonLines.h
+    ${__cli_hdr_dir}/LibManager.h
+    ${__cli_hdr_dir}/PropertyStore.h
+    ${__cli_hdr_dir}/PropertySubscriptions.h
+    ${__cli_hdr_dir}/PropertyTable.h
     ${__cli_hdr_dir}/PropertyValueTable.h
+    ${__cli_hdr_dir}/PropertyValueView.h
+    ${__cli_hdr_dir}/RigCapture.h
     ${__cli_hdr_dir}/Text.h
+    ${__cli_hdr_dir}/Timelapse.h
+    ${__cli_hdr_dir}/LiveView.h
+    ${__cli_hdr_dir}/MjpegServer.h
     ${__cli_hdr_dir}/MessageDefine.h
+    ${__cli_hdr_dir}/Socket.h
+    ${__cli_hdr_dir}/SyncJournal.h
 )
 
 ## Use cli_srcs in project CMakeLists
@@ -4,13 +4,32 @@ set(__cli_src_dir ${CMAKE_CURRENT_SOURCE_DIR}/app)
 ### Enumerate RemoteCli source files ###
 message("[${PROJECT_NAME}] Indexing source files..")
 set(__cli_srcs
+    ${__cli_src_dir}/Bracket.cpp
+    ${__cli_src_dir}/BurstCapture.cpp
     ${__cli_src_dir}/CameraDevice.cpp
+    ${__cli_src_dir}/CameraSession.cpp
+    ${__cli_src_dir}/Completions.cpp
     ${__cli_src_dir}/ConnectionInfo.cpp
-    # ${__cli_src_dir}/LibManager.cpp
+    ${__cli_src_dir}/ContentsDownloader.cpp
+    ${__cli_src_dir}/ContentsIndexFile.cpp
+    ${__cli_src_dir}/ContentsIndexer.cpp
+    ${__cli_src_dir}/Daemon.cpp
+    ${__cli_src_dir}/FocusStack.cpp
+    ${__cli_src_dir}/JsonLines.cpp
+    ${__cli_src_dir}/LibManager.cpp
+    ${__cli_src_dir}/PropertyStore.cpp
+    ${__cli_src_dir}/PropertySubscriptions.cpp
+    ${__cli_src_dir}/PropertyTable.cpp
     ${__cli_src_dir}/PropertyValueTable.cpp
     ${__cli_src_dir}/RemoteCli.cpp
+    ${__cli_src_dir}/RigCapture.cpp
     ${__cli_src_dir}/Text.cpp
+    ${__cli_src_dir}/Timelapse.cpp
+    ${__cli_src_dir}/LiveView.cpp
+    ${__cli_src_dir}/MjpegServer.cpp
     ${__cli_src_dir}/MessageDefine.cpp
+    ${__cli_src_dir}/Socket.cpp
+    ${__cli_src_dir}/SyncJournal.cpp
 )
 
 ## Use cli_srcs in project CMakeLists
@@ -0,0 +1,14 @@
+## Script for enumerating the simulated camera source files
+set(__sim_src_dir ${CMAKE_CURRENT_SOURCE_DIR}/app/sim)
+
+### Enumerate simulated camera source files ###
+message("[${PROJECT_NAME}] Indexing simulated camera source files..")
+set(__sim_srcs
+    ${__sim_src_dir}/SimulatedCamera.h
+    ${__sim_src_dir}/SimulatedCamera.cpp
+    ${__sim_src_dir}/SimulatedSdk.cpp
+    ${__sim_src_dir}/SimulatedSdkTypes.cpp
+)
+
+## Use sim_srcs in project CMakeLists
+set(sim_srcs ${__sim_srcs})
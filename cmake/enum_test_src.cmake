@@ -0,0 +1,32 @@
+## Script for enumerating the test programs
+set(__test_src_dir ${CMAKE_CURRENT_SOURCE_DIR}/test)
+
+### Enumerate test source files ###
+message("[${PROJECT_NAME}] Indexing test source files..")
+set(__test_srcs
+    ${__test_src_dir}/ShutterTimingTest.cpp
+    ${__test_src_dir}/SnapshotTest.cpp
+    ${__test_src_dir}/ContentsIndexerTest.cpp
+    ${__test_src_dir}/ContentsDownloaderTest.cpp
+    ${__test_src_dir}/CameraSessionTest.cpp
+    ${__test_src_dir}/TimelapseTest.cpp
+    ${__test_src_dir}/PropertyTableTest.cpp
+    ${__test_src_dir}/PropertyValueViewTest.cpp
+    ${__test_src_dir}/PropertySubscriptionsTest.cpp
+    ${__test_src_dir}/AsyncTest.cpp
+    ${__test_src_dir}/SyncTest.cpp
+    ${__test_src_dir}/DaemonTest.cpp
+    ${__test_src_dir}/MjpegServerTest.cpp
+    ${__test_src_dir}/LiveViewTest.cpp
+)
+
+### Benchmarks, run as tests labelled benchmark; each prints its timings ###
+set(__bench_srcs
+    ${__test_src_dir}/PropertyLookupBenchmark.cpp
+    ${__test_src_dir}/PropertyParseBenchmark.cpp
+    ${__test_src_dir}/AsyncOverlapBenchmark.cpp
+)
+
+## Use test_srcs and bench_srcs in project CMakeLists
+set(test_srcs ${__test_srcs})
+set(bench_srcs ${__bench_srcs})
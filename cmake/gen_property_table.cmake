@@ -0,0 +1,104 @@
+## Script generating the device property table from the SDK header
+## cmake -DHEADER=<CrDeviceProperty.h> -DTYPES=<property_types.txt> -DOUTPUT=<PropertyTable.inc> -P gen_property_table.cmake
+
+file(READ ${HEADER} __header)
+
+### Underlying types of the value enums, e.g. "enum CrFocusMode : CrInt16u" ###
+set(__CrInt8u UInt8)
+set(__CrInt8 Int8)
+set(__CrInt16u UInt16)
+set(__CrInt16 Int16)
+set(__CrInt32u UInt32)
+set(__CrInt32 Int32)
+set(__CrInt64u UInt64)
+set(__CrInt64 Int64)
+string(REGEX MATCHALL "enum[ \t]+Cr[A-Za-z0-9_]+[ \t]*:[ \t]*CrInt[0-9]+u?" __enums "${__header}")
+foreach(__enum IN LISTS __enums)
+    string(REGEX REPLACE "enum[ \t]+(Cr[A-Za-z0-9_]+)[ \t]*:[ \t]*(CrInt[0-9]+u?)" "\\1;\\2" __pair "${__enum}")
+    list(GET __pair 0 __name)
+    list(GET __pair 1 __type)
+    set(__enum_${__name} ${__${__type}})
+endforeach()
+
+### C++ type of each CrDataType, for the formatters ###
+set(__ctype_UInt8 std::uint8_t)
+set(__ctype_Int8 std::int8_t)
+set(__ctype_UInt16 std::uint16_t)
+set(__ctype_Int16 std::int16_t)
+set(__ctype_UInt32 std::uint32_t)
+set(__ctype_Int32 std::int32_t)
+set(__ctype_UInt64 std::uint64_t)
+set(__ctype_Int64 std::int64_t)
+
+### Property codes in declaration order, which is ascending ###
+string(FIND "${__header}" "enum CrDevicePropertyCode" __begin)
+string(SUBSTRING "${__header}" ${__begin} -1 __codes)
+string(FIND "${__codes}" "};" __end)
+string(SUBSTRING "${__codes}" 0 ${__end} __codes)
+string(REGEX MATCHALL "CrDeviceProperty_[A-Za-z0-9_]+" __codes "${__codes}")
+set(__properties)
+foreach(__code IN LISTS __codes)
+    string(REGEX REPLACE "^CrDeviceProperty_" "" __name ${__code})
+    # Markers and gaps of the enum, not properties
+    if(__name MATCHES "^reserved" OR __name STREQUAL "Undefined" OR __name STREQUAL "GetOnly" OR __name STREQUAL "MaxVal")
+        continue()
+    endif()
+    list(APPEND __properties ${__name})
+endforeach()
+
+### Value types and formatters ###
+file(STRINGS ${TYPES} __lines)
+foreach(__line IN LISTS __lines)
+    string(STRIP "${__line}" __line)
+    if(__line STREQUAL "" OR __line MATCHES "^#")
+        continue()
+    endif()
+    string(REGEX REPLACE "[ \t]+" ";" __fields "${__line}")
+    list(GET __fields 0 __name)
+    list(GET __fields 1 __type)
+    list(FIND __properties ${__name} __found)
+    if(__found EQUAL -1)
+        message(FATAL_ERROR "${TYPES}: ${__name} is not in CrDevicePropertyCode")
+    endif()
+    if(DEFINED __enum_${__type})
+        set(__type ${__enum_${__type}})
+    elseif(NOT DEFINED __ctype_${__type})
+        message(FATAL_ERROR "${TYPES}: ${__type} is neither a value enum nor a CrDataType")
+    endif()
+    set(__type_${__name} ${__type})
+    list(LENGTH __fields __count)
+    if(__count GREATER 2)
+        list(GET __fields 2 __format)
+        if(NOT __format STREQUAL "-")
+            set(__format_${__name} ${__format})
+        endif()
+    endif()
+    if(__count GREATER 3)
+        list(GET __fields 3 __field_${__name})
+    endif()
+endforeach()
+
+### Table in code order ###
+set(__table "")
+foreach(__name IN LISTS __properties)
+    set(__type Undefined)
+    set(__format nullptr)
+    set(__load nullptr)
+    if(DEFINED __type_${__name})
+        set(__type ${__type_${__name}})
+    endif()
+    if(DEFINED __format_${__name})
+        set(__format "&format_as<${__ctype_${__type}}, ${__format_${__name}}>")
+    endif()
+    if(DEFINED __field_${__name})
+        set(__load "&load_as<&PropertyValueTable::${__field_${__name}}>")
+    endif()
+    string(APPEND __table "    { SDK::CrDevicePropertyCode::CrDeviceProperty_${__name}, \"${__name}\", TEXT(\"${__name}\"), SDK::CrDataType::CrDataType_${__type}, ${__format}, ${__load} },\n")
+endforeach()
+
+file(WRITE ${OUTPUT}
+"// Generated by cmake/gen_property_table.cmake from CrDeviceProperty.h and cmake/property_types.txt; do not edit
+
+constexpr PropertyInfo property_table[] = {
+${__table}};
+")
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <future>
+#include <vector>
+#include "SimTest.h"
+
+// A focus step, a white balance change and the next live view frame, 20 rounds each, first one request
+// after the other and then all three at once. Run for two sets of simulated latencies.
+// Prints the p50 and max of a round; only fails when the overlapped rounds are not faster.
+
+namespace
+{
+constexpr std::size_t const rounds = 20;
+
+struct Latencies
+{
+    const char* focus_step_ms;
+    const char* set_ms;
+    const char* liveview_fps;
+};
+
+struct Timing
+{
+    long long p50;
+    long long max;
+};
+
+Timing timing(std::vector<long long> ms)
+{
+    std::sort(ms.begin(), ms.end());
+    return { ms[ms.size() / 2], ms.back() };
+}
+
+// Rounds of the three requests; sequential waits for each outcome before sending the next request
+bool run(cli::CameraDevice& camera, bool sequential, std::vector<long long>& ms)
+{
+    bool success = true;
+    std::uint64_t sequence = 0;
+    for (std::size_t round = 0; round < rounds; ++round) {
+        // Alternates, so every set is a change the camera has to report
+        CrInt64 white_balance = (0 == round % 2) ? SCRSDK::CrWhiteBalance_Daylight : SCRSDK::CrWhiteBalance_Cloudy;
+        auto started = std::chrono::steady_clock::now();
+        if (sequential) {
+            success = camera.step_focus_async(1).get() && success;
+            success = camera.set_property_value_async(SCRSDK::CrDeviceProperty_WhiteBalance, white_balance).get() && success;
+            auto frame = camera.next_live_view_frame_async(sequence).get();
+            success = static_cast<bool>(frame) && success;
+            if (frame) sequence = frame.sequence();
+        }
+        else {
+            auto focused = camera.step_focus_async(1);
+            auto set = camera.set_property_value_async(SCRSDK::CrDeviceProperty_WhiteBalance, white_balance);
+            auto next = camera.next_live_view_frame_async(sequence);
+            success = focused.get() && success;
+            success = set.get() && success;
+            auto frame = next.get();
+            success = static_cast<bool>(frame) && success;
+            if (frame) sequence = frame.sequence();
+        }
+        ms.push_back(simtest::elapsed_ms(started));
+    }
+    return success;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_JITTER_MS", "0");
+    auto cr_lib = cli::linked_cr_lib();
+    for (auto& latencies : { Latencies{ "80", "30", "60" }, Latencies{ "150", "60", "30" } }) {
+        simtest::set_sim("CRSIM_FOCUS_STEP_MS", latencies.focus_step_ms);
+        simtest::set_sim("CRSIM_SET_MS", latencies.set_ms);
+        simtest::set_sim("CRSIM_LIVEVIEW_FPS", latencies.liveview_fps);
+        auto camera = simtest::connect_camera(SCRSDK::CrSdkControlMode_Remote, 0, cr_lib);
+        if (!CHECK(camera)) break;
+        if (!CHECK(camera->start_live_view())) {
+            simtest::close_camera(camera);
+            break;
+        }
+
+        std::vector<long long> sequential_ms;
+        std::vector<long long> async_ms;
+        CHECK(run(*camera, true, sequential_ms));
+        CHECK(run(*camera, false, async_ms));
+        camera->stop_live_view();
+        simtest::close_camera(camera);
+        cr_lib->Release();
+
+        auto sequential = timing(sequential_ms);
+        auto async = timing(async_ms);
+        std::cout << "NearFar " << latencies.focus_step_ms << " ms, set " << latencies.set_ms << " ms, LV "
+            << latencies.liveview_fps << " fps: sequential p50 " << sequential.p50 << " ms (max " << sequential.max
+            << "), async p50 " << async.p50 << " ms (max " << async.max << ")\n";
+        CHECK(async.p50 < sequential.p50);
+    }
+    return simtest::finish();
+}
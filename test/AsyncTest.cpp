@@ -0,0 +1,76 @@
+#include <future>
+#include "SimTest.h"
+
+// The futures of CameraDevice become ready when the camera reports the outcome, so independent requests overlap.
+
+namespace
+{
+CrInt64 value_of(const std::vector<cli::PropertyValue>& values, CrInt32u code)
+{
+    for (auto& value : values) {
+        if (code == value.code) return value.value;
+    }
+    return -1;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_SET_MS", "200");
+    simtest::set_sim("CRSIM_CAPTURE_MS", "100");
+    auto cr_lib = cli::linked_cr_lib();
+    if (!CHECK(cr_lib->Init(0))) return simtest::finish();
+    SCRSDK::ICrEnumCameraObjectInfo* list = nullptr;
+    if (!CHECK(CR_SUCCEEDED(cr_lib->EnumCameraObjects(&list, 0)) && list)) return simtest::finish();
+    auto camera = std::make_shared<cli::CameraDevice>(1, cr_lib, list->GetCameraObjectInfo(0));
+    list->Release();
+
+    CHECK(camera->connect_async(SCRSDK::CrSdkControlMode_Remote, std::chrono::seconds(10)).get());
+    CHECK(camera->is_connected());
+
+    auto values = camera->get_property_values_async({ SCRSDK::CrDeviceProperty_FNumber, SCRSDK::CrDeviceProperty_IsoSensitivity }).get();
+    CHECK(2 == values.size());
+    CHECK(400 == value_of(values, SCRSDK::CrDeviceProperty_FNumber));
+    CHECK(0 < value_of(values, SCRSDK::CrDeviceProperty_IsoSensitivity));
+
+    // Each value takes 200 ms to be reported; both at once take the time of one
+    auto started = std::chrono::steady_clock::now();
+    auto f_number = camera->set_property_value_async(SCRSDK::CrDeviceProperty_FNumber, 560);
+    auto iso = camera->set_property_value_async(SCRSDK::CrDeviceProperty_IsoSensitivity, 800);
+    CHECK(f_number.get());
+    CHECK(iso.get());
+    auto elapsed = simtest::elapsed_ms(started);
+    CHECK(190 <= elapsed);
+    CHECK(elapsed < 350);
+    values = camera->get_property_values_async({ SCRSDK::CrDeviceProperty_FNumber, SCRSDK::CrDeviceProperty_IsoSensitivity }).get();
+    CHECK(560 == value_of(values, SCRSDK::CrDeviceProperty_FNumber));
+    CHECK(800 == value_of(values, SCRSDK::CrDeviceProperty_IsoSensitivity));
+
+    // The camera ignores a value it does not offer, so the future ends at its timeout
+    CHECK(!camera->set_property_value_async(SCRSDK::CrDeviceProperty_FNumber, 333).get());
+
+    auto captured = camera->capture_async();
+    CHECK(std::future_status::ready == captured.wait_for(std::chrono::seconds(3)));
+    CHECK(captured.get());
+
+    simtest::close_camera(camera);
+
+    // A pulled file is ready once the camera reported its transfer finished
+    auto transfer = simtest::connect_camera(SCRSDK::CrSdkControlMode_ContentsTransfer, 0, cr_lib);
+    if (CHECK(transfer)) {
+        transfer->set_contents_index(std::string(), false);
+        SCRSDK::CrContentHandle first = 0;
+        cli::ContentsIndexStats stats{};
+        CHECK(transfer->index_contents(1, [&](const SCRSDK::CrMtpContentsInfo& info) {
+            if (0 == first) first = info.handle;
+        }, stats));
+        auto pulled = transfer->pull_contents_async(first);
+        CHECK(std::future_status::ready == pulled.wait_for(std::chrono::seconds(5)));
+        auto content = pulled.get();
+        CHECK(0 == content.error);
+        CHECK(!content.file.empty());
+        simtest::close_camera(transfer);
+    }
+    cr_lib->Release();
+    return simtest::finish();
+}
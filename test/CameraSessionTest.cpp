@@ -0,0 +1,74 @@
+#include <atomic>
+#include <thread>
+#include "CameraSession.h"
+#include "SimTest.h"
+
+// Every camera has its own worker: cameras connect at the same time, and a slow task on one camera
+// does not hold up the tasks of another.
+
+int main()
+{
+    simtest::set_sim("CRSIM_CAMERAS", "2");
+    simtest::set_sim("CRSIM_CONNECT_MS", "300");
+    simtest::set_sim("CRSIM_GET_MS", "20");
+    auto cr_lib = cli::linked_cr_lib();
+    if (!CHECK(cr_lib->Init(0))) return simtest::finish();
+
+    {
+        cli::SessionManager manager(cr_lib, false);
+        CHECK(2 == manager.connect_all(SCRSDK::CrSdkControlMode_Remote, std::chrono::seconds(10)));
+        if (!CHECK(2 == manager.sessions().size())) return simtest::finish();
+        // One after the other would take two connect times
+        CHECK(manager.bring_up_time().count() < 550);
+
+        auto& slow = *manager.sessions()[0];
+        auto& quick = *manager.sessions()[1];
+        std::atomic<int> order{ 0 };
+        int slow_ran = 0;
+        int after_slow_ran = 0;
+        auto started = std::chrono::steady_clock::now();
+        auto slow_done = slow.post([&](cli::CameraDevice&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            slow_ran = ++order;
+            return true;
+        });
+        auto after_slow = slow.post([&](cli::CameraDevice&) {
+            after_slow_ran = ++order;
+            return true;
+        });
+        auto quick_done = quick.post([](cli::CameraDevice& camera) {
+            CrInt64 value = 0;
+            return camera.get_property_value(SCRSDK::CrDeviceProperty_FNumber, value);
+        });
+        CHECK(quick_done.get());
+        CHECK(simtest::elapsed_ms(started) < 250);
+        CHECK(slow_done.get());
+        CHECK(after_slow.get());
+        // Tasks of one camera keep their order
+        CHECK(slow_ran < after_slow_ran);
+
+        auto results = manager.run_all([](cli::CameraDevice& camera) { return camera.is_connected(); });
+        CHECK(2 == results.size());
+        for (auto result : results) CHECK(result);
+
+        // Tasks still queued when the session stops get to run
+        std::atomic<int> ran{ 0 };
+        for (int i = 0; i < 3; ++i) {
+            quick.post([&](cli::CameraDevice&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                ++ran;
+                return true;
+            });
+        }
+        quick.stop();
+        CHECK(3 == ran);
+        auto after_stop = quick.post([](cli::CameraDevice&) { return true; });
+        CHECK(!after_stop.get());
+        // disconnect_all() only reaches cameras through their running sessions
+        quick.camera()->disconnect();
+
+        manager.disconnect_all();
+    }
+    cr_lib->Release();
+    return simtest::finish();
+}
@@ -0,0 +1,160 @@
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include "ContentsDownloader.h"
+#include "SimTest.h"
+#if defined(__GNUC__) && __GNUC__ < 8
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+// The download window shrinks to what the camera accepts and grows back once it accepts more,
+// and a file the camera saves after its transfer timed out is deleted.
+// PullContentsFile is replaced by a camera that takes at most limit requests at once and completes them itself.
+
+namespace
+{
+struct FakeCamera
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<SCRSDK::CrContentHandle> pulled;
+    std::size_t limit = 2;
+    std::size_t outstanding = 0;
+    std::size_t most_outstanding = 0;
+    std::size_t refused = 0;
+    bool complete = true;
+    bool stopping = false;
+};
+
+FakeCamera fake;
+
+SCRSDK::CrError pull_contents_file(SCRSDK::CrDeviceHandle, SCRSDK::CrContentHandle handle, SCRSDK::CrPropertyStillImageTransSize, CrChar*, CrChar*)
+{
+    {
+        std::lock_guard<std::mutex> lock(fake.mtx);
+        if (fake.limit <= fake.outstanding) {
+            ++fake.refused;
+            return SCRSDK::CrError_Generic_Unknown;
+        }
+        ++fake.outstanding;
+        fake.most_outstanding = std::max(fake.most_outstanding, fake.outstanding);
+        if (!fake.complete) return SCRSDK::CrError_None;
+        fake.pulled.push_back(handle);
+    }
+    fake.cv.notify_all();
+    return SCRSDK::CrError_None;
+}
+
+// Ends the transfers in the order they were requested, as the camera's transfer notification would
+void complete_transfers(cli::ContentsDownloader& downloader)
+{
+    std::unique_lock<std::mutex> lock(fake.mtx);
+    while (true) {
+        fake.cv.wait(lock, [] { return fake.stopping || !fake.pulled.empty(); });
+        if (fake.pulled.empty()) return;
+        auto handle = fake.pulled.front();
+        fake.pulled.pop_front();
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        lock.lock();
+        --fake.outstanding;
+        lock.unlock();
+        downloader.on_transfer(SCRSDK::CrNotify_ContentsTransfer_Complete, handle, TEXT("file"));
+        lock.lock();
+    }
+}
+
+void stop_completing()
+{
+    {
+        std::lock_guard<std::mutex> lock(fake.mtx);
+        fake.stopping = true;
+    }
+    fake.cv.notify_all();
+}
+
+SCRSDK::CrMtpContentsInfo contents(SCRSDK::CrContentHandle handle)
+{
+    SCRSDK::CrMtpContentsInfo info;
+    info.handle = handle;
+    info.contentSize = 0;
+    return info;
+}
+} // namespace
+
+int main()
+{
+    auto cr_lib = *cli::linked_cr_lib();
+    cr_lib.PullContentsFile = pull_contents_file;
+
+    // The camera takes two requests of four until ten files completed, then all four
+    {
+        constexpr SCRSDK::CrContentHandle files = 40;
+        cli::ContentsDownloader downloader(&cr_lib, 0, 4, TEXT("."));
+        std::size_t results = 0;
+        std::size_t most_after_limit = 0;
+        downloader.set_result_sink([&](SCRSDK::CrContentHandle, const cli::text&, CrInt32u error) {
+            CHECK(0 == error);
+            std::lock_guard<std::mutex> lock(fake.mtx);
+            if (10 == ++results) {
+                fake.limit = 4;
+                fake.most_outstanding = 0;
+            }
+            if (10 < results) most_after_limit = fake.most_outstanding;
+        });
+        std::thread completer(complete_transfers, std::ref(downloader));
+        downloader.start();
+        for (SCRSDK::CrContentHandle handle = 1; handle <= files; ++handle) downloader.enqueue(contents(handle));
+        downloader.close();
+        downloader.wait();
+        stop_completing();
+        completer.join();
+
+        auto stats = downloader.stats();
+        CHECK(files == stats.queued);
+        CHECK(files == stats.completed);
+        CHECK(0 == stats.failed);
+        CHECK(files == results);
+        CHECK(0 < fake.refused);
+        CHECK(4 == most_after_limit);
+    }
+
+    // The camera accepts the request but saves the file only after the downloader gave up on it
+    {
+        fake.limit = 4;
+        fake.outstanding = 0;
+        fake.complete = false;
+        fs::path late = "late.jpg";
+        fs::path other = "other.jpg";
+        std::ofstream(late) << "late";
+        std::ofstream(other) << "other";
+
+        cli::ContentsDownloader downloader(&cr_lib, 0, 1, TEXT("."));
+        downloader.set_timeout(std::chrono::milliseconds(100));
+        CrInt32u reported = 0;
+        downloader.set_result_sink([&](SCRSDK::CrContentHandle, const cli::text&, CrInt32u error) { reported = error; });
+        downloader.start();
+        downloader.enqueue(contents(7));
+        downloader.close();
+        auto started = std::chrono::steady_clock::now();
+        downloader.wait();
+        CHECK(simtest::elapsed_ms(started) < 5000);
+        CHECK(0 != reported);
+        CHECK(1 == downloader.stats().failed);
+
+        // Not a transfer of this downloader, so its file stays
+        downloader.on_transfer(SCRSDK::CrNotify_ContentsTransfer_Complete, 8, other.native());
+        CHECK(fs::exists(other));
+        downloader.on_transfer(SCRSDK::CrNotify_ContentsTransfer_Complete, 7, late.native());
+        CHECK(!fs::exists(late));
+        CHECK(0 == downloader.stats().completed);
+        fs::remove(other);
+    }
+    return simtest::finish();
+}
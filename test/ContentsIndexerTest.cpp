@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include "SimTest.h"
+
+// Indexing keeps several detail requests in flight and hands entries out while folders are still being listed.
+// A folder whose handles cannot be listed fails the listing, so it is never taken for the whole card.
+
+namespace
+{
+// The handle list of the second folder asked for fails
+SCRSDK::CrError get_contents_handle_list(SCRSDK::CrDeviceHandle device, SCRSDK::CrFolderHandle folder,
+    SCRSDK::CrContentHandle** handles, CrInt32u* count)
+{
+    static int calls = 0;
+    if (2 == ++calls) return SCRSDK::CrError_Generic_Unknown;
+    return cli::linked_cr_lib()->GetContentsHandleList(device, folder, handles, count);
+}
+
+struct IndexRun
+{
+    bool success = false;
+    std::set<SCRSDK::CrContentHandle> handles;
+    std::size_t folders = 0;
+    cli::ContentsIndexStats stats{};
+};
+
+IndexRun index(cli::CameraDevice& camera, std::size_t workers, cli::ContentsIndexer::FolderFilter filter = nullptr)
+{
+    IndexRun run;
+    std::mutex mtx;
+    run.success = camera.index_contents(workers,
+        [&](const SCRSDK::CrMtpContentsInfo& info) {
+            std::lock_guard<std::mutex> lock(mtx);
+            run.handles.insert(info.handle);
+        },
+        run.stats, std::move(filter),
+        [&](const SCRSDK::CrMtpFolderInfo&, CrInt32u) {
+            std::lock_guard<std::mutex> lock(mtx);
+            ++run.folders;
+        });
+    return run;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_FOLDERS", "2");
+    simtest::set_sim("CRSIM_CONTENTS", "40");
+    simtest::set_sim("CRSIM_MTP_MS", "10");
+    auto camera = simtest::connect_camera(SCRSDK::CrSdkControlMode_ContentsTransfer);
+    if (!CHECK(camera)) return simtest::finish();
+    // Every run asks the camera, none is served from an index file
+    camera->set_contents_index(std::string(), false);
+
+    auto serial = index(*camera, 1);
+    CHECK(serial.success);
+    CHECK(80 == serial.handles.size());
+    CHECK(80 == serial.stats.entries);
+    CHECK(2 == serial.folders);
+    CHECK(0 == serial.stats.cached);
+
+    // A complete listing is written to the index file
+    std::remove("SIM00001.crindex");
+    camera->set_contents_index(".", false);
+    auto pipelined = index(*camera, 4);
+    CHECK(pipelined.success);
+    CHECK(nullptr != cli::ContentsIndexFile::open("SIM00001.crindex"));
+    std::remove("SIM00001.crindex");
+    camera->set_contents_index(std::string(), false);
+    CHECK(serial.handles == pipelined.handles);
+    CHECK(0 == pipelined.stats.failures);
+    // 80 detail requests of 10 ms take 800 ms one at a time
+    CHECK(pipelined.stats.elapsed.count() * 2 < serial.stats.elapsed.count());
+    // The first entry arrives before the last folder was even listed
+    CHECK(pipelined.stats.first_entry.count() * 4 < pipelined.stats.elapsed.count());
+
+    bool first = true;
+    auto filtered = index(*camera, 4, [&](const SCRSDK::CrMtpFolderInfo&) {
+        bool keep = first;
+        first = false;
+        return keep;
+    });
+    CHECK(filtered.success);
+    CHECK(40 == filtered.handles.size());
+    CHECK(1 == filtered.folders);
+
+    simtest::close_camera(camera);
+
+    // The other folder is still delivered, but the index file is not written
+    auto cr_lib = *cli::linked_cr_lib();
+    cr_lib.GetContentsHandleList = get_contents_handle_list;
+    auto failing = simtest::connect_camera(SCRSDK::CrSdkControlMode_ContentsTransfer, 0, &cr_lib);
+    if (CHECK(failing)) {
+        failing->set_contents_index(".", false);
+        auto partial = index(*failing, 4);
+        CHECK(!partial.success);
+        CHECK(40 == partial.handles.size());
+        CHECK(1 == partial.folders);
+        CHECK(1 == partial.stats.failures);
+        CHECK(nullptr == cli::ContentsIndexFile::open("SIM00001.crindex"));
+        simtest::close_camera(failing);
+    }
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
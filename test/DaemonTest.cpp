@@ -0,0 +1,51 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "Daemon.h"
+#include "SimTest.h"
+
+// A request reaches the daemon's handler with its arguments exactly as sent, empty ones included,
+// and the client gets the handler's exit status back.
+
+int main()
+{
+    std::string path = "DaemonTest.sock";
+    std::vector<std::vector<std::string>> received;
+    std::thread daemon([&] {
+        CHECK(cli::serve_requests(path, [&](const std::vector<std::string>& args, std::basic_ostream<cli::text_char>& out, bool& stop) {
+            received.push_back(args);
+            stop = !args.empty() && "stop" == args[0];
+            out << "args " << args.size() << "\n";
+            return static_cast<int>(args.size());
+        }, false));
+    });
+
+    // Retried until the daemon listens
+    int status = -1;
+    std::vector<std::string> first{ "capture", "", "--dir", "", "--json" };
+    bool forwarded = false;
+    for (int attempt = 0; attempt < 100 && !forwarded; ++attempt) {
+        forwarded = cli::forward_request(path, first, status);
+        if (!forwarded) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(forwarded);
+    CHECK(5 == status);
+
+    std::vector<std::string> empty;
+    CHECK(cli::forward_request(path, empty, status));
+    CHECK(0 == status);
+    std::vector<std::string> lines{ "get", "a\nb", std::string(2000, 'x') };
+    CHECK(cli::forward_request(path, lines, status));
+    CHECK(3 == status);
+    CHECK(cli::forward_request(path, { "stop" }, status));
+    daemon.join();
+
+    if (CHECK(4 == received.size())) {
+        CHECK(first == received[0]);
+        CHECK(received[1].empty());
+        CHECK(lines == received[2]);
+    }
+    // Once stopped, nothing answers on the path
+    CHECK(!cli::forward_request(path, { "get" }, status));
+    return simtest::finish();
+}
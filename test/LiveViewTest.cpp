@@ -0,0 +1,36 @@
+#include "LiveView.h"
+#include "SimTest.h"
+
+// Live view restarts on the same stream: not while a frame from the previous run is still held,
+// since the restart rebuilds the buffer pool that frame points into.
+
+int main()
+{
+    simtest::set_sim("CRSIM_LIVEVIEW_FPS", "30");
+    auto camera = simtest::connect_camera();
+    if (!CHECK(camera)) return simtest::finish();
+    if (!CHECK(camera->start_live_view(3))) return simtest::finish();
+    auto* stream = camera->get_live_view_stream();
+
+    auto frame = stream->wait_next(0, std::chrono::milliseconds(3000));
+    if (CHECK(frame)) {
+        auto sequence = frame.sequence();
+        camera->stop_live_view();
+        CHECK(!camera->start_live_view(3));
+        CHECK(stream == camera->get_live_view_stream());
+        // The held frame is untouched by the refused restart
+        CHECK(sequence == frame.sequence());
+        CHECK(0xFF == frame.data()[0] && 0xD8 == frame.data()[1]);
+
+        frame = cli::LiveViewFrame();
+        CHECK(camera->start_live_view(3));
+        CHECK(stream == camera->get_live_view_stream());
+        // Sequences start over with the new run
+        auto next = stream->wait_next(0, std::chrono::milliseconds(3000));
+        CHECK(next && 1 <= next.sequence());
+    }
+    camera->stop_live_view();
+    simtest::close_camera(camera);
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
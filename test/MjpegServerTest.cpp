@@ -0,0 +1,111 @@
+#include <cstdint>
+#include <string>
+#include "MjpegServer.h"
+#include "SimTest.h"
+
+// liveview --serve: the camera's live view goes out over loopback HTTP as multipart JPEG parts,
+// each a whole frame from SOI to EOI, and a client beyond max_clients is turned away.
+
+namespace
+{
+// Receives until data holds at least size bytes; false on timeout or when the server closed
+bool receive(cli::socket_t sock, std::string& data, std::size_t size)
+{
+    char chunk[4096];
+    while (data.size() < size) {
+        if (!cli::wait_readable(sock, 3000)) return false;
+        long len = cli::recv_some(sock, chunk, sizeof chunk);
+        if (len <= 0) return false;
+        data.append(chunk, static_cast<std::size_t>(len));
+    }
+    return true;
+}
+
+// Receives until data holds delimiter; returns the position after it, or npos
+std::size_t receive_until(cli::socket_t sock, std::string& data, std::size_t from, const std::string& delimiter)
+{
+    while (true) {
+        auto pos = data.find(delimiter, from);
+        if (std::string::npos != pos) return pos + delimiter.size();
+        if (!receive(sock, data, data.size() + 1)) return std::string::npos;
+    }
+}
+
+cli::socket_t request(std::uint16_t port)
+{
+    auto sock = cli::connect_tcp(port);
+    std::string get = "GET / HTTP/1.0\r\n\r\n";
+    if (cli::invalid_socket != sock && !cli::send_all(sock, get.data(), get.size())) {
+        cli::close_socket(sock);
+        return cli::invalid_socket;
+    }
+    return sock;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_LIVEVIEW_FPS", "30");
+    simtest::set_sim("CRSIM_LIVEVIEW_BYTES", "20000");
+    auto camera = simtest::connect_camera();
+    if (!CHECK(camera) || !CHECK(cli::socket_startup())) return simtest::finish();
+    if (!CHECK(camera->start_live_view(3))) return simtest::finish();
+
+    // One client at a time, on the first free port
+    cli::MjpegServer server(*camera->get_live_view_stream(), 1);
+    std::uint16_t port = 0;
+    for (std::uint16_t candidate = 28431; candidate < 28471 && 0 == port; ++candidate) {
+        if (server.start(candidate)) port = candidate;
+    }
+    if (CHECK(0 != port)) {
+        auto sock = request(port);
+        if (CHECK(cli::invalid_socket != sock)) {
+            std::string data;
+            auto body = receive_until(sock, data, 0, "\r\n\r\n");
+            if (CHECK(std::string::npos != body)) {
+                CHECK(0 == data.compare(0, 15, "HTTP/1.0 200 OK"));
+                CHECK(std::string::npos != data.find("Content-Type: multipart/x-mixed-replace; boundary=frame"));
+            }
+
+            // A second client while the first is served gets 503
+            auto rejected = request(port);
+            if (CHECK(cli::invalid_socket != rejected)) {
+                std::string reply;
+                CHECK(std::string::npos != receive_until(rejected, reply, 0, "\r\n\r\n"));
+                CHECK(0 == reply.compare(0, 12, "HTTP/1.0 503"));
+                cli::close_socket(rejected);
+            }
+
+            std::size_t pos = body;
+            for (int part = 0; part < 3 && std::string::npos != pos; ++part) {
+                auto start = pos;
+                pos = receive_until(sock, data, start, "\r\n\r\n");
+                if (!CHECK(std::string::npos != pos)) break;
+                auto header = data.substr(start, pos - start);
+                CHECK(0 == header.compare(0, 9, "--frame\r\n"));
+                CHECK(std::string::npos != header.find("Content-Type: image/jpeg\r\n"));
+                auto length_at = header.find("Content-Length: ");
+                if (!CHECK(std::string::npos != length_at)) break;
+                std::size_t length = std::stoul(header.substr(length_at + 16));
+                CHECK(1000 < length);
+                // The JPEG and the CRLF that ends the part
+                if (!CHECK(receive(sock, data, pos + length + 2))) break;
+                auto jpeg = reinterpret_cast<const unsigned char*>(data.data() + pos);
+                CHECK(0xFF == jpeg[0] && 0xD8 == jpeg[1]);
+                CHECK(0xFF == jpeg[length - 2] && 0xD9 == jpeg[length - 1]);
+                CHECK(0 == data.compare(pos + length, 2, "\r\n"));
+                pos += length + 2;
+            }
+            cli::close_socket(sock);
+        }
+        server.stop();
+        auto stats = server.stats();
+        CHECK(1 == stats.clients);
+        CHECK(1 == stats.rejected);
+        CHECK(3 <= stats.sent);
+    }
+    camera->stop_live_view();
+    simtest::close_camera(camera);
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "PropertyTable.h"
+#include "SimTest.h"
+
+// Name->code lookups: the perfect hash of the generated table against the unordered_map it replaced.
+// Prints nanoseconds per lookup; only fails when the perfect hash is far behind the map.
+
+namespace
+{
+constexpr std::size_t const lookups = 1000000;
+
+// Takes the sum of each run, which keeps the lookups from being optimized away
+volatile CrInt32u sink = 0;
+
+template <typename Lookup>
+double ns_per_lookup(const std::vector<std::size_t>& order, Lookup lookup)
+{
+    CrInt32u sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i : order) sum += lookup(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    sink = sum;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / order.size();
+}
+} // namespace
+
+int main()
+{
+    std::vector<std::string> names;
+    std::unordered_map<cli::text, CrInt32u> map;
+    for (CrInt32u code = 0; code < 0x10000; ++code) {
+        auto* info = cli::find_property(code);
+        if (nullptr == info) continue;
+        names.emplace_back(info->name);
+        map.emplace(cli::text(info->name.begin(), info->name.end()), code);
+    }
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<std::size_t> pick(0, names.size() - 1);
+    std::vector<std::size_t> order(lookups);
+    for (auto& i : order) i = pick(random);
+
+    // As the CLI looked properties up before the table: a text copy of the argument, count, then at
+    double old_map = ns_per_lookup(order, [&](std::size_t i) {
+        cli::text name(names[i].begin(), names[i].end());
+        return map.count(name) ? map.at(name) : 0;
+    });
+    std::vector<cli::text> texts;
+    for (auto& name : names) texts.emplace_back(name.begin(), name.end());
+    double map_find = ns_per_lookup(order, [&](std::size_t i) {
+        auto found = map.find(texts[i]);
+        return found == map.end() ? 0 : found->second;
+    });
+    double perfect_hash = ns_per_lookup(order, [&](std::size_t i) {
+        auto* info = cli::find_property(std::string_view(names[i]));
+        return info ? info->code : 0;
+    });
+
+    std::cout << lookups << " random lookups over " << names.size() << " names\n" << std::fixed << std::setprecision(1)
+        << "  old map (text copy + count + at) " << old_map << " ns\n"
+        << "  map find only                    " << map_find << " ns\n"
+        << "  perfect hash                     " << perfect_hash << " ns\n";
+    CHECK(perfect_hash < old_map * 2);
+    return simtest::finish();
+}
@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include "PropertyStore.h"
+#include "PropertyTable.h"
+#include "PropertyValueTable.h"
+#include "SimTest.h"
+
+// Parse cost per load_properties on a full dump of every typed property, 16 of them with value lists
+// of 2 to 60 entries. Each pass copies the previous value table, as load_properties does, and loads the dump
+// into it: the parse_* functions copied every list into a fresh vector; the views rebuild a list in the
+// capacity it has when it differs from the table's, and compare it in place when it does not.
+// The property store is timed on the same dump. Prints microseconds per pass; only fails when the views
+// are far behind the copies.
+
+namespace
+{
+constexpr int const rounds = 5;
+constexpr int const calls = 20000;
+
+// Takes a result of each pass, which keeps the passes from being optimized away
+volatile std::size_t sink = 0;
+
+struct Dump
+{
+    std::vector<SCRSDK::CrDeviceProperty> props;
+    std::vector<std::vector<unsigned char>> buffers;
+};
+
+// Values of the lists start at first
+Dump full_dump(CrInt64u first)
+{
+    Dump dump;
+    std::size_t lists = 0;
+    for (CrInt32u code = 0; code < 0x10000; ++code) {
+        auto* info = cli::find_property(code);
+        if (nullptr == info || SCRSDK::CrDataType_Undefined == info->type) continue;
+        SCRSDK::CrDeviceProperty prop;
+        prop.SetCode(code);
+        prop.SetValueType(info->type);
+        prop.SetPropertyEnableFlag(SCRSDK::CrEnableValue_True);
+        prop.SetCurrentValue(1);
+        if (lists < 16 && info->value_size() <= 8) {
+            std::size_t count = 2 + lists * 58 / 15;
+            std::vector<unsigned char> buffer(count * info->value_size());
+            for (std::size_t i = 0; i < count; ++i) {
+                CrInt64u value = first + i;
+                std::memcpy(buffer.data() + i * info->value_size(), &value, info->value_size());
+            }
+            dump.buffers.push_back(std::move(buffer));
+            prop.SetValueType(static_cast<SCRSDK::CrDataType>(info->type | SCRSDK::CrDataType_ArrayBit));
+            ++lists;
+        }
+        dump.props.push_back(prop);
+    }
+    // Buffers no longer move once all are in place
+    for (std::size_t i = 0, b = 0; i < dump.props.size(); ++i) {
+        if (0 == (dump.props[i].GetValueType() & SCRSDK::CrDataType_ArrayBit)) continue;
+        dump.props[i].SetValues(dump.buffers[b].data());
+        dump.props[i].SetValueSize(static_cast<CrInt32u>(dump.buffers[b].size()));
+        ++b;
+    }
+    return dump;
+}
+
+// Best of the rounds, in microseconds per call
+template <typename Pass>
+double us_per_call(Pass pass)
+{
+    double best = 0;
+    for (int round = 0; round < rounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int call = 0; call < calls; ++call) pass();
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / calls;
+        if (0 == round || us < best) best = us;
+    }
+    return best;
+}
+} // namespace
+
+int main()
+{
+    auto dump = full_dump(1);
+    auto other = full_dump(2);
+    auto& props = dump.props;
+    CHECK(50 < props.size());
+    CHECK(16 == dump.buffers.size());
+
+    auto load = [](cli::PropertyValueTable& table, std::vector<SCRSDK::CrDeviceProperty>& props) {
+        for (auto& prop : props) {
+            auto* info = cli::find_property(prop.GetCode());
+            if (info->load) info->load(table, prop);
+        }
+    };
+    cli::PropertyValueTable same{};
+    load(same, dump.props);
+    cli::PropertyValueTable changed{};
+    load(changed, other.props);
+
+    double copies = us_per_call([&] {
+        cli::PropertyValueTable next(same);
+        std::size_t values = 0;
+        for (auto& prop : props) {
+            auto* info = cli::find_property(prop.GetCode());
+            if (!info->load) continue;
+            cli::visit_values(prop.GetValueType(), prop.GetValues(), prop.GetValues() ? prop.GetValueSize() : 0, [&](auto view) {
+                values += view.to_vector().size();
+            });
+        }
+        sink = values + next.f_number.possible.size();
+    });
+    double rebuilt = us_per_call([&] {
+        cli::PropertyValueTable next(changed);
+        load(next, props);
+        sink = next.f_number.possible.size();
+    });
+    double in_place = us_per_call([&] {
+        cli::PropertyValueTable next(same);
+        load(next, props);
+        sink = next.f_number.possible.size();
+    });
+    cli::PropertyStore store;
+    store.update(props.data(), static_cast<std::int32_t>(props.size()), true);
+    double stored = us_per_call([&] {
+        sink = store.update(props.data(), static_cast<std::int32_t>(props.size()), true);
+    });
+
+    std::cout << props.size() << " properties, " << dump.buffers.size() << " with value lists, best of " << rounds << " x "
+        << calls << " calls\n" << std::fixed << std::setprecision(2)
+        << "  value table, parse_* copies    " << copies << " us\n"
+        << "  value table, lists rebuilt     " << rebuilt << " us\n"
+        << "  value table, compared in place " << in_place << " us\n"
+        << "  store, compared in place       " << stored << " us\n";
+    CHECK(in_place < copies * 1.5);
+    CHECK(rebuilt < copies * 1.5);
+    return simtest::finish();
+}
@@ -0,0 +1,140 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PropertySubscriptions.h"
+#include "SimTest.h"
+
+// Subscribers see the changes of their codes that their predicate accepts, on the dispatch thread.
+// Once and timed out subscriptions end by themselves, and a full queue drops changes instead of blocking.
+
+namespace
+{
+constexpr CrInt32u iso = SCRSDK::CrDeviceProperty_IsoSensitivity;
+constexpr CrInt32u f_number = SCRSDK::CrDeviceProperty_FNumber;
+
+struct Recorder
+{
+    std::mutex mtx;
+    std::vector<cli::PropertyChange> changes;
+    std::thread::id thread;
+
+    cli::PropertyHandler handler()
+    {
+        return [this](const cli::PropertyChange& change) {
+            std::lock_guard<std::mutex> lock(mtx);
+            changes.push_back(change);
+            thread = std::this_thread::get_id();
+        };
+    }
+
+    // Waits up to a second for count changes
+    std::size_t wait_for(std::size_t count)
+    {
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (std::chrono::steady_clock::now() < until) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (count <= changes.size()) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        return changes.size();
+    }
+};
+} // namespace
+
+int main()
+{
+    {
+        cli::PropertySubscriptions subscriptions;
+        // Nobody listens yet, so nothing is queued
+        CHECK(subscriptions.publish(iso, 100));
+        CHECK(0 == subscriptions.stats().published);
+
+        Recorder filtered;
+        auto id = subscriptions.subscribe({ iso }, [](CrInt32u, CrInt64u value) { return 400 <= value; }, filtered.handler(),
+            std::chrono::milliseconds(0), false);
+        subscriptions.publish(iso, 200);
+        subscriptions.publish(f_number, 800);
+        subscriptions.publish(iso, 400);
+        subscriptions.publish(iso, 800);
+        CHECK(2 == filtered.wait_for(2));
+        CHECK(iso == filtered.changes[0].code && 400 == filtered.changes[0].value);
+        CHECK(800 == filtered.changes[1].value);
+        CHECK(!filtered.changes[0].timed_out);
+        CHECK(std::this_thread::get_id() != filtered.thread);
+
+        subscriptions.unsubscribe(id);
+        subscriptions.publish(iso, 1600);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(2 == filtered.wait_for(2));
+
+        Recorder once;
+        subscriptions.subscribe({}, nullptr, once.handler(), std::chrono::milliseconds(100), true);
+        subscriptions.publish(f_number, 280);
+        subscriptions.publish(iso, 3200);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        // Matched before the timeout, so there is no timed out call either
+        CHECK(1 == once.wait_for(1));
+        CHECK(f_number == once.changes[0].code);
+
+        Recorder unmatched;
+        auto started = std::chrono::steady_clock::now();
+        subscriptions.subscribe({ f_number }, nullptr, unmatched.handler(), std::chrono::milliseconds(100), false);
+        CHECK(1 == unmatched.wait_for(1));
+        CHECK(unmatched.changes[0].timed_out);
+        CHECK(90 <= simtest::elapsed_ms(started));
+
+        auto next = subscriptions.next({ iso }, [](CrInt32u, CrInt64u value) { return 6400 == value; }, std::chrono::seconds(1));
+        subscriptions.publish(iso, 100);
+        subscriptions.publish(iso, 6400);
+        auto change = next.get();
+        CHECK(!change.timed_out);
+        CHECK(6400 == change.value);
+        CHECK(subscriptions.next({ iso }, nullptr, std::chrono::milliseconds(50)).get().timed_out);
+    }
+
+    // A handler that cannot keep up: publish() never waits for it
+    {
+        cli::PropertySubscriptions subscriptions(4);
+        std::mutex blocked;
+        std::unique_lock<std::mutex> hold(blocked);
+        std::atomic<int> calls{ 0 };
+        subscriptions.subscribe({ iso }, nullptr, [&](const cli::PropertyChange&) {
+            std::lock_guard<std::mutex> lock(blocked);
+            ++calls;
+        }, std::chrono::milliseconds(0), false);
+        std::size_t refused = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (CrInt64u value = 0; value < 100; ++value) {
+            if (!subscriptions.publish(iso, value)) ++refused;
+        }
+        CHECK(simtest::elapsed_ms(started) < 100);
+        auto stats = subscriptions.stats();
+        CHECK(0 < refused);
+        CHECK(refused == stats.dropped);
+        CHECK(100 == stats.published + stats.dropped);
+        hold.unlock();
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (calls < static_cast<int>(stats.published) && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        CHECK(stats.published == static_cast<std::uint64_t>(calls));
+    }
+
+    // Changes reported by the camera reach the subscribers of CameraDevice
+    simtest::set_sim("CRSIM_DIAL_MS", "50");
+    auto camera = simtest::connect_camera();
+    if (CHECK(camera)) {
+        auto turned = camera->next_property_change({ iso }, nullptr, std::chrono::seconds(2)).get();
+        CHECK(!turned.timed_out);
+        CHECK(iso == turned.code);
+        // Counted once the handler returned, which may be after the future was set
+        CHECK(0 < camera->get_subscription_stats().published);
+        camera->disconnect();
+    }
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
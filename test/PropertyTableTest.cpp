@@ -0,0 +1,72 @@
+#include <string>
+#include "PropertyTable.h"
+#include "PropertyValueTable.h"
+#include "SimTest.h"
+
+// Every property of the generated table is found by its code and by its name, and nothing else is.
+// The table also loads the properties CameraDevice keeps into their PropertyValueTable entry.
+
+int main()
+{
+    std::size_t found = 0;
+    CrInt32u previous = 0;
+    for (CrInt32u code = 0; code < 0x10000; ++code) {
+        auto* info = cli::find_property(code);
+        if (nullptr == info) continue;
+        ++found;
+        CHECK(code == info->code);
+        CHECK(1 == found || previous < code);
+        previous = code;
+        CHECK(!info->name.empty());
+        CHECK(info == cli::find_property(info->name));
+        CHECK(cli::text(info->name.begin(), info->name.end()) == cli::text(info->display_name));
+        if (SCRSDK::CrDataType_Undefined != info->type) {
+            auto size = info->value_size();
+            CHECK(1 == size || 2 == size || 4 == size || 8 == size || 16 == size);
+        }
+    }
+    CHECK(50 < found);
+
+    auto* f_number = cli::find_property("FNumber");
+    if (CHECK(f_number)) {
+        CHECK(SCRSDK::CrDeviceProperty_FNumber == f_number->code);
+        CHECK(SCRSDK::CrDataType_UInt16 == f_number->type);
+        CHECK(2 == f_number->value_size());
+        if (CHECK(f_number->format)) CHECK(cli::format_f_number(280) == f_number->format(280));
+        CHECK(cli::format_f_number(280) == cli::format_property_value(SCRSDK::CrDeviceProperty_FNumber, 280));
+    }
+    auto* s1 = cli::find_property(SCRSDK::CrDeviceProperty_S1);
+    if (CHECK(s1)) CHECK("S1" == s1->name);
+
+    // Loaded in the entry's own type, with the possible values copied out of the SDK's buffer
+    if (f_number && CHECK(f_number->load)) {
+        std::uint16_t possible[] = { 280, 400, 560 };
+        SCRSDK::CrDeviceProperty prop;
+        prop.SetCode(SCRSDK::CrDeviceProperty_FNumber);
+        prop.SetValueType(SCRSDK::CrDataType_UInt16Array);
+        prop.SetPropertyEnableFlag(SCRSDK::CrEnableValue_True);
+        prop.SetCurrentValue(400);
+        prop.SetValues(reinterpret_cast<CrInt8u*>(possible));
+        prop.SetValueSize(sizeof(possible));
+        cli::PropertyValueTable table{};
+        f_number->load(table, prop);
+        CHECK(400 == table.f_number.current);
+        CHECK(table.f_number.writable);
+        CHECK((std::vector<std::uint16_t>{ 280, 400, 560 }) == table.f_number.possible);
+        CHECK(0 == table.iso_sensitivity.current);
+    }
+    auto* mode = cli::find_property(SCRSDK::CrDeviceProperty_SdkControlMode);
+    if (CHECK(mode)) CHECK(mode->load);
+    if (CHECK(s1)) CHECK(nullptr == s1->load);
+
+    // Names are exact, without the prefix of the enum
+    CHECK(nullptr == cli::find_property(""));
+    CHECK(nullptr == cli::find_property("fnumber"));
+    CHECK(nullptr == cli::find_property("FNumbe"));
+    CHECK(nullptr == cli::find_property("FNumberX"));
+    CHECK(nullptr == cli::find_property("CrDeviceProperty_FNumber"));
+    CHECK(nullptr == cli::find_property(std::string(300, 'x')));
+    CHECK(nullptr == cli::find_property(SCRSDK::CrDeviceProperty_MaxVal + 0x8000));
+    CHECK(cli::format_property_value(SCRSDK::CrDeviceProperty_MaxVal + 0x8000, 1).empty());
+    return simtest::finish();
+}
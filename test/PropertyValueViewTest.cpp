@@ -0,0 +1,87 @@
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "PropertyValueView.h"
+#include "SimTest.h"
+
+// Values are read in place from unaligned buffers, range properties are flagged,
+// and a property reporting elements of another width gives an empty view.
+
+namespace
+{
+template <typename T>
+std::vector<unsigned char> bytes_of(const std::vector<T>& values, std::size_t offset)
+{
+    std::vector<unsigned char> buffer(offset + values.size() * sizeof(T) + 1);
+    std::memcpy(buffer.data() + offset, values.data(), values.size() * sizeof(T));
+    return buffer;
+}
+} // namespace
+
+int main()
+{
+    // One byte in, so no element is aligned; the trailing byte is a partial element and ignored
+    std::vector<std::uint32_t> isos{ 100, 200, 400, 800, 0x10000000 | 25600 };
+    auto buffer = bytes_of(isos, 1);
+    cli::PropertyValueView<std::uint32_t> view(buffer.data() + 1, buffer.size() - 1);
+    CHECK(isos.size() == view.size());
+    CHECK(!view.empty());
+    CHECK(!view.range());
+    CHECK(view.equals(isos));
+    CHECK(isos == view.to_vector());
+    CHECK(800 == view[3]);
+    CHECK(isos.size() == static_cast<std::size_t>(view.end() - view.begin()));
+    std::vector<std::uint32_t> reused(100, 7);
+    view.assign_to(reused);
+    CHECK(isos == reused);
+    CHECK(!view.equals({ 100, 200 }));
+    CHECK(!view.equals({ 100, 200, 400, 800, 25600 }));
+
+    cli::PropertyValueView<std::uint32_t> none(nullptr, 16);
+    CHECK(none.empty());
+    CHECK(none.begin() == none.end());
+
+    // Int16Range: minimum, maximum and step
+    std::vector<std::int16_t> range{ -15, 15, 3 };
+    auto range_buffer = bytes_of(range, 3);
+    bool visited = false;
+    CHECK(cli::visit_values(SCRSDK::CrDataType_Int16Range, range_buffer.data() + 3, range.size() * sizeof(std::int16_t),
+        [&](auto values) {
+            using T = typename decltype(values)::iterator::value_type;
+            visited = std::is_same<T, std::int16_t>::value && values.range() && 3 == values.size()
+                && -15 == static_cast<long long>(values[0]) && 15 == static_cast<long long>(values[1])
+                && 3 == static_cast<long long>(values[2]);
+        }));
+    CHECK(visited);
+    CHECK(!cli::visit_values(SCRSDK::CrDataType_Undefined, range_buffer.data(), range_buffer.size(), [](auto) {}));
+
+    CHECK(1 == cli::data_type_size(SCRSDK::CrDataType_Int8Array));
+    CHECK(2 == cli::data_type_size(SCRSDK::CrDataType_UInt16Range));
+    CHECK(4 == cli::data_type_size(SCRSDK::CrDataType_Int32));
+    CHECK(8 == cli::data_type_size(SCRSDK::CrDataType_UInt64Array));
+    CHECK(0 == cli::data_type_size(SCRSDK::CrDataType_Undefined));
+
+    SCRSDK::CrDeviceProperty prop;
+    prop.SetValueType(SCRSDK::CrDataType_UInt32Array);
+    prop.SetValues(buffer.data() + 1);
+    prop.SetValueSize(static_cast<CrInt32u>(isos.size() * sizeof(std::uint32_t)));
+    CHECK(cli::view_values<std::uint32_t>(prop).equals(isos));
+    // Elements of another width are not reinterpreted
+    CHECK(cli::view_values<std::uint16_t>(prop).empty());
+    prop.SetValueType(SCRSDK::CrDataType_Undefined);
+    CHECK(10 == cli::view_values<std::uint16_t>(prop).size());
+    prop.SetValues(nullptr);
+
+    // The camera's own lists go through the same views
+    auto camera = simtest::connect_camera();
+    if (CHECK(camera)) {
+        std::vector<CrInt64> values;
+        bool is_range = true;
+        CHECK(camera->get_possible_values(SCRSDK::CrDeviceProperty_FNumber, values, is_range));
+        CHECK(!values.empty());
+        CHECK(!is_range);
+        camera->disconnect();
+    }
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
@@ -0,0 +1,52 @@
+#include <chrono>
+#include "SimTest.h"
+
+// The focus step of the shutter sequence ends on the camera's focus report after the half press,
+// never on a report left over from before it, and does not wait at all in manual focus.
+
+namespace
+{
+long long focus_ms(cli::CameraDevice& camera, bool& timed_out)
+{
+    for (auto& step : camera.get_shutter_timing()) {
+        if (step.step == TEXT("Focus")) {
+            timed_out = step.timed_out;
+            return step.elapsed.count();
+        }
+    }
+    timed_out = true;
+    return -1;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_AF_MS", "400");
+    simtest::set_sim("CRSIM_SET_MS", "30");
+    auto camera = simtest::connect_camera();
+    if (!CHECK(camera)) return simtest::finish();
+
+    bool timed_out = false;
+    CHECK(camera->arm_release());
+    auto first = focus_ms(*camera, timed_out);
+    CHECK(!timed_out);
+    CHECK(400 <= first);
+
+    // S1 is still held and the camera still reports focus from the first half press
+    CHECK(camera->arm_release());
+    auto again = focus_ms(*camera, timed_out);
+    CHECK(!timed_out);
+    CHECK(400 <= again);
+    CHECK(camera->release_armed());
+
+    CHECK(camera->set_focusmode_manual());
+    CHECK(camera->arm_release());
+    auto manual = focus_ms(*camera, timed_out);
+    CHECK(!timed_out);
+    CHECK(manual < 200);
+    CHECK(camera->release_armed());
+
+    camera->disconnect();
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
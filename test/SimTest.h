@@ -0,0 +1,88 @@
+#ifndef SIMTEST_H
+#define SIMTEST_H
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "CRSDK/CameraRemote_SDK.h"
+#include "CameraDevice.h"
+#include "LibManager.h"
+
+// Helpers of the test programs, which run their scenarios against the simulated camera.
+// Each program exits with EXIT_FAILURE if any CHECK failed.
+namespace simtest
+{
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+inline bool check(bool passed, const char* expression, const char* file, int line)
+{
+    if (!passed) {
+        ++failures();
+        std::cerr << file << ":" << line << ": CHECK failed: " << expression << std::endl;
+    }
+    return passed;
+}
+
+inline int finish()
+{
+    if (0 == failures()) return EXIT_SUCCESS;
+    std::cerr << failures() << " checks failed" << std::endl;
+    return EXIT_FAILURE;
+}
+
+// Simulator settings are read by Init(), so they have to be set before
+inline void set_sim(const char* name, const char* value)
+{
+#if defined(_WIN32)
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+}
+
+// Initializes the SDK and connects the camera at index, or returns nullptr
+inline std::shared_ptr<cli::CameraDevice> connect_camera(SCRSDK::CrSdkControlMode mode = SCRSDK::CrSdkControlMode_Remote,
+    CrInt32u index = 0, cli::CRLibInterface const* cr_lib = cli::linked_cr_lib())
+{
+    if (!cr_lib->Init(0)) return nullptr;
+    SCRSDK::ICrEnumCameraObjectInfo* list = nullptr;
+    if (CR_FAILED(cr_lib->EnumCameraObjects(&list, 0)) || nullptr == list) return nullptr;
+    std::shared_ptr<cli::CameraDevice> camera;
+    if (index < list->GetCount()) {
+        camera = std::make_shared<cli::CameraDevice>(static_cast<std::int32_t>(index + 1), cr_lib, list->GetCameraObjectInfo(index));
+    }
+    list->Release();
+    if (!camera || !camera->connect(mode) || !camera->wait_for_connection(std::chrono::seconds(10))) return nullptr;
+    return camera;
+}
+
+// Disconnects and releases the device, after which the SDK sends the camera no more callbacks
+// and it can be destroyed before the SDK is released
+inline void close_camera(std::shared_ptr<cli::CameraDevice>& camera)
+{
+    if (!camera) return;
+    if (camera->disconnect()) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (camera->is_connected() && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    camera->release();
+    camera.reset();
+}
+
+inline long long elapsed_ms(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since).count();
+}
+} // namespace simtest
+
+#define CHECK(expression) simtest::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif // !SIMTEST_H
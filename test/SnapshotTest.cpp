@@ -0,0 +1,92 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Snapshot.h"
+#include "SimTest.h"
+
+// Readers of a Snapshot see whole versions, in publish order, while the writer keeps publishing.
+// A version is a vector whose elements all equal its generation, so a torn or reused value shows.
+
+namespace
+{
+struct Generation
+{
+    std::uint64_t number = 0;
+    std::vector<std::uint64_t> values;
+};
+
+bool intact(const Generation& generation)
+{
+    if (generation.values.size() != generation.number % 64 + 1) return false;
+    for (auto value : generation.values) {
+        if (value != generation.number) return false;
+    }
+    return true;
+}
+
+// Counted per reader, and checked on the main thread once the readers joined
+struct ReaderResult
+{
+    std::uint64_t loads = 0;
+    std::uint64_t torn = 0;
+    std::uint64_t backwards = 0;
+    std::uint64_t stale_version = 0;
+    std::uint64_t changed_while_held = 0;
+};
+} // namespace
+
+int main()
+{
+    constexpr std::uint64_t generations = 20000;
+    constexpr int readers = 4;
+
+    auto first = std::make_shared<Generation>();
+    first->values.assign(1, 0);
+    cli::Snapshot<Generation> snapshot(first);
+
+    std::atomic<bool> done{ false };
+    std::atomic<int> started{ 0 };
+    std::vector<ReaderResult> results(readers);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; ++i) {
+        threads.emplace_back([&, i] {
+            auto& result = results[i];
+            std::shared_ptr<const Generation> held;
+            std::uint64_t last = 0;
+            started.fetch_add(1);
+            while (!done.load(std::memory_order_acquire)) {
+                auto current = snapshot.load();
+                ++result.loads;
+                if (!intact(*current)) ++result.torn;
+                if (current->number < last) ++result.backwards;
+                // The version is counted after the swap, so it may trail the value by one
+                if (snapshot.version() + 1 < current->number) ++result.stale_version;
+                if (held && !intact(*held)) ++result.changed_while_held;
+                last = current->number;
+                // Keep every 16th version alive across later publishes
+                if (0 == result.loads % 16) held = current;
+            }
+        });
+    }
+
+    while (started.load() < readers) std::this_thread::yield();
+    for (std::uint64_t number = 1; number <= generations; ++number) {
+        auto next = std::make_shared<Generation>();
+        next->number = number;
+        next->values.assign(number % 64 + 1, number);
+        snapshot.publish(std::move(next));
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thread : threads) thread.join();
+
+    CHECK(generations == snapshot.version());
+    CHECK(generations == snapshot.load()->number);
+    for (auto& result : results) {
+        CHECK(0 < result.loads);
+        CHECK(0 == result.torn);
+        CHECK(0 == result.backwards);
+        CHECK(0 == result.stale_version);
+        CHECK(0 == result.changed_while_held);
+    }
+    return simtest::finish();
+}
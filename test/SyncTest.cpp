@@ -0,0 +1,121 @@
+#include <fstream>
+#include <set>
+#include <string>
+#include "SimTest.h"
+#if defined(__GNUC__) && __GNUC__ < 8
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+// A sync whose transfers break partway journals only the files it completed and leaves no partial file
+// under a final name; the next sync skips those files and downloads the rest.
+// PullContentsFile passes the first pulls to the simulator, then leaves half a file behind and fails.
+
+namespace
+{
+// Pulls that still work; the link breaks for good after them
+int pulls_left = 0;
+
+SCRSDK::CrError pull_contents_file(SCRSDK::CrDeviceHandle device, SCRSDK::CrContentHandle handle,
+    SCRSDK::CrPropertyStillImageTransSize size, CrChar* dir, CrChar* file_name)
+{
+    if (0 < pulls_left) {
+        --pulls_left;
+        return cli::linked_cr_lib()->PullContentsFile(device, handle, size, dir, file_name);
+    }
+    std::ofstream(fs::path(dir) / file_name, std::ios::binary) << "half a file";
+    return SCRSDK::CrError_Generic_Unknown;
+}
+
+struct SyncResult
+{
+    bool success = false;
+    std::uint64_t skipped = 0;
+    std::uint64_t completed = 0;
+    std::uint64_t failed = 0;
+};
+
+SyncResult sync(cli::CameraDevice& camera, const std::string& dest)
+{
+    SyncResult result;
+    cli::SyncJournal journal(dest, camera.get_id());
+    if (!CHECK(journal.open())) return result;
+    cli::ContentsIndexStats index_stats{};
+    cli::ContentsDownloadStats download_stats{};
+    result.success = camera.sync_contents(2, 1, journal, cli::text(dest.begin(), dest.end()), cli::ContentsFilter(), nullptr,
+        index_stats, download_stats);
+    result.skipped = journal.skipped();
+    result.completed = download_stats.completed;
+    result.failed = download_stats.failed;
+    return result;
+}
+
+// Names in the journal, and complete and partial files on disk
+std::set<std::string> journaled(const std::string& dest)
+{
+    std::set<std::string> names;
+    std::ifstream in(fs::path(dest) / ".remotecli-sync");
+    for (std::string line; std::getline(in, line);) names.insert(line.substr(line.rfind('\t') + 1));
+    return names;
+}
+
+std::set<std::string> files(const std::string& dest, bool partial, std::uintmax_t size)
+{
+    std::set<std::string> names;
+    for (auto& entry : fs::recursive_directory_iterator(dest)) {
+        if (!fs::is_regular_file(entry.path())) continue;
+        auto name = entry.path().filename().string();
+        if (".remotecli-sync" == name) continue;
+        bool is_partial = std::string::npos != name.find(".remotecli-part");
+        if (partial == is_partial) names.insert(name);
+        // Every file under its final name is complete
+        if (!is_partial) CHECK(size == fs::file_size(entry.path()));
+    }
+    return names;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_FOLDERS", "2");
+    simtest::set_sim("CRSIM_CONTENTS", "5");
+    simtest::set_sim("CRSIM_CONTENT_BYTES", "20000");
+    const std::string dest = "sync";
+    std::error_code ec;
+    fs::remove_all(dest, ec);
+
+    auto cr_lib = *cli::linked_cr_lib();
+    cr_lib.PullContentsFile = pull_contents_file;
+    auto camera = simtest::connect_camera(SCRSDK::CrSdkControlMode_ContentsTransfer, 0, &cr_lib);
+    if (!CHECK(camera)) return simtest::finish();
+    camera->set_contents_index(std::string(), false);
+
+    pulls_left = 4;
+    auto broken = sync(*camera, dest);
+    CHECK(!broken.success);
+    CHECK(0 == broken.skipped);
+    CHECK(4 == broken.completed);
+    CHECK(6 == broken.failed);
+    auto complete = files(dest, false, 20000);
+    CHECK(4 == complete.size());
+    CHECK(complete == journaled(dest));
+    CHECK(6 == files(dest, true, 20000).size());
+
+    pulls_left = 100;
+    auto resumed = sync(*camera, dest);
+    CHECK(resumed.success);
+    CHECK(4 == resumed.skipped);
+    CHECK(6 == resumed.completed);
+    CHECK(0 == resumed.failed);
+    complete = files(dest, false, 20000);
+    CHECK(10 == complete.size());
+    CHECK(complete == journaled(dest));
+    CHECK(files(dest, true, 20000).empty());
+
+    simtest::close_camera(camera);
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}
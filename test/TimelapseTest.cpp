@@ -0,0 +1,61 @@
+#include <vector>
+#include "Timelapse.h"
+#include "SimTest.h"
+
+// Frames fire on their absolute deadlines. When the camera cannot keep up, skip leaves frames out on schedule
+// and adapt lengthens the interval instead.
+
+namespace
+{
+std::vector<cli::TimelapseFrame> run_timelapse(cli::CameraDevice& camera, cli::TimelapsePolicy policy, std::uint32_t count,
+    std::chrono::milliseconds interval, cli::TimelapseStats& stats)
+{
+    std::vector<cli::TimelapseFrame> frames;
+    cli::Timelapse timelapse(camera, policy, 4);
+    timelapse.set_frame_sink([&](std::uint32_t, cli::TimelapseFrame result, std::chrono::microseconds) { frames.push_back(result); });
+    timelapse.run(count, interval, std::chrono::seconds(5));
+    stats = timelapse.stats();
+    return frames;
+}
+} // namespace
+
+int main()
+{
+    simtest::set_sim("CRSIM_CAPTURE_MS", "50");
+    simtest::set_sim("CRSIM_SAVE_MS", "50");
+    simtest::set_sim("CRSIM_CONTENT_BYTES", "1000");
+    auto camera = simtest::connect_camera();
+    if (!CHECK(camera)) return simtest::finish();
+
+    // The camera keeps up: every frame fires within a tenth of the interval of its deadline
+    cli::TimelapseStats stats{};
+    std::chrono::milliseconds interval(300);
+    auto frames = run_timelapse(*camera, cli::TimelapsePolicy::skip, 5, interval, stats);
+    CHECK(5 == frames.size());
+    CHECK(5 == stats.fired);
+    CHECK(0 == stats.skipped);
+    CHECK(stats.jitter_p90 < interval / 10);
+    CHECK(stats.jitter_p50 <= stats.jitter_p90 && stats.jitter_p90 <= stats.jitter_max);
+    // Deadlines are absolute, so five frames end after four intervals and not much more: the last release
+    // and download (about 100 ms here) fit in one more interval, while drift would add up over the four
+    CHECK(4 * interval <= stats.elapsed);
+    CHECK(stats.elapsed < 5 * interval);
+
+    // Every release takes longer than the interval
+    frames = run_timelapse(*camera, cli::TimelapsePolicy::skip, 8, std::chrono::milliseconds(30), stats);
+    CHECK(8 == frames.size());
+    CHECK(0 < stats.skipped);
+    CHECK(8 == stats.fired + stats.skipped);
+    CHECK(0 == stats.adapted);
+    CHECK(std::chrono::milliseconds(30) == stats.interval);
+
+    frames = run_timelapse(*camera, cli::TimelapsePolicy::adapt, 8, std::chrono::milliseconds(30), stats);
+    CHECK(8 == stats.fired);
+    CHECK(0 == stats.skipped);
+    CHECK(0 < stats.adapted);
+    CHECK(std::chrono::milliseconds(30) < stats.interval);
+
+    camera->disconnect();
+    cli::linked_cr_lib()->Release();
+    return simtest::finish();
+}